@@ -0,0 +1,672 @@
+#ifndef MERLIN_ARGON2_HPP
+#define MERLIN_ARGON2_HPP
+
+#include <merlin_argon2_pool.hpp>
+#include <merlin_basic_password.hpp>
+#include <merlin_blake2b.hpp>
+#include <merlin_detail.hpp>
+#include <merlin_password_codecs.hpp>
+#include <merlin_secure_allocator.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Argon2id (RFC 9106, version 0x13) over basic_password.
+// Lanes are spread over worker threads (one per lane, capped at the hardware concurrency unless argon2_params::threads says otherwise),
+// the compression function runs on AVX-512 or AVX2 when available, and the memory blocks come from argon2_params::pool
+// when it is set and its areas are large enough, from secure_allocator otherwise; either way they are wiped after use. PHC strings ($argon2id$v=19$m=...,t=...,p=...$salt$hash) are encoded into
+// and decoded from caller-provided storage; salts and hashes of up to 64 bytes are supported there.
+
+namespace merl
+{
+    struct argon2_params
+    {
+        std::uint32_t memory_kib = 65536;   // m: memory size in KiB (1 KiB blocks)
+        std::uint32_t iterations = 3;       // t: passes over the memory
+        std::uint32_t parallelism = 1;      // p: independent lanes
+        std::uint32_t tag_size = 32;        // T: output length in bytes
+        std::uint32_t threads = 0;          // worker threads, 0 for one per lane (capped at the hardware concurrency)
+        argon2_memory_pool * pool = nullptr; // work areas to lease the memory from, nullptr to allocate it per hash
+    };
+
+    // Upper bounds on the parameters argon2id_verify() accepts from a PHC string, which may come from an untrusted store:
+    // anything above them is rejected before memory is allocated
+    struct argon2_verify_limits
+    {
+        std::uint32_t max_memory_kib = 1048576; // m, 1 GiB
+        std::uint32_t max_iterations = 64;      // t
+        std::uint32_t max_parallelism = 64;     // p
+    };
+
+    namespace detail
+    {
+        inline constexpr std::uint32_t argon2_version = 0x13;
+        inline constexpr std::uint32_t argon2_sync_points = 4;
+        inline constexpr std::uint32_t argon2_type_id = 2;
+
+        struct alignas(64) argon2_block
+        {
+            std::uint64_t v[128];
+        };
+
+        // H' of RFC 9106 section 3.3: variable-length output built from chained BLAKE2b-512 digests
+        inline void blake2b_long(unsigned char * out, std::uint32_t out_size, const void * in, std::size_t n)
+        {
+            unsigned char length[4];
+            store_le32(length, out_size);
+
+            blake2b ctx(out_size < 64 ? out_size : 64);
+            ctx.update(length, 4);
+            ctx.update(in, n);
+            if(out_size <= 64)
+                return ctx.final(out);
+
+            unsigned char v[64];
+            ctx.final(v);
+            std::memcpy(out, v, 32);
+            out += 32;
+            std::uint32_t remaining = out_size - 32;
+            while(remaining > 64)
+            {
+                blake2b::hash(v, 64, v, 64);
+                std::memcpy(out, v, 32);
+                out += 32;
+                remaining -= 32;
+            }
+            blake2b::hash(v, 64, out, remaining);
+            secure_zero(v, sizeof(v));
+        }
+
+        // --- Compression function G: next = P(prev ^ ref) ^ prev ^ ref (^ next from the second pass on) ---
+        inline std::uint64_t blamka(std::uint64_t x, std::uint64_t y) noexcept
+        {
+            return x + y + 2 * (x & 0xffffffffu) * (y & 0xffffffffu);
+        }
+        inline void blamka_g(std::uint64_t & a, std::uint64_t & b, std::uint64_t & c, std::uint64_t & d) noexcept
+        {
+            a = blamka(a, b); d = rotr64(d ^ a, 32);
+            c = blamka(c, d); b = rotr64(b ^ c, 24);
+            a = blamka(a, b); d = rotr64(d ^ a, 16);
+            c = blamka(c, d); b = rotr64(b ^ c, 63);
+        }
+        // P over 16 words given by their indices into v
+        inline void blamka_p(std::uint64_t * v, const int * i) noexcept
+        {
+            blamka_g(v[i[0]], v[i[4]], v[i[8]], v[i[12]]);
+            blamka_g(v[i[1]], v[i[5]], v[i[9]], v[i[13]]);
+            blamka_g(v[i[2]], v[i[6]], v[i[10]], v[i[14]]);
+            blamka_g(v[i[3]], v[i[7]], v[i[11]], v[i[15]]);
+            blamka_g(v[i[0]], v[i[5]], v[i[10]], v[i[15]]);
+            blamka_g(v[i[1]], v[i[6]], v[i[11]], v[i[12]]);
+            blamka_g(v[i[2]], v[i[7]], v[i[8]], v[i[13]]);
+            blamka_g(v[i[3]], v[i[4]], v[i[9]], v[i[14]]);
+        }
+        inline void argon2_fill_block_scalar(const argon2_block & prev, const argon2_block & ref, argon2_block & next, bool with_xor) noexcept
+        {
+            argon2_block r, t;
+            for(int i = 0; i < 128; ++i)
+            {
+                r.v[i] = prev.v[i] ^ ref.v[i];
+                t.v[i] = with_xor ? r.v[i] ^ next.v[i] : r.v[i];
+            }
+
+            int index[16];
+            for(int row = 0; row < 8; ++row)
+            {
+                for(int j = 0; j < 16; ++j)
+                    index[j] = 16*row + j;
+                blamka_p(r.v, index);
+            }
+            for(int column = 0; column < 8; ++column)
+            {
+                for(int j = 0; j < 8; ++j)
+                {
+                    index[2*j] = 2*column + 16*j;
+                    index[2*j + 1] = 2*column + 16*j + 1;
+                }
+                blamka_p(r.v, index);
+            }
+
+            for(int i = 0; i < 128; ++i)
+                next.v[i] = t.v[i] ^ r.v[i];
+            secure_zero(&r, sizeof(r));
+            secure_zero(&t, sizeof(t));
+        }
+
+#if MERLIN_X86_SIMD
+        // --- AVX2: a row (or a column) is four registers of four words; diagonals are lane rotations ---
+        MERLIN_TARGET("avx2")
+        inline __m256i blamka_avx2(__m256i x, __m256i y) noexcept
+        {
+            __m256i xy = _mm256_mul_epu32(x, y);
+            return _mm256_add_epi64(_mm256_add_epi64(x, y), _mm256_add_epi64(xy, xy));
+        }
+        MERLIN_TARGET("avx2")
+        inline void blamka_g_avx2(__m256i & a, __m256i & b, __m256i & c, __m256i & d) noexcept
+        {
+            const __m256i rot24 = _mm256_setr_epi8(3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10,
+                                                   3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10);
+            const __m256i rot16 = _mm256_setr_epi8(2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9,
+                                                   2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9);
+            a = blamka_avx2(a, b); d = _mm256_shuffle_epi32(_mm256_xor_si256(d, a), 0xb1);
+            c = blamka_avx2(c, d); b = _mm256_shuffle_epi8(_mm256_xor_si256(b, c), rot24);
+            a = blamka_avx2(a, b); d = _mm256_shuffle_epi8(_mm256_xor_si256(d, a), rot16);
+            c = blamka_avx2(c, d); b = _mm256_xor_si256(b, c);
+            b = _mm256_xor_si256(_mm256_srli_epi64(b, 63), _mm256_add_epi64(b, b));
+        }
+        MERLIN_TARGET("avx2")
+        inline void blamka_p_avx2(__m256i & a, __m256i & b, __m256i & c, __m256i & d) noexcept
+        {
+            blamka_g_avx2(a, b, c, d);
+            b = _mm256_permute4x64_epi64(b, 0x39);
+            c = _mm256_permute4x64_epi64(c, 0x4e);
+            d = _mm256_permute4x64_epi64(d, 0x93);
+            blamka_g_avx2(a, b, c, d);
+            b = _mm256_permute4x64_epi64(b, 0x93);
+            c = _mm256_permute4x64_epi64(c, 0x4e);
+            d = _mm256_permute4x64_epi64(d, 0x39);
+        }
+        MERLIN_TARGET("avx2")
+        inline void argon2_fill_block_avx2(const argon2_block & prev, const argon2_block & ref, argon2_block & next, bool with_xor) noexcept
+        {
+            __m256i r[32], t[32];
+            for(int i = 0; i < 32; ++i)
+            {
+                r[i] = _mm256_xor_si256(_mm256_load_si256(reinterpret_cast<const __m256i *>(prev.v) + i),
+                                        _mm256_load_si256(reinterpret_cast<const __m256i *>(ref.v) + i));
+                t[i] = with_xor ? _mm256_xor_si256(r[i], _mm256_load_si256(reinterpret_cast<const __m256i *>(next.v) + i)) : r[i];
+            }
+
+            for(int row = 0; row < 8; ++row)
+                blamka_p_avx2(r[4*row], r[4*row + 1], r[4*row + 2], r[4*row + 3]);
+
+            // Columns 2j and 2j+1 take the low and high halves of r[j], r[j+4], ..., r[j+28]
+            for(int j = 0; j < 4; ++j)
+            {
+                __m256i lo[4], hi[4];
+                for(int k = 0; k < 4; ++k)
+                {
+                    lo[k] = _mm256_permute2x128_si256(r[j + 8*k], r[j + 8*k + 4], 0x20);
+                    hi[k] = _mm256_permute2x128_si256(r[j + 8*k], r[j + 8*k + 4], 0x31);
+                }
+                blamka_p_avx2(lo[0], lo[1], lo[2], lo[3]);
+                blamka_p_avx2(hi[0], hi[1], hi[2], hi[3]);
+                for(int k = 0; k < 4; ++k)
+                {
+                    r[j + 8*k] = _mm256_permute2x128_si256(lo[k], hi[k], 0x20);
+                    r[j + 8*k + 4] = _mm256_permute2x128_si256(lo[k], hi[k], 0x31);
+                }
+            }
+
+            for(int i = 0; i < 32; ++i)
+                _mm256_store_si256(reinterpret_cast<__m256i *>(next.v) + i, _mm256_xor_si256(t[i], r[i]));
+            for(int i = 0; i < 32; ++i)
+                r[i] = t[i] = _mm256_setzero_si256();
+        }
+
+        // --- AVX-512: two rows (or two columns) at once, one per 256-bit half ---
+        // (zero-masked forms again, see rotr64_avx512)
+        MERLIN_TARGET("avx512f")
+        inline __m512i blamka_avx512(__m512i x, __m512i y) noexcept
+        {
+            __m512i xy = _mm512_maskz_mul_epu32(0xff, x, y);
+            return _mm512_add_epi64(_mm512_add_epi64(x, y), _mm512_add_epi64(xy, xy));
+        }
+        MERLIN_TARGET("avx512f")
+        inline void blamka_g_avx512(__m512i & a, __m512i & b, __m512i & c, __m512i & d) noexcept
+        {
+            a = blamka_avx512(a, b); d = rotr64_avx512<32>(_mm512_xor_si512(d, a));
+            c = blamka_avx512(c, d); b = rotr64_avx512<24>(_mm512_xor_si512(b, c));
+            a = blamka_avx512(a, b); d = rotr64_avx512<16>(_mm512_xor_si512(d, a));
+            c = blamka_avx512(c, d); b = rotr64_avx512<63>(_mm512_xor_si512(b, c));
+        }
+        MERLIN_TARGET("avx512f")
+        inline void blamka_p_avx512(__m512i & a, __m512i & b, __m512i & c, __m512i & d) noexcept
+        {
+            blamka_g_avx512(a, b, c, d);
+            b = _mm512_maskz_permutex_epi64(0xff, b, 0x39);
+            c = _mm512_maskz_permutex_epi64(0xff, c, 0x4e);
+            d = _mm512_maskz_permutex_epi64(0xff, d, 0x93);
+            blamka_g_avx512(a, b, c, d);
+            b = _mm512_maskz_permutex_epi64(0xff, b, 0x93);
+            c = _mm512_maskz_permutex_epi64(0xff, c, 0x4e);
+            d = _mm512_maskz_permutex_epi64(0xff, d, 0x39);
+        }
+        MERLIN_TARGET("avx512f")
+        inline void argon2_fill_block_avx512(const argon2_block & prev, const argon2_block & ref, argon2_block & next, bool with_xor) noexcept
+        {
+            __m512i r[16], t[16];
+            for(int i = 0; i < 16; ++i)
+            {
+                r[i] = _mm512_xor_si512(_mm512_load_si512(prev.v + 8*i), _mm512_load_si512(ref.v + 8*i));
+                t[i] = with_xor ? _mm512_xor_si512(r[i], _mm512_load_si512(next.v + 8*i)) : r[i];
+            }
+
+            // Rows 2k and 2k+1 are r[4k], r[4k+1] and r[4k+2], r[4k+3]
+            for(int k = 0; k < 4; ++k)
+            {
+                __m512i a = _mm512_maskz_shuffle_i64x2(0xff, r[4*k], r[4*k + 2], 0x44);
+                __m512i b = _mm512_maskz_shuffle_i64x2(0xff, r[4*k], r[4*k + 2], 0xee);
+                __m512i c = _mm512_maskz_shuffle_i64x2(0xff, r[4*k + 1], r[4*k + 3], 0x44);
+                __m512i d = _mm512_maskz_shuffle_i64x2(0xff, r[4*k + 1], r[4*k + 3], 0xee);
+                blamka_p_avx512(a, b, c, d);
+                r[4*k] = _mm512_maskz_shuffle_i64x2(0xff, a, b, 0x44);
+                r[4*k + 2] = _mm512_maskz_shuffle_i64x2(0xff, a, b, 0xee);
+                r[4*k + 1] = _mm512_maskz_shuffle_i64x2(0xff, c, d, 0x44);
+                r[4*k + 3] = _mm512_maskz_shuffle_i64x2(0xff, c, d, 0xee);
+            }
+
+            // Columns 4g..4g+3 take word pairs from r[g + 2m] and r[g + 2m + 2]; two columns per register
+            const __m512i gather_lo = _mm512_setr_epi64(0, 1, 8, 9, 2, 3, 10, 11);
+            const __m512i gather_hi = _mm512_setr_epi64(4, 5, 12, 13, 6, 7, 14, 15);
+            const __m512i scatter_lo = _mm512_setr_epi64(0, 1, 4, 5, 8, 9, 12, 13);
+            const __m512i scatter_hi = _mm512_setr_epi64(2, 3, 6, 7, 10, 11, 14, 15);
+            for(int g = 0; g < 2; ++g)
+            {
+                __m512i lo[4], hi[4];
+                for(int m = 0; m < 4; ++m)
+                {
+                    lo[m] = _mm512_permutex2var_epi64(r[g + 4*m], gather_lo, r[g + 4*m + 2]);
+                    hi[m] = _mm512_permutex2var_epi64(r[g + 4*m], gather_hi, r[g + 4*m + 2]);
+                }
+                blamka_p_avx512(lo[0], lo[1], lo[2], lo[3]);
+                blamka_p_avx512(hi[0], hi[1], hi[2], hi[3]);
+                for(int m = 0; m < 4; ++m)
+                {
+                    r[g + 4*m] = _mm512_permutex2var_epi64(lo[m], scatter_lo, hi[m]);
+                    r[g + 4*m + 2] = _mm512_permutex2var_epi64(lo[m], scatter_hi, hi[m]);
+                }
+            }
+
+            for(int i = 0; i < 16; ++i)
+                _mm512_store_si512(next.v + 8*i, _mm512_xor_si512(t[i], r[i]));
+            for(int i = 0; i < 16; ++i)
+                r[i] = t[i] = _mm512_setzero_si512();
+        }
+#endif
+
+        using argon2_fill_function = void (*)(const argon2_block &, const argon2_block &, argon2_block &, bool) noexcept;
+
+        inline argon2_fill_function argon2_select_fill() noexcept
+        {
+#if MERLIN_X86_SIMD
+            if(cpu().avx512f)
+                return argon2_fill_block_avx512;
+            if(cpu().avx2)
+                return argon2_fill_block_avx2;
+#endif
+            return argon2_fill_block_scalar;
+        }
+
+        struct argon2_instance
+        {
+            argon2_block * memory;
+            std::uint32_t passes;
+            std::uint32_t lanes;
+            std::uint32_t lane_length;
+            std::uint32_t segment_length;
+            std::uint32_t memory_blocks;
+            argon2_fill_function fill;
+        };
+
+        // Index of the reference block within its lane (RFC 9106 section 3.4.1.2)
+        inline std::uint32_t argon2_index_alpha(const argon2_instance & in, std::uint32_t pass, std::uint32_t slice, std::uint32_t index,
+                                                std::uint32_t pseudo_rand, bool same_lane) noexcept
+        {
+            std::uint32_t area;
+            if(pass == 0)
+            {
+                if(slice == 0)
+                    area = index - 1;
+                else if(same_lane)
+                    area = slice * in.segment_length + index - 1;
+                else
+                    area = slice * in.segment_length - (index == 0 ? 1 : 0);
+            }
+            else if(same_lane)
+                area = in.lane_length - in.segment_length + index - 1;
+            else
+                area = in.lane_length - in.segment_length - (index == 0 ? 1 : 0);
+
+            std::uint64_t x = (std::uint64_t{pseudo_rand} * pseudo_rand) >> 32;
+            std::uint32_t relative = area - 1 - static_cast<std::uint32_t>((std::uint64_t{area} * x) >> 32);
+            std::uint32_t start = (pass != 0 && slice != argon2_sync_points - 1) ? (slice + 1) * in.segment_length : 0;
+            return static_cast<std::uint32_t>((std::uint64_t{start} + relative) % in.lane_length);
+        }
+
+        inline void argon2_fill_segment(const argon2_instance & in, std::uint32_t pass, std::uint32_t lane, std::uint32_t slice) noexcept
+        {
+            // Argon2id: data-independent addressing for the first half of the first pass
+            const bool independent = pass == 0 && slice < argon2_sync_points / 2;
+
+            argon2_block zero{}, input{}, address{};
+            if(independent)
+            {
+                input.v[0] = pass;
+                input.v[1] = lane;
+                input.v[2] = slice;
+                input.v[3] = in.memory_blocks;
+                input.v[4] = in.passes;
+                input.v[5] = argon2_type_id;
+            }
+            auto next_addresses = [&]
+            {
+                ++input.v[6];
+                in.fill(zero, input, address, false);
+                in.fill(zero, address, address, false);
+            };
+
+            std::uint32_t start = 0;
+            if(pass == 0 && slice == 0)
+            {
+                start = 2; // the first two blocks of each lane come from H0
+                if(independent)
+                    next_addresses();
+            }
+
+            std::uint64_t current = std::uint64_t{lane} * in.lane_length + slice * in.segment_length + start;
+            std::uint64_t previous = current % in.lane_length == 0 ? current + in.lane_length - 1 : current - 1;
+
+            for(std::uint32_t i = start; i < in.segment_length; ++i, ++current, ++previous)
+            {
+                if(current % in.lane_length == 1)
+                    previous = current - 1;
+
+                std::uint64_t pseudo_rand;
+                if(independent)
+                {
+                    if(i % 128 == 0)
+                        next_addresses();
+                    pseudo_rand = address.v[i % 128];
+                }
+                else
+                    pseudo_rand = in.memory[previous].v[0];
+
+                std::uint32_t ref_lane = static_cast<std::uint32_t>((pseudo_rand >> 32) % in.lanes);
+                if(pass == 0 && slice == 0)
+                    ref_lane = lane;
+                std::uint32_t ref_index = argon2_index_alpha(in, pass, slice, i, static_cast<std::uint32_t>(pseudo_rand), ref_lane == lane);
+
+                in.fill(in.memory[previous], in.memory[std::uint64_t{ref_lane} * in.lane_length + ref_index], in.memory[current], pass != 0);
+            }
+
+            secure_zero(&address, sizeof(address));
+        }
+
+        inline void check_argon2_params(const argon2_params & params, std::size_t password_size, std::size_t salt_size,
+                                        std::size_t secret_size, std::size_t ad_size)
+        {
+            if(params.parallelism < 1 || params.parallelism > 0xffffff)
+                throw std::invalid_argument("merl::argon2id(): Invalid argument -> Parallelism must be 1 to 2^24-1");
+            if(params.iterations < 1)
+                throw std::invalid_argument("merl::argon2id(): Invalid argument -> Iteration count must be positive");
+            if(params.tag_size < 4)
+                throw std::invalid_argument("merl::argon2id(): Invalid argument -> Tag size must be at least 4 bytes");
+            if(params.memory_kib / 8 < params.parallelism)
+                throw std::invalid_argument("merl::argon2id(): Invalid argument -> Memory must be at least 8 KiB per lane");
+            if(salt_size < 8)
+                throw std::invalid_argument("merl::argon2id(): Invalid argument -> Salt must be at least 8 bytes");
+            if(password_size > 0xffffffffu || salt_size > 0xffffffffu || secret_size > 0xffffffffu || ad_size > 0xffffffffu)
+                throw std::length_error("merl::argon2id(): Length error -> Input longer than 2^32-1 bytes");
+        }
+
+        inline void argon2_hash(const void * password, std::size_t password_size, const void * salt, std::size_t salt_size,
+                                const void * secret, std::size_t secret_size, const void * ad, std::size_t ad_size,
+                                const argon2_params & params, unsigned char * out)
+        {
+            check_argon2_params(params, password_size, salt_size, secret_size, ad_size);
+
+            argon2_instance in;
+            in.lanes = params.parallelism;
+            in.passes = params.iterations;
+            in.segment_length = params.memory_kib / (argon2_sync_points * in.lanes);
+            in.lane_length = in.segment_length * argon2_sync_points;
+            in.memory_blocks = in.lane_length * in.lanes;
+            in.fill = argon2_select_fill();
+
+            // H0, followed by room for the block and lane indices of the first blocks
+            unsigned char h0[72];
+            {
+                blake2b ctx(64);
+                unsigned char word[4];
+                auto put = [&](std::uint32_t v)
+                {
+                    store_le32(word, v);
+                    ctx.update(word, 4);
+                };
+                put(params.parallelism);
+                put(params.tag_size);
+                put(params.memory_kib);
+                put(params.iterations);
+                put(argon2_version);
+                put(argon2_type_id);
+                put(static_cast<std::uint32_t>(password_size));
+                ctx.update(password, password_size);
+                put(static_cast<std::uint32_t>(salt_size));
+                ctx.update(salt, salt_size);
+                put(static_cast<std::uint32_t>(secret_size));
+                ctx.update(secret, secret_size);
+                put(static_cast<std::uint32_t>(ad_size));
+                ctx.update(ad, ad_size);
+                ctx.final(h0);
+            }
+
+            // Waits for a free area when the pool is exhausted; hashes too large for it allocate their own memory
+            std::size_t memory_size = std::size_t{in.memory_blocks} * sizeof(argon2_block);
+            argon2_memory_pool::lease lease;
+            secure_allocator<argon2_block> allocator;
+            struct memory_guard
+            {
+                secure_allocator<argon2_block> & allocator;
+                argon2_block * p;
+                std::size_t n;
+                ~memory_guard()
+                {
+                    if(p)
+                        allocator.deallocate(p, n);
+                }
+            } guard{allocator, nullptr, 0};
+            if(params.pool && memory_size <= params.pool->area_size())
+            {
+                lease = params.pool->acquire(memory_size);
+                in.memory = static_cast<argon2_block *>(lease.data());
+            }
+            else
+            {
+                guard.p = allocator.allocate(in.memory_blocks);
+                guard.n = in.memory_blocks;
+                in.memory = guard.p;
+            }
+
+            unsigned char bytes[1024];
+            for(std::uint32_t lane = 0; lane < in.lanes; ++lane)
+            {
+                for(std::uint32_t j = 0; j < 2; ++j)
+                {
+                    store_le32(h0 + 64, j);
+                    store_le32(h0 + 68, lane);
+                    blake2b_long(bytes, 1024, h0, 72);
+                    argon2_block & b = in.memory[std::uint64_t{lane} * in.lane_length + j];
+                    for(int i = 0; i < 128; ++i)
+                        b.v[i] = load_le64(bytes + 8*i);
+                }
+            }
+            secure_zero(h0, sizeof(h0));
+
+            // Lanes of one slice are independent; slices are synchronisation points
+            std::uint32_t workers = params.threads ? params.threads : std::max(1u, std::thread::hardware_concurrency());
+            workers = std::min(workers, in.lanes);
+            for(std::uint32_t pass = 0; pass < in.passes; ++pass)
+            {
+                for(std::uint32_t slice = 0; slice < argon2_sync_points; ++slice)
+                {
+                    auto work = [&in, pass, slice, workers](std::uint32_t first)
+                    {
+                        for(std::uint32_t lane = first; lane < in.lanes; lane += workers)
+                            argon2_fill_segment(in, pass, lane, slice);
+                    };
+                    if(workers == 1)
+                    {
+                        work(0);
+                        continue;
+                    }
+                    std::vector<std::jthread> threads;
+                    threads.reserve(workers - 1);
+                    for(std::uint32_t w = 1; w < workers; ++w)
+                        threads.emplace_back(work, w);
+                    work(0);
+                }
+            }
+
+            // Final block: XOR of the last block of every lane
+            argon2_block final_block = in.memory[in.lane_length - 1];
+            for(std::uint32_t lane = 1; lane < in.lanes; ++lane)
+                for(int i = 0; i < 128; ++i)
+                    final_block.v[i] ^= in.memory[std::uint64_t{lane} * in.lane_length + in.lane_length - 1].v[i];
+            for(int i = 0; i < 128; ++i)
+                for(int j = 0; j < 8; ++j)
+                    bytes[8*i + j] = static_cast<unsigned char>(final_block.v[i] >> (8*j));
+            blake2b_long(out, params.tag_size, bytes, sizeof(bytes));
+
+            secure_zero(bytes, sizeof(bytes));
+            secure_zero(&final_block, sizeof(final_block));
+        }
+    }
+
+    // Raw Argon2id: writes params.tag_size bytes to out. secret (K) and ad (X) are optional.
+    template <typename CharT, typename Traits, typename Alloc>
+    void argon2id(const basic_password<CharT, Traits, Alloc> & password, const void * salt, std::size_t salt_size, const argon2_params & params,
+                  unsigned char * out, const void * secret = nullptr, std::size_t secret_size = 0, const void * ad = nullptr, std::size_t ad_size = 0)
+    {
+        detail::argon2_hash(password.data(), password.size() * sizeof(CharT), salt, salt_size, secret, secret_size, ad, ad_size, params, out);
+    }
+
+    // --- PHC string format ---
+    struct argon2_phc
+    {
+        static constexpr std::size_t max_salt_size = 64;
+        static constexpr std::size_t max_hash_size = 64;
+        // "$argon2id$v=19$m=4294967295,t=4294967295,p=16777215$" plus two unpadded base64 fields of 64 bytes and a separator
+        static constexpr std::size_t max_encoded_size = 52 + 86 + 1 + 86;
+
+        argon2_params params;
+        unsigned char salt[max_salt_size];
+        std::size_t salt_size = 0;
+        unsigned char hash[max_hash_size];
+        std::size_t hash_size = 0;
+
+        ~argon2_phc()
+        {
+            detail::secure_zero(hash, sizeof(hash));
+        }
+    };
+
+    namespace detail
+    {
+        [[noreturn]] inline void throw_invalid_phc()
+        {
+            throw std::invalid_argument("merl::argon2id_decode(): Invalid argument -> Malformed PHC string");
+        }
+    }
+
+    // Writes the PHC string of phc to out (no terminator) and returns its length; throws if it does not fit
+    inline std::size_t argon2id_encode(const argon2_phc & phc, char * out, std::size_t size)
+    {
+        if(phc.salt_size > argon2_phc::max_salt_size || phc.hash_size > argon2_phc::max_hash_size)
+            throw std::invalid_argument("merl::argon2id_encode(): Invalid argument -> Salt or hash longer than 64 bytes");
+
+        char buffer[argon2_phc::max_encoded_size];
+        char * p = detail::phc_put(buffer, "$argon2id$v=19$m=");
+        p = detail::phc_put_number(p, phc.params.memory_kib);
+        p = detail::phc_put(p, ",t=");
+        p = detail::phc_put_number(p, phc.params.iterations);
+        p = detail::phc_put(p, ",p=");
+        p = detail::phc_put_number(p, phc.params.parallelism);
+        *p++ = '$';
+        p = detail::phc_put_base64(p, phc.salt, phc.salt_size);
+        *p++ = '$';
+        p = detail::phc_put_base64(p, phc.hash, phc.hash_size);
+
+        std::size_t length = static_cast<std::size_t>(p - buffer);
+        if(length > size)
+            throw std::length_error("merl::argon2id_encode(): Length error -> Output buffer too small");
+        std::memcpy(out, buffer, length);
+        return length;
+    }
+
+    // Parses an $argon2id$ PHC string (version 19) into phc; the tag size is the length of the hash field
+    inline void argon2id_decode(std::string_view s, argon2_phc & phc)
+    {
+        std::uint32_t version = 0;
+        if(!detail::phc_take(s, "$argon2id$v=") || !detail::phc_take_number(s, version) || version != detail::argon2_version
+           || !detail::phc_take(s, "$m=") || !detail::phc_take_number(s, phc.params.memory_kib)
+           || !detail::phc_take(s, ",t=") || !detail::phc_take_number(s, phc.params.iterations)
+           || !detail::phc_take(s, ",p=") || !detail::phc_take_number(s, phc.params.parallelism)
+           || !detail::phc_take(s, "$") || !detail::phc_take_base64(s, phc.salt, argon2_phc::max_salt_size, phc.salt_size)
+           || !detail::phc_take(s, "$") || !detail::phc_take_base64(s, phc.hash, argon2_phc::max_hash_size, phc.hash_size)
+           || !s.empty())
+            detail::throw_invalid_phc();
+        phc.params.tag_size = static_cast<std::uint32_t>(phc.hash_size);
+    }
+
+    // Hashes password under salt and writes the PHC string to out; returns its length
+    template <typename CharT, typename Traits, typename Alloc>
+    std::size_t argon2id_hash_encoded(const basic_password<CharT, Traits, Alloc> & password, const void * salt, std::size_t salt_size,
+                                      const argon2_params & params, char * out, std::size_t size)
+    {
+        if(salt_size > argon2_phc::max_salt_size || params.tag_size > argon2_phc::max_hash_size)
+            throw std::invalid_argument("merl::argon2id_hash_encoded(): Invalid argument -> Salt or tag longer than 64 bytes");
+
+        argon2_phc phc;
+        phc.params = params;
+        std::memcpy(phc.salt, salt, salt_size);
+        phc.salt_size = salt_size;
+        argon2id(password, salt, salt_size, params, phc.hash);
+        phc.hash_size = params.tag_size;
+        return argon2id_encode(phc, out, size);
+    }
+
+    namespace detail
+    {
+        template <typename CharT, typename Traits, typename Alloc>
+        bool argon2id_verify_decoded(const basic_password<CharT, Traits, Alloc> & password, const argon2_phc & phc, const argon2_verify_limits & limits)
+        {
+            if(phc.params.memory_kib > limits.max_memory_kib || phc.params.iterations > limits.max_iterations
+               || phc.params.parallelism > limits.max_parallelism)
+                throw std::invalid_argument("merl::argon2id_verify(): Invalid argument -> Parameters exceed the verification limits");
+
+            unsigned char computed[argon2_phc::max_hash_size];
+            argon2id(password, phc.salt, phc.salt_size, phc.params, computed);
+            bool equal = ct_equal(computed, phc.hash, phc.hash_size);
+            secure_zero(computed, sizeof(computed));
+            return equal;
+        }
+    }
+
+    // Recomputes the hash described by a PHC string and compares it in constant time; throws if its parameters exceed limits
+    template <typename CharT, typename Traits, typename Alloc>
+    bool argon2id_verify(const basic_password<CharT, Traits, Alloc> & password, std::string_view encoded, std::uint32_t threads = 0,
+                         const argon2_verify_limits & limits = {})
+    {
+        argon2_phc phc;
+        argon2id_decode(encoded, phc);
+        phc.params.threads = threads;
+        return detail::argon2id_verify_decoded(password, phc, limits);
+    }
+    // Same, with the memory leased from pool (blocks while all its areas are in use)
+    template <typename CharT, typename Traits, typename Alloc>
+    bool argon2id_verify(const basic_password<CharT, Traits, Alloc> & password, std::string_view encoded, argon2_memory_pool & pool, std::uint32_t threads = 0,
+                         const argon2_verify_limits & limits = {})
+    {
+        argon2_phc phc;
+        argon2id_decode(encoded, phc);
+        phc.params.threads = threads;
+        phc.params.pool = &pool;
+        return detail::argon2id_verify_decoded(password, phc, limits);
+    }
+}
+
+#endif // MERLIN_ARGON2_HPP
@@ -0,0 +1,212 @@
+#ifndef MERLIN_ARGON2_POOL_HPP
+#define MERLIN_ARGON2_POOL_HPP
+
+#include <merlin_detail.hpp>
+#include <merlin_secure_allocator.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+// Fixed set of reusable Argon2 work areas, so a verification does not have to map and fault in its memory every time.
+// Areas are allocated and pre-faulted up front, backed by 2 MiB pages when possible (explicit hugetlb pages first,
+// transparent huge pages otherwise), locked in RAM and excluded from core dumps. A lease wipes the part of the area
+// it was granted when it is released. When every area is leased, acquire() blocks until one comes back.
+
+namespace merl
+{
+    struct argon2_pool_options
+    {
+        std::size_t area_size = std::size_t{64} << 20;   // bytes per work area, enough for m = area_size / 1024
+        std::size_t areas = 4;                           // number of areas, i.e. concurrent hashes served from the pool
+        bool huge_pages = true;                          // back the areas with 2 MiB pages when the system allows it
+        bool lock_memory = true;                         // mlock the areas (best effort, see locked())
+    };
+
+    class argon2_memory_pool
+    {
+        public:
+            // Exclusive use of one work area; wipes the granted bytes and hands the area back on destruction
+            class lease
+            {
+                public:
+                    lease() noexcept = default;
+                    lease(lease && other) noexcept
+                        : pool_(other.pool_), index_(other.index_), size_(other.size_)
+                    {
+                        other.pool_ = nullptr;
+                    }
+                    lease & operator=(lease && other) noexcept
+                    {
+                        if(this != &other)
+                        {
+                            reset();
+                            pool_ = other.pool_;
+                            index_ = other.index_;
+                            size_ = other.size_;
+                            other.pool_ = nullptr;
+                        }
+                        return *this;
+                    }
+                    ~lease()
+                    {
+                        reset();
+                    }
+
+                    void * data() const noexcept
+                    {
+                        return pool_ ? pool_->areas_[index_].p : nullptr;
+                    }
+                    std::size_t size() const noexcept
+                    {
+                        return pool_ ? size_ : 0;
+                    }
+                    explicit operator bool() const noexcept
+                    {
+                        return pool_ != nullptr;
+                    }
+
+                    void reset() noexcept
+                    {
+                        if(pool_)
+                            pool_->release(index_, size_);
+                        pool_ = nullptr;
+                    }
+
+                private:
+                    friend class argon2_memory_pool;
+
+                    argon2_memory_pool * pool_ = nullptr;
+                    std::size_t index_ = 0;
+                    std::size_t size_ = 0;
+
+                    lease(argon2_memory_pool * pool, std::size_t index, std::size_t size) noexcept
+                        : pool_(pool), index_(index), size_(size)
+                    {}
+            };
+
+            explicit argon2_memory_pool(const argon2_pool_options & options = {})
+                : area_size_(options.area_size), huge_pages_(options.huge_pages), locked_(options.lock_memory)
+            {
+                if(!options.area_size || !options.areas)
+                    throw std::invalid_argument("merl::argon2_memory_pool::argon2_memory_pool(): Invalid argument -> Empty pool");
+
+                areas_.reserve(options.areas);
+                free_.reserve(options.areas);
+                try
+                {
+                    for(std::size_t i = 0; i < options.areas; ++i)
+                    {
+                        areas_.push_back(detail::map_locked_region(options.area_size, options.huge_pages, options.lock_memory));
+                        huge_pages_ = huge_pages_ && areas_.back().huge_pages;
+                        locked_ = locked_ && areas_.back().locked;
+                        free_.push_back(i);
+                    }
+                }
+                catch(...)
+                {
+                    for(const detail::locked_region & area : areas_)
+                        detail::unmap_locked_region(area);
+                    throw;
+                }
+            }
+            argon2_memory_pool(const argon2_memory_pool &) = delete;
+            argon2_memory_pool & operator=(const argon2_memory_pool &) = delete;
+            // Every lease must have been released
+            ~argon2_memory_pool()
+            {
+                for(const detail::locked_region & area : areas_)
+                    detail::unmap_locked_region(area);
+            }
+
+            std::size_t area_size() const noexcept
+            {
+                return area_size_;
+            }
+            std::size_t areas() const noexcept
+            {
+                return areas_.size();
+            }
+            // Whether every area is backed by huge pages (hugetlb or transparent huge pages requested)
+            bool huge_pages() const noexcept
+            {
+                return huge_pages_;
+            }
+            // Whether every area could be locked in RAM (mlock fails past RLIMIT_MEMLOCK without CAP_IPC_LOCK)
+            bool locked() const noexcept
+            {
+                return locked_;
+            }
+            std::size_t available() const
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return free_.size();
+            }
+
+            // Leases an area for size bytes, waiting until one is free
+            lease acquire(std::size_t size)
+            {
+                check_size(size);
+                std::unique_lock<std::mutex> lock(mutex_);
+                available_.wait(lock, [this] { return !free_.empty(); });
+                return take(size);
+            }
+            // Same as acquire(), but gives up after timeout and returns an empty lease
+            template <typename Rep, typename Period>
+            lease try_acquire_for(std::size_t size, const std::chrono::duration<Rep, Period> & timeout)
+            {
+                check_size(size);
+                std::unique_lock<std::mutex> lock(mutex_);
+                if(!available_.wait_for(lock, timeout, [this] { return !free_.empty(); }))
+                    return lease();
+                return take(size);
+            }
+            // Returns an empty lease instead of waiting
+            lease try_acquire(std::size_t size)
+            {
+                check_size(size);
+                std::lock_guard<std::mutex> lock(mutex_);
+                if(free_.empty())
+                    return lease();
+                return take(size);
+            }
+
+        private:
+            std::size_t area_size_;
+            bool huge_pages_;
+            bool locked_;
+            std::vector<detail::locked_region> areas_;
+            std::vector<std::size_t> free_;
+            mutable std::mutex mutex_;
+            std::condition_variable available_;
+
+            void check_size(std::size_t size) const
+            {
+                if(size > area_size_)
+                    throw std::length_error("merl::argon2_memory_pool::acquire(): Length error -> Request larger than the pool's area size");
+            }
+
+            // Called with the mutex held and at least one area free
+            lease take(std::size_t size) noexcept
+            {
+                std::size_t index = free_.back();
+                free_.pop_back();
+                return lease(this, index, size);
+            }
+
+            void release(std::size_t index, std::size_t size) noexcept
+            {
+                // Wiped outside the lock, the area is not reachable by anyone else until it is pushed back
+                detail::secure_zero(areas_[index].p, size);
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    free_.push_back(index);
+                }
+                available_.notify_one();
+            }
+    };
+}
+
+#endif // MERLIN_ARGON2_POOL_HPP
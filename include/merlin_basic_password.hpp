@@ -8,14 +8,19 @@
 #include <utility>
 #include <limits>
 #include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <merlin_detail.hpp>
+#include <merlin_password_view.hpp>
 
 namespace merl
 {
-    template <typename CharT, typename Traits = std::char_traits<CharT>>
+    template <typename CharT, typename Traits, typename Alloc>
     class basic_password
     {
         public:
             using value_type = CharT;
+            using allocator_type = Alloc;
             using size_type = std::size_t;
             using reference = value_type &;
             using const_reference = const value_type &; // reference to const
@@ -29,13 +34,36 @@ namespace merl
             static const size_type npos = -1;
 
         private:
+            using alloc_traits = std::allocator_traits<Alloc>;
+
+            // The buffer always holds size_ + 1 characters, the last one null. A moved-from password points to empty_
+            // instead, so moving never allocates (and cannot throw, whatever the resource).
+            static constexpr CharT empty_[1] {};
+
             CharT * data_;
             size_type size_;
+            [[no_unique_address]] Alloc alloc_;
 
+            static CharT * allocate(Alloc & alloc, size_type count)
+            {
+                CharT * p = alloc_traits::allocate(alloc, count);
+                std::fill_n(p, count, CharT());
+                return p;
+            }
+            CharT * allocate(size_type count)
+            {
+                return allocate(alloc_, count);
+            }
+            static CharT * moved_from() noexcept
+            {
+                return const_cast<CharT *>(empty_);
+            }
             void secure_del()
             {
-                std::fill_n(data_, size_, 0);
-                delete[] data_;
+                if(data_ == moved_from())
+                    return;
+                detail::secure_zero(data_, size_ * sizeof(CharT)); // a plain fill is a dead store before deallocation and may be elided
+                alloc_traits::deallocate(alloc_, data_, size_ + 1);
             }
             bool iterator_check(const_iterator cit) const
             {
@@ -51,51 +79,59 @@ namespace merl
 
         public:
             // Constructors
-            basic_password() : data_{new CharT[1]{}}, size_{0}
+            basic_password() : basic_password(Alloc())
             {}
-            basic_password(const CharT * p) : size_{0}
+            explicit basic_password(const Alloc & alloc) : size_{0}, alloc_{alloc}
+            {
+                data_ = allocate(1);
+            }
+            basic_password(const CharT * p, const Alloc & alloc = Alloc()) : size_{0}, alloc_{alloc}
             {
                 if(p)
                 {
                     while(p[size_++]);
 
-                    data_ = new CharT[size_];
+                    data_ = allocate(size_);
                     Traits::copy(data_, p, size_--);
                 }
                 else
-                    data_ = new CharT[size_+1]{};
+                    data_ = allocate(size_+1);
             }
-            basic_password(const CharT * p, size_type count) : size_{0}
+            basic_password(const CharT * p, size_type count, const Alloc & alloc = Alloc()) : size_{0}, alloc_{alloc}
             {
                 if(p)
                 {
                     size_ = count;
-                    data_ = new CharT[size_+1]{};
+                    data_ = allocate(size_+1);
                     Traits::copy(data_, p, size_);
                 }
                 else
-                    data_ = new CharT[size_+1]{};
+                    data_ = allocate(size_+1);
             }
-            basic_password(size_type count, CharT c) : size_{count}
+            basic_password(size_type count, CharT c, const Alloc & alloc = Alloc()) : size_{count}, alloc_{alloc}
             {
-                data_ = new CharT[size_+1]{};
+                data_ = allocate(size_+1);
                 std::fill_n(data_, size_, c);
             }
             template <typename InputIt>
-            basic_password(InputIt first, InputIt last) : size_{static_cast<size_type>(std::distance(first, last))}
+            basic_password(InputIt first, InputIt last, const Alloc & alloc = Alloc()) : size_{static_cast<size_type>(std::distance(first, last))}, alloc_{alloc}
             {
-                data_ = new CharT[size_+1]{};
+                data_ = allocate(size_+1);
                 std::copy(first, last, data_);
             }
-            basic_password(std::initializer_list<CharT> il) : basic_password(il.begin(), il.end())
+            basic_password(std::initializer_list<CharT> il, const Alloc & alloc = Alloc()) : basic_password(il.begin(), il.end(), alloc)
+            {}
+            explicit basic_password(basic_password_view<CharT, Traits> v, const Alloc & alloc = Alloc()) : basic_password(v.data(), v.size(), alloc)
             {}
 
-            basic_password(const basic_password & other) : size_{other.size_}
+            basic_password(const basic_password & other) : basic_password(other, alloc_traits::select_on_container_copy_construction(other.alloc_))
+            {}
+            basic_password(const basic_password & other, const Alloc & alloc) : size_{other.size_}, alloc_{alloc}
             {
-                data_ = new CharT[size_+1]{};
+                data_ = allocate(size_+1);
                 Traits::copy(data_, other.data_, size_);
             }
-            basic_password(basic_password && other) noexcept : data_{std::exchange(other.data_, new CharT[1]{})}, size_{std::exchange(other.size_, 0)}
+            basic_password(basic_password && other) noexcept : data_{std::exchange(other.data_, moved_from())}, size_{std::exchange(other.size_, 0)}, alloc_{other.alloc_}
             {}
 
             // Destructor
@@ -109,58 +145,99 @@ namespace merl
             {
                 if(&other != this)
                 {
-                    secure_del();
+                    if constexpr(alloc_traits::propagate_on_container_copy_assignment::value)
+                    {
+                        if(alloc_ != other.alloc_)
+                        {
+                            // Allocate from the incoming allocator before letting go of anything
+                            Alloc alloc = other.alloc_;
+                            CharT * target = allocate(alloc, other.size_+1);
+                            Traits::copy(target, other.data_, other.size_);
+
+                            secure_del();
+                            alloc_ = alloc;
+                            size_ = other.size_;
+                            data_ = target;
+                            return *this;
+                        }
+                    }
+
+                    CharT * target = allocate(other.size_+1);
+                    Traits::copy(target, other.data_, other.size_);
 
+                    secure_del();
                     size_ = other.size_;
-                    data_ = new CharT[size_+1]{};
-                    Traits::copy(data_, other.data_, size_);
+                    data_ = target;
                 }
                 return *this;
             }
-            basic_password & operator=(basic_password && other) noexcept
+            basic_password & operator=(basic_password && other) noexcept(alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value)
             {
                 if(&other != this)
                 {
+                    if constexpr(!alloc_traits::propagate_on_container_move_assignment::value && !alloc_traits::is_always_equal::value)
+                    {
+                        // Storage from another resource cannot be adopted: copy, then wipe the source
+                        if(alloc_ != other.alloc_)
+                        {
+                            *this = other;
+                            other.clear();
+                            return *this;
+                        }
+                    }
+
+                    secure_del();
+                    if constexpr(alloc_traits::propagate_on_container_move_assignment::value)
+                        alloc_ = other.alloc_;
                     size_ = std::exchange(other.size_, 0);
-                    data_ = std::exchange(other.data_, new CharT[1]{});
+                    data_ = std::exchange(other.data_, moved_from());
                 }
                 return *this;
             }
 
+            // The new buffer is built before the old one goes: an allocation that throws leaves *this as it was,
+            // and p may point into the current buffer
             basic_password & operator=(const CharT * p)
             {
-                secure_del();
-
-                size_ = 0;
-                while(p[size_++]);
+                size_type target_size = Traits::length(p);
+                CharT * target = allocate(target_size + 1);
+                Traits::copy(target, p, target_size);
 
-                data_ = new CharT[size_];
-                Traits::copy(data_, p, size_--);
+                secure_del();
+                data_ = target;
+                size_ = target_size;
 
                 return *this;
             }
             basic_password & operator=(std::nullptr_t) = delete;
             basic_password & operator=(CharT c)
             {
-                secure_del();
+                CharT * target = allocate(2);
+                target[0] = c;
 
+                secure_del();
+                data_ = target;
                 size_ = 1;
-                data_ = new CharT[size_+1]{};
-                data_[0] = c;
 
                 return *this;
             }
             basic_password & operator=(std::initializer_list<CharT> il)
             {
-                secure_del();
+                CharT * target = allocate(il.size() + 1);
+                std::copy(il.begin(), il.end(), target);
 
+                secure_del();
+                data_ = target;
                 size_ = il.size();
-                data_ = new CharT[size_+1]{};
-                std::copy(il.begin(), il.end(), data_);
 
                 return *this;
             }
 
+            allocator_type get_allocator() const noexcept
+            {
+                return alloc_;
+            }
+
             // Elements access
             const_reference operator[](size_type pos) const
             {
@@ -179,7 +256,7 @@ namespace merl
             }
             reference at(size_type pos)
             {
-                return const_cast<CharT &>(const_cast<const basic_password<CharT> &>(*this).at(pos));
+                return const_cast<CharT &>(const_cast<const basic_password &>(*this).at(pos));
             }
 
             const_pointer data() const noexcept
@@ -275,9 +352,10 @@ namespace merl
             // Operations
             void clear()
             {
+                CharT * target = allocate(1);
                 secure_del();
                 size_ = 0;
-                data_ = new CharT[size_+1]{};
+                data_ = target;
             }
             basic_password & insert(size_type index, size_type count, CharT c)
             {
@@ -290,7 +368,7 @@ namespace merl
                     return *this;
 
                 size_type target_size = size_ + count;
-                CharT * target = new CharT[target_size + 1]{};
+                CharT * target = allocate(target_size + 1);
 
                 Traits::copy(target, data_, index);
                 std::fill_n(target + index, count, c);
@@ -315,7 +393,7 @@ namespace merl
                     return *this;
 
                 size_type target_size = size_ + length;
-                CharT * target = new CharT[target_size + 1]{};
+                CharT * target = allocate(target_size + 1);
 
                 Traits::copy(target, data_, index);
                 Traits::copy(target + index, p, length);
@@ -338,7 +416,7 @@ namespace merl
                     return *this;
 
                 size_type target_size = size_ + count;
-                CharT * target = new CharT[target_size + 1]{};
+                CharT * target = allocate(target_size + 1);
 
                 Traits::copy(target, data_, index);
                 Traits::copy(target + index, p, count);
@@ -361,7 +439,7 @@ namespace merl
                     return *this;
 
                 size_type target_size = size_ + p.size_;
-                CharT * target = new CharT[target_size + 1]{};
+                CharT * target = allocate(target_size + 1);
 
                 Traits::copy(target, data_, index);
                 Traits::copy(target + index, p.data_, p.size_);
@@ -388,7 +466,7 @@ namespace merl
                     return *this;
 
                 size_type target_size = size_ + count;
-                CharT * target = new CharT[target_size + 1]{};
+                CharT * target = allocate(target_size + 1);
 
                 Traits::copy(target, data_, index);
                 Traits::copy(target + index, p.data_ + p_index, count);
@@ -436,7 +514,7 @@ namespace merl
                 
                 size_type index = pos - data_;
                 size_type target_size = size_ + length;
-                CharT * target = new CharT[target_size + 1]{};
+                CharT * target = allocate(target_size + 1);
 
                 Traits::copy(target, data_, index);
                 std::copy(first, last, target + index);
@@ -464,7 +542,7 @@ namespace merl
                     return *this;
 
                 size_type target_size = size_ - count;
-                CharT * target = new CharT[target_size + 1]{};
+                CharT * target = allocate(target_size + 1);
 
                 Traits::copy(target, data_, index);
                 Traits::copy(target + index, data_ + index+count, size_ - (index+count));
@@ -534,6 +612,10 @@ namespace merl
                 insert(data_ + size_, ilist);
                 return *this;
             }
+            basic_password & append(basic_password_view<CharT, Traits> v)
+            {
+                return insert(size_, v.data(), v.size());
+            }
 
             basic_password & operator+=(const basic_password & p)
             {
@@ -551,6 +633,10 @@ namespace merl
             {
                 return append(ilist);
             }
+            basic_password & operator+=(basic_password_view<CharT, Traits> v)
+            {
+                return append(v);
+            }
 
             int compare(const basic_password & p) const
             {
@@ -610,6 +696,17 @@ namespace merl
 
                 return result;
             }
+            int compare(basic_password_view<CharT, Traits> v) const noexcept
+            {
+                return view().compare(v);
+            }
+            int compare(size_type pos1, size_type count1, basic_password_view<CharT, Traits> v) const
+            {
+                if(pos1 >= size_)
+                    throw std::out_of_range("merl::basic_password::compare(): Out of range (position = " + std::to_string(pos1) + ", size = " + std::to_string(size_) + ')');
+
+                return view(pos1, count1).compare(v);
+            }
             int compare(const CharT * p) const
             {
                 std::size_t length = Traits::length(p);
@@ -667,6 +764,10 @@ namespace merl
                 return result;
             }
 
+            bool starts_with(basic_password_view<CharT, Traits> v) const noexcept
+            {
+                return view().starts_with(v);
+            }
             bool starts_with(CharT c) const noexcept
             {
                 return (size_ && Traits::eq(data_[0], c));
@@ -686,6 +787,10 @@ namespace merl
                 
                 return true;
             }
+            bool ends_with(basic_password_view<CharT, Traits> v) const noexcept
+            {
+                return view().ends_with(v);
+            }
             bool ends_with(CharT c) const noexcept
             {
                 return(size_ && Traits::eq(data_[size_ - 1], c));
@@ -715,26 +820,13 @@ namespace merl
                 }
                 return false;
             }
+            bool contains(basic_password_view<CharT, Traits> v) const noexcept
+            {
+                return view().contains(v);
+            }
             bool contains(const CharT * p) const
             {
-                std::size_t length = Traits::length(p);
-                if(!length)
-                    return true;
-
-                std::size_t pidx {};
-                for(std::size_t i = 0; i < size_; ++i)
-                {
-                    if(Traits::eq(data_[i], p[pidx]))
-                    {
-                        if(++pidx == length)
-                            return true;
-                    }
-                    else if(Traits::eq(data_[i], p[0]))
-                        pidx = 1;
-                    else
-                        pidx = 0;
-                }
-                return false;
+                return view().contains(p);
             }
 
             basic_password & replace(size_type pos, size_type count, const basic_password & p)
@@ -755,7 +847,7 @@ namespace merl
                 else
                 {
                     size_type target_size = size_ - nb_to_rm + p.size_;
-                    CharT * target = new CharT[target_size + 1]{};
+                    CharT * target = allocate(target_size + 1);
 
                     Traits::copy(target, data_, pos);
                     Traits::copy(target + pos, p.data_, p.size_);
@@ -798,7 +890,7 @@ namespace merl
                 else
                 {
                     size_type target_size = size_ - nb_to_rm + nb_to_place;
-                    CharT * target = new CharT[target_size + 1]{};
+                    CharT * target = allocate(target_size + 1);
 
                     Traits::copy(target, data_, pos);
                     Traits::copy(target + pos, p.data_ + pos2, nb_to_place);
@@ -831,7 +923,7 @@ namespace merl
                 else
                 {
                     size_type target_size = size_ - nb_to_rm + count2;
-                    CharT * target = new CharT[target_size + 1]{};
+                    CharT * target = allocate(target_size + 1);
 
                     Traits::copy(target, data_, pos);
                     Traits::copy(target + pos, p, count2);
@@ -882,7 +974,7 @@ namespace merl
                 else
                 {
                     size_type target_size = size_ - nb_to_rm + count2;
-                    CharT * target = new CharT[target_size + 1]{};
+                    CharT * target = allocate(target_size + 1);
 
                     Traits::copy(target, data_, pos);
                     std::fill_n(target + pos, count2, c);
@@ -928,7 +1020,7 @@ namespace merl
                 {
                     size_type index = first - data_;
                     size_type target_size = size_ - count + count2;
-                    CharT * target = new CharT[target_size + 1]{};
+                    CharT * target = allocate(target_size + 1);
 
                     Traits::copy(target, data_, index);
                     std::copy(first2, last2, target + (first - data_));
@@ -951,8 +1043,23 @@ namespace merl
                 if(pos > size_)
                     throw std::out_of_range("merl::basic_password::subpwd(): Out of range (position = " + std::to_string(pos) + ", size = " + std::to_string(size_) + ')');
                 
-                return basic_password(data_ + pos, data_ + pos + std::min(count, size_ - pos)); // If pos == size_, will call equivalent to basic_password(end(), end()), which will be empty basic_password.
+                return basic_password(data_ + pos, data_ + pos + std::min(count, size_ - pos), alloc_traits::select_on_container_copy_construction(alloc_)); // If pos == size_, will call equivalent to basic_password(end(), end()), which will be empty basic_password.
+            }
+
+            // Non-owning window onto [pos, pos + count): no allocation, no copy of the plaintext. Valid until the next modification.
+            basic_password_view<CharT, Traits> view(size_type pos = 0, size_type count = npos) const &
+            {
+                if(pos > size_)
+                    throw std::out_of_range("merl::basic_password::view(): Out of range (position = " + std::to_string(pos) + ", size = " + std::to_string(size_) + ')');
+
+                return basic_password_view<CharT, Traits>(data_ + pos, std::min(count, size_ - pos));
+            }
+            basic_password_view<CharT, Traits> view(size_type pos = 0, size_type count = npos) const && = delete;
+            explicit operator basic_password_view<CharT, Traits>() const & noexcept
+            {
+                return basic_password_view<CharT, Traits>(data_, size_);
             }
+            explicit operator basic_password_view<CharT, Traits>() const && = delete;
 
             size_type copy(CharT * dest, size_type count, size_type pos = 0) const
             {
@@ -973,7 +1080,7 @@ namespace merl
 
                 if(count != size_)
                 {
-                    CharT * target = new CharT[count + 1]{};
+                    CharT * target = allocate(count + 1);
 
                     if(count < size_)
                     {
@@ -996,6 +1103,8 @@ namespace merl
                 using std::swap;
                 swap(data_, other.data_);
                 swap(size_, other.size_);
+                if constexpr(alloc_traits::propagate_on_container_swap::value)
+                    swap(alloc_, other.alloc_);
             }
 
             // Search
@@ -1003,28 +1112,13 @@ namespace merl
             {
                 return find(p.data(), pos, p.size_);
             }
+            size_type find(basic_password_view<CharT, Traits> v, size_type pos = 0) const noexcept
+            {
+                return view().find(v, pos);
+            }
             size_type find(const CharT * p, size_type pos, size_type count) const
             {
-                if(pos >= size_)
-                    return npos;
-                if(!count)
-                    return pos;
-
-                size_type pidx {};
-                for(size_type i = pos; i < size_; ++i)
-                {
-                    if(Traits::eq(data_[i], p[pidx]))
-                    {
-                        if(++pidx == count)
-                            return i+1-count;
-                    }
-                    else if(Traits::eq(data_[i], p[0]))
-                        pidx = 1;
-                    else
-                        pidx = 0;
-                }
-
-                return npos;
+                return view().find(p, pos, count);
             }
             size_type find(const CharT * p, size_type pos = 0) const
             {
@@ -1047,30 +1141,13 @@ namespace merl
             {
                 return rfind(p.data(), pos, p.size_);
             }
+            size_type rfind(basic_password_view<CharT, Traits> v, size_type pos = npos) const noexcept
+            {
+                return view().rfind(v, pos);
+            }
             size_type rfind(const CharT * p, size_type pos, size_type count) const
             {
-                if(!size_)
-                    return npos;
-                if(!count)
-                    return (pos < size_ ? pos : size_);
-                if(pos >= size_)
-                    pos = size_-1;
-
-                size_type pidx{};
-                for(size_type i = 0; i <= pos; ++i)
-                {
-                    if(Traits::eq(data_[pos - i], p[count-1 - pidx]))
-                    {
-                        if(++pidx == count)
-                            return pos-i;
-                    }
-                    else if(Traits::eq(data_[pos - i], p[count-1]))
-                        pidx = 1;
-                    else
-                        pidx = 0;
-                }
-
-                return npos;
+                return view().rfind(p, pos, count);
             }
             size_type rfind(const CharT * p, size_type pos = npos) const
             {
@@ -1212,13 +1289,13 @@ namespace merl
     };
 
     // Non-member functions
-    template <typename CharT, typename Traits>
-    std::basic_ostream<CharT, Traits> & operator<<(std::basic_ostream<CharT, Traits> & os, const basic_password<CharT, Traits> & p)
+    template <typename CharT, typename Traits, typename Alloc>
+    std::basic_ostream<CharT, Traits> & operator<<(std::basic_ostream<CharT, Traits> & os, const basic_password<CharT, Traits, Alloc> & p)
     {
         return (os << p.data());
     }
-    template <typename CharT, typename Traits>
-    std::basic_istream<CharT, Traits> & operator>>(std::basic_istream<CharT, Traits> & is, basic_password<CharT, Traits> & p)
+    template <typename CharT, typename Traits, typename Alloc>
+    std::basic_istream<CharT, Traits> & operator>>(std::basic_istream<CharT, Traits> & is, basic_password<CharT, Traits, Alloc> & p)
     {
         static const std::size_t SIZE = 1024;
         CharT buffer[SIZE];
@@ -1228,18 +1305,18 @@ namespace merl
         return is;
     }
 
-    template <typename CharT, typename Traits>
-    bool operator==(const basic_password<CharT, Traits> & lhs, const basic_password<CharT, Traits> & rhs)
+    template <typename CharT, typename Traits, typename Alloc>
+    bool operator==(const basic_password<CharT, Traits, Alloc> & lhs, const basic_password<CharT, Traits, Alloc> & rhs)
     {
         return !lhs.compare(rhs);
     }
-    template <typename CharT, typename Traits>
-    bool operator==(const basic_password<CharT, Traits> & lhs, const CharT * rhs)
+    template <typename CharT, typename Traits, typename Alloc>
+    bool operator==(const basic_password<CharT, Traits, Alloc> & lhs, const CharT * rhs)
     {
         return !lhs.compare(rhs);
     }
-    template <typename CharT, typename Traits>
-    Traits::comparison_category operator<=>(const basic_password<CharT, Traits> & lhs, const basic_password<CharT, Traits> & rhs)
+    template <typename CharT, typename Traits, typename Alloc>
+    Traits::comparison_category operator<=>(const basic_password<CharT, Traits, Alloc> & lhs, const basic_password<CharT, Traits, Alloc> & rhs)
     {
         if(lhs.compare(rhs) < 0)
             return Traits::comparison_category::less;
@@ -1249,8 +1326,8 @@ namespace merl
 
         return Traits::comparison_category::equal;
     }
-    template <typename CharT, typename Traits>
-    Traits::comparison_category operator<=>(const basic_password<CharT, Traits> & lhs, const CharT * rhs)
+    template <typename CharT, typename Traits, typename Alloc>
+    Traits::comparison_category operator<=>(const basic_password<CharT, Traits, Alloc> & lhs, const CharT * rhs)
     {
         if(lhs.compare(rhs) < 0)
             return Traits::comparison_category::less;
@@ -1261,83 +1338,94 @@ namespace merl
         return Traits::comparison_category::equal;
     }
 
-    template <typename CharT, typename Traits>
-    void swap(basic_password<CharT, Traits> & lhs, basic_password<CharT, Traits> & rhs) noexcept
+    template <typename CharT, typename Traits, typename Alloc>
+    bool operator==(const basic_password<CharT, Traits, Alloc> & lhs, basic_password_view<CharT, Traits> rhs) noexcept
+    {
+        return lhs.view() == rhs;
+    }
+    template <typename CharT, typename Traits, typename Alloc>
+    Traits::comparison_category operator<=>(const basic_password<CharT, Traits, Alloc> & lhs, basic_password_view<CharT, Traits> rhs) noexcept
+    {
+        return lhs.view() <=> rhs;
+    }
+
+    template <typename CharT, typename Traits, typename Alloc>
+    void swap(basic_password<CharT, Traits, Alloc> & lhs, basic_password<CharT, Traits, Alloc> & rhs) noexcept
     {
         lhs.swap(rhs);
     }
 
-    template <typename CharT, typename Traits>
-    basic_password<CharT, Traits> operator+(const basic_password<CharT, Traits> & lhs, const basic_password<CharT, Traits> & rhs)
+    template <typename CharT, typename Traits, typename Alloc>
+    basic_password<CharT, Traits, Alloc> operator+(const basic_password<CharT, Traits, Alloc> & lhs, const basic_password<CharT, Traits, Alloc> & rhs)
     {
-        return basic_password<CharT, Traits>(lhs) += rhs;
+        return basic_password<CharT, Traits, Alloc>(lhs) += rhs;
     }
-    template <typename CharT, typename Traits>
-    basic_password<CharT, Traits> operator+(const basic_password<CharT, Traits> & lhs, const CharT * rhs)
+    template <typename CharT, typename Traits, typename Alloc>
+    basic_password<CharT, Traits, Alloc> operator+(const basic_password<CharT, Traits, Alloc> & lhs, const CharT * rhs)
     {
-        return basic_password<CharT, Traits>(lhs) += rhs;
+        return basic_password<CharT, Traits, Alloc>(lhs) += rhs;
     }
-    template <typename CharT, typename Traits>
-    basic_password<CharT, Traits> operator+(const basic_password<CharT, Traits> & lhs, CharT rhs)
+    template <typename CharT, typename Traits, typename Alloc>
+    basic_password<CharT, Traits, Alloc> operator+(const basic_password<CharT, Traits, Alloc> & lhs, CharT rhs)
     {
-        return basic_password<CharT, Traits>(lhs) += rhs;
+        return basic_password<CharT, Traits, Alloc>(lhs) += rhs;
     }
-    template <typename CharT, typename Traits>
-    basic_password<CharT, Traits> operator+(const CharT * lhs, const basic_password<CharT, Traits> & rhs)
+    template <typename CharT, typename Traits, typename Alloc>
+    basic_password<CharT, Traits, Alloc> operator+(const CharT * lhs, const basic_password<CharT, Traits, Alloc> & rhs)
     {
-        return basic_password<CharT, Traits>(lhs) += rhs;
+        return basic_password<CharT, Traits, Alloc>(lhs, std::allocator_traits<Alloc>::select_on_container_copy_construction(rhs.get_allocator())) += rhs;
     }
-    template <typename CharT, typename Traits>
-    basic_password<CharT, Traits> operator+(CharT lhs, const basic_password<CharT, Traits> & rhs)
+    template <typename CharT, typename Traits, typename Alloc>
+    basic_password<CharT, Traits, Alloc> operator+(CharT lhs, const basic_password<CharT, Traits, Alloc> & rhs)
     {
-        return basic_password<CharT, Traits>(1, lhs) += rhs;
+        return basic_password<CharT, Traits, Alloc>(1, lhs, std::allocator_traits<Alloc>::select_on_container_copy_construction(rhs.get_allocator())) += rhs;
     }
-    template <typename CharT, typename Traits>
-    basic_password<CharT, Traits> operator+(basic_password<CharT, Traits> && lhs, basic_password<CharT, Traits> && rhs)
+    template <typename CharT, typename Traits, typename Alloc>
+    basic_password<CharT, Traits, Alloc> operator+(basic_password<CharT, Traits, Alloc> && lhs, basic_password<CharT, Traits, Alloc> && rhs)
     {
-        return basic_password<CharT, Traits>(std::move(lhs)) += rhs;
+        return basic_password<CharT, Traits, Alloc>(std::move(lhs)) += rhs;
     }
-    template <typename CharT, typename Traits>
-    basic_password<CharT, Traits> operator+(basic_password<CharT, Traits> && lhs, const basic_password<CharT, Traits> & rhs)
+    template <typename CharT, typename Traits, typename Alloc>
+    basic_password<CharT, Traits, Alloc> operator+(basic_password<CharT, Traits, Alloc> && lhs, const basic_password<CharT, Traits, Alloc> & rhs)
     {
-        return basic_password<CharT, Traits>(std::move(lhs)) += rhs;
+        return basic_password<CharT, Traits, Alloc>(std::move(lhs)) += rhs;
     }
-    template <typename CharT, typename Traits>
-    basic_password<CharT, Traits> operator+(basic_password<CharT, Traits> && lhs, const CharT * rhs)
+    template <typename CharT, typename Traits, typename Alloc>
+    basic_password<CharT, Traits, Alloc> operator+(basic_password<CharT, Traits, Alloc> && lhs, const CharT * rhs)
     {
-        return basic_password<CharT, Traits>(std::move(lhs)) += rhs;
+        return basic_password<CharT, Traits, Alloc>(std::move(lhs)) += rhs;
     }
-    template <typename CharT, typename Traits>
-    basic_password<CharT, Traits> operator+(basic_password<CharT, Traits> && lhs, CharT rhs)
+    template <typename CharT, typename Traits, typename Alloc>
+    basic_password<CharT, Traits, Alloc> operator+(basic_password<CharT, Traits, Alloc> && lhs, CharT rhs)
     {
-        return basic_password<CharT, Traits>(std::move(lhs)) += rhs;
+        return basic_password<CharT, Traits, Alloc>(std::move(lhs)) += rhs;
     }
-    template <typename CharT, typename Traits>
-    basic_password<CharT, Traits> operator+(const basic_password<CharT, Traits> & lhs, basic_password<CharT, Traits> && rhs)
+    template <typename CharT, typename Traits, typename Alloc>
+    basic_password<CharT, Traits, Alloc> operator+(const basic_password<CharT, Traits, Alloc> & lhs, basic_password<CharT, Traits, Alloc> && rhs)
     {
-        return basic_password<CharT, Traits>(std::move(rhs)).insert(0, lhs);
+        return basic_password<CharT, Traits, Alloc>(std::move(rhs)).insert(0, lhs);
     }
-    template <typename CharT, typename Traits>
-    basic_password<CharT, Traits> operator+(const CharT * lhs, basic_password<CharT, Traits> && rhs)
+    template <typename CharT, typename Traits, typename Alloc>
+    basic_password<CharT, Traits, Alloc> operator+(const CharT * lhs, basic_password<CharT, Traits, Alloc> && rhs)
     {
-        return basic_password<CharT, Traits>(std::move(rhs)).insert(0, lhs);
+        return basic_password<CharT, Traits, Alloc>(std::move(rhs)).insert(0, lhs);
     }
-    template <typename CharT, typename Traits>
-    basic_password<CharT, Traits> operator+(CharT lhs, basic_password<CharT, Traits> && rhs)
+    template <typename CharT, typename Traits, typename Alloc>
+    basic_password<CharT, Traits, Alloc> operator+(CharT lhs, basic_password<CharT, Traits, Alloc> && rhs)
     {
-        return basic_password<CharT, Traits>(std::move(rhs)).insert(static_cast<basic_password<CharT, Traits>::size_type>(0), 1, lhs);
+        return basic_password<CharT, Traits, Alloc>(std::move(rhs)).insert(static_cast<basic_password<CharT, Traits, Alloc>::size_type>(0), 1, lhs);
     }
 
-    template <typename CharT, typename Traits, typename U>
-    basic_password<CharT, Traits>::size_type erase(basic_password<CharT, Traits> & p, const U & value)
+    template <typename CharT, typename Traits, typename Alloc, typename U>
+    basic_password<CharT, Traits, Alloc>::size_type erase(basic_password<CharT, Traits, Alloc> & p, const U & value)
     {
         auto it = std::remove(p.begin(), p.end(), value);
         auto r = p.end() - it;
         p.erase(it, p.end());
         return r;
     }
-    template <typename CharT, typename Traits, typename Pred>
-    basic_password<CharT, Traits>::size_type erase_if(basic_password<CharT, Traits> & p, Pred pred)
+    template <typename CharT, typename Traits, typename Alloc, typename Pred>
+    basic_password<CharT, Traits, Alloc>::size_type erase_if(basic_password<CharT, Traits, Alloc> & p, Pred pred)
     {
         auto it = std::remove_if(p.begin(), p.end(), pred);
         auto r = p.end() - it;
@@ -1345,8 +1433,8 @@ namespace merl
         return r;
     }
 
-    template <typename CharT, typename Traits>
-    std::basic_istream<CharT, Traits> & getline(std::basic_istream<CharT, Traits> & input, basic_password<CharT, Traits> & p, CharT delim)
+    template <typename CharT, typename Traits, typename Alloc>
+    std::basic_istream<CharT, Traits> & getline(std::basic_istream<CharT, Traits> & input, basic_password<CharT, Traits, Alloc> & p, CharT delim)
     {
         p.clear();
 
@@ -1369,23 +1457,40 @@ namespace merl
 
         return input;
     }
-    template <typename CharT, typename Traits>
-    std::basic_istream<CharT, Traits> & getline(std::basic_istream<CharT, Traits> && input, basic_password<CharT, Traits> & p, CharT delim)
+    template <typename CharT, typename Traits, typename Alloc>
+    std::basic_istream<CharT, Traits> & getline(std::basic_istream<CharT, Traits> && input, basic_password<CharT, Traits, Alloc> & p, CharT delim)
     {
         return getline(input, p, delim); // Call the lvalue overload 
     }
-    template <typename CharT, typename Traits>
-    std::basic_istream<CharT, Traits> & getline(std::basic_istream<CharT, Traits> & input, basic_password<CharT, Traits> & p)
+    template <typename CharT, typename Traits, typename Alloc>
+    std::basic_istream<CharT, Traits> & getline(std::basic_istream<CharT, Traits> & input, basic_password<CharT, Traits, Alloc> & p)
     {
         return getline(input, p, input.widen('\n'));
     }
-    template <typename CharT, typename Traits>
-    std::basic_istream<CharT, Traits> & getline(std::basic_istream<CharT, Traits> && input, basic_password<CharT, Traits> & p)
+    template <typename CharT, typename Traits, typename Alloc>
+    std::basic_istream<CharT, Traits> & getline(std::basic_istream<CharT, Traits> && input, basic_password<CharT, Traits, Alloc> & p)
     {
         return getline(static_cast<std::basic_istream<CharT, Traits> &&>(input), p, input.widen('\n'));
     }
 
     using password = basic_password<char>;
+    using wpassword = basic_password<wchar_t>;
+    using u8password = basic_password<char8_t>;
+    using u16password = basic_password<char16_t>;
+    using u32password = basic_password<char32_t>;
+
+    // Passwords whose storage comes from a std::pmr::memory_resource, such as secure_arena
+    namespace pmr
+    {
+        template <typename CharT, typename Traits = std::char_traits<CharT>>
+        using basic_password = merl::basic_password<CharT, Traits, std::pmr::polymorphic_allocator<CharT>>;
+
+        using password = basic_password<char>;
+        using wpassword = basic_password<wchar_t>;
+        using u8password = basic_password<char8_t>;
+        using u16password = basic_password<char16_t>;
+        using u32password = basic_password<char32_t>;
+    }
 }
 
 #endif // MERLIN_BASIC_PASSWORD_HPP
\ No newline at end of file
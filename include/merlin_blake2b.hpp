@@ -0,0 +1,201 @@
+#ifndef MERLIN_BLAKE2B_HPP
+#define MERLIN_BLAKE2B_HPP
+
+#include <merlin_basic_password.hpp>
+#include <merlin_detail.hpp>
+#include <merlin_siphash.hpp>
+
+#include <stdexcept>
+#include <string_view>
+
+// BLAKE2b (RFC 7693) with a 1 to 64 byte digest and an optional key, incremental like merl::sha256.
+// The context is wiped on destruction; the last block is kept buffered, since it has to be compressed with the final flag.
+
+namespace merl
+{
+    namespace detail
+    {
+        inline constexpr std::uint64_t blake2b_iv[8] = {
+            0x6a09e667f3bcc908ull, 0xbb67ae8584caa73bull, 0x3c6ef372fe94f82bull, 0xa54ff53a5f1d36f1ull,
+            0x510e527fade682d1ull, 0x9b05688c2b3e6c1full, 0x1f83d9abfb41bd6bull, 0x5be0cd19137e2179ull
+        };
+        inline constexpr unsigned char blake2b_sigma[12][16] = {
+            {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+            {14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3},
+            {11, 8, 12, 0, 5, 2, 15, 13, 10, 14, 3, 6, 7, 1, 9, 4},
+            {7, 9, 3, 1, 13, 12, 11, 14, 2, 6, 5, 10, 4, 0, 15, 8},
+            {9, 0, 5, 7, 2, 4, 10, 15, 14, 1, 11, 12, 6, 8, 3, 13},
+            {2, 12, 6, 10, 0, 11, 8, 3, 4, 13, 7, 5, 15, 14, 1, 9},
+            {12, 5, 1, 15, 14, 13, 4, 10, 0, 7, 6, 3, 9, 2, 8, 11},
+            {13, 11, 7, 14, 12, 1, 3, 9, 5, 0, 15, 4, 8, 6, 2, 10},
+            {6, 15, 14, 9, 11, 3, 0, 8, 12, 2, 13, 7, 1, 4, 10, 5},
+            {10, 2, 8, 4, 7, 6, 1, 5, 15, 11, 9, 14, 3, 12, 13, 0},
+            {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+            {14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3}
+        };
+
+        inline void blake2b_g(std::uint64_t * v, int a, int b, int c, int d, std::uint64_t x, std::uint64_t y) noexcept
+        {
+            v[a] = v[a] + v[b] + x; v[d] = rotr64(v[d] ^ v[a], 32);
+            v[c] = v[c] + v[d];     v[b] = rotr64(v[b] ^ v[c], 24);
+            v[a] = v[a] + v[b] + y; v[d] = rotr64(v[d] ^ v[a], 16);
+            v[c] = v[c] + v[d];     v[b] = rotr64(v[b] ^ v[c], 63);
+        }
+
+        inline void blake2b_compress(std::uint64_t * h, const unsigned char * block, std::uint64_t t0, std::uint64_t t1, bool last) noexcept
+        {
+            std::uint64_t m[16], v[16];
+            for(int i = 0; i < 16; ++i)
+                m[i] = load_le64(block + 8*i);
+            for(int i = 0; i < 8; ++i)
+            {
+                v[i] = h[i];
+                v[i + 8] = blake2b_iv[i];
+            }
+            v[12] ^= t0;
+            v[13] ^= t1;
+            if(last)
+                v[14] = ~v[14];
+
+            for(const auto & s : blake2b_sigma)
+            {
+                blake2b_g(v, 0, 4, 8, 12, m[s[0]], m[s[1]]);
+                blake2b_g(v, 1, 5, 9, 13, m[s[2]], m[s[3]]);
+                blake2b_g(v, 2, 6, 10, 14, m[s[4]], m[s[5]]);
+                blake2b_g(v, 3, 7, 11, 15, m[s[6]], m[s[7]]);
+                blake2b_g(v, 0, 5, 10, 15, m[s[8]], m[s[9]]);
+                blake2b_g(v, 1, 6, 11, 12, m[s[10]], m[s[11]]);
+                blake2b_g(v, 2, 7, 8, 13, m[s[12]], m[s[13]]);
+                blake2b_g(v, 3, 4, 9, 14, m[s[14]], m[s[15]]);
+            }
+
+            for(int i = 0; i < 8; ++i)
+                h[i] ^= v[i] ^ v[i + 8];
+            secure_zero(m, sizeof(m));
+            secure_zero(v, sizeof(v));
+        }
+    }
+
+    class blake2b
+    {
+        public:
+            static constexpr std::size_t block_size = 128;
+            static constexpr std::size_t max_digest_size = 64;
+
+            explicit blake2b(std::size_t digest_size = 64, const void * key = nullptr, std::size_t key_size = 0)
+                : digest_size_(digest_size)
+            {
+                if(!digest_size || digest_size > max_digest_size)
+                    throw std::invalid_argument("merl::blake2b::blake2b(): Invalid argument -> Digest size must be 1 to 64 bytes");
+                if(key_size > 64)
+                    throw std::invalid_argument("merl::blake2b::blake2b(): Invalid argument -> Key size must be at most 64 bytes");
+
+                for(int i = 0; i < 8; ++i)
+                    h_[i] = detail::blake2b_iv[i];
+                h_[0] ^= 0x01010000ull ^ (std::uint64_t{key_size} << 8) ^ digest_size;
+                std::memset(buffer_, 0, block_size);
+                if(key_size)
+                {
+                    std::memcpy(buffer_, key, key_size);
+                    buffered_ = block_size;
+                }
+            }
+            blake2b(const blake2b &) noexcept = default;
+            blake2b & operator=(const blake2b &) noexcept = default;
+            ~blake2b()
+            {
+                detail::secure_zero(this, sizeof(*this));
+            }
+
+            std::size_t digest_size() const noexcept
+            {
+                return digest_size_;
+            }
+
+            blake2b & update(const void * data, std::size_t n) noexcept
+            {
+                const unsigned char * p = static_cast<const unsigned char *>(data);
+                while(n)
+                {
+                    if(buffered_ == block_size)
+                    {
+                        count(block_size);
+                        detail::blake2b_compress(h_, buffer_, t0_, t1_, false);
+                        buffered_ = 0;
+                    }
+                    // Whole blocks that are not the last one are compressed in place
+                    while(!buffered_ && n > block_size)
+                    {
+                        count(block_size);
+                        detail::blake2b_compress(h_, p, t0_, t1_, false);
+                        p += block_size;
+                        n -= block_size;
+                    }
+                    std::size_t take = n < block_size - buffered_ ? n : block_size - buffered_;
+                    std::memcpy(buffer_ + buffered_, p, take);
+                    buffered_ += take;
+                    p += take;
+                    n -= take;
+                }
+                return *this;
+            }
+            template <typename CharT, typename Traits, typename Alloc>
+            blake2b & update(const basic_password<CharT, Traits, Alloc> & p) noexcept
+            {
+                return update(p.data(), p.size() * sizeof(CharT));
+            }
+            template <typename CharT, typename Traits>
+            blake2b & update(basic_password_view<CharT, Traits> v) noexcept
+            {
+                return update(v.data(), v.size() * sizeof(CharT));
+            }
+            template <typename CharT, typename Traits>
+            blake2b & update(std::basic_string_view<CharT, Traits> sv) noexcept
+            {
+                return update(sv.data(), sv.size() * sizeof(CharT));
+            }
+
+            // Writes digest_size() bytes to digest; the context is wiped and must not be updated again
+            void final(unsigned char * digest) noexcept
+            {
+                count(buffered_);
+                std::memset(buffer_ + buffered_, 0, block_size - buffered_);
+                detail::blake2b_compress(h_, buffer_, t0_, t1_, true);
+
+                unsigned char out[64];
+                for(int i = 0; i < 8; ++i)
+                    for(int j = 0; j < 8; ++j)
+                        out[8*i + j] = static_cast<unsigned char>(h_[i] >> (8*j));
+                std::memcpy(digest, out, digest_size_);
+
+                detail::secure_zero(out, sizeof(out));
+                std::size_t size = digest_size_;
+                detail::secure_zero(this, sizeof(*this));
+                digest_size_ = size;
+            }
+
+            // One-shot hash of n bytes into a digest_size byte digest
+            static void hash(const void * data, std::size_t n, unsigned char * digest, std::size_t digest_size = 64)
+            {
+                blake2b ctx(digest_size);
+                ctx.update(data, n);
+                ctx.final(digest);
+            }
+
+        private:
+            std::uint64_t h_[8];
+            std::uint64_t t0_ = 0;
+            std::uint64_t t1_ = 0;
+            std::size_t digest_size_;
+            std::size_t buffered_ = 0;
+            unsigned char buffer_[block_size];
+
+            void count(std::size_t n) noexcept
+            {
+                t0_ += n;
+                t1_ += t0_ < n;
+            }
+    };
+}
+
+#endif // MERLIN_BLAKE2B_HPP
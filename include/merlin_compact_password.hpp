@@ -0,0 +1,583 @@
+#ifndef MERLIN_COMPACT_PASSWORD_HPP
+#define MERLIN_COMPACT_PASSWORD_HPP
+
+#include <merlin_basic_password.hpp>
+#include <merlin_detail.hpp>
+#include <merlin_password_hash.hpp>
+#include <merlin_password_view.hpp>
+#include <merlin_secure_allocator.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+// basic_compact_password: a password the size of one pointer. The size and capacity live in a header at the start
+// of the secure block instead of in the object, so large arrays of secrets take half the index memory of
+// basic_password. Reading the size touches the block, which the characters share a cache line with anyway.
+// An empty password holds no block. Released blocks are wiped by secure_allocator, header included.
+
+namespace merl
+{
+    template <typename CharT, typename Traits = std::char_traits<CharT>>
+    class basic_compact_password
+    {
+        public:
+            using traits_type = Traits;
+            using value_type = CharT;
+            using size_type = std::size_t;
+            using difference_type = std::ptrdiff_t;
+            using reference = CharT &;
+            using const_reference = const CharT &;
+            using pointer = CharT *;
+            using const_pointer = const CharT *;
+            using iterator = CharT *;
+            using const_iterator = const CharT *;
+            using reverse_iterator = std::reverse_iterator<iterator>;
+            using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+            static constexpr size_type npos = -1;
+
+        private:
+            struct header
+            {
+                size_type size;
+                size_type capacity;
+            };
+            static_assert(sizeof(header) % alignof(CharT) == 0);
+
+            static constexpr CharT empty_[1] {};
+
+            header * block_ = nullptr;
+
+            static size_type block_bytes(size_type capacity) noexcept
+            {
+                return sizeof(header) + (capacity + 1) * sizeof(CharT);
+            }
+            static CharT * chars(header * h) noexcept
+            {
+                return reinterpret_cast<CharT *>(reinterpret_cast<std::byte *>(h) + sizeof(header));
+            }
+            static void secure_del(header * h) noexcept
+            {
+                if(h)
+                    secure_allocator<std::byte>().deallocate(reinterpret_cast<std::byte *>(h), block_bytes(h->capacity));
+            }
+
+            // Moves the characters to a block of new_cap; v may point into the current block
+            void reallocate(size_type new_cap, basic_password_view<CharT, Traits> v = {})
+            {
+                if(new_cap > max_size())
+                    throw std::length_error("merl::basic_compact_password::reallocate(): Length error -> size exceeds max_size()");
+
+                header * h = reinterpret_cast<header *>(secure_allocator<std::byte>().allocate(block_bytes(new_cap)));
+                size_type old_size = size();
+                ::new(h) header{old_size + v.size(), new_cap};
+                Traits::copy(chars(h), data(), old_size);
+                Traits::copy(chars(h) + old_size, v.data(), v.size());
+                chars(h)[h->size] = CharT();
+                secure_del(std::exchange(block_, h));
+            }
+            void check_position(size_type pos, const char * func) const
+            {
+                if(pos > size())
+                    throw std::out_of_range(std::string("merl::basic_compact_password::") + func + "(): Out of range (position = " + std::to_string(pos) + ", size = " + std::to_string(size()) + ')');
+            }
+
+        public:
+            // Constructors
+            basic_compact_password() noexcept = default;
+            explicit basic_compact_password(basic_password_view<CharT, Traits> v)
+            {
+                append(v);
+            }
+            template <typename Alloc>
+            explicit basic_compact_password(const basic_password<CharT, Traits, Alloc> & p)
+            {
+                append(p.view());
+            }
+            explicit basic_compact_password(const CharT * p)
+            {
+                append(basic_password_view<CharT, Traits>(p));
+            }
+            basic_compact_password(std::nullptr_t) = delete;
+            basic_compact_password(const basic_compact_password & other)
+            {
+                append(other.view());
+            }
+            basic_compact_password(basic_compact_password && other) noexcept : block_{std::exchange(other.block_, nullptr)}
+            {}
+
+            // Destructor
+            ~basic_compact_password()
+            {
+                secure_del(block_);
+            }
+
+            // Assignment
+            basic_compact_password & operator=(const basic_compact_password & other)
+            {
+                if(this != &other)
+                {
+                    clear();
+                    append(other.view());
+                }
+                return *this;
+            }
+            basic_compact_password & operator=(basic_compact_password && other) noexcept
+            {
+                if(this != &other)
+                    secure_del(std::exchange(block_, std::exchange(other.block_, nullptr)));
+                return *this;
+            }
+            basic_compact_password & operator=(basic_password_view<CharT, Traits> v)
+            {
+                return assign(v);
+            }
+            basic_compact_password & assign(basic_password_view<CharT, Traits> v)
+            {
+                // v may alias the current contents, so build aside first
+                basic_compact_password tmp(v);
+                return *this = std::move(tmp);
+            }
+
+            // Elements access
+            CharT & at(size_type pos)
+            {
+                if(pos >= size())
+                    throw std::out_of_range("merl::basic_compact_password::at(): Out of range (pos = " + std::to_string(pos) + ", size = " + std::to_string(size()) + ')');
+
+                return data()[pos];
+            }
+            const CharT & at(size_type pos) const
+            {
+                if(pos >= size())
+                    throw std::out_of_range("merl::basic_compact_password::at(): Out of range (pos = " + std::to_string(pos) + ", size = " + std::to_string(size()) + ')');
+
+                return data()[pos];
+            }
+            CharT & operator[](size_type pos) noexcept
+            {
+                return data()[pos];
+            }
+            const CharT & operator[](size_type pos) const noexcept
+            {
+                return data()[pos];
+            }
+            CharT & front() noexcept
+            {
+                return data()[0];
+            }
+            const CharT & front() const noexcept
+            {
+                return data()[0];
+            }
+            CharT & back() noexcept
+            {
+                return data()[size() - 1];
+            }
+            const CharT & back() const noexcept
+            {
+                return data()[size() - 1];
+            }
+            // Null terminated; the empty password's characters are shared and must not be written
+            CharT * data() noexcept
+            {
+                return block_ ? chars(block_) : const_cast<CharT *>(empty_);
+            }
+            const CharT * data() const noexcept
+            {
+                return block_ ? chars(block_) : empty_;
+            }
+
+            // Iterators
+            iterator begin() noexcept
+            {
+                return data();
+            }
+            const_iterator begin() const noexcept
+            {
+                return data();
+            }
+            const_iterator cbegin() const noexcept
+            {
+                return begin();
+            }
+            iterator end() noexcept
+            {
+                return data() + size();
+            }
+            const_iterator end() const noexcept
+            {
+                return data() + size();
+            }
+            const_iterator cend() const noexcept
+            {
+                return end();
+            }
+            reverse_iterator rbegin() noexcept
+            {
+                return reverse_iterator(end());
+            }
+            const_reverse_iterator rbegin() const noexcept
+            {
+                return const_reverse_iterator(end());
+            }
+            const_reverse_iterator crbegin() const noexcept
+            {
+                return rbegin();
+            }
+            reverse_iterator rend() noexcept
+            {
+                return reverse_iterator(begin());
+            }
+            const_reverse_iterator rend() const noexcept
+            {
+                return const_reverse_iterator(begin());
+            }
+            const_reverse_iterator crend() const noexcept
+            {
+                return rend();
+            }
+
+            // Capacity
+            bool empty() const noexcept
+            {
+                return !size();
+            }
+            size_type size() const noexcept
+            {
+                return block_ ? block_->size : 0;
+            }
+            size_type length() const noexcept
+            {
+                return size();
+            }
+            size_type capacity() const noexcept
+            {
+                return block_ ? block_->capacity : 0;
+            }
+            static constexpr size_type max_size() noexcept
+            {
+                return (std::numeric_limits<size_type>::max() - sizeof(header)) / sizeof(CharT) - 1;
+            }
+            void reserve(size_type new_cap)
+            {
+                if(new_cap > capacity())
+                    reallocate(new_cap);
+            }
+            void shrink_to_fit()
+            {
+                if(!size())
+                    secure_del(std::exchange(block_, nullptr));
+                else if(size() < capacity())
+                    reallocate(size());
+            }
+
+            // Modifiers
+            // Wipes the characters and keeps the block
+            void clear() noexcept
+            {
+                if(block_)
+                {
+                    detail::secure_zero(chars(block_), block_->size * sizeof(CharT));
+                    block_->size = 0;
+                }
+            }
+            basic_compact_password & append(basic_password_view<CharT, Traits> v)
+            {
+                if(v.size() > max_size() - size())
+                    throw std::length_error("merl::basic_compact_password::append(): Length error -> size exceeds max_size()");
+
+                if(size() + v.size() > capacity())
+                    reallocate(std::max(size() + v.size(), capacity() * 2), v);
+                else if(!v.empty())
+                {
+                    Traits::move(chars(block_) + block_->size, v.data(), v.size());
+                    block_->size += v.size();
+                    chars(block_)[block_->size] = CharT();
+                }
+                return *this;
+            }
+            basic_compact_password & operator+=(basic_password_view<CharT, Traits> v)
+            {
+                return append(v);
+            }
+            basic_compact_password & operator+=(CharT c)
+            {
+                push_back(c);
+                return *this;
+            }
+            void push_back(CharT c)
+            {
+                append(basic_password_view<CharT, Traits>(&c, 1));
+            }
+            // Throws like basic_password::pop_back() when empty
+            void pop_back()
+            {
+                if(empty())
+                    throw std::out_of_range("merl::basic_compact_password::pop_back(): Out of range (size = 0)");
+
+                chars(block_)[--block_->size] = CharT();
+            }
+            void swap(basic_compact_password & other) noexcept
+            {
+                std::swap(block_, other.block_);
+            }
+
+            // Operations
+            template <typename Alloc = std::allocator<CharT>>
+            basic_password<CharT, Traits, Alloc> to_password(const Alloc & alloc = Alloc()) const
+            {
+                return basic_password<CharT, Traits, Alloc>(view(), alloc);
+            }
+            basic_password_view<CharT, Traits> view(size_type pos = 0, size_type count = npos) const &
+            {
+                if(pos > size())
+                    throw std::out_of_range("merl::basic_compact_password::view(): Out of range (position = " + std::to_string(pos) + ", size = " + std::to_string(size()) + ')');
+
+                return basic_password_view<CharT, Traits>(data() + pos, std::min(count, size() - pos));
+            }
+            basic_password_view<CharT, Traits> view(size_type pos = 0, size_type count = npos) const && = delete;
+            explicit operator basic_password_view<CharT, Traits>() const & noexcept
+            {
+                return basic_password_view<CharT, Traits>(data(), size());
+            }
+            explicit operator basic_password_view<CharT, Traits>() const && = delete;
+
+            int compare(basic_password_view<CharT, Traits> v) const noexcept
+            {
+                return view().compare(v);
+            }
+            int compare(size_type pos1, size_type count1, basic_password_view<CharT, Traits> v) const
+            {
+                check_position(pos1, "compare");
+                return view(pos1, count1).compare(v);
+            }
+            int compare(size_type pos1, size_type count1, basic_password_view<CharT, Traits> v, size_type pos2, size_type count2 = npos) const
+            {
+                check_position(pos1, "compare");
+                return view(pos1, count1).compare(0, npos, v, pos2, count2);
+            }
+            int compare(const CharT * p) const
+            {
+                return view().compare(p);
+            }
+            int compare(size_type pos1, size_type count1, const CharT * p) const
+            {
+                check_position(pos1, "compare");
+                return view(pos1, count1).compare(p);
+            }
+            int compare(size_type pos1, size_type count1, const CharT * p, size_type count2) const
+            {
+                check_position(pos1, "compare");
+                return view(pos1, count1).compare(basic_password_view<CharT, Traits>(p, count2));
+            }
+
+            bool starts_with(basic_password_view<CharT, Traits> v) const noexcept
+            {
+                return view().starts_with(v);
+            }
+            bool starts_with(CharT c) const noexcept
+            {
+                return view().starts_with(c);
+            }
+            bool starts_with(const CharT * p) const
+            {
+                return view().starts_with(p);
+            }
+            bool ends_with(basic_password_view<CharT, Traits> v) const noexcept
+            {
+                return view().ends_with(v);
+            }
+            bool ends_with(CharT c) const noexcept
+            {
+                return view().ends_with(c);
+            }
+            bool ends_with(const CharT * p) const
+            {
+                return view().ends_with(p);
+            }
+            bool contains(basic_password_view<CharT, Traits> v) const noexcept
+            {
+                return view().contains(v);
+            }
+            bool contains(CharT c) const noexcept
+            {
+                return view().contains(c);
+            }
+            bool contains(const CharT * p) const
+            {
+                return view().contains(p);
+            }
+
+            // Search
+            size_type find(basic_password_view<CharT, Traits> v, size_type pos = 0) const noexcept
+            {
+                return view().find(v, pos);
+            }
+            size_type find(const CharT * p, size_type pos, size_type count) const
+            {
+                return view().find(p, pos, count);
+            }
+            size_type find(const CharT * p, size_type pos = 0) const
+            {
+                return view().find(p, pos);
+            }
+            size_type find(CharT c, size_type pos = 0) const noexcept
+            {
+                return view().find(c, pos);
+            }
+            size_type rfind(basic_password_view<CharT, Traits> v, size_type pos = npos) const noexcept
+            {
+                return view().rfind(v, pos);
+            }
+            size_type rfind(const CharT * p, size_type pos, size_type count) const
+            {
+                return view().rfind(p, pos, count);
+            }
+            size_type rfind(const CharT * p, size_type pos = npos) const
+            {
+                return view().rfind(p, pos);
+            }
+            size_type rfind(CharT c, size_type pos = npos) const noexcept
+            {
+                return view().rfind(c, pos);
+            }
+            size_type find_first_of(basic_password_view<CharT, Traits> v, size_type pos = 0) const noexcept
+            {
+                return view().find_first_of(v, pos);
+            }
+            size_type find_first_of(const CharT * p, size_type pos, size_type count) const
+            {
+                return view().find_first_of(p, pos, count);
+            }
+            size_type find_first_of(const CharT * p, size_type pos = 0) const
+            {
+                return view().find_first_of(p, pos);
+            }
+            size_type find_first_of(CharT c, size_type pos = 0) const noexcept
+            {
+                return view().find_first_of(c, pos);
+            }
+            size_type find_last_of(basic_password_view<CharT, Traits> v, size_type pos = npos) const noexcept
+            {
+                return view().find_last_of(v, pos);
+            }
+            size_type find_last_of(const CharT * p, size_type pos, size_type count) const
+            {
+                return view().find_last_of(p, pos, count);
+            }
+            size_type find_last_of(const CharT * p, size_type pos = npos) const
+            {
+                return view().find_last_of(p, pos);
+            }
+            size_type find_last_of(CharT c, size_type pos = npos) const noexcept
+            {
+                return view().find_last_of(c, pos);
+            }
+            size_type find_first_not_of(basic_password_view<CharT, Traits> v, size_type pos = 0) const noexcept
+            {
+                return view().find_first_not_of(v, pos);
+            }
+            size_type find_first_not_of(const CharT * p, size_type pos, size_type count) const
+            {
+                return view().find_first_not_of(p, pos, count);
+            }
+            size_type find_first_not_of(const CharT * p, size_type pos = 0) const
+            {
+                return view().find_first_not_of(p, pos);
+            }
+            size_type find_first_not_of(CharT c, size_type pos = 0) const noexcept
+            {
+                return view().find_first_not_of(c, pos);
+            }
+            size_type find_last_not_of(basic_password_view<CharT, Traits> v, size_type pos = npos) const noexcept
+            {
+                return view().find_last_not_of(v, pos);
+            }
+            size_type find_last_not_of(const CharT * p, size_type pos, size_type count) const
+            {
+                return view().find_last_not_of(p, pos, count);
+            }
+            size_type find_last_not_of(const CharT * p, size_type pos = npos) const
+            {
+                return view().find_last_not_of(p, pos);
+            }
+            size_type find_last_not_of(CharT c, size_type pos = npos) const noexcept
+            {
+                return view().find_last_not_of(c, pos);
+            }
+    };
+
+    // Non-member functions
+    template <typename CharT, typename Traits>
+    bool operator==(const basic_compact_password<CharT, Traits> & lhs, const basic_compact_password<CharT, Traits> & rhs) noexcept
+    {
+        return lhs.view() == rhs.view();
+    }
+    template <typename CharT, typename Traits>
+    Traits::comparison_category operator<=>(const basic_compact_password<CharT, Traits> & lhs, const basic_compact_password<CharT, Traits> & rhs) noexcept
+    {
+        return lhs.view() <=> rhs.view();
+    }
+    template <typename CharT, typename Traits>
+    bool operator==(const basic_compact_password<CharT, Traits> & lhs, basic_password_view<CharT, Traits> rhs) noexcept
+    {
+        return lhs.view() == rhs;
+    }
+    template <typename CharT, typename Traits>
+    Traits::comparison_category operator<=>(const basic_compact_password<CharT, Traits> & lhs, basic_password_view<CharT, Traits> rhs) noexcept
+    {
+        return lhs.view() <=> rhs;
+    }
+    template <typename CharT, typename Traits>
+    bool operator==(const basic_compact_password<CharT, Traits> & lhs, const CharT * rhs)
+    {
+        return lhs.view() == rhs;
+    }
+    template <typename CharT, typename Traits>
+    Traits::comparison_category operator<=>(const basic_compact_password<CharT, Traits> & lhs, const CharT * rhs)
+    {
+        return lhs.view() <=> rhs;
+    }
+    template <typename CharT, typename Traits, typename Alloc>
+    bool operator==(const basic_compact_password<CharT, Traits> & lhs, const basic_password<CharT, Traits, Alloc> & rhs) noexcept
+    {
+        return lhs.view() == rhs.view();
+    }
+    template <typename CharT, typename Traits, typename Alloc>
+    Traits::comparison_category operator<=>(const basic_compact_password<CharT, Traits> & lhs, const basic_password<CharT, Traits, Alloc> & rhs) noexcept
+    {
+        return lhs.view() <=> rhs.view();
+    }
+
+    template <typename CharT, typename Traits>
+    void swap(basic_compact_password<CharT, Traits> & lhs, basic_compact_password<CharT, Traits> & rhs) noexcept
+    {
+        lhs.swap(rhs);
+    }
+
+    using compact_password = basic_compact_password<char>;
+    using wcompact_password = basic_compact_password<wchar_t>;
+    using u8compact_password = basic_compact_password<char8_t>;
+    using u16compact_password = basic_compact_password<char16_t>;
+    using u32compact_password = basic_compact_password<char32_t>;
+
+    static_assert(sizeof(compact_password) == sizeof(void *));
+}
+
+template <typename CharT, typename Traits>
+struct std::hash<merl::basic_compact_password<CharT, Traits>>
+{
+    std::size_t operator()(const merl::basic_compact_password<CharT, Traits> & p) const noexcept
+    {
+        return merl::detail::hash_bytes(p.data(), p.size() * sizeof(CharT));
+    }
+};
+
+#endif // MERLIN_COMPACT_PASSWORD_HPP
@@ -0,0 +1,750 @@
+#ifndef MERLIN_CRYPT_HPP
+#define MERLIN_CRYPT_HPP
+
+#include <merlin_basic_password.hpp>
+#include <merlin_blowfish_tables.hpp>
+#include <merlin_detail.hpp>
+#include <merlin_pbkdf2.hpp>
+#include <merlin_secure_allocator.hpp>
+#include <merlin_sha2.hpp>
+
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// crypt(3) modular hashes ($id$...): parsing, and verification of bcrypt ($2a$, $2b$, $2y$, as crypt_blowfish computes them)
+// and SHA-crypt ($5$ SHA-256, $6$ SHA-512) over basic_password. As with crypt(3), the password ends at its first NUL.
+// crypt_verify_batch() spreads the work over threads, and runs the $6$ hashes of each thread side by side in SIMD lanes
+// (8 with AVX-512, 4 with AVX2) on the SHA-512 kernels of the PBKDF2 engine. The P and S byte sequences of SHA-crypt
+// and the Blowfish key schedule of bcrypt are wiped after use.
+
+namespace merl
+{
+    enum class crypt_scheme
+    {
+        bcrypt,
+        sha256_crypt,
+        sha512_crypt
+    };
+
+    // Fields of a parsed crypt(3) string; salt and hash point into the parsed string
+    struct crypt_hash
+    {
+        crypt_scheme scheme = crypt_scheme::sha512_crypt;
+        char bcrypt_variant = 0;        // 'a', 'b' or 'y'
+        std::uint32_t rounds = 0;       // bcrypt: cost (log2 of the rounds), SHA-crypt: rounds, clamped like crypt(3) does
+        bool explicit_rounds = false;   // SHA-crypt: the string carries "rounds="
+        std::string_view salt;
+        std::string_view hash;
+    };
+
+    namespace detail
+    {
+        inline constexpr char crypt_itoa64[] = "./0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+        inline constexpr char bcrypt_itoa64[] = "./ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789";
+
+        inline int bcrypt_b64_value(char c) noexcept
+        {
+            if(c == '.' || c == '/')
+                return c - '.';
+            if(c >= 'A' && c <= 'Z')
+                return c - 'A' + 2;
+            if(c >= 'a' && c <= 'z')
+                return c - 'a' + 28;
+            if(c >= '0' && c <= '9')
+                return c - '0' + 54;
+            return -1;
+        }
+        inline bool is_crypt_b64(char c) noexcept
+        {
+            return bcrypt_b64_value(c) >= 0;
+        }
+        inline bool is_crypt_b64(std::string_view s) noexcept
+        {
+            return std::all_of(s.begin(), s.end(), [](char c) { return is_crypt_b64(c); });
+        }
+
+        // bcrypt's base64: standard bit order, no padding
+        inline void bcrypt_b64_encode(const unsigned char * in, std::size_t n, char * out) noexcept
+        {
+            for(std::size_t i = 0; i < n; i += 3)
+            {
+                unsigned int c1 = in[i];
+                *out++ = bcrypt_itoa64[c1 >> 2];
+                c1 = (c1 & 0x03) << 4;
+                if(i + 1 >= n)
+                {
+                    *out++ = bcrypt_itoa64[c1];
+                    break;
+                }
+                unsigned int c2 = in[i + 1];
+                *out++ = bcrypt_itoa64[c1 | c2 >> 4];
+                c1 = (c2 & 0x0f) << 2;
+                if(i + 2 >= n)
+                {
+                    *out++ = bcrypt_itoa64[c1];
+                    break;
+                }
+                c2 = in[i + 2];
+                *out++ = bcrypt_itoa64[c1 | c2 >> 6];
+                *out++ = bcrypt_itoa64[c2 & 0x3f];
+            }
+        }
+        // Decodes the 22-character salt into 16 bytes (the low bits of the last character are ignored)
+        inline void bcrypt_decode_salt(std::string_view s, unsigned char * out) noexcept
+        {
+            std::uint32_t bits = 0;
+            int pending = 0;
+            std::size_t n = 0;
+            for(char c : s)
+            {
+                bits = bits << 6 | static_cast<std::uint32_t>(bcrypt_b64_value(c));
+                pending += 6;
+                if(pending >= 8 && n < 16)
+                {
+                    pending -= 8;
+                    out[n++] = static_cast<unsigned char>(bits >> pending);
+                }
+            }
+        }
+
+        // --- bcrypt ---
+        struct blowfish_state
+        {
+            std::uint32_t p[18];
+            std::uint32_t s[4][256];
+        };
+
+        inline std::uint32_t blowfish_f(const blowfish_state & st, std::uint32_t x) noexcept
+        {
+            return ((st.s[0][x >> 24] + st.s[1][(x >> 16) & 0xff]) ^ st.s[2][(x >> 8) & 0xff]) + st.s[3][x & 0xff];
+        }
+        inline void blowfish_encipher(const blowfish_state & st, std::uint32_t & l, std::uint32_t & r) noexcept
+        {
+            std::uint32_t xl = l ^ st.p[0], xr = r;
+            for(int i = 1; i <= 16; i += 2)
+            {
+                xr ^= blowfish_f(st, xl) ^ st.p[i];
+                xl ^= blowfish_f(st, xr) ^ st.p[i + 1];
+            }
+            l = xr ^ st.p[17];
+            r = xl;
+        }
+        // Re-encrypts the P-array and S-boxes in chain; salt (4 words, or null) is mixed into every block like in ExpandState
+        inline void blowfish_rekey(blowfish_state & st, const std::uint32_t * salt) noexcept
+        {
+            std::uint32_t l = 0, r = 0;
+            int k = 0;
+            auto next = [&](std::uint32_t * dst)
+            {
+                if(salt)
+                {
+                    l ^= salt[k];
+                    r ^= salt[k + 1];
+                    k ^= 2;
+                }
+                blowfish_encipher(st, l, r);
+                dst[0] = l;
+                dst[1] = r;
+            };
+            for(int i = 0; i < 18; i += 2)
+                next(st.p + i);
+            for(auto & box : st.s)
+                for(int i = 0; i < 256; i += 2)
+                    next(box + i);
+        }
+
+        // Key words as crypt_blowfish builds them: the key with its NUL, repeated over 72 bytes.
+        // $2a$ keeps its countermeasure against hashes made with the old sign-extension bug (it flips a bit of P[0]).
+        inline void bcrypt_key_words(const unsigned char * key, std::size_t n, char variant, std::uint32_t * words, std::uint32_t & p0_flip) noexcept
+        {
+            std::uint32_t sign = 0, diff = 0;
+            std::size_t j = 0;
+            for(int i = 0; i < 18; ++i)
+            {
+                std::uint32_t correct = 0, buggy = 0;
+                for(int b = 0; b < 4; ++b)
+                {
+                    unsigned char c = j < n ? key[j] : 0;
+                    correct = correct << 8 | c;
+                    buggy = buggy << 8 | static_cast<std::uint32_t>(static_cast<std::int32_t>(static_cast<signed char>(c)));
+                    if(b)
+                        sign |= buggy & 0x80;
+                    j = j < n ? j + 1 : 0;
+                }
+                diff |= correct ^ buggy;
+                words[i] = correct;
+            }
+            diff |= diff >> 16;
+            diff &= 0xffff;
+            diff += 0xffff;
+            sign <<= 9;
+            p0_flip = variant == 'a' ? sign & ~diff & 0x10000 : 0;
+        }
+
+        // 23-byte bcrypt hash of key (n bytes before the NUL) under a 16-byte salt
+        inline void bcrypt_hash(const unsigned char * key, std::size_t n, char variant, const unsigned char * salt, std::uint32_t cost,
+                                unsigned char * out)
+        {
+            secure_allocator<blowfish_state> allocator;
+            struct state_guard
+            {
+                secure_allocator<blowfish_state> & allocator;
+                blowfish_state * p;
+                ~state_guard()
+                {
+                    allocator.deallocate(p, 1);
+                }
+            } guard{allocator, allocator.allocate(1)};
+            blowfish_state & st = *guard.p;
+
+            std::uint32_t key_words[18], salt_words[4], p0_flip;
+            bcrypt_key_words(key, n, variant, key_words, p0_flip);
+            for(int i = 0; i < 4; ++i)
+                salt_words[i] = load_be<std::uint32_t>(salt + 4*i);
+
+            std::memcpy(st.s, blowfish_s, sizeof(st.s));
+            for(int i = 0; i < 18; ++i)
+                st.p[i] = blowfish_p[i] ^ key_words[i];
+            st.p[0] ^= p0_flip;
+            blowfish_rekey(st, salt_words);
+
+            for(std::uint64_t round = std::uint64_t{1} << cost; round; --round)
+            {
+                for(int i = 0; i < 18; ++i)
+                    st.p[i] ^= key_words[i];
+                blowfish_rekey(st, nullptr);
+                for(int i = 0; i < 18; ++i)
+                    st.p[i] ^= salt_words[i & 3];
+                blowfish_rekey(st, nullptr);
+            }
+
+            // "OrpheanBeholderScryDoubt"
+            std::uint32_t text[6] = {0x4f727068, 0x65616e42, 0x65686f6c, 0x64657253, 0x63727944, 0x6f756274};
+            for(int i = 0; i < 64; ++i)
+                for(int k = 0; k < 6; k += 2)
+                    blowfish_encipher(st, text[k], text[k + 1]);
+            unsigned char bytes[24];
+            for(int k = 0; k < 6; ++k)
+                store_be<std::uint32_t>(bytes + 4*k, text[k]);
+            std::memcpy(out, bytes, 23);
+
+            secure_zero(key_words, sizeof(key_words));
+            secure_zero(text, sizeof(text));
+            secure_zero(bytes, sizeof(bytes));
+        }
+
+        inline bool bcrypt_check(const unsigned char * key, std::size_t n, const crypt_hash & h)
+        {
+            unsigned char salt[16], raw[23];
+            char encoded[31];
+            bcrypt_decode_salt(h.salt, salt);
+            bcrypt_hash(key, n, h.bcrypt_variant, salt, h.rounds, raw);
+            bcrypt_b64_encode(raw, 23, encoded);
+            bool equal = ct_equal(encoded, h.hash.data(), 31);
+            secure_zero(raw, sizeof(raw));
+            secure_zero(encoded, sizeof(encoded));
+            return equal;
+        }
+
+        // --- SHA-crypt ---
+        template <typename Spec>
+        inline constexpr std::size_t sha_crypt_encoded_size = Spec::digest_size == 32 ? 43 : 86;
+
+        // Digest A (into c) and the P and S sequences (key_size and salt_size bytes) of SHA-crypt
+        template <typename Spec>
+        void sha_crypt_setup(const unsigned char * key, std::size_t key_size, const unsigned char * salt, std::size_t salt_size,
+                             unsigned char * c, unsigned char * p, unsigned char * s) noexcept
+        {
+            constexpr std::size_t d = Spec::digest_size;
+            basic_sha2<Spec> ctx;
+            unsigned char b[d];
+            ctx.update(key, key_size).update(salt, salt_size).update(key, key_size).final(b);
+
+            ctx.update(key, key_size).update(salt, salt_size);
+            std::size_t count = key_size;
+            for(; count > d; count -= d)
+                ctx.update(b, d);
+            ctx.update(b, count);
+            for(count = key_size; count; count >>= 1)
+            {
+                if(count & 1)
+                    ctx.update(b, d);
+                else
+                    ctx.update(key, key_size);
+            }
+            ctx.final(c);
+
+            for(std::size_t i = 0; i < key_size; ++i)
+                ctx.update(key, key_size);
+            ctx.final(b);
+            for(std::size_t i = 0; i < key_size; i += d)
+                std::memcpy(p + i, b, std::min(d, key_size - i));
+
+            for(std::size_t i = 0; i < 16u + c[0]; ++i)
+                ctx.update(salt, salt_size);
+            ctx.final(b);
+            std::memcpy(s, b, salt_size);
+
+            secure_zero(b, sizeof(b));
+        }
+
+        template <typename Spec>
+        void sha_crypt_rounds(unsigned char * c, const unsigned char * p, std::size_t p_size, const unsigned char * s, std::size_t s_size,
+                              std::uint32_t first, std::uint32_t rounds) noexcept
+        {
+            constexpr std::size_t d = Spec::digest_size;
+            basic_sha2<Spec> ctx;
+            for(std::uint32_t i = first; i < rounds; ++i)
+            {
+                if(i & 1)
+                    ctx.update(p, p_size);
+                else
+                    ctx.update(c, d);
+                if(i % 3)
+                    ctx.update(s, s_size);
+                if(i % 7)
+                    ctx.update(p, p_size);
+                if(i & 1)
+                    ctx.update(c, d);
+                else
+                    ctx.update(p, p_size);
+                ctx.final(c);
+            }
+        }
+
+        // The digest bytes are regrouped into 24-bit values before going through crypt's base64
+        inline constexpr unsigned char sha256_crypt_order[30] = {
+            0, 10, 20, 21, 1, 11, 12, 22, 2, 3, 13, 23, 24, 4, 14, 15, 25, 5, 6, 16, 26, 27, 7, 17, 18, 28, 8, 9, 19, 29
+        };
+        inline constexpr unsigned char sha512_crypt_order[63] = {
+            0, 21, 42, 22, 43, 1, 44, 2, 23, 3, 24, 45, 25, 46, 4, 47, 5, 26, 6, 27, 48, 28, 49, 7, 50, 8, 29, 9, 30, 51,
+            31, 52, 10, 53, 11, 32, 12, 33, 54, 34, 55, 13, 56, 14, 35, 15, 36, 57, 37, 58, 16, 59, 17, 38, 18, 39, 60,
+            40, 61, 19, 62, 20, 41
+        };
+
+        inline char * crypt_b64_from_24bit(char * out, unsigned int b2, unsigned int b1, unsigned int b0, int n) noexcept
+        {
+            unsigned int w = b2 << 16 | b1 << 8 | b0;
+            while(n--)
+            {
+                *out++ = crypt_itoa64[w & 0x3f];
+                w >>= 6;
+            }
+            return out;
+        }
+
+        template <typename Spec>
+        void sha_crypt_encode(const unsigned char * c, char * out) noexcept
+        {
+            if constexpr(Spec::digest_size == 32)
+            {
+                for(int i = 0; i < 30; i += 3)
+                    out = crypt_b64_from_24bit(out, c[sha256_crypt_order[i]], c[sha256_crypt_order[i + 1]], c[sha256_crypt_order[i + 2]], 4);
+                crypt_b64_from_24bit(out, 0, c[31], c[30], 3);
+            }
+            else
+            {
+                for(int i = 0; i < 63; i += 3)
+                    out = crypt_b64_from_24bit(out, c[sha512_crypt_order[i]], c[sha512_crypt_order[i + 1]], c[sha512_crypt_order[i + 2]], 4);
+                crypt_b64_from_24bit(out, 0, 0, c[63], 2);
+            }
+        }
+
+        template <typename Spec>
+        bool sha_crypt_compare(const unsigned char * c, const crypt_hash & h) noexcept
+        {
+            char encoded[86];
+            sha_crypt_encode<Spec>(c, encoded);
+            bool equal = ct_equal(encoded, h.hash.data(), sha_crypt_encoded_size<Spec>);
+            secure_zero(encoded, sizeof(encoded));
+            return equal;
+        }
+
+        template <typename Spec>
+        bool sha_crypt_check(const unsigned char * key, std::size_t n, const crypt_hash & h)
+        {
+            std::vector<unsigned char, secure_allocator<unsigned char>> p(n + 1);
+            unsigned char s[16], c[Spec::digest_size];
+            const unsigned char * salt = reinterpret_cast<const unsigned char *>(h.salt.data());
+            sha_crypt_setup<Spec>(key, n, salt, h.salt.size(), c, p.data(), s);
+            sha_crypt_rounds<Spec>(c, p.data(), n, s, h.salt.size(), 0, h.rounds);
+            bool equal = sha_crypt_compare<Spec>(c, h);
+            secure_zero(s, sizeof(s));
+            secure_zero(c, sizeof(c));
+            return equal;
+        }
+
+        inline bool crypt_check(const unsigned char * key, std::size_t n, const crypt_hash & h)
+        {
+            switch(h.scheme)
+            {
+                case crypt_scheme::bcrypt:
+                    return bcrypt_check(key, n, h);
+                case crypt_scheme::sha256_crypt:
+                    return sha_crypt_check<sha256_spec>(key, n, h);
+                default:
+                    return sha_crypt_check<sha512_spec>(key, n, h);
+            }
+        }
+
+        // --- Multi-buffer $6$ ---
+        // A round message is at most C + S + 2 P bytes; lanes take the hashes whose messages fit two SHA-512 blocks
+        inline constexpr std::size_t sha512_crypt_lane_max_key = 79;
+
+        struct sha512_crypt_job
+        {
+            const unsigned char * key;
+            std::size_t key_size;
+            const crypt_hash * hash;
+            bool * result;
+        };
+
+#if MERLIN_X86_SIMD
+        // One round for every lane: msg holds the padded messages, blocks their length in blocks (1 or 2); digests go to c
+        MERLIN_TARGET("avx512f")
+        inline void sha512_crypt_round_x8_avx512(const unsigned char (*msg)[256], const unsigned char * blocks, unsigned char (*c)[64]) noexcept
+        {
+            alignas(64) std::uint64_t words[16][8];
+            __m512i s[8], w[16], saved[8];
+            __mmask8 second = 0;
+            for(int l = 0; l < 8; ++l)
+                second |= static_cast<__mmask8>((blocks[l] > 1) << l);
+            for(int i = 0; i < 8; ++i)
+                s[i] = _mm512_set1_epi64(static_cast<long long>(sha512_spec::iv[i]));
+
+            for(int b = 0; b < (second ? 2 : 1); ++b)
+            {
+                for(int t = 0; t < 16; ++t)
+                {
+                    for(int l = 0; l < 8; ++l)
+                        words[t][l] = load_be<std::uint64_t>(msg[l] + 128*b + 8*t);
+                    w[t] = _mm512_load_si512(words[t]);
+                }
+                for(int i = 0; i < 8; ++i)
+                    saved[i] = s[i];
+                sha512_compress_x8_avx512(s, w);
+                // Lanes with a one-block message keep the state of the first block
+                if(b)
+                    for(int i = 0; i < 8; ++i)
+                        s[i] = _mm512_mask_blend_epi64(second, saved[i], s[i]);
+            }
+
+            for(int i = 0; i < 8; ++i)
+                _mm512_store_si512(words[i], s[i]);
+            for(int l = 0; l < 8; ++l)
+                for(int i = 0; i < 8; ++i)
+                    store_be<std::uint64_t>(c[l] + 8*i, words[i][l]);
+            secure_zero(words, sizeof(words));
+            for(__m512i & v : w)
+                v = _mm512_setzero_si512();
+        }
+
+        MERLIN_TARGET("avx2")
+        inline void sha512_crypt_round_x4_avx2(const unsigned char (*msg)[256], const unsigned char * blocks, unsigned char (*c)[64]) noexcept
+        {
+            alignas(32) std::uint64_t words[16][4];
+            __m256i s[8], w[16], saved[8];
+            bool any_second = false;
+            for(int l = 0; l < 4; ++l)
+                any_second = any_second || blocks[l] > 1;
+            const __m256i second = _mm256_set_epi64x(-(blocks[3] > 1), -(blocks[2] > 1), -(blocks[1] > 1), -(blocks[0] > 1));
+            for(int i = 0; i < 8; ++i)
+                s[i] = _mm256_set1_epi64x(static_cast<long long>(sha512_spec::iv[i]));
+
+            for(int b = 0; b < (any_second ? 2 : 1); ++b)
+            {
+                for(int t = 0; t < 16; ++t)
+                {
+                    for(int l = 0; l < 4; ++l)
+                        words[t][l] = load_be<std::uint64_t>(msg[l] + 128*b + 8*t);
+                    w[t] = _mm256_load_si256(reinterpret_cast<const __m256i *>(words[t]));
+                }
+                for(int i = 0; i < 8; ++i)
+                    saved[i] = s[i];
+                sha512_compress_x4_avx2(s, w);
+                if(b)
+                    for(int i = 0; i < 8; ++i)
+                        s[i] = _mm256_blendv_epi8(saved[i], s[i], second);
+            }
+
+            for(int i = 0; i < 8; ++i)
+                _mm256_store_si256(reinterpret_cast<__m256i *>(words[i]), s[i]);
+            for(int l = 0; l < 4; ++l)
+                for(int i = 0; i < 8; ++i)
+                    store_be<std::uint64_t>(c[l] + 8*i, words[i][l]);
+            secure_zero(words, sizeof(words));
+            for(__m256i & v : w)
+                v = _mm256_setzero_si256();
+        }
+#endif
+
+        inline std::size_t sha512_crypt_width() noexcept
+        {
+#if MERLIN_X86_SIMD
+            if(cpu().avx512f)
+                return 8;
+            if(cpu().avx2)
+                return 4;
+#endif
+            return 1;
+        }
+
+        // Runs the jobs in SIMD lanes, refilling a lane as soon as its hash is done
+        inline void sha512_crypt_batch(const sha512_crypt_job * jobs, std::size_t count)
+        {
+            const std::size_t width = sha512_crypt_width();
+            if(width == 1)
+            {
+                for(std::size_t i = 0; i < count; ++i)
+                    *jobs[i].result = sha_crypt_check<sha512_spec>(jobs[i].key, jobs[i].key_size, *jobs[i].hash);
+                return;
+            }
+
+            struct lane
+            {
+                unsigned char p[sha512_crypt_lane_max_key];
+                unsigned char s[16];
+                std::size_t p_size;
+                std::size_t s_size;
+                std::uint32_t round;
+                const sha512_crypt_job * job;
+            };
+            lane lanes[8] = {};
+            alignas(64) unsigned char msg[8][256] = {};
+            unsigned char c[8][64];
+            unsigned char blocks[8] = {1, 1, 1, 1, 1, 1, 1, 1};
+            std::size_t next = 0;
+
+            auto finish = [&](std::size_t l)
+            {
+                *lanes[l].job->result = sha_crypt_compare<sha512_spec>(c[l], *lanes[l].job->hash);
+                lanes[l].job = nullptr;
+            };
+
+            for(;;)
+            {
+                std::size_t busy = 0;
+                for(std::size_t l = 0; l < width; ++l)
+                {
+                    while(!lanes[l].job && next < count)
+                    {
+                        const sha512_crypt_job & j = jobs[next++];
+                        lane & ln = lanes[l];
+                        ln.job = &j;
+                        ln.p_size = j.key_size;
+                        ln.s_size = j.hash->salt.size();
+                        ln.round = 0;
+                        sha_crypt_setup<sha512_spec>(j.key, j.key_size, reinterpret_cast<const unsigned char *>(j.hash->salt.data()),
+                                                     ln.s_size, c[l], ln.p, ln.s);
+                        if(!j.hash->rounds)
+                            finish(l);
+                    }
+                    busy += lanes[l].job != nullptr;
+                }
+                if(!busy)
+                    break;
+
+                if(busy == 1)
+                {
+                    // A lone hash runs faster on the one-lane path than with idle lanes
+                    std::size_t l = 0;
+                    while(!lanes[l].job)
+                        ++l;
+                    lane & ln = lanes[l];
+                    sha_crypt_rounds<sha512_spec>(c[l], ln.p, ln.p_size, ln.s, ln.s_size, ln.round, ln.job->hash->rounds);
+                    finish(l);
+                    continue;
+                }
+
+                for(std::size_t l = 0; l < width; ++l)
+                {
+                    lane & ln = lanes[l];
+                    if(!ln.job)
+                        continue;
+                    unsigned char * m = msg[l];
+                    std::size_t n = 0;
+                    auto put = [&](const unsigned char * data, std::size_t k)
+                    {
+                        std::memcpy(m + n, data, k);
+                        n += k;
+                    };
+                    std::uint32_t i = ln.round;
+                    if(i & 1)
+                        put(ln.p, ln.p_size);
+                    else
+                        put(c[l], 64);
+                    if(i % 3)
+                        put(ln.s, ln.s_size);
+                    if(i % 7)
+                        put(ln.p, ln.p_size);
+                    if(i & 1)
+                        put(c[l], 64);
+                    else
+                        put(ln.p, ln.p_size);
+
+                    blocks[l] = n + 17 <= 128 ? 1 : 2;
+                    m[n] = 0x80;
+                    std::memset(m + n + 1, 0, 128 * blocks[l] - n - 9);
+                    store_be<std::uint64_t>(m + 128 * blocks[l] - 8, std::uint64_t{n} << 3);
+                }
+
+#if MERLIN_X86_SIMD
+                if(width == 8)
+                    sha512_crypt_round_x8_avx512(msg, blocks, c);
+                else
+                    sha512_crypt_round_x4_avx2(msg, blocks, c);
+#endif
+
+                for(std::size_t l = 0; l < width; ++l)
+                    if(lanes[l].job && ++lanes[l].round == lanes[l].job->hash->rounds)
+                        finish(l);
+            }
+
+            secure_zero(lanes, sizeof(lanes));
+            secure_zero(msg, sizeof(msg));
+            secure_zero(c, sizeof(c));
+        }
+
+        // Bytes of a crypt(3) key: the password up to its first NUL
+        template <typename CharT, typename Traits, typename Alloc>
+        std::size_t crypt_key_size(const basic_password<CharT, Traits, Alloc> & password) noexcept
+        {
+            static_assert(sizeof(CharT) == 1, "crypt(3) hashes take byte passwords");
+            const CharT * data = password.data();
+            std::size_t n = 0;
+            while(n < password.size() && data[n] != CharT())
+                ++n;
+            return n;
+        }
+
+        template <typename CharT, typename Traits, typename Alloc>
+        void crypt_verify_range(const basic_password<CharT, Traits, Alloc> * passwords, const crypt_hash * hashes, bool * results,
+                                std::size_t begin, std::size_t end)
+        {
+            std::vector<sha512_crypt_job> lane_jobs;
+            for(std::size_t i = begin; i < end; ++i)
+            {
+                const unsigned char * key = reinterpret_cast<const unsigned char *>(passwords[i].data());
+                std::size_t n = crypt_key_size(passwords[i]);
+                if(hashes[i].scheme == crypt_scheme::sha512_crypt && n <= sha512_crypt_lane_max_key)
+                    lane_jobs.push_back(sha512_crypt_job{key, n, hashes + i, results + i});
+                else
+                    results[i] = crypt_check(key, n, hashes[i]);
+            }
+            sha512_crypt_batch(lane_jobs.data(), lane_jobs.size());
+        }
+
+        [[noreturn]] inline void throw_invalid_crypt()
+        {
+            throw std::invalid_argument("merl::crypt_parse(): Invalid argument -> Malformed or unsupported crypt(3) string");
+        }
+    }
+
+    // Splits a $2a$/$2b$/$2y$/$5$/$6$ string into its fields; throws std::invalid_argument if it is malformed or of another scheme
+    inline crypt_hash crypt_parse(std::string_view s)
+    {
+        crypt_hash h;
+        if(s.size() == 60 && s.substr(0, 2) == "$2" && (s[2] == 'a' || s[2] == 'b' || s[2] == 'y') && s[3] == '$' && s[6] == '$')
+        {
+            if(s[4] < '0' || s[4] > '3' || s[5] < '0' || s[5] > '9')
+                detail::throw_invalid_crypt();
+            h.scheme = crypt_scheme::bcrypt;
+            h.bcrypt_variant = s[2];
+            h.rounds = static_cast<std::uint32_t>((s[4] - '0') * 10 + (s[5] - '0'));
+            h.salt = s.substr(7, 22);
+            h.hash = s.substr(29);
+            if(h.rounds < 4 || h.rounds > 31 || !detail::is_crypt_b64(h.salt) || !detail::is_crypt_b64(h.hash))
+                detail::throw_invalid_crypt();
+            return h;
+        }
+
+        if(s.substr(0, 3) == "$5$")
+            h.scheme = crypt_scheme::sha256_crypt;
+        else if(s.substr(0, 3) == "$6$")
+            h.scheme = crypt_scheme::sha512_crypt;
+        else
+            detail::throw_invalid_crypt();
+        s.remove_prefix(3);
+
+        h.rounds = 5000;
+        if(s.substr(0, 7) == "rounds=")
+        {
+            s.remove_prefix(7);
+            std::uint64_t rounds = 0;
+            std::size_t i = 0;
+            for(; i < s.size() && i < 10 && s[i] >= '0' && s[i] <= '9'; ++i)
+                rounds = rounds * 10 + static_cast<std::uint64_t>(s[i] - '0');
+            if(!i || i >= s.size() || s[i] != '$')
+                detail::throw_invalid_crypt();
+            h.rounds = static_cast<std::uint32_t>(std::clamp<std::uint64_t>(rounds, 1000, 999999999));
+            h.explicit_rounds = true;
+            s.remove_prefix(i + 1);
+        }
+
+        std::size_t dollar = s.find('$');
+        if(dollar == std::string_view::npos || dollar > 16)
+            detail::throw_invalid_crypt();
+        h.salt = s.substr(0, dollar);
+        h.hash = s.substr(dollar + 1);
+        std::size_t expected = h.scheme == crypt_scheme::sha256_crypt ? detail::sha_crypt_encoded_size<detail::sha256_spec>
+                                                                       : detail::sha_crypt_encoded_size<detail::sha512_spec>;
+        if(h.hash.size() != expected || !detail::is_crypt_b64(h.hash))
+            detail::throw_invalid_crypt();
+        return h;
+    }
+
+    // Checks password against a crypt(3) string in constant time (with respect to the stored hash)
+    template <typename CharT, typename Traits, typename Alloc>
+    bool crypt_verify(const basic_password<CharT, Traits, Alloc> & password, std::string_view encoded)
+    {
+        crypt_hash h = crypt_parse(encoded);
+        return detail::crypt_check(reinterpret_cast<const unsigned char *>(password.data()), detail::crypt_key_size(password), h);
+    }
+
+    // Verifies passwords[i] against hashes[i] into results[i] for every i < count, over threads workers
+    // (0 for the hardware concurrency). Every string is parsed first, so a malformed one throws before any work is done.
+    template <typename CharT, typename Traits, typename Alloc>
+    void crypt_verify_batch(const basic_password<CharT, Traits, Alloc> * passwords, const std::string_view * hashes, bool * results,
+                            std::size_t count, std::uint32_t threads = 0)
+    {
+        std::vector<crypt_hash> parsed(count);
+        for(std::size_t i = 0; i < count; ++i)
+            parsed[i] = crypt_parse(hashes[i]);
+        if(!count)
+            return;
+
+        std::size_t workers = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+        workers = std::min(workers, count);
+        // An exception must not escape a worker thread (std::terminate): it is rethrown here after the join
+        std::vector<std::exception_ptr> errors(workers);
+        auto work = [&](std::size_t w)
+        {
+            try
+            {
+                detail::crypt_verify_range(passwords, parsed.data(), results, count * w / workers, count * (w + 1) / workers);
+            }
+            catch(...)
+            {
+                errors[w] = std::current_exception();
+            }
+        };
+        {
+            std::vector<std::jthread> pool;
+            pool.reserve(workers - 1);
+            for(std::size_t w = 1; w < workers; ++w)
+                pool.emplace_back(work, w);
+            work(0);
+        }
+        for(std::exception_ptr & e : errors)
+        {
+            if(e)
+                std::rethrow_exception(e);
+        }
+    }
+}
+
+#endif // MERLIN_CRYPT_HPP
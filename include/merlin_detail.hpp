@@ -0,0 +1,152 @@
+#ifndef MERLIN_DETAIL_HPP
+#define MERLIN_DETAIL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// SIMD code paths are compiled with per-function target attributes and selected at runtime,
+// so the headers stay usable without any -m flag.
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    #define MERLIN_X86_SIMD 1
+    #define MERLIN_TARGET(features) __attribute__((target(features)))
+    #include <cpuid.h>
+    #include <immintrin.h>
+#else
+    #define MERLIN_X86_SIMD 0
+    #define MERLIN_TARGET(features)
+#endif
+
+namespace merl::detail
+{
+    struct cpu_features
+    {
+        bool ssse3 = false;
+        bool sse41 = false;
+        bool avx2 = false;
+        bool sha = false;
+        bool avx512f = false;
+        bool avx512bw = false;
+        bool avx512vl = false;
+    };
+
+    inline cpu_features detect_cpu_features() noexcept
+    {
+        cpu_features f;
+#if MERLIN_X86_SIMD
+        unsigned int eax, ebx, ecx, edx;
+        if(!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+            return f;
+
+        f.ssse3 = ecx & (1u << 9);
+        f.sse41 = ecx & (1u << 19);
+
+        // AVX state must be enabled by the OS (OSXSAVE + XCR0) before the wide registers can be used
+        bool os_avx = false, os_avx512 = false;
+        if(ecx & (1u << 27))
+        {
+            unsigned int xcr0_lo, xcr0_hi;
+            __asm__ volatile("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+            os_avx = (xcr0_lo & 0x06) == 0x06;
+            os_avx512 = (xcr0_lo & 0xe6) == 0xe6;
+        }
+
+        if(__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+        {
+            f.avx2 = os_avx && (ebx & (1u << 5));
+            f.sha = ebx & (1u << 29);
+            f.avx512f = os_avx512 && (ebx & (1u << 16));
+            f.avx512bw = f.avx512f && (ebx & (1u << 30));
+            f.avx512vl = f.avx512f && (ebx & (1u << 31));
+        }
+#endif
+        return f;
+    }
+
+    inline const cpu_features & cpu() noexcept
+    {
+        static const cpu_features features = detect_cpu_features();
+        return features;
+    }
+
+    inline std::uint32_t rotr32(std::uint32_t x, int b) noexcept
+    {
+        return (x >> b) | (x << (32 - b));
+    }
+    inline std::uint64_t rotr64(std::uint64_t x, int b) noexcept
+    {
+        return (x >> b) | (x << (64 - b));
+    }
+
+#if MERLIN_X86_SIMD
+    // Per-lane rotates and shifts by a constant, shared by the SIMD hash kernels
+    template <int B>
+    MERLIN_TARGET("avx2")
+    inline __m256i rotr32_avx2(__m256i v) noexcept
+    {
+        return _mm256_or_si256(_mm256_srli_epi32(v, B), _mm256_slli_epi32(v, 32 - B));
+    }
+    template <int B>
+    MERLIN_TARGET("avx2")
+    inline __m256i rotr64_avx2(__m256i v) noexcept
+    {
+        return _mm256_or_si256(_mm256_srli_epi64(v, B), _mm256_slli_epi64(v, 64 - B));
+    }
+    // The zero-masked forms are used because GCC's unmasked ones pass an undefined operand and trip -Wmaybe-uninitialized
+    template <int B>
+    MERLIN_TARGET("avx512f")
+    inline __m512i rotr32_avx512(__m512i v) noexcept
+    {
+        return _mm512_maskz_ror_epi32(0xffff, v, B);
+    }
+    template <int B>
+    MERLIN_TARGET("avx512f")
+    inline __m512i shr32_avx512(__m512i v) noexcept
+    {
+        return _mm512_maskz_srli_epi32(0xffff, v, B);
+    }
+    template <int B>
+    MERLIN_TARGET("avx512f")
+    inline __m512i rotr64_avx512(__m512i v) noexcept
+    {
+        return _mm512_maskz_ror_epi64(0xff, v, B);
+    }
+    template <int B>
+    MERLIN_TARGET("avx512f")
+    inline __m512i shr64_avx512(__m512i v) noexcept
+    {
+        return _mm512_maskz_srli_epi64(0xff, v, B);
+    }
+#endif
+
+    // Zeroes memory in a way the optimizer cannot elide (unlike a plain fill before a delete)
+    inline void secure_zero(void * p, std::size_t n) noexcept
+    {
+        if(!p || !n)
+            return;
+#if defined(__GNUC__) || defined(__clang__)
+        std::memset(p, 0, n);
+        __asm__ __volatile__("" : : "r"(p) : "memory");
+#else
+        volatile unsigned char * vp = static_cast<volatile unsigned char *>(p);
+        while(n--)
+            *vp++ = 0;
+#endif
+    }
+
+    // Equality of two buffers in time that only depends on n
+    inline bool ct_equal(const void * a, const void * b, std::size_t n) noexcept
+    {
+        const unsigned char * pa = static_cast<const unsigned char *>(a);
+        const unsigned char * pb = static_cast<const unsigned char *>(b);
+        unsigned char diff = 0;
+        for(std::size_t i = 0; i < n; ++i)
+            diff |= pa[i] ^ pb[i];
+#if defined(__GNUC__) || defined(__clang__)
+        __asm__("" : "+r"(diff)); // keep the compiler from turning the loop into an early-exit comparison
+#endif
+        return !diff;
+    }
+}
+
+#endif // MERLIN_DETAIL_HPP
@@ -0,0 +1,788 @@
+#ifndef MERLIN_FIXED_PASSWORD_HPP
+#define MERLIN_FIXED_PASSWORD_HPP
+
+#include <merlin_basic_password.hpp>
+#include <merlin_detail.hpp>
+#include <merlin_password_view.hpp>
+#include <algorithm>
+#include <compare>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+// basic_fixed_password<CharT, N>: the member API of basic_password over inline storage of N characters (plus the
+// terminator), for code that must not allocate (embedded agents, per-packet paths). Exceeding N throws
+// std::length_error instead of growing. Everything is constexpr; at run time, characters that leave the live range
+// (erase, shrinking replace, destruction, being moved from) are wiped with detail::secure_zero.
+// The storage past size() is always zero, so data() is null-terminated like basic_password's.
+
+namespace merl
+{
+    template <typename CharT, std::size_t N, typename Traits = std::char_traits<CharT>>
+    class basic_fixed_password
+    {
+        public:
+            using value_type = CharT;
+            using size_type = std::size_t;
+            using reference = value_type &;
+            using const_reference = const value_type &;
+            using pointer = value_type *;
+            using const_pointer = const value_type *;
+            using iterator = value_type *;
+            using const_iterator = const value_type *;
+            using reverse_iterator = std::reverse_iterator<iterator>;
+            using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+            static const size_type npos = -1;
+
+        private:
+            CharT data_[N + 1] {};
+            size_type size_ {};
+
+            static constexpr void wipe(CharT * p, size_type n) noexcept
+            {
+                if(std::is_constant_evaluated())
+                    std::fill_n(p, n, CharT{});
+                else
+                    detail::secure_zero(p, n * sizeof(CharT));
+            }
+            constexpr bool iterator_check(const_iterator cit) const noexcept
+            {
+                return cit >= data_ && cit <= data_ + size_;
+            }
+            // True when p points into our own storage, which the splice below would shift under the reader
+            constexpr bool aliases(const CharT * p) const noexcept
+            {
+                return std::is_constant_evaluated() || (std::less_equal<const CharT *>{}(data_, p) && std::less<const CharT *>{}(p, data_ + N + 1));
+            }
+
+            // Replaces [index, index + count) (already clamped) with count2 characters left for the caller to write
+            constexpr CharT * splice(size_type index, size_type count, size_type count2, const char * func)
+            {
+                if(count2 > N || size_ - count > N - count2)
+                    throw std::length_error(std::string("merl::basic_fixed_password::") + func + "(): Length error -> Capacity exceeded (capacity = " + std::to_string(N) + ')');
+
+                size_type target_size = size_ - count + count2;
+                Traits::move(data_ + index + count2, data_ + index + count, size_ - index - count);
+                if(target_size < size_)
+                    wipe(data_ + target_size, size_ - target_size);
+                size_ = target_size;
+
+                return data_ + index;
+            }
+            constexpr basic_fixed_password & splice(size_type index, size_type count, const CharT * p, size_type count2, const char * func)
+            {
+                if(count2 && aliases(p))
+                {
+                    basic_fixed_password tmp; // wiped on scope exit
+                    Traits::copy(tmp.splice(0, 0, count2, func), p, count2);
+                    Traits::copy(splice(index, count, count2, func), tmp.data_, count2);
+                }
+                else
+                    Traits::copy(splice(index, count, count2, func), p, count2);
+
+                return *this;
+            }
+            constexpr void check_index(size_type index, const char * func) const
+            {
+                if(index > size_)
+                    throw std::out_of_range(std::string("merl::basic_fixed_password::") + func + "(): Out of range (index = " + std::to_string(index) + ", size = " + std::to_string(size_) + ')');
+            }
+            constexpr void check_position(size_type pos, const char * func) const
+            {
+                if(pos >= size_)
+                    throw std::out_of_range(std::string("merl::basic_fixed_password::") + func + "(): Out of range (position = " + std::to_string(pos) + ", size = " + std::to_string(size_) + ')');
+            }
+            constexpr void check_iterators(const_iterator first, const_iterator last, const char * func) const
+            {
+                if(!(iterator_check(first) && iterator_check(last)) || first > last)
+                    throw std::invalid_argument(std::string("merl::basic_fixed_password::") + func + "(): Invalid argument -> Invalid iterator");
+            }
+
+        public:
+            // Constructors
+            constexpr basic_fixed_password() noexcept = default;
+            constexpr basic_fixed_password(const CharT * p)
+            {
+                if(p)
+                    append(p);
+            }
+            constexpr basic_fixed_password(const CharT * p, size_type count)
+            {
+                if(p)
+                    append(p, count);
+            }
+            constexpr basic_fixed_password(size_type count, CharT c)
+            {
+                append(count, c);
+            }
+            template <typename InputIt>
+            constexpr basic_fixed_password(InputIt first, InputIt last)
+            {
+                append(first, last);
+            }
+            constexpr basic_fixed_password(std::initializer_list<CharT> il) : basic_fixed_password(il.begin(), il.end())
+            {}
+            constexpr explicit basic_fixed_password(basic_password_view<CharT, Traits> v) : basic_fixed_password(v.data(), v.size())
+            {}
+            template <typename Alloc>
+            explicit basic_fixed_password(const basic_password<CharT, Traits, Alloc> & p) : basic_fixed_password(p.data(), p.size())
+            {}
+
+            constexpr basic_fixed_password(const basic_fixed_password & other) noexcept : size_{other.size_}
+            {
+                Traits::copy(data_, other.data_, size_);
+            }
+            // Moving copies the characters, then wipes the source
+            constexpr basic_fixed_password(basic_fixed_password && other) noexcept : basic_fixed_password(other)
+            {
+                other.clear();
+            }
+
+            // Destructor
+            constexpr ~basic_fixed_password()
+            {
+                wipe(data_, size_);
+            }
+
+            // Assignment
+            constexpr basic_fixed_password & operator=(const basic_fixed_password & other) noexcept
+            {
+                if(&other != this)
+                {
+                    clear();
+                    size_ = other.size_;
+                    Traits::copy(data_, other.data_, size_);
+                }
+                return *this;
+            }
+            constexpr basic_fixed_password & operator=(basic_fixed_password && other) noexcept
+            {
+                if(&other != this)
+                {
+                    *this = other;
+                    other.clear();
+                }
+                return *this;
+            }
+            constexpr basic_fixed_password & operator=(const CharT * p)
+            {
+                return splice(0, size_, p, Traits::length(p), "operator=");
+            }
+            basic_fixed_password & operator=(std::nullptr_t) = delete;
+            constexpr basic_fixed_password & operator=(CharT c)
+            {
+                *splice(0, size_, 1, "operator=") = c;
+                return *this;
+            }
+            constexpr basic_fixed_password & operator=(std::initializer_list<CharT> il)
+            {
+                return replace(begin(), end(), il);
+            }
+            constexpr basic_fixed_password & operator=(basic_password_view<CharT, Traits> v)
+            {
+                return splice(0, size_, v.data(), v.size(), "operator=");
+            }
+
+            template <typename Alloc>
+            explicit operator basic_password<CharT, Traits, Alloc>() const
+            {
+                return basic_password<CharT, Traits, Alloc>(data_, size_);
+            }
+
+            // Elements access
+            constexpr const_reference operator[](size_type pos) const
+            {
+                return data_[pos];
+            }
+            constexpr reference operator[](size_type pos)
+            {
+                return data_[pos];
+            }
+            constexpr const_reference at(size_type pos) const
+            {
+                if(pos >= size_)
+                    throw std::out_of_range("merl::basic_fixed_password::at(): Out of range (pos = " + std::to_string(pos) + ", size = " + std::to_string(size_) + ')');
+
+                return data_[pos];
+            }
+            constexpr reference at(size_type pos)
+            {
+                return const_cast<CharT &>(std::as_const(*this).at(pos));
+            }
+
+            constexpr const_pointer data() const noexcept
+            {
+                return data_;
+            }
+            constexpr pointer data() noexcept
+            {
+                return data_;
+            }
+
+            constexpr const_reference front() const
+            {
+                return data_[0];
+            }
+            constexpr reference front()
+            {
+                return data_[0];
+            }
+            constexpr const_reference back() const
+            {
+                return data_[size_-1];
+            }
+            constexpr reference back()
+            {
+                return data_[size_-1];
+            }
+
+            // Capacity
+            constexpr bool empty() const noexcept
+            {
+                return !size_;
+            }
+            constexpr size_type size() const noexcept
+            {
+                return size_;
+            }
+            static constexpr size_type max_size() noexcept
+            {
+                return N;
+            }
+            static constexpr size_type capacity() noexcept
+            {
+                return N;
+            }
+
+            // Iterators
+            constexpr const_iterator cbegin() const noexcept
+            {
+                return data_;
+            }
+            constexpr const_iterator begin() const noexcept
+            {
+                return data_;
+            }
+            constexpr iterator begin() noexcept
+            {
+                return data_;
+            }
+            constexpr const_iterator cend() const noexcept
+            {
+                return data_+size_;
+            }
+            constexpr const_iterator end() const noexcept
+            {
+                return data_+size_;
+            }
+            constexpr iterator end() noexcept
+            {
+                return data_+size_;
+            }
+            constexpr const_reverse_iterator crbegin() const noexcept
+            {
+                return const_reverse_iterator(end());
+            }
+            constexpr const_reverse_iterator rbegin() const noexcept
+            {
+                return const_reverse_iterator(end());
+            }
+            constexpr reverse_iterator rbegin() noexcept
+            {
+                return reverse_iterator(end());
+            }
+            constexpr const_reverse_iterator crend() const noexcept
+            {
+                return const_reverse_iterator(begin());
+            }
+            constexpr const_reverse_iterator rend() const noexcept
+            {
+                return const_reverse_iterator(begin());
+            }
+            constexpr reverse_iterator rend() noexcept
+            {
+                return reverse_iterator(begin());
+            }
+
+            // Operations
+            constexpr void clear() noexcept
+            {
+                wipe(data_, size_);
+                size_ = 0;
+            }
+
+            constexpr basic_fixed_password & insert(size_type index, size_type count, CharT c)
+            {
+                check_index(index, "insert");
+                std::fill_n(splice(index, 0, count, "insert"), count, c);
+                return *this;
+            }
+            constexpr basic_fixed_password & insert(size_type index, const CharT * p)
+            {
+                return insert(index, p, Traits::length(p));
+            }
+            constexpr basic_fixed_password & insert(size_type index, const CharT * p, size_type count)
+            {
+                check_index(index, "insert");
+                return splice(index, 0, p, count, "insert");
+            }
+            constexpr basic_fixed_password & insert(size_type index, const basic_fixed_password & p)
+            {
+                return insert(index, p.data_, p.size_);
+            }
+            constexpr basic_fixed_password & insert(size_type index, const basic_fixed_password & p, size_type p_index, size_type count = npos)
+            {
+                if(p_index > p.size_)
+                    throw std::out_of_range("merl::basic_fixed_password::insert(): Out of range (index = " + std::to_string(p_index) + ", size = " + std::to_string(p.size_) + ')');
+
+                return insert(index, p.data_ + p_index, std::min(count, p.size_ - p_index));
+            }
+            constexpr basic_fixed_password & insert(size_type index, basic_password_view<CharT, Traits> v)
+            {
+                return insert(index, v.data(), v.size());
+            }
+            constexpr iterator insert(const_iterator pos, CharT c)
+            {
+                return insert(pos, size_type{1}, c);
+            }
+            constexpr iterator insert(const_iterator pos, size_type count, CharT c)
+            {
+                check_iterators(pos, pos, "insert");
+
+                size_type index = pos - data_;
+                insert(index, count, c);
+                return data_ + index;
+            }
+            template <typename InputIt>
+            constexpr iterator insert(const_iterator pos, InputIt first, InputIt last)
+            {
+                check_iterators(pos, pos, "insert");
+
+                size_type index = pos - data_;
+                replace(pos, pos, first, last);
+                return data_ + index;
+            }
+            constexpr iterator insert(const_iterator pos, std::initializer_list<CharT> ilist)
+            {
+                return insert(pos, ilist.begin(), ilist.end());
+            }
+
+            constexpr basic_fixed_password & erase(size_type index = 0, size_type count = npos)
+            {
+                check_index(index, "erase");
+                splice(index, std::min(count, size_ - index), 0, "erase");
+                return *this;
+            }
+            constexpr iterator erase(const_iterator position)
+            {
+                if(!iterator_check(position) || position == end())
+                    throw std::invalid_argument("merl::basic_fixed_password::erase(): Invalid argument -> Invalid iterator");
+
+                size_type index = position - data_;
+                erase(index, 1);
+                return data_ + index;
+            }
+            constexpr iterator erase(const_iterator first, const_iterator last)
+            {
+                check_iterators(first, last, "erase");
+
+                size_type index = first - data_;
+                erase(index, last - first);
+                return data_ + index;
+            }
+
+            constexpr void push_back(CharT c)
+            {
+                append(1, c);
+            }
+            constexpr void pop_back()
+            {
+                erase(size_-1, 1);
+            }
+
+            constexpr basic_fixed_password & append(size_type count, CharT c)
+            {
+                return insert(size_, count, c);
+            }
+            constexpr basic_fixed_password & append(const basic_fixed_password & p)
+            {
+                return insert(size_, p);
+            }
+            constexpr basic_fixed_password & append(const basic_fixed_password & p, size_type pos, size_type count = npos)
+            {
+                return insert(size_, p, pos, count);
+            }
+            constexpr basic_fixed_password & append(const CharT * p, size_type count)
+            {
+                return insert(size_, p, count);
+            }
+            constexpr basic_fixed_password & append(const CharT * p)
+            {
+                return insert(size_, p);
+            }
+            template <typename InputIt>
+            constexpr basic_fixed_password & append(InputIt first, InputIt last)
+            {
+                return replace(end(), end(), first, last);
+            }
+            constexpr basic_fixed_password & append(std::initializer_list<CharT> ilist)
+            {
+                return append(ilist.begin(), ilist.end());
+            }
+            constexpr basic_fixed_password & append(basic_password_view<CharT, Traits> v)
+            {
+                return insert(size_, v);
+            }
+
+            constexpr basic_fixed_password & operator+=(const basic_fixed_password & p)
+            {
+                return append(p);
+            }
+            constexpr basic_fixed_password & operator+=(CharT c)
+            {
+                return append(1, c);
+            }
+            constexpr basic_fixed_password & operator+=(const CharT * p)
+            {
+                return append(p);
+            }
+            constexpr basic_fixed_password & operator+=(std::initializer_list<CharT> ilist)
+            {
+                return append(ilist);
+            }
+            constexpr basic_fixed_password & operator+=(basic_password_view<CharT, Traits> v)
+            {
+                return append(v);
+            }
+
+            constexpr int compare(const basic_fixed_password & p) const noexcept
+            {
+                return view().compare(p.view());
+            }
+            constexpr int compare(size_type pos1, size_type count1, const basic_fixed_password & p) const
+            {
+                check_position(pos1, "compare");
+                return view(pos1, count1).compare(p.view());
+            }
+            constexpr int compare(size_type pos1, size_type count1, const basic_fixed_password & p, size_type pos2, size_type count2 = npos) const
+            {
+                check_position(pos1, "compare");
+                p.check_position(pos2, "compare");
+                return view(pos1, count1).compare(p.view(pos2, count2));
+            }
+            constexpr int compare(basic_password_view<CharT, Traits> v) const noexcept
+            {
+                return view().compare(v);
+            }
+            constexpr int compare(size_type pos1, size_type count1, basic_password_view<CharT, Traits> v) const
+            {
+                check_position(pos1, "compare");
+                return view(pos1, count1).compare(v);
+            }
+            constexpr int compare(const CharT * p) const
+            {
+                return view().compare(p);
+            }
+            constexpr int compare(size_type pos1, size_type count1, const CharT * p) const
+            {
+                check_position(pos1, "compare");
+                return view(pos1, count1).compare(p);
+            }
+            constexpr int compare(size_type pos1, size_type count1, const CharT * p, size_type count2) const
+            {
+                check_position(pos1, "compare");
+                return view(pos1, count1).compare(basic_password_view<CharT, Traits>(p, count2));
+            }
+
+            constexpr bool starts_with(basic_password_view<CharT, Traits> v) const noexcept
+            {
+                return view().starts_with(v);
+            }
+            constexpr bool starts_with(CharT c) const noexcept
+            {
+                return view().starts_with(c);
+            }
+            constexpr bool starts_with(const CharT * p) const
+            {
+                return view().starts_with(p);
+            }
+            constexpr bool ends_with(basic_password_view<CharT, Traits> v) const noexcept
+            {
+                return view().ends_with(v);
+            }
+            constexpr bool ends_with(CharT c) const noexcept
+            {
+                return view().ends_with(c);
+            }
+            constexpr bool ends_with(const CharT * p) const
+            {
+                return view().ends_with(p);
+            }
+            constexpr bool contains(basic_password_view<CharT, Traits> v) const noexcept
+            {
+                return view().contains(v);
+            }
+            constexpr bool contains(CharT c) const noexcept
+            {
+                return view().contains(c);
+            }
+            constexpr bool contains(const CharT * p) const
+            {
+                return view().contains(p);
+            }
+
+            constexpr basic_fixed_password & replace(size_type pos, size_type count, const basic_fixed_password & p)
+            {
+                return replace(pos, count, p.data_, p.size_);
+            }
+            constexpr basic_fixed_password & replace(const_iterator first, const_iterator last, const basic_fixed_password & p)
+            {
+                return replace(first, last, p.data_, p.size_);
+            }
+            constexpr basic_fixed_password & replace(size_type pos, size_type count, const basic_fixed_password & p, size_type pos2, size_type count2 = npos)
+            {
+                p.check_position(pos2, "replace");
+                return replace(pos, count, p.data_ + pos2, std::min(count2, p.size_ - pos2));
+            }
+            constexpr basic_fixed_password & replace(size_type pos, size_type count, basic_password_view<CharT, Traits> v)
+            {
+                return replace(pos, count, v.data(), v.size());
+            }
+            constexpr basic_fixed_password & replace(size_type pos, size_type count, const CharT * p, size_type count2)
+            {
+                check_position(pos, "replace");
+                return splice(pos, std::min(count, size_ - pos), p, count2, "replace");
+            }
+            constexpr basic_fixed_password & replace(const_iterator first, const_iterator last, const CharT * p, size_type count2)
+            {
+                check_iterators(first, last, "replace");
+                return splice(first - data_, last - first, p, count2, "replace");
+            }
+            constexpr basic_fixed_password & replace(size_type pos, size_type count, const CharT * p)
+            {
+                return replace(pos, count, p, Traits::length(p));
+            }
+            constexpr basic_fixed_password & replace(const_iterator first, const_iterator last, const CharT * p)
+            {
+                return replace(first, last, p, Traits::length(p));
+            }
+            constexpr basic_fixed_password & replace(size_type pos, size_type count, size_type count2, CharT c)
+            {
+                check_position(pos, "replace");
+                std::fill_n(splice(pos, std::min(count, size_ - pos), count2, "replace"), count2, c);
+                return *this;
+            }
+            constexpr basic_fixed_password & replace(const_iterator first, const_iterator last, size_type count2, CharT c)
+            {
+                check_iterators(first, last, "replace");
+                std::fill_n(splice(first - data_, last - first, count2, "replace"), count2, c);
+                return *this;
+            }
+            template <typename InputIt>
+            constexpr basic_fixed_password & replace(const_iterator first, const_iterator last, InputIt first2, InputIt last2)
+            {
+                check_iterators(first, last, "replace");
+
+                if constexpr(std::is_pointer_v<InputIt> && std::is_same_v<std::remove_cv_t<std::remove_pointer_t<InputIt>>, CharT>)
+                {
+                    return splice(first - data_, last - first, first2, last2 - first2, "replace");
+                }
+                else
+                {
+                    basic_fixed_password tmp; // the source may alias our storage
+                    for(; first2 != last2; ++first2)
+                        tmp.push_back(*first2);
+                    return splice(first - data_, last - first, tmp.data_, tmp.size_, "replace");
+                }
+            }
+            constexpr basic_fixed_password & replace(const_iterator first, const_iterator last, std::initializer_list<CharT> ilist)
+            {
+                return replace(first, last, ilist.begin(), ilist.size());
+            }
+
+            constexpr basic_fixed_password subpwd(size_type pos = 0, size_type count = npos) const
+            {
+                if(pos > size_)
+                    throw std::out_of_range("merl::basic_fixed_password::subpwd(): Out of range (position = " + std::to_string(pos) + ", size = " + std::to_string(size_) + ')');
+
+                return basic_fixed_password(data_ + pos, std::min(count, size_ - pos));
+            }
+
+            // Non-owning window onto [pos, pos + count), valid until the next modification
+            constexpr basic_password_view<CharT, Traits> view(size_type pos = 0, size_type count = npos) const &
+            {
+                if(pos > size_)
+                    throw std::out_of_range("merl::basic_fixed_password::view(): Out of range (position = " + std::to_string(pos) + ", size = " + std::to_string(size_) + ')');
+
+                return basic_password_view<CharT, Traits>(data_ + pos, std::min(count, size_ - pos));
+            }
+            basic_password_view<CharT, Traits> view(size_type pos = 0, size_type count = npos) const && = delete;
+            constexpr explicit operator basic_password_view<CharT, Traits>() const & noexcept
+            {
+                return basic_password_view<CharT, Traits>(data_, size_);
+            }
+            explicit operator basic_password_view<CharT, Traits>() const && = delete;
+
+            constexpr size_type copy(CharT * dest, size_type count, size_type pos = 0) const
+            {
+                if(pos > size_)
+                    throw std::out_of_range("merl::basic_fixed_password::copy(): Out of range (position = " + std::to_string(pos) + ", size = " + std::to_string(size_) + ')');
+
+                return view().copy(dest, count, pos);
+            }
+
+            constexpr void resize(size_type count, CharT c = CharT{})
+            {
+                if(count > N)
+                    throw std::length_error("merl::basic_fixed_password::resize(): Length error -> Capacity exceeded (capacity = " + std::to_string(N) + ')');
+
+                if(count < size_)
+                    erase(count);
+                else
+                    append(count - size_, c);
+            }
+
+            constexpr void swap(basic_fixed_password & other) noexcept
+            {
+                std::swap_ranges(data_, data_ + std::max(size_, other.size_), other.data_);
+                std::swap(size_, other.size_);
+            }
+
+            // Search
+            constexpr size_type find(basic_password_view<CharT, Traits> v, size_type pos = 0) const noexcept
+            {
+                return view().find(v, pos);
+            }
+            constexpr size_type find(const CharT * p, size_type pos, size_type count) const
+            {
+                return view().find(p, pos, count);
+            }
+            constexpr size_type find(const CharT * p, size_type pos = 0) const
+            {
+                return view().find(p, pos);
+            }
+            constexpr size_type find(CharT c, size_type pos = 0) const noexcept
+            {
+                return view().find(c, pos);
+            }
+            constexpr size_type rfind(basic_password_view<CharT, Traits> v, size_type pos = npos) const noexcept
+            {
+                return view().rfind(v, pos);
+            }
+            constexpr size_type rfind(const CharT * p, size_type pos, size_type count) const
+            {
+                return view().rfind(p, pos, count);
+            }
+            constexpr size_type rfind(const CharT * p, size_type pos = npos) const
+            {
+                return view().rfind(p, pos);
+            }
+            constexpr size_type rfind(CharT c, size_type pos = npos) const noexcept
+            {
+                return view().rfind(c, pos);
+            }
+            constexpr size_type find_first_of(basic_password_view<CharT, Traits> v, size_type pos = 0) const noexcept
+            {
+                return view().find_first_of(v, pos);
+            }
+            constexpr size_type find_first_of(const CharT * p, size_type pos = 0) const
+            {
+                return view().find_first_of(p, pos);
+            }
+            constexpr size_type find_first_of(CharT c, size_type pos = 0) const noexcept
+            {
+                return view().find_first_of(c, pos);
+            }
+            constexpr size_type find_last_of(basic_password_view<CharT, Traits> v, size_type pos = npos) const noexcept
+            {
+                return view().find_last_of(v, pos);
+            }
+            constexpr size_type find_last_of(const CharT * p, size_type pos = npos) const
+            {
+                return view().find_last_of(p, pos);
+            }
+            constexpr size_type find_last_of(CharT c, size_type pos = npos) const noexcept
+            {
+                return view().find_last_of(c, pos);
+            }
+            constexpr size_type find_first_not_of(basic_password_view<CharT, Traits> v, size_type pos = 0) const noexcept
+            {
+                return view().find_first_not_of(v, pos);
+            }
+            constexpr size_type find_first_not_of(const CharT * p, size_type pos = 0) const
+            {
+                return view().find_first_not_of(p, pos);
+            }
+            constexpr size_type find_first_not_of(CharT c, size_type pos = 0) const noexcept
+            {
+                return view().find_first_not_of(c, pos);
+            }
+            constexpr size_type find_last_not_of(basic_password_view<CharT, Traits> v, size_type pos = npos) const noexcept
+            {
+                return view().find_last_not_of(v, pos);
+            }
+            constexpr size_type find_last_not_of(const CharT * p, size_type pos = npos) const
+            {
+                return view().find_last_not_of(p, pos);
+            }
+            constexpr size_type find_last_not_of(CharT c, size_type pos = npos) const noexcept
+            {
+                return view().find_last_not_of(c, pos);
+            }
+    };
+
+    // Non-member functions
+    template <typename CharT, std::size_t N, std::size_t M, typename Traits>
+    constexpr bool operator==(const basic_fixed_password<CharT, N, Traits> & lhs, const basic_fixed_password<CharT, M, Traits> & rhs) noexcept
+    {
+        return lhs.view() == rhs.view();
+    }
+    template <typename CharT, std::size_t N, typename Traits>
+    constexpr bool operator==(const basic_fixed_password<CharT, N, Traits> & lhs, basic_password_view<CharT, Traits> rhs) noexcept
+    {
+        return lhs.view() == rhs;
+    }
+    template <typename CharT, std::size_t N, typename Traits>
+    constexpr bool operator==(const basic_fixed_password<CharT, N, Traits> & lhs, const CharT * rhs)
+    {
+        return lhs.view() == rhs;
+    }
+    template <typename CharT, std::size_t N, std::size_t M, typename Traits>
+    constexpr Traits::comparison_category operator<=>(const basic_fixed_password<CharT, N, Traits> & lhs, const basic_fixed_password<CharT, M, Traits> & rhs) noexcept
+    {
+        return lhs.view() <=> rhs.view();
+    }
+    template <typename CharT, std::size_t N, typename Traits>
+    constexpr Traits::comparison_category operator<=>(const basic_fixed_password<CharT, N, Traits> & lhs, basic_password_view<CharT, Traits> rhs) noexcept
+    {
+        return lhs.view() <=> rhs;
+    }
+    template <typename CharT, std::size_t N, typename Traits>
+    constexpr Traits::comparison_category operator<=>(const basic_fixed_password<CharT, N, Traits> & lhs, const CharT * rhs)
+    {
+        return lhs.view() <=> rhs;
+    }
+
+    template <typename CharT, std::size_t N, typename Traits>
+    constexpr void swap(basic_fixed_password<CharT, N, Traits> & lhs, basic_fixed_password<CharT, N, Traits> & rhs) noexcept
+    {
+        lhs.swap(rhs);
+    }
+
+    template <std::size_t N>
+    using fixed_password = basic_fixed_password<char, N>;
+    template <std::size_t N>
+    using wfixed_password = basic_fixed_password<wchar_t, N>;
+    template <std::size_t N>
+    using u8fixed_password = basic_fixed_password<char8_t, N>;
+    template <std::size_t N>
+    using u16fixed_password = basic_fixed_password<char16_t, N>;
+    template <std::size_t N>
+    using u32fixed_password = basic_fixed_password<char32_t, N>;
+}
+
+#endif // MERLIN_FIXED_PASSWORD_HPP
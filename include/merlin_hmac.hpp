@@ -0,0 +1,382 @@
+#ifndef MERLIN_HMAC_HPP
+#define MERLIN_HMAC_HPP
+
+#include <merlin_basic_password.hpp>
+#include <merlin_detail.hpp>
+#include <merlin_pbkdf2.hpp>
+#include <merlin_sha2.hpp>
+
+#include <algorithm>
+
+// HMAC-SHA256 / HMAC-SHA512 (RFC 2104) keyed by a basic_password. A basic_hmac_key absorbs the key blocks once,
+// at construction, and keeps the inner and outer states (wiped on destruction), so a MAC only costs the message
+// blocks plus one outer block. hmac_verify_batch() checks many MACs at once: messages go through independent SIMD
+// lanes, 8 (AVX-512) or 4 (AVX2) for SHA-512, on the compress kernels of the PBKDF2 engine. SHA-256 uses 16 or 8 lanes
+// the same way, unless the CPU has the SHA extensions, which are faster one message at a time.
+// MACs are always compared in constant time, and a truncated MAC must keep at least half of the digest.
+
+namespace merl
+{
+    template <typename Spec>
+    class basic_hmac_key;
+
+    // One verification of a batch
+    template <typename Spec>
+    struct basic_hmac_request
+    {
+        const basic_hmac_key<Spec> * key;
+        const void * message;
+        std::size_t message_size;
+        const void * mac;
+        std::size_t mac_size;
+    };
+
+    namespace detail
+    {
+        template <typename Spec>
+        struct hmac_runner;
+
+#if MERLIN_X86_SIMD
+        // Word-major lane arrays (word i of lane l at [i * lanes + l]), message words in host order
+        MERLIN_TARGET("avx512f")
+        inline void sha256_blocks_x16_avx512(std::uint32_t * state, const std::uint32_t * w) noexcept
+        {
+            __m512i s[8], v[16];
+            for(int i = 0; i < 8; ++i)
+                s[i] = _mm512_loadu_si512(state + 16*i);
+            for(int i = 0; i < 16; ++i)
+                v[i] = _mm512_loadu_si512(w + 16*i);
+            sha256_compress_x16_avx512(s, v);
+            for(int i = 0; i < 8; ++i)
+                _mm512_storeu_si512(state + 16*i, s[i]);
+            for(__m512i & x : v)
+                x = _mm512_setzero_si512();
+        }
+        MERLIN_TARGET("avx2")
+        inline void sha256_blocks_x8_avx2(std::uint32_t * state, const std::uint32_t * w) noexcept
+        {
+            __m256i s[8], v[16];
+            for(int i = 0; i < 8; ++i)
+                s[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(state + 8*i));
+            for(int i = 0; i < 16; ++i)
+                v[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(w + 8*i));
+            sha256_compress_x8_avx2(s, v);
+            for(int i = 0; i < 8; ++i)
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(state + 8*i), s[i]);
+            for(__m256i & x : v)
+                x = _mm256_setzero_si256();
+        }
+        MERLIN_TARGET("avx512f")
+        inline void sha512_blocks_x8_avx512(std::uint64_t * state, const std::uint64_t * w) noexcept
+        {
+            __m512i s[8], v[16];
+            for(int i = 0; i < 8; ++i)
+                s[i] = _mm512_loadu_si512(state + 8*i);
+            for(int i = 0; i < 16; ++i)
+                v[i] = _mm512_loadu_si512(w + 8*i);
+            sha512_compress_x8_avx512(s, v);
+            for(int i = 0; i < 8; ++i)
+                _mm512_storeu_si512(state + 8*i, s[i]);
+            for(__m512i & x : v)
+                x = _mm512_setzero_si512();
+        }
+        MERLIN_TARGET("avx2")
+        inline void sha512_blocks_x4_avx2(std::uint64_t * state, const std::uint64_t * w) noexcept
+        {
+            __m256i s[8], v[16];
+            for(int i = 0; i < 8; ++i)
+                s[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(state + 4*i));
+            for(int i = 0; i < 16; ++i)
+                v[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(w + 4*i));
+            sha512_compress_x4_avx2(s, v);
+            for(int i = 0; i < 8; ++i)
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(state + 4*i), s[i]);
+            for(__m256i & x : v)
+                x = _mm256_setzero_si256();
+        }
+#endif
+
+        template <typename Spec>
+        struct hmac_lanes;
+
+        template <>
+        struct hmac_lanes<sha256_spec>
+        {
+            static constexpr std::size_t max_width = 16;
+
+            // Message blocks are loaded one lane at a time, which the SHA extensions beat on a single lane
+            static std::size_t width() noexcept
+            {
+#if MERLIN_X86_SIMD
+                if(cpu().sha)
+                    return 1;
+#endif
+                return pbkdf2_lanes<sha256_spec>::width();
+            }
+            static void blocks([[maybe_unused]] std::size_t width, [[maybe_unused]] std::uint32_t * state, [[maybe_unused]] const std::uint32_t * w) noexcept
+            {
+#if MERLIN_X86_SIMD
+                if(width == 16)
+                    sha256_blocks_x16_avx512(state, w);
+                else
+                    sha256_blocks_x8_avx2(state, w);
+#endif
+            }
+        };
+        template <>
+        struct hmac_lanes<sha512_spec>
+        {
+            static constexpr std::size_t max_width = 8;
+
+            static std::size_t width() noexcept
+            {
+                return pbkdf2_lanes<sha512_spec>::width();
+            }
+            static void blocks([[maybe_unused]] std::size_t width, [[maybe_unused]] std::uint64_t * state, [[maybe_unused]] const std::uint64_t * w) noexcept
+            {
+#if MERLIN_X86_SIMD
+                if(width == 8)
+                    sha512_blocks_x8_avx512(state, w);
+                else
+                    sha512_blocks_x4_avx2(state, w);
+#endif
+            }
+        };
+
+        template <typename Spec>
+        constexpr bool hmac_mac_size_ok(std::size_t mac_size) noexcept
+        {
+            return mac_size >= Spec::digest_size / 2 && mac_size <= Spec::digest_size;
+        }
+    }
+
+    // The inner and outer HMAC states of one key, reusable for any number of MACs
+    template <typename Spec>
+    class basic_hmac_key
+    {
+        public:
+            static constexpr std::size_t mac_size = Spec::digest_size;
+
+            template <typename CharT, typename Traits, typename Alloc>
+            explicit basic_hmac_key(const basic_password<CharT, Traits, Alloc> & key) noexcept
+                : state_(key.data(), key.size() * sizeof(CharT))
+            {}
+            template <typename CharT, typename Traits>
+            explicit basic_hmac_key(basic_password_view<CharT, Traits> key) noexcept
+                : state_(key.data(), key.size() * sizeof(CharT))
+            {}
+            basic_hmac_key(const void * key, std::size_t n) noexcept
+                : state_(key, n)
+            {}
+
+            // Writes the mac_size-byte MAC of message to out
+            void sign(const void * message, std::size_t n, unsigned char * out) const noexcept
+            {
+                state_.mac(message, n, nullptr, 0, out);
+            }
+            // Compares the MAC of message with mac (possibly truncated, to no less than half the digest) in constant time
+            bool verify(const void * message, std::size_t n, const void * mac, std::size_t size = mac_size) const noexcept
+            {
+                unsigned char computed[mac_size];
+                sign(message, n, computed);
+                bool equal = detail::hmac_mac_size_ok<Spec>(size) && detail::ct_equal(computed, mac, size);
+                detail::secure_zero(computed, sizeof(computed));
+                return equal;
+            }
+
+        private:
+            template <typename S>
+            friend struct detail::hmac_runner;
+
+            detail::hmac_state<Spec> state_;
+    };
+
+    using hmac_sha256_key = basic_hmac_key<detail::sha256_spec>;
+    using hmac_sha512_key = basic_hmac_key<detail::sha512_spec>;
+    using hmac_key = hmac_sha256_key;   // HS256
+
+    using hmac_sha256_request = basic_hmac_request<detail::sha256_spec>;
+    using hmac_sha512_request = basic_hmac_request<detail::sha512_spec>;
+
+    namespace detail
+    {
+        template <typename Spec>
+        struct hmac_runner
+        {
+            using word_type = typename Spec::word_type;
+            using lanes = hmac_lanes<Spec>;
+            static constexpr std::size_t block_size = 16 * sizeof(word_type);
+            static constexpr std::size_t digest_words = Spec::digest_size / sizeof(word_type);
+
+            // A lane walks the message blocks, the padded tail (1 or 2 blocks), then the outer block
+            struct lane
+            {
+                const basic_hmac_request<Spec> * request = nullptr;
+                bool * result = nullptr;
+                const unsigned char * message = nullptr;
+                std::size_t whole = 0;      // full message blocks
+                std::size_t blocks = 0;     // inner blocks in all
+                std::size_t position = 0;
+                unsigned char tail[3 * block_size];   // padded tail, then the outer block
+            };
+
+            static void load(lane & l, const basic_hmac_request<Spec> & request, bool * result, word_type * state, std::size_t index,
+                             std::size_t width) noexcept
+            {
+                l.request = &request;
+                l.result = result;
+                l.message = static_cast<const unsigned char *>(request.message);
+                l.whole = request.message_size / block_size;
+                l.position = 0;
+
+                std::size_t rest = request.message_size - l.whole * block_size;
+                std::memset(l.tail, 0, 2 * block_size);
+                if(rest)
+                    std::memcpy(l.tail, l.message + l.whole * block_size, rest);
+                l.tail[rest] = 0x80;
+                std::size_t tail_blocks = rest + 1 + 2 * sizeof(word_type) > block_size ? 2 : 1;
+                std::uint64_t total = block_size + request.message_size;
+                store_be<std::uint64_t>(l.tail + tail_blocks * block_size - 8, total << 3);
+                if constexpr(sizeof(word_type) == 8)
+                    store_be<std::uint64_t>(l.tail + tail_blocks * block_size - 16, total >> 61);
+                l.blocks = l.whole + tail_blocks;
+
+                for(std::size_t i = 0; i < 8; ++i)
+                    state[i * width + index] = request.key->state_.inner[i];
+            }
+
+            static const unsigned char * next_block(const lane & l) noexcept
+            {
+                if(l.position < l.whole)
+                    return l.message + l.position * block_size;
+                if(l.position < l.blocks)
+                    return l.tail + (l.position - l.whole) * block_size;
+                return l.tail + 2 * block_size;
+            }
+
+            static void finish(lane & l, const unsigned char * digest) noexcept
+            {
+                *l.result = hmac_mac_size_ok<Spec>(l.request->mac_size) && ct_equal(digest, l.request->mac, l.request->mac_size);
+                l.request = nullptr;
+            }
+
+            static void run(const basic_hmac_request<Spec> * requests, std::size_t count, bool * results) noexcept
+            {
+                const std::size_t width = lanes::width();
+                if(width == 1)
+                {
+                    for(std::size_t i = 0; i < count; ++i)
+                        results[i] = requests[i].key->verify(requests[i].message, requests[i].message_size, requests[i].mac, requests[i].mac_size);
+                    return;
+                }
+
+                lane ls[lanes::max_width];
+                word_type state[8 * lanes::max_width] = {};
+                word_type w[16 * lanes::max_width] = {};
+                unsigned char digest[Spec::digest_size];
+                std::size_t next = 0;
+
+                for(;;)
+                {
+                    std::size_t busy = 0, last = 0;
+                    for(std::size_t l = 0; l < width; ++l)
+                    {
+                        if(!ls[l].request && next < count)
+                        {
+                            load(ls[l], requests[next], results + next, state, l, width);
+                            ++next;
+                        }
+                        if(ls[l].request)
+                        {
+                            ++busy;
+                            last = l;
+                        }
+                    }
+                    if(!busy)
+                        break;
+
+                    if(busy == 1 && next == count)
+                    {
+                        // The last message runs faster on the one-lane path (SHA extensions) than with idle lanes
+                        lane & l = ls[last];
+                        word_type s[8];
+                        for(std::size_t i = 0; i < 8; ++i)
+                            s[i] = state[i * width + last];
+                        while(l.position <= l.blocks)
+                        {
+                            Spec::blocks(s, next_block(l), 1);
+                            if(l.position++ == l.blocks - 1)
+                                next_outer(l, s, l.request->key->state_.outer);
+                        }
+                        for(std::size_t i = 0; i < digest_words; ++i)
+                            store_be<word_type>(digest + i * sizeof(word_type), s[i]);
+                        finish(l, digest);
+                        secure_zero(s, sizeof(s));
+                        continue;
+                    }
+
+                    for(std::size_t l = 0; l < width; ++l)
+                    {
+                        if(!ls[l].request)
+                            continue;
+                        const unsigned char * block = next_block(ls[l]);
+                        for(std::size_t t = 0; t < 16; ++t)
+                            w[t * width + l] = load_be<word_type>(block + t * sizeof(word_type));
+                    }
+                    lanes::blocks(width, state, w);
+
+                    for(std::size_t l = 0; l < width; ++l)
+                    {
+                        lane & ln = ls[l];
+                        if(!ln.request)
+                            continue;
+                        if(ln.position < ln.blocks)
+                        {
+                            if(++ln.position == ln.blocks)
+                            {
+                                word_type s[8];
+                                for(std::size_t i = 0; i < 8; ++i)
+                                    s[i] = state[i * width + l];
+                                next_outer(ln, s, ln.request->key->state_.outer);
+                                for(std::size_t i = 0; i < 8; ++i)
+                                    state[i * width + l] = s[i];
+                                secure_zero(s, sizeof(s));
+                            }
+                            continue;
+                        }
+                        for(std::size_t i = 0; i < digest_words; ++i)
+                            store_be<word_type>(digest + i * sizeof(word_type), state[i * width + l]);
+                        finish(ln, digest);
+                    }
+                }
+
+                for(lane & l : ls)
+                    secure_zero(l.tail, sizeof(l.tail));
+                secure_zero(state, sizeof(state));
+                secure_zero(w, sizeof(w));
+                secure_zero(digest, sizeof(digest));
+            }
+
+            // Turns the inner hash state s into the outer block, and s into the outer state
+            static void next_outer(lane & l, word_type * s, const word_type * outer) noexcept
+            {
+                unsigned char * block = l.tail + 2 * block_size;
+                std::memset(block, 0, block_size);
+                for(std::size_t i = 0; i < digest_words; ++i)
+                    store_be<word_type>(block + i * sizeof(word_type), s[i]);
+                block[Spec::digest_size] = 0x80;
+                store_be<std::uint64_t>(block + block_size - 8, (block_size + Spec::digest_size) * 8);
+                std::memcpy(s, outer, 8 * sizeof(word_type));
+            }
+        };
+    }
+
+    // Verifies every request into results[i]; MACs of any key and length, compared in constant time
+    template <typename Spec>
+    void hmac_verify_batch(const basic_hmac_request<Spec> * requests, std::size_t count, bool * results) noexcept
+    {
+        detail::hmac_runner<Spec>::run(requests, count, results);
+    }
+}
+
+#endif // MERLIN_HMAC_HPP
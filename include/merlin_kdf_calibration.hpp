@@ -0,0 +1,627 @@
+#ifndef MERLIN_KDF_CALIBRATION_HPP
+#define MERLIN_KDF_CALIBRATION_HPP
+
+#include <merlin_argon2.hpp>
+#include <merlin_basic_password.hpp>
+#include <merlin_detail.hpp>
+#include <merlin_pbkdf2.hpp>
+#include <merlin_scrypt.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <latch>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Picks KDF costs for the machine the process runs on: every enabled KDF is timed on basic_password probes while
+// `concurrency` verifications run at once, and its cost is raised until the median latency reaches the target.
+// Argon2id keeps its memory at the cap (halving it only when one pass is already too slow) and scales the passes,
+// PBKDF2 scales its iterations and scrypt its N (up to its own memory cap). Results serialize to a flat JSON object, which doubles as a cache
+// file: calibrate_kdf_cached() reuses it as long as it was measured on the same processor with the same target.
+
+namespace merl
+{
+    struct kdf_calibration_target
+    {
+        std::chrono::milliseconds latency{100};     // median verification latency to reach
+        std::uint32_t concurrency = 0;              // verifications running at once, 0 for the hardware concurrency
+        std::uint32_t samples = 3;                  // timed runs per worker at each probed cost
+        std::uint32_t argon2_max_memory_kib = 65536;
+        std::uint32_t argon2_parallelism = 1;
+        std::uint32_t scrypt_max_memory_kib = 65536; // 128 r p N bytes, i.e. N = 2^16 with the default r and p
+        std::uint32_t scrypt_r = 8;
+        std::uint32_t scrypt_p = 1;
+        std::uint64_t memory_budget_kib = 0;        // Argon2id / scrypt memory for all concurrent hashes, 0 for only the per-hash caps
+        bool argon2id = true;
+        bool pbkdf2_sha256 = true;
+        bool pbkdf2_sha512 = true;
+        bool scrypt = true;
+
+        bool operator==(const kdf_calibration_target &) const = default;
+    };
+
+    // Chosen costs and the median latency measured with them; KDFs that were not calibrated are left at 0
+    struct kdf_calibration
+    {
+        std::string machine;                        // processor and thread count the costs were measured on
+        kdf_calibration_target target;
+        std::uint32_t concurrency = 0;              // concurrency actually used
+
+        argon2_params argon2{0, 0, 0};
+        std::chrono::microseconds argon2_latency{0};
+        std::uint32_t pbkdf2_sha256_iterations = 0;
+        std::chrono::microseconds pbkdf2_sha256_latency{0};
+        std::uint32_t pbkdf2_sha512_iterations = 0;
+        std::chrono::microseconds pbkdf2_sha512_latency{0};
+        std::uint32_t scrypt_log2_n = 0;
+        std::uint32_t scrypt_r = 0;
+        std::uint32_t scrypt_p = 0;
+        std::chrono::microseconds scrypt_latency{0};
+    };
+
+    namespace detail
+    {
+        inline constexpr std::uint32_t kdf_calibration_format = 1;
+
+        // Processor brand, instruction set extensions in use and thread count
+        inline std::string kdf_machine_fingerprint()
+        {
+            std::string s;
+#if MERLIN_X86_SIMD
+            unsigned int regs[12] = {};
+            unsigned int max_leaf = __get_cpuid_max(0x80000000, nullptr);
+            if(max_leaf >= 0x80000004)
+            {
+                for(unsigned int i = 0; i < 3; ++i)
+                    __get_cpuid(0x80000002 + i, regs + 4*i, regs + 4*i + 1, regs + 4*i + 2, regs + 4*i + 3);
+                char brand[49] = {};
+                std::memcpy(brand, regs, 48);
+                std::string_view b(brand);
+                b.remove_prefix(std::min(b.find_first_not_of(' '), b.size()));
+                s.append(b.substr(0, b.find_last_not_of(' ') + 1));
+            }
+            const cpu_features & f = cpu();
+            for(auto [on, name] : {std::pair{f.ssse3, " ssse3"}, {f.sse41, " sse4.1"}, {f.avx2, " avx2"}, {f.sha, " sha"},
+                                   {f.avx512f, " avx512f"}, {f.avx512bw, " avx512bw"}, {f.avx512vl, " avx512vl"}})
+                if(on)
+                    s += name;
+#else
+            s = "generic";
+#endif
+            s += " threads=" + std::to_string(std::thread::hardware_concurrency());
+            return s;
+        }
+
+        // Median latency of fn(probe) with `concurrency` threads calling it at the same time
+        template <typename Fn>
+        std::chrono::nanoseconds kdf_probe_latency(std::uint32_t concurrency, std::uint32_t samples, std::size_t probe_count, Fn fn)
+        {
+            std::vector<std::chrono::nanoseconds> times(std::size_t{concurrency} * samples);
+            std::vector<std::exception_ptr> errors(concurrency);
+            std::latch start(concurrency);
+            auto work = [&](std::size_t worker)
+            {
+                // A worker that throws still arrives at the latch, or the others would wait for it forever
+                bool arrived = false;
+                try
+                {
+                    fn((worker * samples) % probe_count); // warm-up: first touch of the memory and thread start-up are not timed
+                    arrived = true;
+                    start.arrive_and_wait();
+                    for(std::size_t i = 0; i < samples; ++i)
+                    {
+                        std::size_t k = worker * samples + i;
+                        auto t0 = std::chrono::steady_clock::now();
+                        fn(k % probe_count);
+                        times[k] = std::chrono::steady_clock::now() - t0;
+                    }
+                }
+                catch(...)
+                {
+                    errors[worker] = std::current_exception();
+                    if(!arrived)
+                        start.count_down();
+                }
+            };
+            {
+                std::vector<std::jthread> workers;
+                workers.reserve(concurrency - 1);
+                try
+                {
+                    for(std::size_t w = 1; w < concurrency; ++w)
+                        workers.emplace_back(work, w);
+                }
+                catch(...)
+                {
+                    // Releases the workers already started (for this thread and the ones that never will) before joining them
+                    start.count_down(static_cast<std::ptrdiff_t>(concurrency - workers.size()));
+                    throw;
+                }
+                work(0);
+            }
+            for(const std::exception_ptr & e : errors)
+            {
+                if(e)
+                    std::rethrow_exception(e);
+            }
+            std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+            return times[times.size() / 2];
+        }
+
+        inline std::chrono::microseconds kdf_us(std::chrono::nanoseconds t) noexcept
+        {
+            return std::chrono::duration_cast<std::chrono::microseconds>(t);
+        }
+
+        // Cost ~ latency / target, as a factor on the current one
+        inline double kdf_scale(std::chrono::nanoseconds target, std::chrono::nanoseconds measured) noexcept
+        {
+            return static_cast<double>(target.count()) / static_cast<double>(std::max<std::int64_t>(measured.count(), 1));
+        }
+
+        // Largest per-hash memory allowed by the cap and the budget, in KiB
+        inline std::uint64_t kdf_memory_cap(const kdf_calibration_target & target, std::uint32_t concurrency, std::uint64_t cap_kib) noexcept
+        {
+            if(target.memory_budget_kib)
+                cap_kib = std::min<std::uint64_t>(cap_kib, target.memory_budget_kib / concurrency);
+            return cap_kib;
+        }
+
+        template <typename Spec, typename CharT, typename Traits, typename Alloc>
+        void kdf_calibrate_pbkdf2(const kdf_calibration_target & target, std::uint32_t concurrency,
+                                  const basic_password<CharT, Traits, Alloc> * probes, std::size_t probe_count,
+                                  std::uint32_t & iterations, std::chrono::microseconds & latency)
+        {
+            static constexpr unsigned char salt[16] = {};
+            auto measure = [&](std::uint32_t c)
+            {
+                return kdf_probe_latency(concurrency, target.samples, probe_count, [&](std::size_t i)
+                {
+                    unsigned char out[Spec::digest_size];
+                    basic_pbkdf2_key<Spec>(probes[i]).derive(salt, sizeof(salt), c, out, sizeof(out));
+                    secure_zero(out, sizeof(out));
+                });
+            };
+
+            // The cost is linear in the iterations: extrapolate from a short run, then extrapolate again from the result,
+            // which corrects for the fixed costs and clock changes the short run over- or underweights
+            std::uint32_t c = 4096;
+            std::chrono::nanoseconds t = measure(c);
+            for(int pass = 0; pass < 2; ++pass)
+            {
+                double next = std::floor(c * kdf_scale(target.latency, t));
+                c = static_cast<std::uint32_t>(std::clamp(next, 1.0, 4294967295.0));
+                t = measure(c);
+            }
+            // Both estimates land above the target about as often as below: step down, with a 3% margin for noise,
+            // until the measured latency fits
+            while(c > 1 && t > target.latency)
+            {
+                double next = std::floor(c * kdf_scale(target.latency, t) * 0.97);
+                c = static_cast<std::uint32_t>(std::clamp(next, 1.0, c - 1.0));
+                t = measure(c);
+            }
+            iterations = c;
+            latency = kdf_us(t);
+        }
+
+        template <typename CharT, typename Traits, typename Alloc>
+        void kdf_calibrate_argon2(const kdf_calibration_target & target, std::uint32_t concurrency,
+                                  const basic_password<CharT, Traits, Alloc> * probes, std::size_t probe_count, kdf_calibration & result)
+        {
+            static constexpr unsigned char salt[16] = {};
+            argon2_params params;
+            params.parallelism = target.argon2_parallelism;
+            params.memory_kib = static_cast<std::uint32_t>(kdf_memory_cap(target, concurrency, target.argon2_max_memory_kib));
+            const std::uint32_t min_memory = 8 * params.parallelism;
+            if(params.memory_kib < min_memory)
+                throw std::invalid_argument("merl::calibrate_kdf(): Invalid argument -> Argon2id memory budget below 8 KiB per lane");
+
+            auto measure = [&](std::uint32_t t)
+            {
+                params.iterations = t;
+                return kdf_probe_latency(concurrency, target.samples, probe_count, [&](std::size_t i)
+                {
+                    unsigned char out[32];
+                    argon2id(probes[i], salt, sizeof(salt), params, out);
+                    secure_zero(out, sizeof(out));
+                });
+            };
+
+            // RFC 9106 recommends spending the time on memory first, so passes only go below 1 by giving up memory
+            std::chrono::nanoseconds one = measure(1);
+            while(one > target.latency && params.memory_kib / 2 >= min_memory)
+            {
+                params.memory_kib /= 2;
+                one = measure(1);
+            }
+
+            std::uint32_t t = 1;
+            std::chrono::nanoseconds latency = one;
+            if(one < target.latency)
+            {
+                // Fixed cost (allocation, initial and final blocks) plus a per-pass cost, re-estimated from every run.
+                // A pass costs at least half of the first run: a noisy run could otherwise make passes look free.
+                auto passes_for = [&](std::uint32_t at, std::chrono::nanoseconds measured)
+                {
+                    std::chrono::nanoseconds per_pass = std::max(at > 1 ? (measured - one) / (at - 1) : one, one / 2);
+                    double passes = 1 + std::floor(static_cast<double>((target.latency - one).count()) / static_cast<double>(per_pass.count()));
+                    return static_cast<std::uint32_t>(std::clamp(passes, 1.0, 4294967295.0));
+                };
+                t = 2;
+                latency = measure(t);
+                for(int refine = 0; refine < 2; ++refine)
+                {
+                    std::uint32_t next = passes_for(t, latency);
+                    if(next == t)
+                        break;
+                    latency = measure(t = next);
+                }
+                while(t > 1 && latency > target.latency)
+                {
+                    std::uint32_t next = static_cast<std::uint32_t>(t * kdf_scale(target.latency, latency));
+                    latency = measure(t = std::clamp(next, 1u, t - 1));
+                }
+                if(t == 1)
+                    latency = one;
+            }
+
+            params.iterations = t;
+            result.argon2 = argon2_params{params.memory_kib, params.iterations, params.parallelism};
+            result.argon2_latency = kdf_us(latency);
+        }
+
+        template <typename CharT, typename Traits, typename Alloc>
+        void kdf_calibrate_scrypt(const kdf_calibration_target & target, std::uint32_t concurrency,
+                                  const basic_password<CharT, Traits, Alloc> * probes, std::size_t probe_count, kdf_calibration & result)
+        {
+            static constexpr unsigned char salt[16] = {};
+            const std::uint32_t r = target.scrypt_r, p = target.scrypt_p;
+            // Each lane's V takes 128 r N bytes, i.e. r N / 8 KiB; scrypt also requires N < 2^(16 r)
+            std::uint64_t cap_kib = kdf_memory_cap(target, concurrency, target.scrypt_max_memory_kib);
+            std::uint32_t max_log2_n = 1;
+            while(max_log2_n < std::min<std::uint32_t>(16 * r - 1, 40) && (std::uint64_t{r} * p << (max_log2_n + 1)) / 8 <= cap_kib)
+                ++max_log2_n;
+
+            auto measure = [&](std::uint32_t log2_n)
+            {
+                return kdf_probe_latency(concurrency, target.samples, probe_count, [&](std::size_t i)
+                {
+                    unsigned char out[32];
+                    scrypt(probes[i], salt, sizeof(salt), std::uint64_t{1} << log2_n, r, p, out, sizeof(out));
+                    secure_zero(out, sizeof(out));
+                });
+            };
+
+            // N only takes powers of two: extrapolate from 2^10, then step down while over the target
+            std::uint32_t log2_n = std::min<std::uint32_t>(10, max_log2_n);
+            std::chrono::nanoseconds latency = measure(log2_n);
+            double steps = std::floor(std::log2(kdf_scale(target.latency, latency)));
+            if(steps > 0)
+            {
+                log2_n = std::min<std::uint32_t>(max_log2_n, log2_n + static_cast<std::uint32_t>(steps));
+                latency = measure(log2_n);
+            }
+            while(log2_n > 1 && latency > target.latency)
+                latency = measure(--log2_n);
+
+            result.scrypt_log2_n = log2_n;
+            result.scrypt_r = r;
+            result.scrypt_p = p;
+            result.scrypt_latency = kdf_us(latency);
+        }
+
+        // --- JSON ---
+        inline void json_put(std::string & out, std::string_view key, std::uint64_t value)
+        {
+            out.append(out.size() > 1 ? ",\n  \"" : "\n  \"").append(key).append("\": ").append(std::to_string(value));
+        }
+        inline void json_put(std::string & out, std::string_view key, std::string_view value)
+        {
+            out.append(out.size() > 1 ? ",\n  \"" : "\n  \"").append(key).append("\": \"");
+            for(char c : value)
+            {
+                if(c == '"' || c == '\\')
+                    out += '\\';
+                if(static_cast<unsigned char>(c) >= 0x20)
+                    out += c;
+            }
+            out += '"';
+        }
+
+        [[noreturn]] inline void throw_invalid_calibration()
+        {
+            throw std::invalid_argument("merl::kdf_calibration_from_json(): Invalid argument -> Malformed calibration");
+        }
+
+        // Whether c holds costs calibrate_kdf() could have chosen for c.target: usable by the KDFs and within the memory caps
+        inline bool kdf_calibration_valid(const kdf_calibration & c) noexcept
+        {
+            const kdf_calibration_target & t = c.target;
+            if(t.latency.count() <= 0 || !t.samples || !c.concurrency || (t.concurrency && t.concurrency != c.concurrency))
+                return false;
+
+            if(t.argon2id)
+            {
+                const argon2_params & a = c.argon2;
+                if(a.parallelism != t.argon2_parallelism || !a.parallelism || a.parallelism > 0xffffff || !a.iterations ||
+                   a.memory_kib < 8 * std::uint64_t{a.parallelism} || a.memory_kib > kdf_memory_cap(t, c.concurrency, t.argon2_max_memory_kib))
+                    return false;
+            }
+            if((t.pbkdf2_sha256 && !c.pbkdf2_sha256_iterations) || (t.pbkdf2_sha512 && !c.pbkdf2_sha512_iterations))
+                return false;
+            if(t.scrypt)
+            {
+                if(c.scrypt_r != t.scrypt_r || c.scrypt_p != t.scrypt_p || !c.scrypt_r || !c.scrypt_p ||
+                   std::uint64_t{c.scrypt_r} * c.scrypt_p >= (1u << 30) || !c.scrypt_log2_n || c.scrypt_log2_n > std::min<std::uint64_t>(16 * std::uint64_t{c.scrypt_r} - 1, 40))
+                    return false;
+                // The smallest N is accepted over a tight cap, as calibrate_kdf() falls back to it
+                std::uint64_t rp = std::uint64_t{c.scrypt_r} * c.scrypt_p;
+                if(c.scrypt_log2_n > 1 && (rp > (~std::uint64_t{0} >> c.scrypt_log2_n) ||
+                                          (rp << c.scrypt_log2_n) / 8 > kdf_memory_cap(t, c.concurrency, t.scrypt_max_memory_kib)))
+                    return false;
+            }
+            return true;
+        }
+
+        // Reads a flat object of string and unsigned integer members, calling member(key, string, number) for each
+        template <typename Member>
+        void json_read_flat(std::string_view s, Member member)
+        {
+            std::size_t i = 0;
+            auto skip = [&]
+            {
+                while(i < s.size() && (s[i] == ' ' || s[i] == '\t' || s[i] == '\n' || s[i] == '\r'))
+                    ++i;
+            };
+            auto expect = [&](char c)
+            {
+                skip();
+                if(i >= s.size() || s[i] != c)
+                    throw_invalid_calibration();
+                ++i;
+            };
+            auto string = [&]
+            {
+                expect('"');
+                std::string v;
+                for(; i < s.size() && s[i] != '"'; ++i)
+                {
+                    if(s[i] == '\\' && ++i >= s.size())
+                        break;
+                    v += s[i];
+                }
+                expect('"');
+                return v;
+            };
+
+            expect('{');
+            skip();
+            if(i < s.size() && s[i] == '}')
+                return;
+            for(;;)
+            {
+                std::string key = string();
+                expect(':');
+                skip();
+                if(i < s.size() && s[i] == '"')
+                    member(key, string(), std::uint64_t{0});
+                else
+                {
+                    std::size_t digits = i;
+                    std::uint64_t v = 0;
+                    for(; i < s.size() && s[i] >= '0' && s[i] <= '9' && i - digits < 19; ++i)
+                        v = v * 10 + static_cast<std::uint64_t>(s[i] - '0');
+                    if(i == digits)
+                        throw_invalid_calibration();
+                    member(key, std::string(), v);
+                }
+                skip();
+                if(i < s.size() && s[i] == ',')
+                {
+                    ++i;
+                    continue;
+                }
+                expect('}');
+                return;
+            }
+        }
+    }
+
+    inline std::string kdf_calibration_to_json(const kdf_calibration & c)
+    {
+        using namespace std::chrono;
+        std::string out = "{";
+        detail::json_put(out, "format", detail::kdf_calibration_format);
+        detail::json_put(out, "machine", c.machine);
+        detail::json_put(out, "target_latency_ms", static_cast<std::uint64_t>(c.target.latency.count()));
+        detail::json_put(out, "target_concurrency", c.target.concurrency);
+        detail::json_put(out, "target_samples", c.target.samples);
+        detail::json_put(out, "target_argon2_max_memory_kib", c.target.argon2_max_memory_kib);
+        detail::json_put(out, "target_argon2_parallelism", c.target.argon2_parallelism);
+        detail::json_put(out, "target_scrypt_max_memory_kib", c.target.scrypt_max_memory_kib);
+        detail::json_put(out, "target_scrypt_r", c.target.scrypt_r);
+        detail::json_put(out, "target_scrypt_p", c.target.scrypt_p);
+        detail::json_put(out, "target_memory_budget_kib", c.target.memory_budget_kib);
+        detail::json_put(out, "target_kdfs", std::uint64_t{c.target.argon2id} | std::uint64_t{c.target.pbkdf2_sha256} << 1 |
+                                             std::uint64_t{c.target.pbkdf2_sha512} << 2 | std::uint64_t{c.target.scrypt} << 3);
+        detail::json_put(out, "concurrency", c.concurrency);
+        detail::json_put(out, "argon2id_memory_kib", c.argon2.memory_kib);
+        detail::json_put(out, "argon2id_iterations", c.argon2.iterations);
+        detail::json_put(out, "argon2id_parallelism", c.argon2.parallelism);
+        detail::json_put(out, "argon2id_latency_us", static_cast<std::uint64_t>(c.argon2_latency.count()));
+        detail::json_put(out, "pbkdf2_sha256_iterations", c.pbkdf2_sha256_iterations);
+        detail::json_put(out, "pbkdf2_sha256_latency_us", static_cast<std::uint64_t>(c.pbkdf2_sha256_latency.count()));
+        detail::json_put(out, "pbkdf2_sha512_iterations", c.pbkdf2_sha512_iterations);
+        detail::json_put(out, "pbkdf2_sha512_latency_us", static_cast<std::uint64_t>(c.pbkdf2_sha512_latency.count()));
+        detail::json_put(out, "scrypt_log2_n", c.scrypt_log2_n);
+        detail::json_put(out, "scrypt_r", c.scrypt_r);
+        detail::json_put(out, "scrypt_p", c.scrypt_p);
+        detail::json_put(out, "scrypt_latency_us", static_cast<std::uint64_t>(c.scrypt_latency.count()));
+        out += "\n}\n";
+        return out;
+    }
+
+    // Parses the output of kdf_calibration_to_json(); throws std::invalid_argument if it is malformed, of another format,
+    // or holds costs out of range for its target (a zero iteration count, a memory cost over the caps, ...)
+    inline kdf_calibration kdf_calibration_from_json(std::string_view json)
+    {
+        kdf_calibration c;
+        std::uint64_t format = 0;
+        auto u32 = [](std::uint64_t v)
+        {
+            if(v > 0xffffffff)
+                detail::throw_invalid_calibration();
+            return static_cast<std::uint32_t>(v);
+        };
+        detail::json_read_flat(json, [&](const std::string & key, std::string str, std::uint64_t v)
+        {
+            if(key == "format")
+                format = v;
+            else if(key == "machine")
+                c.machine = std::move(str);
+            else if(key == "target_latency_ms")
+                c.target.latency = std::chrono::milliseconds(static_cast<std::int64_t>(u32(v)));
+            else if(key == "target_concurrency")
+                c.target.concurrency = u32(v);
+            else if(key == "target_samples")
+                c.target.samples = u32(v);
+            else if(key == "target_argon2_max_memory_kib")
+                c.target.argon2_max_memory_kib = u32(v);
+            else if(key == "target_argon2_parallelism")
+                c.target.argon2_parallelism = u32(v);
+            else if(key == "target_scrypt_max_memory_kib")
+                c.target.scrypt_max_memory_kib = u32(v);
+            else if(key == "target_scrypt_r")
+                c.target.scrypt_r = u32(v);
+            else if(key == "target_scrypt_p")
+                c.target.scrypt_p = u32(v);
+            else if(key == "target_memory_budget_kib")
+                c.target.memory_budget_kib = v;
+            else if(key == "target_kdfs")
+            {
+                c.target.argon2id = v & 1;
+                c.target.pbkdf2_sha256 = v & 2;
+                c.target.pbkdf2_sha512 = v & 4;
+                c.target.scrypt = v & 8;
+            }
+            else if(key == "concurrency")
+                c.concurrency = u32(v);
+            else if(key == "argon2id_memory_kib")
+                c.argon2.memory_kib = u32(v);
+            else if(key == "argon2id_iterations")
+                c.argon2.iterations = u32(v);
+            else if(key == "argon2id_parallelism")
+                c.argon2.parallelism = u32(v);
+            else if(key == "argon2id_latency_us")
+                c.argon2_latency = std::chrono::microseconds(static_cast<std::int64_t>(u32(v)));
+            else if(key == "pbkdf2_sha256_iterations")
+                c.pbkdf2_sha256_iterations = u32(v);
+            else if(key == "pbkdf2_sha256_latency_us")
+                c.pbkdf2_sha256_latency = std::chrono::microseconds(static_cast<std::int64_t>(u32(v)));
+            else if(key == "pbkdf2_sha512_iterations")
+                c.pbkdf2_sha512_iterations = u32(v);
+            else if(key == "pbkdf2_sha512_latency_us")
+                c.pbkdf2_sha512_latency = std::chrono::microseconds(static_cast<std::int64_t>(u32(v)));
+            else if(key == "scrypt_log2_n")
+                c.scrypt_log2_n = u32(v);
+            else if(key == "scrypt_r")
+                c.scrypt_r = u32(v);
+            else if(key == "scrypt_p")
+                c.scrypt_p = u32(v);
+            else if(key == "scrypt_latency_us")
+                c.scrypt_latency = std::chrono::microseconds(static_cast<std::int64_t>(u32(v)));
+        });
+        if(format != detail::kdf_calibration_format || !detail::kdf_calibration_valid(c))
+            detail::throw_invalid_calibration();
+        return c;
+    }
+
+    // Times every KDF enabled in target on the probe passwords (which should look like production ones: same character
+    // type, typical lengths) and returns the highest costs that stay within the target latency
+    template <typename CharT, typename Traits, typename Alloc>
+    kdf_calibration calibrate_kdf(const kdf_calibration_target & target, const basic_password<CharT, Traits, Alloc> * probes, std::size_t probe_count)
+    {
+        if(!probes || !probe_count || !target.samples || target.latency.count() <= 0)
+            throw std::invalid_argument("merl::calibrate_kdf(): Invalid argument -> No probe, sample or latency");
+
+        kdf_calibration result;
+        result.machine = detail::kdf_machine_fingerprint();
+        result.target = target;
+        result.concurrency = target.concurrency ? target.concurrency : std::max(1u, std::thread::hardware_concurrency());
+
+        if(target.argon2id)
+            detail::kdf_calibrate_argon2(target, result.concurrency, probes, probe_count, result);
+        if(target.pbkdf2_sha256)
+            detail::kdf_calibrate_pbkdf2<detail::sha256_spec>(target, result.concurrency, probes, probe_count,
+                                                              result.pbkdf2_sha256_iterations, result.pbkdf2_sha256_latency);
+        if(target.pbkdf2_sha512)
+            detail::kdf_calibrate_pbkdf2<detail::sha512_spec>(target, result.concurrency, probes, probe_count,
+                                                              result.pbkdf2_sha512_iterations, result.pbkdf2_sha512_latency);
+        if(target.scrypt)
+            detail::kdf_calibrate_scrypt(target, result.concurrency, probes, probe_count, result);
+        return result;
+    }
+
+    // Same, on a built-in set of printable passwords of 8 to 64 characters
+    inline kdf_calibration calibrate_kdf(const kdf_calibration_target & target = {})
+    {
+        std::vector<password> probes;
+        for(std::size_t size : {8, 12, 16, 20, 32, 64})
+        {
+            password p;
+            for(std::size_t i = 0; i < size; ++i)
+                p.push_back(static_cast<char>('!' + (i * 37 + size) % 94));
+            probes.push_back(std::move(p));
+        }
+        return calibrate_kdf(target, probes.data(), probes.size());
+    }
+
+    // Loads the calibration cached at path if it is valid and was made on this machine for the same target, otherwise
+    // calibrates and rewrites the file (best effort: a cache that cannot be written does not fail the calibration)
+    template <typename CharT, typename Traits, typename Alloc>
+    kdf_calibration calibrate_kdf_cached(const std::string & path, const kdf_calibration_target & target,
+                                         const basic_password<CharT, Traits, Alloc> * probes, std::size_t probe_count)
+    {
+        if(std::ifstream in{path, std::ios::binary})
+        {
+            std::ostringstream content;
+            content << in.rdbuf();
+            try
+            {
+                kdf_calibration cached = kdf_calibration_from_json(content.str());
+                if(cached.target == target && cached.machine == detail::kdf_machine_fingerprint())
+                    return cached;
+            }
+            catch(const std::invalid_argument &)
+            {
+            }
+        }
+
+        kdf_calibration result = probes ? calibrate_kdf(target, probes, probe_count) : calibrate_kdf(target);
+        std::string tmp = path + ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            out << kdf_calibration_to_json(result);
+            if(!out.flush())
+                return result;
+        }
+        if(std::rename(tmp.c_str(), path.c_str()) != 0)
+            std::remove(tmp.c_str());
+        return result;
+    }
+    inline kdf_calibration calibrate_kdf_cached(const std::string & path, const kdf_calibration_target & target = {})
+    {
+        return calibrate_kdf_cached(path, target, static_cast<const password *>(nullptr), 0);
+    }
+}
+
+#endif // MERLIN_KDF_CALIBRATION_HPP
@@ -0,0 +1,675 @@
+#ifndef MERLIN_PASSWORD_CODECS_HPP
+#define MERLIN_PASSWORD_CODECS_HPP
+
+#include <merlin_basic_password.hpp>
+#include <merlin_detail.hpp>
+
+#include <string_view>
+
+// Hex, base32 (RFC 4648) and base64 (RFC 4648, standard alphabet) codecs that write straight into basic_password storage.
+// Every character <-> value mapping is computed arithmetically instead of through lookup tables,
+// so neither encoding nor decoding performs memory accesses that depend on the secret.
+// Invalid input is reported once the whole input has been processed, not at the first bad character.
+// The password overloads allocate the result with the input's allocator, so e.g. a secret decoded from an arena stays there.
+
+namespace merl
+{
+    namespace detail
+    {
+        // Each helper returns the 4/5/6-bit value of c, or -1 if c is not part of the alphabet.
+        // (((lo - 1 - c) & (c - hi - 1)) >> 8) is all-ones exactly when lo <= c <= hi.
+        inline int ct_hex_value(int c) noexcept
+        {
+            int r = -1;
+            r += (((0x2f - c) & (c - 0x3a)) >> 8) & (c - 47); // '0'..'9'
+            r += (((0x60 - c) & (c - 0x67)) >> 8) & (c - 86); // 'a'..'f'
+            r += (((0x40 - c) & (c - 0x47)) >> 8) & (c - 54); // 'A'..'F'
+            return r;
+        }
+        inline int ct_hex_char(int n) noexcept
+        {
+            return n + '0' + (((9 - n) >> 8) & ('a' - '0' - 10));
+        }
+
+        inline int ct_base32_value(int c) noexcept
+        {
+            int r = -1;
+            r += (((0x40 - c) & (c - 0x5b)) >> 8) & (c - 64); // 'A'..'Z'
+            r += (((0x31 - c) & (c - 0x38)) >> 8) & (c - 23); // '2'..'7'
+            return r;
+        }
+        inline int ct_base32_char(int n) noexcept
+        {
+            return n + 'A' - (((25 - n) >> 8) & ('A' - '2' + 26));
+        }
+
+        inline int ct_base64_value(int c) noexcept
+        {
+            int r = -1;
+            r += (((0x40 - c) & (c - 0x5b)) >> 8) & (c - 64); // 'A'..'Z'
+            r += (((0x60 - c) & (c - 0x7b)) >> 8) & (c - 70); // 'a'..'z'
+            r += (((0x2f - c) & (c - 0x3a)) >> 8) & (c + 5);  // '0'..'9'
+            r += (((0x2a - c) & (c - 0x2c)) >> 8) & 63;       // '+'
+            r += (((0x2e - c) & (c - 0x30)) >> 8) & 64;       // '/'
+            return r;
+        }
+        inline int ct_base64_char(int n) noexcept
+        {
+            int c = 'A' + n;
+            c += ((25 - n) >> 8) & 6;   // 26..51 -> 'a'..'z'
+            c -= ((51 - n) >> 8) & 75;  // 52..61 -> '0'..'9'
+            c -= ((61 - n) >> 8) & 15;  // 62 -> '+'
+            c += ((62 - n) >> 8) & 3;   // 63 -> '/'
+            return c;
+        }
+
+        inline unsigned char to_uchar(char c) noexcept
+        {
+            return static_cast<unsigned char>(c);
+        }
+
+        // --- Scalar kernels (also used for the tails of the SIMD kernels) ---
+        inline void hex_encode_scalar(const unsigned char * in, std::size_t n, char * out) noexcept
+        {
+            for(std::size_t i = 0; i < n; ++i)
+            {
+                out[2*i] = static_cast<char>(ct_hex_char(in[i] >> 4));
+                out[2*i + 1] = static_cast<char>(ct_hex_char(in[i] & 0x0f));
+            }
+        }
+        inline int hex_decode_scalar(const char * in, std::size_t n, unsigned char * out) noexcept
+        {
+            int err = 0;
+            for(std::size_t i = 0; i < n; ++i)
+            {
+                int hi = ct_hex_value(to_uchar(in[2*i]));
+                int lo = ct_hex_value(to_uchar(in[2*i + 1]));
+                err |= hi | lo;
+                out[i] = static_cast<unsigned char>((hi << 4) | (lo & 0x0f));
+            }
+            return err;
+        }
+
+        inline void base64_encode_scalar(const unsigned char * in, std::size_t n, char * out) noexcept
+        {
+            std::size_t i = 0;
+            for(; i + 3 <= n; i += 3, out += 4)
+            {
+                std::uint32_t v = (std::uint32_t{in[i]} << 16) | (std::uint32_t{in[i+1]} << 8) | in[i+2];
+                out[0] = static_cast<char>(ct_base64_char((v >> 18) & 0x3f));
+                out[1] = static_cast<char>(ct_base64_char((v >> 12) & 0x3f));
+                out[2] = static_cast<char>(ct_base64_char((v >> 6) & 0x3f));
+                out[3] = static_cast<char>(ct_base64_char(v & 0x3f));
+            }
+            if(n - i == 1)
+            {
+                std::uint32_t v = std::uint32_t{in[i]} << 16;
+                out[0] = static_cast<char>(ct_base64_char((v >> 18) & 0x3f));
+                out[1] = static_cast<char>(ct_base64_char((v >> 12) & 0x3f));
+                out[2] = '=';
+                out[3] = '=';
+            }
+            else if(n - i == 2)
+            {
+                std::uint32_t v = (std::uint32_t{in[i]} << 16) | (std::uint32_t{in[i+1]} << 8);
+                out[0] = static_cast<char>(ct_base64_char((v >> 18) & 0x3f));
+                out[1] = static_cast<char>(ct_base64_char((v >> 12) & 0x3f));
+                out[2] = static_cast<char>(ct_base64_char((v >> 6) & 0x3f));
+                out[3] = '=';
+            }
+        }
+        // n is the number of significant (non-padding) characters
+        inline int base64_decode_scalar(const char * in, std::size_t n, unsigned char * out) noexcept
+        {
+            int err = 0;
+            std::size_t i = 0;
+            for(; i + 4 <= n; i += 4, out += 3)
+            {
+                int a = ct_base64_value(to_uchar(in[i])), b = ct_base64_value(to_uchar(in[i+1]));
+                int c = ct_base64_value(to_uchar(in[i+2])), d = ct_base64_value(to_uchar(in[i+3]));
+                err |= a | b | c | d;
+                std::uint32_t v = (std::uint32_t(a & 0x3f) << 18) | (std::uint32_t(b & 0x3f) << 12) | (std::uint32_t(c & 0x3f) << 6) | std::uint32_t(d & 0x3f);
+                out[0] = static_cast<unsigned char>(v >> 16);
+                out[1] = static_cast<unsigned char>(v >> 8);
+                out[2] = static_cast<unsigned char>(v);
+            }
+            std::size_t rest = n - i; // 0, 2 or 3 (1 is rejected by the caller)
+            if(rest >= 2)
+            {
+                int a = ct_base64_value(to_uchar(in[i])), b = ct_base64_value(to_uchar(in[i+1]));
+                int c = rest == 3 ? ct_base64_value(to_uchar(in[i+2])) : 0;
+                err |= a | b | c;
+                std::uint32_t v = (std::uint32_t(a & 0x3f) << 18) | (std::uint32_t(b & 0x3f) << 12) | (std::uint32_t(c & 0x3f) << 6);
+                out[0] = static_cast<unsigned char>(v >> 16);
+                if(rest == 3)
+                    out[1] = static_cast<unsigned char>(v >> 8);
+            }
+            return err;
+        }
+
+        inline void base32_encode_scalar(const unsigned char * in, std::size_t n, char * out) noexcept
+        {
+            for(std::size_t i = 0; i < n; i += 5, out += 8)
+            {
+                std::size_t chunk = std::min<std::size_t>(5, n - i);
+                std::uint64_t v = 0;
+                for(std::size_t j = 0; j < 5; ++j)
+                    v = (v << 8) | (j < chunk ? in[i+j] : 0u);
+
+                // 1, 2, 3, 4 or 5 input bytes yield 2, 4, 5, 7 or 8 significant characters
+                std::size_t significant = (chunk * 8 + 4) / 5;
+                for(std::size_t j = 0; j < 8; ++j)
+                    out[j] = j < significant ? static_cast<char>(ct_base32_char(static_cast<int>((v >> (35 - 5*j)) & 0x1f))) : '=';
+            }
+        }
+        inline int base32_decode_scalar(const char * in, std::size_t n, unsigned char * out) noexcept
+        {
+            int err = 0;
+            for(std::size_t i = 0; i < n; i += 8)
+            {
+                std::size_t chunk = std::min<std::size_t>(8, n - i);
+                std::uint64_t v = 0;
+                for(std::size_t j = 0; j < 8; ++j)
+                {
+                    int x = j < chunk ? ct_base32_value(to_uchar(in[i+j])) : 0;
+                    err |= x;
+                    v = (v << 5) | static_cast<std::uint64_t>(x & 0x1f);
+                }
+
+                std::size_t bytes = chunk * 5 / 8;
+                for(std::size_t j = 0; j < bytes; ++j)
+                    *out++ = static_cast<unsigned char>(v >> (32 - 8*j));
+            }
+            return err;
+        }
+
+#if MERLIN_X86_SIMD
+        // --- SSE4.1 kernels ---
+        // All kernels process whole blocks only and return the number of input units consumed;
+        // the scalar kernels finish the remainder.
+        MERLIN_TARGET("sse4.1")
+        inline std::size_t hex_encode_sse41(const unsigned char * in, std::size_t n, char * out) noexcept
+        {
+            const __m128i mask = _mm_set1_epi8(0x0f);
+            const __m128i nine = _mm_set1_epi8(9);
+            const __m128i ascii_0 = _mm_set1_epi8('0');
+            const __m128i letter_shift = _mm_set1_epi8('a' - '0' - 10);
+
+            std::size_t i = 0;
+            for(; i + 16 <= n; i += 16)
+            {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+                __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), mask);
+                __m128i lo = _mm_and_si128(v, mask);
+                hi = _mm_add_epi8(_mm_add_epi8(hi, ascii_0), _mm_and_si128(_mm_cmpgt_epi8(hi, nine), letter_shift));
+                lo = _mm_add_epi8(_mm_add_epi8(lo, ascii_0), _mm_and_si128(_mm_cmpgt_epi8(lo, nine), letter_shift));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 2*i), _mm_unpacklo_epi8(hi, lo));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 2*i + 16), _mm_unpackhi_epi8(hi, lo));
+            }
+            return i;
+        }
+        // Maps 16 characters to their nibble values; invalid characters set bits in err
+        MERLIN_TARGET("sse4.1")
+        inline __m128i hex_values_sse41(__m128i v, __m128i & err) noexcept
+        {
+            __m128i d = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+            __m128i l = _mm_sub_epi8(_mm_or_si128(v, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+            __m128i is_d = _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(9)), d);
+            __m128i is_l = _mm_cmpeq_epi8(_mm_min_epu8(l, _mm_set1_epi8(5)), l);
+            err = _mm_or_si128(err, _mm_andnot_si128(_mm_or_si128(is_d, is_l), _mm_set1_epi8(-1)));
+            return _mm_or_si128(_mm_and_si128(is_d, d), _mm_and_si128(is_l, _mm_add_epi8(l, _mm_set1_epi8(10))));
+        }
+        MERLIN_TARGET("sse4.1")
+        inline std::size_t hex_decode_sse41(const char * in, std::size_t n, unsigned char * out, int & error) noexcept
+        {
+            const __m128i weights = _mm_set1_epi16(0x0110); // high nibble * 16 + low nibble
+            __m128i err = _mm_setzero_si128();
+
+            std::size_t i = 0;
+            for(; i + 16 <= n; i += 16)
+            {
+                __m128i a = hex_values_sse41(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 2*i)), err);
+                __m128i b = hex_values_sse41(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 2*i + 16)), err);
+                __m128i packed = _mm_packus_epi16(_mm_maddubs_epi16(a, weights), _mm_maddubs_epi16(b, weights));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), packed);
+            }
+            error |= -!_mm_testz_si128(err, err);
+            return i;
+        }
+
+        // Base64 encoding after W. Mula and D. Lemire, "Faster Base64 Encoding and Decoding using AVX2 Instructions"
+        MERLIN_TARGET("sse4.1")
+        inline __m128i base64_encode_block_sse41(__m128i in) noexcept
+        {
+            in = _mm_shuffle_epi8(in, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+            const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+            const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+            const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+            const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+            const __m128i indices = _mm_or_si128(t1, t3);
+
+            // The ASCII offset of each index is selected in-register, without touching memory
+            __m128i result = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+            const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+            result = _mm_or_si128(result, _mm_and_si128(less, _mm_set1_epi8(13)));
+            const __m128i shift_lut = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                    '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+            result = _mm_shuffle_epi8(shift_lut, result);
+            return _mm_add_epi8(result, indices);
+        }
+        MERLIN_TARGET("sse4.1")
+        inline std::size_t base64_encode_sse41(const unsigned char * in, std::size_t n, char * out) noexcept
+        {
+            std::size_t i = 0;
+            for(; i + 16 <= n; i += 12, out += 16) // 16-byte loads of which 12 bytes are consumed
+            {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out), base64_encode_block_sse41(v));
+            }
+            return i;
+        }
+
+        // Maps 16 base64 characters to their 6-bit values; invalid characters set bits in err
+        MERLIN_TARGET("sse4.1")
+        inline __m128i base64_values_sse41(__m128i str, __m128i & err) noexcept
+        {
+            const __m128i lut_lo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+            const __m128i lut_hi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+            const __m128i lut_roll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+            const __m128i mask_2f = _mm_set1_epi8(0x2f);
+
+            const __m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(str, 4), mask_2f);
+            const __m128i lo_nibbles = _mm_and_si128(str, mask_2f);
+            const __m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+            const __m128i lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+            const __m128i eq_2f = _mm_cmpeq_epi8(str, mask_2f);
+            const __m128i roll = _mm_shuffle_epi8(lut_roll, _mm_add_epi8(eq_2f, hi_nibbles));
+
+            err = _mm_or_si128(err, _mm_and_si128(lo, hi));
+            return _mm_add_epi8(str, roll);
+        }
+        MERLIN_TARGET("sse4.1")
+        inline __m128i base64_pack_sse41(__m128i values) noexcept
+        {
+            const __m128i merge_ab_bc = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+            const __m128i merged = _mm_madd_epi16(merge_ab_bc, _mm_set1_epi32(0x00011000));
+            return _mm_shuffle_epi8(merged, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        }
+        MERLIN_TARGET("sse4.1")
+        inline std::size_t base64_decode_sse41(const char * in, std::size_t n, unsigned char * out, int & error) noexcept
+        {
+            __m128i err = _mm_setzero_si128();
+
+            // Each block writes 16 bytes of which 12 are significant: keep one block of slack in the output
+            std::size_t i = 0;
+            for(; i + 32 <= n; i += 16, out += 12)
+            {
+                __m128i v = base64_values_sse41(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i)), err);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out), base64_pack_sse41(v));
+            }
+            error |= -!_mm_testz_si128(err, err);
+            return i;
+        }
+
+        // --- AVX2 kernels ---
+        MERLIN_TARGET("avx2")
+        inline std::size_t hex_encode_avx2(const unsigned char * in, std::size_t n, char * out) noexcept
+        {
+            const __m256i mask = _mm256_set1_epi8(0x0f);
+            const __m256i nine = _mm256_set1_epi8(9);
+            const __m256i ascii_0 = _mm256_set1_epi8('0');
+            const __m256i letter_shift = _mm256_set1_epi8('a' - '0' - 10);
+
+            std::size_t i = 0;
+            for(; i + 32 <= n; i += 32)
+            {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+                __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), mask);
+                __m256i lo = _mm256_and_si256(v, mask);
+                hi = _mm256_add_epi8(_mm256_add_epi8(hi, ascii_0), _mm256_and_si256(_mm256_cmpgt_epi8(hi, nine), letter_shift));
+                lo = _mm256_add_epi8(_mm256_add_epi8(lo, ascii_0), _mm256_and_si256(_mm256_cmpgt_epi8(lo, nine), letter_shift));
+                __m256i a = _mm256_unpacklo_epi8(hi, lo); // bytes 0-7 | 16-23
+                __m256i b = _mm256_unpackhi_epi8(hi, lo); // bytes 8-15 | 24-31
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + 2*i), _mm256_permute2x128_si256(a, b, 0x20));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + 2*i + 32), _mm256_permute2x128_si256(a, b, 0x31));
+            }
+            return i;
+        }
+        MERLIN_TARGET("avx2")
+        inline __m256i hex_values_avx2(__m256i v, __m256i & err) noexcept
+        {
+            __m256i d = _mm256_sub_epi8(v, _mm256_set1_epi8('0'));
+            __m256i l = _mm256_sub_epi8(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+            __m256i is_d = _mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(9)), d);
+            __m256i is_l = _mm256_cmpeq_epi8(_mm256_min_epu8(l, _mm256_set1_epi8(5)), l);
+            err = _mm256_or_si256(err, _mm256_andnot_si256(_mm256_or_si256(is_d, is_l), _mm256_set1_epi8(-1)));
+            return _mm256_or_si256(_mm256_and_si256(is_d, d), _mm256_and_si256(is_l, _mm256_add_epi8(l, _mm256_set1_epi8(10))));
+        }
+        MERLIN_TARGET("avx2")
+        inline std::size_t hex_decode_avx2(const char * in, std::size_t n, unsigned char * out, int & error) noexcept
+        {
+            const __m256i weights = _mm256_set1_epi16(0x0110);
+            __m256i err = _mm256_setzero_si256();
+
+            std::size_t i = 0;
+            for(; i + 32 <= n; i += 32)
+            {
+                __m256i a = hex_values_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + 2*i)), err);
+                __m256i b = hex_values_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + 2*i + 32)), err);
+                __m256i packed = _mm256_packus_epi16(_mm256_maddubs_epi16(a, weights), _mm256_maddubs_epi16(b, weights));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_permute4x64_epi64(packed, 0xd8));
+            }
+            error |= -!_mm256_testz_si256(err, err);
+            return i;
+        }
+
+        MERLIN_TARGET("avx2")
+        inline std::size_t base64_encode_avx2(const unsigned char * in, std::size_t n, char * out) noexcept
+        {
+            std::size_t i = 0;
+            for(; i + 28 <= n; i += 24, out += 32) // two 16-byte loads at +0 and +12, 24 bytes consumed
+            {
+                __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+                __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i + 12));
+                __m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+
+                v = _mm256_shuffle_epi8(v, _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                                                            1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+                const __m256i t0 = _mm256_and_si256(v, _mm256_set1_epi32(0x0fc0fc00));
+                const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+                const __m256i t2 = _mm256_and_si256(v, _mm256_set1_epi32(0x003f03f0));
+                const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+                const __m256i indices = _mm256_or_si256(t1, t3);
+
+                __m256i result = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+                const __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+                result = _mm256_or_si256(result, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+                const __m256i shift_lut = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                           '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+                                                           'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                           '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+                result = _mm256_add_epi8(_mm256_shuffle_epi8(shift_lut, result), indices);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), result);
+            }
+            return i;
+        }
+        MERLIN_TARGET("avx2")
+        inline std::size_t base64_decode_avx2(const char * in, std::size_t n, unsigned char * out, int & error) noexcept
+        {
+            const __m256i lut_lo = _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a,
+                                                    0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+            const __m256i lut_hi = _mm256_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                                                    0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+            const __m256i lut_roll = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+                                                      0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+            const __m256i mask_2f = _mm256_set1_epi8(0x2f);
+            __m256i err = _mm256_setzero_si256();
+
+            // Each block writes 32 bytes of which 24 are significant: keep one block of slack in the output
+            std::size_t i = 0;
+            for(; i + 64 <= n; i += 32, out += 24)
+            {
+                const __m256i str = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+                const __m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(str, 4), mask_2f);
+                const __m256i lo_nibbles = _mm256_and_si256(str, mask_2f);
+                const __m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+                const __m256i lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+                const __m256i eq_2f = _mm256_cmpeq_epi8(str, mask_2f);
+                const __m256i roll = _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(eq_2f, hi_nibbles));
+                err = _mm256_or_si256(err, _mm256_and_si256(lo, hi));
+                const __m256i values = _mm256_add_epi8(str, roll);
+
+                const __m256i merge_ab_bc = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+                __m256i merged = _mm256_madd_epi16(merge_ab_bc, _mm256_set1_epi32(0x00011000));
+                merged = _mm256_shuffle_epi8(merged, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                                                      2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+                merged = _mm256_permutevar8x32_epi32(merged, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), merged);
+            }
+            error |= -!_mm256_testz_si256(err, err);
+            return i;
+        }
+#endif
+
+        inline void hex_encode(const unsigned char * in, std::size_t n, char * out) noexcept
+        {
+            std::size_t done = 0;
+#if MERLIN_X86_SIMD
+            if(cpu().avx2)
+                done = hex_encode_avx2(in, n, out);
+            else if(cpu().sse41)
+                done = hex_encode_sse41(in, n, out);
+#endif
+            hex_encode_scalar(in + done, n - done, out + 2*done);
+        }
+        inline int hex_decode(const char * in, std::size_t n, unsigned char * out) noexcept
+        {
+            int err = 0;
+            std::size_t done = 0;
+#if MERLIN_X86_SIMD
+            if(cpu().avx2)
+                done = hex_decode_avx2(in, n, out, err);
+            else if(cpu().sse41)
+                done = hex_decode_sse41(in, n, out, err);
+#endif
+            return err | hex_decode_scalar(in + 2*done, n - done, out + done);
+        }
+        inline void base64_encode(const unsigned char * in, std::size_t n, char * out) noexcept
+        {
+            std::size_t done = 0;
+#if MERLIN_X86_SIMD
+            if(cpu().avx2)
+                done = base64_encode_avx2(in, n, out);
+            else if(cpu().sse41)
+                done = base64_encode_sse41(in, n, out);
+#endif
+            base64_encode_scalar(in + done, n - done, out + done / 3 * 4);
+        }
+        inline int base64_decode(const char * in, std::size_t n, unsigned char * out) noexcept
+        {
+            int err = 0;
+            std::size_t done = 0;
+#if MERLIN_X86_SIMD
+            if(cpu().avx2)
+                done = base64_decode_avx2(in, n, out, err);
+            else if(cpu().sse41)
+                done = base64_decode_sse41(in, n, out, err);
+#endif
+            return err | base64_decode_scalar(in + done, n - done, out + done / 4 * 3);
+        }
+
+        // Fields of PHC strings ($id$param=value,...$salt$hash): unpadded base64 and decimal numbers
+        inline char * phc_put(char * p, std::string_view s) noexcept
+        {
+            std::memcpy(p, s.data(), s.size());
+            return p + s.size();
+        }
+        inline char * phc_put_number(char * p, std::uint32_t v) noexcept
+        {
+            char digits[10];
+            int n = 0;
+            do
+            {
+                digits[n++] = static_cast<char>('0' + v % 10);
+                v /= 10;
+            }
+            while(v);
+            while(n)
+                *p++ = digits[--n];
+            return p;
+        }
+        // n is at most 64
+        inline char * phc_put_base64(char * p, const unsigned char * data, std::size_t n) noexcept
+        {
+            char padded[88];
+            base64_encode(data, n, padded);
+            std::size_t length = (4 * n + 2) / 3;
+            std::memcpy(p, padded, length);
+            return p + length;
+        }
+
+        inline bool phc_take(std::string_view & s, std::string_view prefix) noexcept
+        {
+            if(s.substr(0, prefix.size()) != prefix)
+                return false;
+            s.remove_prefix(prefix.size());
+            return true;
+        }
+        inline bool phc_take_number(std::string_view & s, std::uint32_t & v) noexcept
+        {
+            std::uint64_t n = 0;
+            std::size_t i = 0;
+            for(; i < s.size() && i < 10 && s[i] >= '0' && s[i] <= '9'; ++i)
+                n = n * 10 + static_cast<std::uint64_t>(s[i] - '0');
+            // Decimal values without leading zeros, as the PHC format requires
+            if(!i || n > 0xffffffffu || (s[0] == '0' && i > 1))
+                return false;
+            v = static_cast<std::uint32_t>(n);
+            s.remove_prefix(i);
+            return true;
+        }
+        inline bool phc_take_base64(std::string_view & s, unsigned char * out, std::size_t max, std::size_t & size) noexcept
+        {
+            std::size_t n = std::min(s.find('$'), s.size());
+            std::size_t decoded = n / 4 * 3 + (n % 4 ? n % 4 - 1 : 0);
+            if(!n || n % 4 == 1 || decoded > max || base64_decode(s.data(), n, out) < 0)
+                return false;
+            size = decoded;
+            s.remove_prefix(n);
+            return true;
+        }
+
+        template <typename Traits, typename Alloc>
+        basic_password<char, Traits, Alloc> make_password_buffer(std::size_t size, const Alloc & alloc)
+        {
+            return basic_password<char, Traits, Alloc>(size, '\0', alloc);
+        }
+
+        [[noreturn]] inline void throw_invalid_encoding(const char * function, const char * what)
+        {
+            throw std::invalid_argument(std::string("merl::") + function + "(): Invalid argument -> " + what);
+        }
+    }
+
+    // --- Hex ---
+    template <typename Traits = std::char_traits<char>, typename Alloc = std::allocator<char>>
+    basic_password<char, Traits, Alloc> hex_encode(const char * p, std::size_t count, const Alloc & alloc = Alloc())
+    {
+        if(count > (std::numeric_limits<std::size_t>::max() - 1) / 2)
+            throw std::length_error("merl::hex_encode(): Length error -> Maximum size exceeded");
+
+        auto result = detail::make_password_buffer<Traits>(2 * count, alloc);
+        detail::hex_encode(reinterpret_cast<const unsigned char *>(p), count, result.data());
+        return result;
+    }
+    template <typename Traits, typename Alloc>
+    basic_password<char, Traits, Alloc> hex_encode(const basic_password<char, Traits, Alloc> & p)
+    {
+        return hex_encode<Traits>(p.data(), p.size(), p.get_allocator());
+    }
+
+    template <typename Traits = std::char_traits<char>, typename Alloc = std::allocator<char>>
+    basic_password<char, Traits, Alloc> hex_decode(const char * p, std::size_t count, const Alloc & alloc = Alloc())
+    {
+        if(count % 2)
+            detail::throw_invalid_encoding("hex_decode", "Odd number of hex digits");
+
+        auto result = detail::make_password_buffer<Traits>(count / 2, alloc);
+        if(detail::hex_decode(p, count / 2, reinterpret_cast<unsigned char *>(result.data())) < 0)
+            detail::throw_invalid_encoding("hex_decode", "Invalid hex digit");
+        return result;
+    }
+    template <typename Traits, typename Alloc>
+    basic_password<char, Traits, Alloc> hex_decode(const basic_password<char, Traits, Alloc> & p)
+    {
+        return hex_decode<Traits>(p.data(), p.size(), p.get_allocator());
+    }
+
+    // --- Base32 ---
+    template <typename Traits = std::char_traits<char>, typename Alloc = std::allocator<char>>
+    basic_password<char, Traits, Alloc> base32_encode(const char * p, std::size_t count, const Alloc & alloc = Alloc())
+    {
+        if(count / 5 > (std::numeric_limits<std::size_t>::max() - 9) / 8)
+            throw std::length_error("merl::base32_encode(): Length error -> Maximum size exceeded");
+
+        auto result = detail::make_password_buffer<Traits>((count + 4) / 5 * 8, alloc);
+        detail::base32_encode_scalar(reinterpret_cast<const unsigned char *>(p), count, result.data());
+        return result;
+    }
+    template <typename Traits, typename Alloc>
+    basic_password<char, Traits, Alloc> base32_encode(const basic_password<char, Traits, Alloc> & p)
+    {
+        return base32_encode<Traits>(p.data(), p.size(), p.get_allocator());
+    }
+
+    // Padding is optional; characters must be upper case (RFC 4648 section 6)
+    template <typename Traits = std::char_traits<char>, typename Alloc = std::allocator<char>>
+    basic_password<char, Traits, Alloc> base32_decode(const char * p, std::size_t count, const Alloc & alloc = Alloc())
+    {
+        if(count % 8 == 0)
+        {
+            std::size_t pad = 0;
+            while(pad < 6 && pad < count && p[count - 1 - pad] == '=')
+                ++pad;
+            count -= pad;
+        }
+        std::size_t rest = count % 8;
+        if(rest == 1 || rest == 3 || rest == 6)
+            detail::throw_invalid_encoding("base32_decode", "Invalid length");
+
+        auto result = detail::make_password_buffer<Traits>(count / 8 * 5 + rest * 5 / 8, alloc);
+        if(detail::base32_decode_scalar(p, count, reinterpret_cast<unsigned char *>(result.data())) < 0)
+            detail::throw_invalid_encoding("base32_decode", "Invalid base32 character");
+        return result;
+    }
+    template <typename Traits, typename Alloc>
+    basic_password<char, Traits, Alloc> base32_decode(const basic_password<char, Traits, Alloc> & p)
+    {
+        return base32_decode<Traits>(p.data(), p.size(), p.get_allocator());
+    }
+
+    // --- Base64 ---
+    template <typename Traits = std::char_traits<char>, typename Alloc = std::allocator<char>>
+    basic_password<char, Traits, Alloc> base64_encode(const char * p, std::size_t count, const Alloc & alloc = Alloc())
+    {
+        if(count / 3 > (std::numeric_limits<std::size_t>::max() - 5) / 4)
+            throw std::length_error("merl::base64_encode(): Length error -> Maximum size exceeded");
+
+        auto result = detail::make_password_buffer<Traits>((count + 2) / 3 * 4, alloc);
+        detail::base64_encode(reinterpret_cast<const unsigned char *>(p), count, result.data());
+        return result;
+    }
+    template <typename Traits, typename Alloc>
+    basic_password<char, Traits, Alloc> base64_encode(const basic_password<char, Traits, Alloc> & p)
+    {
+        return base64_encode<Traits>(p.data(), p.size(), p.get_allocator());
+    }
+
+    // Padding is optional
+    template <typename Traits = std::char_traits<char>, typename Alloc = std::allocator<char>>
+    basic_password<char, Traits, Alloc> base64_decode(const char * p, std::size_t count, const Alloc & alloc = Alloc())
+    {
+        if(count % 4 == 0)
+        {
+            std::size_t pad = 0;
+            while(pad < 2 && pad < count && p[count - 1 - pad] == '=')
+                ++pad;
+            count -= pad;
+        }
+        std::size_t rest = count % 4;
+        if(rest == 1)
+            detail::throw_invalid_encoding("base64_decode", "Invalid length");
+
+        auto result = detail::make_password_buffer<Traits>(count / 4 * 3 + (rest ? rest - 1 : 0), alloc);
+        if(detail::base64_decode(p, count, reinterpret_cast<unsigned char *>(result.data())) < 0)
+            detail::throw_invalid_encoding("base64_decode", "Invalid base64 character");
+        return result;
+    }
+    template <typename Traits, typename Alloc>
+    basic_password<char, Traits, Alloc> base64_decode(const basic_password<char, Traits, Alloc> & p)
+    {
+        return base64_decode<Traits>(p.data(), p.size(), p.get_allocator());
+    }
+}
+
+#endif // MERLIN_PASSWORD_CODECS_HPP
@@ -0,0 +1,183 @@
+#ifndef MERLIN_PASSWORD_FORMAT_HPP
+#define MERLIN_PASSWORD_FORMAT_HPP
+
+#include <merlin_basic_password.hpp>
+#include <merlin_detail.hpp>
+#include <merlin_siphash.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+
+// Redacted rendering of basic_password for logs, which never prints the secret itself.
+// basic_redaction_format<CharT> parses a format spec (the text between ':' and '}' in a format string) and writes the
+// redacted form through an output iterator:
+//     {} or {:r}  [REDACTED]
+//     {:l}        [REDACTED len=12]
+//     {:tN}       [REDACTED ...xyz] (the last N characters, only if at least twice as many are hidden;
+//                 otherwise falls back to [REDACTED])
+//     {:f}        [REDACTED fp=0123456789abcdef] (SipHash-2-4 of the password under the fingerprint key)
+// Everything is written straight to the output iterator: formatting never allocates.
+// A std::formatter (or fmt::formatter) forwards its parse() and format() to these; none ships here until one has been
+// built against a standard library that provides <format>.
+
+namespace merl
+{
+    namespace detail
+    {
+        struct fingerprint_key_state
+        {
+            std::mutex mutex;
+            siphash_key key = siphash_key::random();
+        };
+
+        // Guarded by its mutex, so set_fingerprint_key() may run while other threads format
+        inline fingerprint_key_state & fingerprint_key_storage()
+        {
+            static fingerprint_key_state state;
+            return state;
+        }
+        inline siphash_key fingerprint_key()
+        {
+            fingerprint_key_state & state = fingerprint_key_storage();
+            std::lock_guard lock(state.mutex);
+            return state.key;
+        }
+    }
+
+    // The fingerprint key defaults to a per-process random key, which makes fingerprints comparable within one process only.
+    // Services that correlate fingerprints across processes share a key through this function. It may be called at any
+    // time, also to rotate the key: each fingerprint is computed under either the old key or the new one.
+    inline void set_fingerprint_key(const siphash_key & key)
+    {
+        detail::fingerprint_key_state & state = detail::fingerprint_key_storage();
+        std::lock_guard lock(state.mutex);
+        state.key = key;
+    }
+
+    template <typename CharT, typename Traits, typename Alloc>
+    std::uint64_t fingerprint(const basic_password<CharT, Traits, Alloc> & p)
+    {
+        siphash_key key = detail::fingerprint_key();
+        std::uint64_t fp = siphash24(key, p.data(), p.size() * sizeof(CharT));
+        detail::secure_zero(&key, sizeof(key));
+        return fp;
+    }
+
+    template <typename CharT>
+    class basic_redaction_format
+    {
+        private:
+            enum class mode { redacted, length, tail, fingerprint };
+
+            mode mode_ = mode::redacted;
+            std::size_t tail_ = 0;
+
+            template <typename OutputIt>
+            static OutputIt put(OutputIt out, const char * s)
+            {
+                while(*s)
+                    *out++ = static_cast<CharT>(*s++);
+                return out;
+            }
+            template <typename OutputIt>
+            static OutputIt put_decimal(OutputIt out, std::size_t n)
+            {
+                char digits[std::numeric_limits<std::size_t>::digits10 + 1];
+                int count = 0;
+                do
+                {
+                    digits[count++] = static_cast<char>('0' + n % 10);
+                    n /= 10;
+                }
+                while(n);
+
+                while(count)
+                    *out++ = static_cast<CharT>(digits[--count]);
+                return out;
+            }
+
+        public:
+            // Reads a spec from first up to last or the closing '}', and returns where it stopped;
+            // throws std::invalid_argument on anything else
+            template <typename It>
+            constexpr It parse(It first, It last)
+            {
+                It it = first;
+                if(it == last || *it == CharT('}'))
+                    return it;
+
+                // Compared as CharT: narrowing first would let e.g. U+0172 pass for 'r'
+                switch(*it++)
+                {
+                    case CharT('r'):
+                        mode_ = mode::redacted;
+                        break;
+                    case CharT('l'):
+                        mode_ = mode::length;
+                        break;
+                    case CharT('f'):
+                        mode_ = mode::fingerprint;
+                        break;
+                    case CharT('t'):
+                        mode_ = mode::tail;
+                        if(it == last || *it < CharT('0') || *it > CharT('9'))
+                            throw std::invalid_argument("merl::basic_redaction_format::parse(): Invalid argument -> Expected a character count after 't'");
+                        for(; it != last && *it >= CharT('0') && *it <= CharT('9'); ++it)
+                        {
+                            tail_ = tail_ * 10 + static_cast<std::size_t>(*it - CharT('0'));
+                            if(tail_ > 64)
+                                throw std::invalid_argument("merl::basic_redaction_format::parse(): Invalid argument -> Character count too large (max 64)");
+                        }
+                        break;
+                    default:
+                        throw std::invalid_argument("merl::basic_redaction_format::parse(): Invalid argument -> Invalid format specification");
+                }
+
+                if(it != last && *it != CharT('}'))
+                    throw std::invalid_argument("merl::basic_redaction_format::parse(): Invalid argument -> Invalid format specification");
+                return it;
+            }
+
+            template <typename OutputIt, typename Traits, typename Alloc>
+            OutputIt format(OutputIt out, const basic_password<CharT, Traits, Alloc> & p) const
+            {
+                out = put(out, "[REDACTED");
+
+                switch(mode_)
+                {
+                    case mode::redacted:
+                        break;
+                    case mode::length:
+                        out = put(out, " len=");
+                        out = put_decimal(out, p.size());
+                        break;
+                    case mode::tail:
+                        if(tail_ && p.size() >= 3 * tail_)
+                        {
+                            out = put(out, " ...");
+                            for(std::size_t i = p.size() - tail_; i < p.size(); ++i)
+                                *out++ = p[i];
+                        }
+                        break;
+                    case mode::fingerprint:
+                    {
+                        std::uint64_t fp = merl::fingerprint(p);
+                        out = put(out, " fp=");
+                        for(int shift = 60; shift >= 0; shift -= 4)
+                            *out++ = static_cast<CharT>("0123456789abcdef"[(fp >> shift) & 0xf]);
+                        break;
+                    }
+                }
+
+                *out++ = CharT(']');
+                return out;
+            }
+    };
+
+    using redaction_format = basic_redaction_format<char>;
+    using wredaction_format = basic_redaction_format<wchar_t>;
+}
+
+#endif // MERLIN_PASSWORD_FORMAT_HPP
@@ -0,0 +1,135 @@
+#ifndef MERLIN_PASSWORD_HASH_HPP
+#define MERLIN_PASSWORD_HASH_HPP
+
+#include <merlin_basic_password.hpp>
+#include <merlin_detail.hpp>
+#include <merlin_siphash.hpp>
+
+#include <functional>
+#include <string>
+#include <string_view>
+
+// std::hash specialization for basic_password, so passwords can be used as unordered_map / unordered_set keys.
+// Hashes are SipHash-1-3 (HalfSipHash-1-3 where std::size_t is 32 bits) of the characters, in place,
+// under a key drawn at random once per process: inputs crafted to collide (hash flooding) cannot be precomputed.
+// Lookups by basic_password_view, std::basic_string_view or const CharT * hash identically; pair with merl::password_equal
+// to look up without constructing a basic_password. merl::password_hasher is the same hash as a transparent functor
+// over any of these (and std::basic_string), for tables keyed by something other than basic_password.
+
+namespace merl
+{
+    namespace detail
+    {
+        inline const siphash_key & hash_key()
+        {
+            static const siphash_key key = siphash_key::random();
+            return key;
+        }
+
+        inline std::size_t hash_bytes(const void * data, std::size_t n) noexcept
+        {
+            if constexpr(sizeof(std::size_t) >= 8)
+                return static_cast<std::size_t>(siphash<1, 3>(hash_key(), data, n));
+            else
+                return static_cast<std::size_t>(halfsiphash<1, 3>(hash_key(), data, n));
+        }
+    }
+
+    // Transparent equality for basic_password keys, comparing in constant time for equal lengths
+    struct password_equal
+    {
+        using is_transparent = void;
+
+        template <typename L, typename R>
+        bool operator()(const L & lhs, const R & rhs) const noexcept
+        {
+            auto l = view(lhs);
+            auto r = view(rhs);
+            return l.size() == r.size() && detail::ct_equal(l.data(), r.data(), l.size() * sizeof(typename decltype(l)::value_type));
+        }
+
+        private:
+            template <typename CharT, typename Traits, typename Alloc>
+            static std::basic_string_view<CharT, Traits> view(const basic_password<CharT, Traits, Alloc> & p) noexcept
+            {
+                return {p.data(), p.size()};
+            }
+            template <typename CharT, typename Traits>
+            static std::basic_string_view<CharT, Traits> view(basic_password_view<CharT, Traits> v) noexcept
+            {
+                return {v.data(), v.size()};
+            }
+            template <typename CharT, typename Traits>
+            static std::basic_string_view<CharT, Traits> view(std::basic_string_view<CharT, Traits> sv) noexcept
+            {
+                return sv;
+            }
+            template <typename CharT, typename Traits, typename Alloc>
+            static std::basic_string_view<CharT, Traits> view(const std::basic_string<CharT, Traits, Alloc> & s) noexcept
+            {
+                return s;
+            }
+            template <typename CharT>
+            static std::basic_string_view<CharT> view(const CharT * p) noexcept
+            {
+                return p;
+            }
+    };
+
+    // Transparent hash of a character sequence under the per-process key, identical to std::hash<basic_password>
+    struct password_hasher
+    {
+        using is_transparent = void;
+
+        template <typename CharT, typename Traits, typename Alloc>
+        std::size_t operator()(const basic_password<CharT, Traits, Alloc> & p) const noexcept
+        {
+            return detail::hash_bytes(p.data(), p.size() * sizeof(CharT));
+        }
+        template <typename CharT, typename Traits>
+        std::size_t operator()(basic_password_view<CharT, Traits> v) const noexcept
+        {
+            return detail::hash_bytes(v.data(), v.size() * sizeof(CharT));
+        }
+        template <typename CharT, typename Traits>
+        std::size_t operator()(std::basic_string_view<CharT, Traits> sv) const noexcept
+        {
+            return detail::hash_bytes(sv.data(), sv.size() * sizeof(CharT));
+        }
+        template <typename CharT, typename Traits, typename Alloc>
+        std::size_t operator()(const std::basic_string<CharT, Traits, Alloc> & s) const noexcept
+        {
+            return detail::hash_bytes(s.data(), s.size() * sizeof(CharT));
+        }
+        template <typename CharT>
+        std::size_t operator()(const CharT * p) const noexcept
+        {
+            return (*this)(std::basic_string_view<CharT>(p));
+        }
+    };
+}
+
+template <typename CharT, typename Traits, typename Alloc>
+struct std::hash<merl::basic_password<CharT, Traits, Alloc>>
+{
+    using is_transparent = void;
+
+    std::size_t operator()(const merl::basic_password<CharT, Traits, Alloc> & p) const noexcept
+    {
+        return merl::detail::hash_bytes(p.data(), p.size() * sizeof(CharT));
+    }
+    std::size_t operator()(merl::basic_password_view<CharT, Traits> v) const noexcept
+    {
+        return merl::detail::hash_bytes(v.data(), v.size() * sizeof(CharT));
+    }
+    std::size_t operator()(std::basic_string_view<CharT, Traits> sv) const noexcept
+    {
+        return merl::detail::hash_bytes(sv.data(), sv.size() * sizeof(CharT));
+    }
+    std::size_t operator()(const CharT * p) const noexcept
+    {
+        return (*this)(std::basic_string_view<CharT, Traits>(p));
+    }
+};
+
+#endif // MERLIN_PASSWORD_HASH_HPP
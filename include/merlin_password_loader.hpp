@@ -0,0 +1,472 @@
+#ifndef MERLIN_PASSWORD_LOADER_HPP
+#define MERLIN_PASSWORD_LOADER_HPP
+
+#include <merlin_basic_password.hpp>
+
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+    #define MERLIN_HAS_IO_URING 1
+    #include <atomic>
+    #include <linux/io_uring.h>
+    #include <sys/mman.h>
+    #include <sys/syscall.h>
+#else
+    #define MERLIN_HAS_IO_URING 0
+#endif
+
+// Bulk loading of secret files (whole file content, like operator>>) straight into basic_password buffers.
+// On Linux the files are processed in batches through an io_uring: one submission for the opens of a batch,
+// one for its reads (into pre-reserved buffers, trimmed afterwards) and one for its closes.
+// Elsewhere, or when io_uring is unavailable (old kernel, seccomp policy...), the files are read with open/pread.
+// The ring is only used if the kernel reports OPENAT, READ and CLOSE as supported (5.6+); a ring that rejects
+// them anyway (-EINVAL, -EOPNOTSUPP) or fails mid-batch is dropped, and the remaining files go through pread.
+
+namespace merl
+{
+    template <typename Traits = std::char_traits<char>>
+    struct loaded_password
+    {
+        basic_password<char, Traits> password;
+        std::error_code error; // set if the file could not be read, password is empty then
+    };
+
+    namespace detail
+    {
+        template <typename Traits>
+        void set_load_error(loaded_password<Traits> & result, int err)
+        {
+            result.password.clear();
+            result.error = std::error_code(err, std::system_category());
+        }
+
+        // Reads a whole file with blocking calls
+        template <typename Traits>
+        void load_password_file_blocking(const std::string & path, loaded_password<Traits> & result)
+        {
+            int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if(fd < 0)
+                return set_load_error(result, errno);
+
+            struct stat st;
+            if(::fstat(fd, &st) < 0)
+            {
+                set_load_error(result, errno);
+                ::close(fd);
+                return;
+            }
+
+            basic_password<char, Traits> buffer(static_cast<std::size_t>(st.st_size), '\0');
+            std::size_t done = 0;
+            while(done < buffer.size())
+            {
+                ssize_t n = ::pread(fd, buffer.data() + done, buffer.size() - done, static_cast<off_t>(done));
+                if(n < 0 && errno == EINTR)
+                    continue;
+                if(n < 0)
+                {
+                    set_load_error(result, errno);
+                    ::close(fd);
+                    return;
+                }
+                if(n == 0) // File shrunk since fstat()
+                    break;
+                done += static_cast<std::size_t>(n);
+            }
+            ::close(fd);
+
+            if(done < buffer.size())
+                buffer.resize(done);
+            result.password.swap(buffer);
+        }
+
+#if MERLIN_HAS_IO_URING
+        // Minimal io_uring wrapper over the raw system calls (no liburing dependency)
+        class io_ring
+        {
+            private:
+                int fd_ = -1;
+                unsigned entries_ = 0;
+
+                void * sq_ptr_ = nullptr;
+                void * cq_ptr_ = nullptr;
+                std::size_t sq_size_ = 0;
+                std::size_t cq_size_ = 0;
+                io_uring_sqe * sqes_ = nullptr;
+                std::size_t sqes_size_ = 0;
+
+                unsigned * sq_head_ = nullptr;
+                unsigned * sq_tail_ = nullptr;
+                unsigned * sq_mask_ = nullptr;
+                unsigned * sq_array_ = nullptr;
+                unsigned * cq_head_ = nullptr;
+                unsigned * cq_tail_ = nullptr;
+                unsigned * cq_mask_ = nullptr;
+                io_uring_cqe * cqes_ = nullptr;
+
+                unsigned pending_ = 0;
+                bool stranded_ = false;
+
+                static unsigned * at(void * base, unsigned offset) noexcept
+                {
+                    return reinterpret_cast<unsigned *>(static_cast<char *>(base) + offset);
+                }
+
+                // Kernels before 5.6 have neither the probe nor these opcodes, but accept the ring anyway
+                bool supports_loader_ops() const noexcept
+                {
+                    constexpr unsigned ops = 256;
+                    alignas(io_uring_probe) unsigned char buffer[sizeof(io_uring_probe) + ops * sizeof(io_uring_probe_op)] = {};
+                    io_uring_probe * probe = reinterpret_cast<io_uring_probe *>(buffer);
+                    if(::syscall(__NR_io_uring_register, fd_, IORING_REGISTER_PROBE, probe, ops) < 0)
+                        return false;
+
+                    for(unsigned op : {IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_CLOSE})
+                        if(op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED))
+                            return false;
+                    return true;
+                }
+
+                // Waits for entries the kernel has already taken; false if even that failed
+                template <typename F>
+                bool drain(unsigned in_flight, F & f)
+                {
+                    while(in_flight)
+                    {
+                        int r = static_cast<int>(::syscall(__NR_io_uring_enter, fd_, 0, in_flight, IORING_ENTER_GETEVENTS, nullptr, 0));
+                        if(r < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+                            return false;
+                        in_flight -= reap(in_flight, f);
+                    }
+                    return true;
+                }
+                template <typename F>
+                unsigned reap(unsigned max, F & f)
+                {
+                    unsigned head = *cq_head_;
+                    unsigned tail = std::atomic_ref<unsigned>(*cq_tail_).load(std::memory_order_acquire);
+                    unsigned done = 0;
+                    for(; head != tail && done < max; ++head, ++done)
+                    {
+                        const io_uring_cqe & cqe = cqes_[head & *cq_mask_];
+                        f(cqe.user_data, cqe.res);
+                    }
+                    std::atomic_ref<unsigned>(*cq_head_).store(head, std::memory_order_release);
+                    return done;
+                }
+
+            public:
+                explicit io_ring(unsigned entries)
+                {
+                    io_uring_params params{};
+                    fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+                    if(fd_ < 0)
+                        return;
+                    if(!supports_loader_ops())
+                    {
+                        close();
+                        return;
+                    }
+                    entries_ = params.sq_entries;
+
+                    sq_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+                    cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+                    if(params.features & IORING_FEAT_SINGLE_MMAP)
+                        sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+
+                    sq_ptr_ = ::mmap(nullptr, sq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+                    if(sq_ptr_ == MAP_FAILED)
+                    {
+                        sq_ptr_ = nullptr;
+                        close();
+                        return;
+                    }
+                    if(params.features & IORING_FEAT_SINGLE_MMAP)
+                        cq_ptr_ = sq_ptr_;
+                    else
+                    {
+                        cq_ptr_ = ::mmap(nullptr, cq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+                        if(cq_ptr_ == MAP_FAILED)
+                        {
+                            cq_ptr_ = nullptr;
+                            close();
+                            return;
+                        }
+                    }
+                    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+                    void * sqes = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+                    if(sqes == MAP_FAILED)
+                    {
+                        close();
+                        return;
+                    }
+                    sqes_ = static_cast<io_uring_sqe *>(sqes);
+
+                    sq_head_ = at(sq_ptr_, params.sq_off.head);
+                    sq_tail_ = at(sq_ptr_, params.sq_off.tail);
+                    sq_mask_ = at(sq_ptr_, params.sq_off.ring_mask);
+                    sq_array_ = at(sq_ptr_, params.sq_off.array);
+                    cq_head_ = at(cq_ptr_, params.cq_off.head);
+                    cq_tail_ = at(cq_ptr_, params.cq_off.tail);
+                    cq_mask_ = at(cq_ptr_, params.cq_off.ring_mask);
+                    cqes_ = reinterpret_cast<io_uring_cqe *>(static_cast<char *>(cq_ptr_) + params.cq_off.cqes);
+                }
+                io_ring(const io_ring &) = delete;
+                io_ring & operator=(const io_ring &) = delete;
+                ~io_ring()
+                {
+                    close();
+                }
+
+                bool valid() const noexcept
+                {
+                    return sqes_ != nullptr;
+                }
+                unsigned capacity() const noexcept
+                {
+                    return entries_;
+                }
+                // Whether a failed submit_and_wait() left entries the kernel may still complete, e.g. reads into caller buffers
+                bool stranded() const noexcept
+                {
+                    return stranded_;
+                }
+
+                // Returns a zeroed submission entry; at most capacity() entries may be queued before submit_and_wait()
+                io_uring_sqe & next(std::uint64_t user_data) noexcept
+                {
+                    unsigned index = (*sq_tail_ + pending_++) & *sq_mask_;
+                    io_uring_sqe & sqe = sqes_[index];
+                    sqe = io_uring_sqe{};
+                    sqe.user_data = user_data;
+                    sq_array_[index] = index;
+                    return sqe;
+                }
+
+                // Submits the queued entries, waits for all of them and calls f(user_data, result) for each completion.
+                // Returns false if the ring itself failed. Entries the kernel had not taken yet are withdrawn and the
+                // others are still waited for (and passed to f), unless that fails too: see stranded().
+                template <typename F>
+                bool submit_and_wait(F && f)
+                {
+                    unsigned to_submit = pending_;
+                    unsigned to_reap = pending_;
+                    std::atomic_ref<unsigned>(*sq_tail_).store(*sq_tail_ + pending_, std::memory_order_release);
+                    pending_ = 0;
+
+                    while(to_reap)
+                    {
+                        // A short submission returns without waiting, so to_reap never waits on entries still queued
+                        int r = static_cast<int>(::syscall(__NR_io_uring_enter, fd_, to_submit, to_reap, IORING_ENTER_GETEVENTS, nullptr, 0));
+                        if(r < 0)
+                        {
+                            if(errno == EINTR)
+                                continue;
+
+                            unsigned head = std::atomic_ref<unsigned>(*sq_head_).load(std::memory_order_acquire);
+                            unsigned queued = *sq_tail_ - head;
+                            std::atomic_ref<unsigned>(*sq_tail_).store(head, std::memory_order_release);
+                            if(!drain(to_reap - queued, f))
+                                stranded_ = true;
+                            return false;
+                        }
+                        to_submit -= std::min(to_submit, static_cast<unsigned>(r));
+                        to_reap -= reap(to_reap, f);
+                    }
+                    return true;
+                }
+
+                void close() noexcept
+                {
+                    if(sqes_)
+                        ::munmap(sqes_, sqes_size_);
+                    if(cq_ptr_ && cq_ptr_ != sq_ptr_)
+                        ::munmap(cq_ptr_, cq_size_);
+                    if(sq_ptr_)
+                        ::munmap(sq_ptr_, sq_size_);
+                    if(fd_ >= 0)
+                        ::close(fd_);
+                    sqes_ = nullptr;
+                    sq_ptr_ = cq_ptr_ = nullptr;
+                    sq_head_ = sq_tail_ = nullptr;
+                    fd_ = -1;
+                }
+        };
+
+        // An old or filtered kernel may accept the ring but refuse the operations themselves
+        inline bool io_ring_unsupported(int res) noexcept
+        {
+            return res == -EINVAL || res == -EOPNOTSUPP;
+        }
+
+        // Loads paths[first, first+count) through the ring; returns false if the ring failed or refused an operation,
+        // with every file opened by the batch closed again
+        template <typename Traits>
+        bool load_password_batch(io_ring & ring, const std::vector<std::string> & paths, std::size_t first, std::size_t count,
+                                 std::size_t reserve, std::vector<loaded_password<Traits>> & results)
+        {
+            std::vector<int> fds(count, -1);
+            std::vector<std::size_t> sizes(count, 0);
+            bool unsupported = false;
+
+            // 1. Opens
+            for(std::size_t i = 0; i < count; ++i)
+            {
+                io_uring_sqe & op = ring.next(i);
+                op.opcode = IORING_OP_OPENAT;
+                op.fd = AT_FDCWD;
+                op.addr = reinterpret_cast<std::uint64_t>(paths[first + i].c_str());
+                op.open_flags = O_RDONLY | O_CLOEXEC;
+            }
+            bool ok = ring.submit_and_wait([&](std::uint64_t i, int res)
+            {
+                if(res < 0)
+                {
+                    unsupported |= io_ring_unsupported(res);
+                    set_load_error(results[first + i], -res);
+                }
+                else
+                    fds[i] = res;
+            });
+            ok = ok && !unsupported;
+
+            // 2. Reads into the pre-reserved buffers
+            std::size_t reads = 0;
+            for(std::size_t i = 0; ok && i < count; ++i)
+            {
+                if(fds[i] < 0)
+                    continue;
+
+                basic_password<char, Traits> buffer(reserve, '\0');
+                results[first + i].password.swap(buffer);
+
+                io_uring_sqe & rd = ring.next(i);
+                rd.opcode = IORING_OP_READ;
+                rd.fd = fds[i];
+                rd.addr = reinterpret_cast<std::uint64_t>(results[first + i].password.data());
+                rd.len = static_cast<std::uint32_t>(reserve);
+                rd.off = 0;
+                ++reads;
+            }
+            if(ok && reads)
+            {
+                ok = ring.submit_and_wait([&](std::uint64_t i, int res)
+                {
+                    if(res < 0)
+                    {
+                        unsupported |= io_ring_unsupported(res);
+                        set_load_error(results[first + i], -res);
+                    }
+                    else
+                        sizes[i] = static_cast<std::size_t>(res);
+                });
+                ok = ok && !unsupported;
+            }
+            if(ring.stranded())
+            {
+                // The kernel may still write into the read buffers: leak them rather than let it scribble over freed memory
+                auto * stranded = new std::vector<basic_password<char, Traits>>();
+                stranded->reserve(count);
+                for(std::size_t i = 0; i < count; ++i)
+                    stranded->push_back(std::move(results[first + i].password));
+            }
+
+            // 3. Closes
+            std::size_t closes = 0;
+            for(std::size_t i = 0; i < count; ++i)
+            {
+                if(fds[i] < 0)
+                    continue;
+                if(!ok)
+                {
+                    ::close(fds[i]);
+                    continue;
+                }
+                io_uring_sqe & cl = ring.next(i);
+                cl.opcode = IORING_OP_CLOSE;
+                cl.fd = fds[i];
+                ++closes;
+            }
+            if(ok && closes)
+            {
+                // A close the kernel refused, or never got to, leaves its descriptor open
+                std::vector<int> open_fds = fds;
+                ok = ring.submit_and_wait([&](std::uint64_t i, int res)
+                {
+                    if(io_ring_unsupported(res))
+                        unsupported = true;
+                    else
+                        open_fds[i] = -1;
+                });
+                ok = ok && !unsupported;
+                for(std::size_t i = 0; !ok && !ring.stranded() && i < count; ++i)
+                    if(open_fds[i] >= 0)
+                        ::close(open_fds[i]);
+            }
+            if(!ok)
+                return false;
+
+            // Trim to the bytes read; a full buffer may mean a larger file, which is read again with pread
+            for(std::size_t i = 0; i < count; ++i)
+            {
+                loaded_password<Traits> & r = results[first + i];
+                if(fds[i] < 0 || r.error)
+                    continue;
+                if(sizes[i] == reserve)
+                    load_password_file_blocking(paths[first + i], r);
+                else
+                    r.password.resize(sizes[i]);
+            }
+            return true;
+        }
+#endif
+    }
+
+    // Reads every file of paths into its own basic_password (results[i] corresponds to paths[i]).
+    // Per-file failures are reported through loaded_password::error; nothing is thrown for them.
+    // Each file is read into a buffer of reserve bytes, then trimmed; larger files are re-read with pread.
+    // queue_depth bounds the number of files in flight in the io_uring.
+    template <typename Traits = std::char_traits<char>>
+    std::vector<loaded_password<Traits>> load_password_files(const std::vector<std::string> & paths, std::size_t reserve = 512, unsigned queue_depth = 256)
+    {
+        std::vector<loaded_password<Traits>> results(paths.size());
+        std::size_t first = 0;
+
+#if MERLIN_HAS_IO_URING
+        if(queue_depth && reserve && reserve <= std::numeric_limits<std::uint32_t>::max() && paths.size() > 1)
+        {
+            detail::io_ring ring(queue_depth);
+            if(ring.valid())
+            {
+                std::size_t batch = ring.capacity();
+                for(; first < paths.size(); first += batch)
+                {
+                    std::size_t count = std::min(batch, paths.size() - first);
+                    if(!detail::load_password_batch(ring, paths, first, count, reserve, results))
+                    {
+                        for(std::size_t i = first; i < first + count; ++i)
+                        {
+                            results[i].password.clear();
+                            results[i].error.clear();
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+#endif
+
+        for(std::size_t i = first; i < paths.size(); ++i)
+            detail::load_password_file_blocking(paths[i], results[i]);
+        return results;
+    }
+}
+
+#endif // MERLIN_PASSWORD_LOADER_HPP
@@ -0,0 +1,400 @@
+#ifndef MERLIN_PASSWORD_TABLE_HPP
+#define MERLIN_PASSWORD_TABLE_HPP
+
+#include <merlin_basic_password.hpp>
+#include <merlin_detail.hpp>
+#include <merlin_password_hash.hpp>
+#include <merlin_password_view.hpp>
+#include <merlin_secure_allocator.hpp>
+#include <merlin_secure_vector.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// basic_password_table: many passwords in columnar form (as Arrow lays out string columns). All characters sit
+// back to back in one secure payload buffer, and entry i spans [offsets[i], offsets[i + 1]). That costs one
+// offset per entry instead of a basic_password header plus a heap block, and batch passes stream through memory.
+// Entries are read as basic_password_view (valid until the table is modified), and copied out to basic_password on demand.
+// Both buffers are secure_vectors, so growth and clear() wipe what they leave behind. The batch operations split
+// the entries over worker threads (0 for the hardware concurrency).
+
+namespace merl
+{
+    template <typename CharT, typename Traits = std::char_traits<CharT>>
+    class basic_password_table
+    {
+        public:
+            using value_type = basic_password_view<CharT, Traits>;
+            using size_type = std::size_t;
+            using difference_type = std::ptrdiff_t;
+
+            static constexpr size_type npos = -1;
+
+        private:
+            secure_vector<CharT, secure_allocator<CharT>> payload_;
+            secure_vector<size_type, secure_allocator<size_type>> offsets_ {0};
+
+            // Worker count for a batch pass: threads (0 for the hardware concurrency), with at least grain entries each
+            size_type workers(std::uint32_t threads) const noexcept
+            {
+                constexpr size_type grain = 4096;
+                size_type n = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+                return std::max<size_type>(1, std::min(n, (size() + grain - 1) / grain));
+            }
+            // Runs fn(w, begin, end) for each of the slices parts of [0, size()); rethrows the first exception a worker hit
+            template <typename Fn>
+            void parallel_ranges(size_type slices, Fn fn) const
+            {
+                size_type count = size();
+                std::vector<std::exception_ptr> errors(slices);
+                auto work = [&](size_type w)
+                {
+                    try
+                    {
+                        fn(w, count * w / slices, count * (w + 1) / slices);
+                    }
+                    catch(...)
+                    {
+                        errors[w] = std::current_exception();
+                    }
+                };
+                {
+                    std::vector<std::jthread> pool;
+                    pool.reserve(slices - 1);
+                    for(size_type w = 1; w < slices; ++w)
+                        pool.emplace_back(work, w);
+                    work(0);
+                }
+                for(std::exception_ptr & e : errors)
+                {
+                    if(e)
+                        std::rethrow_exception(e);
+                }
+            }
+
+        public:
+            class const_iterator
+            {
+                friend class basic_password_table;
+
+                private:
+                    const basic_password_table * table_ = nullptr;
+                    size_type index_ = 0;
+
+                    const_iterator(const basic_password_table * table, size_type index) noexcept : table_{table}, index_{index}
+                    {}
+
+                public:
+                    using iterator_category = std::random_access_iterator_tag;
+                    using value_type = basic_password_view<CharT, Traits>;
+                    using difference_type = std::ptrdiff_t;
+                    using reference = value_type;
+                    using pointer = void;
+
+                    const_iterator() noexcept = default;
+
+                    value_type operator*() const noexcept
+                    {
+                        return (*table_)[index_];
+                    }
+                    value_type operator[](difference_type n) const noexcept
+                    {
+                        return (*table_)[index_ + n];
+                    }
+                    const_iterator & operator++() noexcept
+                    {
+                        ++index_;
+                        return *this;
+                    }
+                    const_iterator operator++(int) noexcept
+                    {
+                        const_iterator tmp(*this);
+                        ++index_;
+                        return tmp;
+                    }
+                    const_iterator & operator--() noexcept
+                    {
+                        --index_;
+                        return *this;
+                    }
+                    const_iterator operator--(int) noexcept
+                    {
+                        const_iterator tmp(*this);
+                        --index_;
+                        return tmp;
+                    }
+                    const_iterator & operator+=(difference_type n) noexcept
+                    {
+                        index_ += n;
+                        return *this;
+                    }
+                    const_iterator & operator-=(difference_type n) noexcept
+                    {
+                        index_ -= n;
+                        return *this;
+                    }
+
+                    friend const_iterator operator+(const_iterator it, difference_type n) noexcept
+                    {
+                        return it += n;
+                    }
+                    friend const_iterator operator+(difference_type n, const_iterator it) noexcept
+                    {
+                        return it += n;
+                    }
+                    friend const_iterator operator-(const_iterator it, difference_type n) noexcept
+                    {
+                        return it -= n;
+                    }
+                    friend difference_type operator-(const const_iterator & lhs, const const_iterator & rhs) noexcept
+                    {
+                        return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+                    }
+                    friend bool operator==(const const_iterator & lhs, const const_iterator & rhs) noexcept
+                    {
+                        return lhs.index_ == rhs.index_;
+                    }
+                    friend auto operator<=>(const const_iterator & lhs, const const_iterator & rhs) noexcept
+                    {
+                        return lhs.index_ <=> rhs.index_;
+                    }
+            };
+            using iterator = const_iterator;
+
+            // Constructors
+            basic_password_table() = default;
+            template <typename Alloc>
+            basic_password_table(const basic_password<CharT, Traits, Alloc> * passwords, size_type count)
+            {
+                size_type chars = 0;
+                for(size_type i = 0; i < count; ++i)
+                    chars += passwords[i].size();
+                reserve(count, chars);
+                for(size_type i = 0; i < count; ++i)
+                    append(passwords[i]);
+            }
+
+            // Elements access
+            basic_password_view<CharT, Traits> operator[](size_type i) const noexcept
+            {
+                return basic_password_view<CharT, Traits>(payload_.data() + offsets_[i], offsets_[i + 1] - offsets_[i]);
+            }
+            basic_password_view<CharT, Traits> at(size_type i) const
+            {
+                if(i >= size())
+                    throw std::out_of_range("merl::basic_password_table::at(): Out of range (pos = " + std::to_string(i) + ", size = " + std::to_string(size()) + ')');
+
+                return (*this)[i];
+            }
+            // Owning copy of entry i
+            template <typename Alloc = std::allocator<CharT>>
+            basic_password<CharT, Traits, Alloc> password(size_type i, const Alloc & alloc = Alloc()) const
+            {
+                return basic_password<CharT, Traits, Alloc>(at(i), alloc);
+            }
+            basic_password_view<CharT, Traits> front() const noexcept
+            {
+                return (*this)[0];
+            }
+            basic_password_view<CharT, Traits> back() const noexcept
+            {
+                return (*this)[size() - 1];
+            }
+            // The raw columns: size() + 1 offsets into payload_size() characters
+            const CharT * payload() const noexcept
+            {
+                return payload_.data();
+            }
+            const size_type * offsets() const noexcept
+            {
+                return offsets_.data();
+            }
+
+            // Iterators
+            const_iterator begin() const noexcept
+            {
+                return const_iterator(this, 0);
+            }
+            const_iterator cbegin() const noexcept
+            {
+                return begin();
+            }
+            const_iterator end() const noexcept
+            {
+                return const_iterator(this, size());
+            }
+            const_iterator cend() const noexcept
+            {
+                return end();
+            }
+
+            // Capacity
+            bool empty() const noexcept
+            {
+                return offsets_.size() == 1;
+            }
+            size_type size() const noexcept
+            {
+                return offsets_.size() - 1;
+            }
+            size_type payload_size() const noexcept
+            {
+                return payload_.size();
+            }
+            void reserve(size_type count, size_type chars)
+            {
+                offsets_.reserve(count + 1);
+                payload_.reserve(chars);
+            }
+            void shrink_to_fit()
+            {
+                offsets_.shrink_to_fit();
+                payload_.shrink_to_fit();
+            }
+
+            // Modifiers
+            void append(basic_password_view<CharT, Traits> v)
+            {
+                // Grow both columns up front, so a failed allocation leaves the table unchanged
+                if(offsets_.size() == offsets_.capacity())
+                    offsets_.reserve(offsets_.capacity() * 2);
+                if(payload_.size() + v.size() > payload_.capacity())
+                {
+                    // A view into this table would dangle once the payload reallocates
+                    bool inside = v.data() >= payload_.data() && v.data() < payload_.data() + payload_.size();
+                    size_type offset = inside ? v.data() - payload_.data() : 0;
+                    payload_.reserve(std::max(payload_.size() + v.size(), payload_.capacity() * 2));
+                    if(inside)
+                        v = basic_password_view<CharT, Traits>(payload_.data() + offset, v.size());
+                }
+                payload_.insert(payload_.end(), v.begin(), v.end());
+                offsets_.push_back(payload_.size());
+            }
+            template <typename Alloc>
+            void append(const basic_password<CharT, Traits, Alloc> & p)
+            {
+                append(p.view());
+            }
+            void append(const CharT * p)
+            {
+                append(basic_password_view<CharT, Traits>(p));
+            }
+            template <typename InputIt>
+            void append(InputIt first, InputIt last)
+            {
+                for(; first != last; ++first)
+                    append(*first);
+            }
+            void pop_back()
+            {
+                if(empty())
+                    throw std::out_of_range("merl::basic_password_table::pop_back(): Out of range (size = 0)");
+                payload_.resize(offsets_[size() - 1]);
+                offsets_.pop_back();
+            }
+            // Wipes every entry in one pass over the payload; the capacity is kept for refilling
+            void clear() noexcept
+            {
+                payload_.clear();
+                offsets_.resize(1);
+            }
+            void swap(basic_password_table & other) noexcept
+            {
+                payload_.swap(other.payload_);
+                offsets_.swap(other.offsets_);
+            }
+
+            // Batch operations
+            // out[i] = fn((*this)[i]) for every entry
+            template <typename Fn, typename OutputIt>
+            void transform(Fn fn, OutputIt out, std::uint32_t threads = 0) const
+            {
+                // Contiguous, so workers writing neighbouring results never share an element (as vector<bool>'s bits would)
+                static_assert(std::contiguous_iterator<OutputIt>, "merl::basic_password_table::transform() writes results in parallel");
+                parallel_ranges(workers(threads), [&](size_type, size_type begin, size_type end)
+                {
+                    for(size_type i = begin; i < end; ++i)
+                        out[i] = fn((*this)[i]);
+                });
+            }
+            // results[i] = policy((*this)[i]), e.g. length, character class or breach-list rules
+            template <typename Policy>
+            void check(Policy policy, bool * results, std::uint32_t threads = 0) const
+            {
+                transform(policy, results, threads);
+            }
+            // Number of entries that fail policy
+            template <typename Policy>
+            size_type count_failing(Policy policy, std::uint32_t threads = 0) const
+            {
+                std::vector<size_type> failing(workers(threads));
+                parallel_ranges(failing.size(), [&](size_type w, size_type begin, size_type end)
+                {
+                    size_type n = 0;
+                    for(size_type i = begin; i < end; ++i)
+                        n += !policy((*this)[i]);
+                    failing[w] = n;
+                });
+                size_type total = 0;
+                for(size_type n : failing)
+                    total += n;
+                return total;
+            }
+            // hashes[i] = the per-process SipHash of entry i, as std::hash<basic_password> computes it
+            void hash(std::size_t * hashes, std::uint32_t threads = 0) const
+            {
+                transform([](basic_password_view<CharT, Traits> v) { return password_hasher{}(v); }, hashes, threads);
+            }
+
+            // Index of an entry equal to needle, or npos. Every entry is compared in full and without early exit,
+            // so the time depends on the entry lengths and on size(), not on which entry (if any) matches.
+            size_type find(basic_password_view<CharT, Traits> needle, std::uint32_t threads = 0) const
+            {
+                std::vector<size_type> found(workers(threads), npos);
+                parallel_ranges(found.size(), [&](size_type w, size_type begin, size_type end)
+                {
+                    size_type match = npos;
+                    for(size_type i = begin; i < end; ++i)
+                    {
+                        basic_password_view<CharT, Traits> entry = (*this)[i];
+                        size_type n = std::min(entry.size(), needle.size());
+                        size_type equal = static_cast<size_type>(entry.size() == needle.size()) & static_cast<size_type>(detail::ct_equal(entry.data(), needle.data(), n * sizeof(CharT)));
+                        size_type mask = ~(equal - 1) & static_cast<size_type>(match == npos) * npos; // all ones on the first match only
+                        match = (match & ~mask) | (i & mask);
+                    }
+                    found[w] = match;
+                });
+                for(size_type i : found)
+                {
+                    if(i != npos)
+                        return i;
+                }
+                return npos;
+            }
+            template <typename Alloc>
+            size_type find(const basic_password<CharT, Traits, Alloc> & needle, std::uint32_t threads = 0) const
+            {
+                return find(needle.view(), threads);
+            }
+    };
+
+    template <typename CharT, typename Traits>
+    void swap(basic_password_table<CharT, Traits> & lhs, basic_password_table<CharT, Traits> & rhs) noexcept
+    {
+        lhs.swap(rhs);
+    }
+
+    using password_table = basic_password_table<char>;
+    using wpassword_table = basic_password_table<wchar_t>;
+    using u8password_table = basic_password_table<char8_t>;
+    using u16password_table = basic_password_table<char16_t>;
+    using u32password_table = basic_password_table<char32_t>;
+}
+
+#endif // MERLIN_PASSWORD_TABLE_HPP
@@ -0,0 +1,334 @@
+#ifndef MERLIN_PASSWORD_TRANSCODE_HPP
+#define MERLIN_PASSWORD_TRANSCODE_HPP
+
+#include <merlin_basic_password.hpp>
+#include <merlin_detail.hpp>
+#include <merlin_password_unicode.hpp>
+
+// Conversions between the UTF-8 (char, char8_t), UTF-16 (char16_t) and UTF-32 (char32_t) basic_password specializations.
+// wchar_t is UTF-16 or UTF-32 depending on its size.
+// The output length is computed while validating the input, so the result is allocated once and written in place.
+// Runs of ASCII are widened / narrowed with SIMD; other code points go through the scalar coder.
+
+namespace merl
+{
+    namespace detail
+    {
+        template <typename CharT>
+        inline constexpr int utf_bits = sizeof(CharT) == 1 ? 8 : sizeof(CharT) == 2 ? 16 : 32;
+
+        // --- Decoding: return the number of code units read, or 0 if the input is ill-formed ---
+        template <typename CharT>
+        std::size_t utf_decode_one(const CharT * p, std::size_t n, std::size_t i, char32_t & cp) noexcept
+        {
+            if constexpr(utf_bits<CharT> == 8)
+                return utf8_decode_one(reinterpret_cast<const unsigned char *>(p), n, i, cp);
+            else if constexpr(utf_bits<CharT> == 16)
+            {
+                char32_t u = static_cast<char16_t>(p[i]);
+                if(u - 0xd800 >= 0x800)
+                {
+                    cp = u;
+                    return 1;
+                }
+                if(u >= 0xdc00 || i + 1 == n)
+                    return 0;
+                char32_t l = static_cast<char16_t>(p[i+1]);
+                if(l - 0xdc00 >= 0x400)
+                    return 0;
+                cp = 0x10000 + ((u - 0xd800) << 10) + (l - 0xdc00);
+                return 2;
+            }
+            else
+            {
+                char32_t u = static_cast<char32_t>(p[i]);
+                if(u > 0x10ffff || u - 0xd800 < 0x800)
+                    return 0;
+                cp = u;
+                return 1;
+            }
+        }
+
+        // --- Encoding ---
+        template <typename CharT>
+        std::size_t utf_length(char32_t cp) noexcept
+        {
+            if constexpr(utf_bits<CharT> == 8)
+                return utf8_length(cp);
+            else if constexpr(utf_bits<CharT> == 16)
+                return cp < 0x10000 ? 1 : 2;
+            else
+                return 1;
+        }
+        template <typename CharT>
+        CharT * utf_encode_one(char32_t cp, CharT * out) noexcept
+        {
+            if constexpr(utf_bits<CharT> == 8)
+                return reinterpret_cast<CharT *>(utf8_encode_one(cp, reinterpret_cast<char *>(out)));
+            else if constexpr(utf_bits<CharT> == 16)
+            {
+                if(cp < 0x10000)
+                    *out++ = static_cast<CharT>(cp);
+                else
+                {
+                    cp -= 0x10000;
+                    *out++ = static_cast<CharT>(0xd800 + (cp >> 10));
+                    *out++ = static_cast<CharT>(0xdc00 + (cp & 0x3ff));
+                }
+                return out;
+            }
+            else
+            {
+                *out++ = static_cast<CharT>(cp);
+                return out;
+            }
+        }
+
+        // --- ASCII runs ---
+        // widen_ascii() converts n bytes already known to be ASCII;
+        // narrow_ascii() converts the leading ASCII code units of p and returns how many it converted.
+        template <typename CharT>
+        void widen_ascii_scalar(const unsigned char * p, std::size_t n, CharT * out) noexcept
+        {
+            for(std::size_t i = 0; i < n; ++i)
+                out[i] = static_cast<CharT>(p[i]);
+        }
+        template <typename CharT>
+        std::size_t narrow_ascii_scalar(const CharT * p, std::size_t n, unsigned char * out) noexcept
+        {
+            std::size_t i = 0;
+            for(; i < n && static_cast<std::uint32_t>(p[i]) < 0x80; ++i)
+                out[i] = static_cast<unsigned char>(p[i]);
+            return i;
+        }
+
+#if MERLIN_X86_SIMD
+        template <typename CharT>
+        MERLIN_TARGET("sse4.1")
+        void widen_ascii_sse41(const unsigned char * p, std::size_t n, CharT * out) noexcept
+        {
+            std::size_t i = 0;
+            for(; i + 8 <= n; i += 8)
+            {
+                __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p + i));
+                if constexpr(sizeof(CharT) == 2)
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_cvtepu8_epi16(v));
+                else
+                {
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_cvtepu8_epi32(v));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i + 4), _mm_cvtepu8_epi32(_mm_srli_si128(v, 4)));
+                }
+            }
+            widen_ascii_scalar(p + i, n - i, out + i);
+        }
+        template <typename CharT>
+        MERLIN_TARGET("sse4.1")
+        std::size_t narrow_ascii_sse41(const CharT * p, std::size_t n, unsigned char * out) noexcept
+        {
+            constexpr std::size_t step = 16 / sizeof(CharT);
+            const __m128i non_ascii = sizeof(CharT) == 2 ? _mm_set1_epi16(static_cast<short>(0xff80)) : _mm_set1_epi32(static_cast<int>(0xffffff80));
+
+            std::size_t i = 0;
+            for(; i + 2*step <= n; i += 2*step)
+            {
+                __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+                __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i + step));
+                if(!_mm_testz_si128(_mm_or_si128(a, b), non_ascii))
+                    break;
+                if constexpr(sizeof(CharT) == 2)
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_packus_epi16(a, b));
+                else
+                    _mm_storel_epi64(reinterpret_cast<__m128i *>(out + i), _mm_packus_epi16(_mm_packus_epi32(a, b), _mm_setzero_si128()));
+            }
+            return i + narrow_ascii_scalar(p + i, n - i, out + i);
+        }
+
+        template <typename CharT>
+        MERLIN_TARGET("avx2")
+        void widen_ascii_avx2(const unsigned char * p, std::size_t n, CharT * out) noexcept
+        {
+            std::size_t i = 0;
+            if constexpr(sizeof(CharT) == 2)
+            {
+                for(; i + 16 <= n; i += 16)
+                {
+                    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_cvtepu8_epi16(v));
+                }
+            }
+            else
+            {
+                for(; i + 8 <= n; i += 8)
+                {
+                    __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p + i));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_cvtepu8_epi32(v));
+                }
+            }
+            widen_ascii_scalar(p + i, n - i, out + i);
+        }
+        template <typename CharT>
+        MERLIN_TARGET("avx2")
+        std::size_t narrow_ascii_avx2(const CharT * p, std::size_t n, unsigned char * out) noexcept
+        {
+            constexpr std::size_t step = 32 / sizeof(CharT);
+            const __m256i non_ascii = sizeof(CharT) == 2 ? _mm256_set1_epi16(static_cast<short>(0xff80)) : _mm256_set1_epi32(static_cast<int>(0xffffff80));
+
+            std::size_t i = 0;
+            for(; i + 2*step <= n; i += 2*step)
+            {
+                __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i));
+                __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i + step));
+                if(!_mm256_testz_si256(_mm256_or_si256(a, b), non_ascii))
+                    break;
+                // Packing works per 128-bit lane: restore the element order afterwards
+                if constexpr(sizeof(CharT) == 2)
+                {
+                    __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xd8);
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), packed);
+                }
+                else
+                {
+                    __m256i words = _mm256_permute4x64_epi64(_mm256_packus_epi32(a, b), 0xd8);
+                    __m128i bytes = _mm_packus_epi16(_mm256_castsi256_si128(words), _mm256_extracti128_si256(words, 1));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), bytes);
+                }
+            }
+            return i + narrow_ascii_scalar(p + i, n - i, out + i);
+        }
+#endif
+
+        template <typename CharT>
+        void widen_ascii(const unsigned char * p, std::size_t n, CharT * out) noexcept
+        {
+#if MERLIN_X86_SIMD
+            if(cpu().avx2)
+                return widen_ascii_avx2(p, n, out);
+            if(cpu().sse41)
+                return widen_ascii_sse41(p, n, out);
+#endif
+            widen_ascii_scalar(p, n, out);
+        }
+        template <typename CharT>
+        std::size_t narrow_ascii(const CharT * p, std::size_t n, unsigned char * out) noexcept
+        {
+#if MERLIN_X86_SIMD
+            if(cpu().avx2)
+                return narrow_ascii_avx2(p, n, out);
+            if(cpu().sse41)
+                return narrow_ascii_sse41(p, n, out);
+#endif
+            return narrow_ascii_scalar(p, n, out);
+        }
+
+        // Returns the number of ToCharT code units needed for p, or npos if p is ill-formed
+        template <typename ToCharT, typename FromCharT>
+        std::size_t transcoded_length(const FromCharT * p, std::size_t n) noexcept
+        {
+            std::size_t length = 0;
+            std::size_t i = 0;
+            while(i < n)
+            {
+                if constexpr(utf_bits<FromCharT> == 8)
+                {
+                    std::size_t ascii = ascii_prefix(reinterpret_cast<const unsigned char *>(p + i), n - i, false);
+                    i += ascii;
+                    length += ascii;
+                    if(i == n)
+                        break;
+                }
+
+                char32_t cp;
+                std::size_t read = utf_decode_one(p, n, i, cp);
+                if(!read)
+                    return static_cast<std::size_t>(-1);
+                i += read;
+                length += utf_length<ToCharT>(cp);
+            }
+            return length;
+        }
+
+        template <typename ToCharT, typename FromCharT>
+        void transcode(const FromCharT * p, std::size_t n, ToCharT * out) noexcept
+        {
+            if constexpr(utf_bits<FromCharT> == utf_bits<ToCharT>) // Same encoding form, already validated
+            {
+                std::copy(p, p + n, out);
+                return;
+            }
+
+            std::size_t i = 0;
+            while(i < n)
+            {
+                if constexpr(utf_bits<FromCharT> == 8 && utf_bits<ToCharT> != 8)
+                {
+                    const unsigned char * bytes = reinterpret_cast<const unsigned char *>(p);
+                    std::size_t ascii = ascii_prefix(bytes + i, n - i, false);
+                    widen_ascii(bytes + i, ascii, out);
+                    i += ascii;
+                    out += ascii;
+                    if(i == n)
+                        break;
+                }
+                else if constexpr(utf_bits<FromCharT> != 8 && utf_bits<ToCharT> == 8)
+                {
+                    std::size_t ascii = narrow_ascii(p + i, n - i, reinterpret_cast<unsigned char *>(out));
+                    i += ascii;
+                    out += ascii;
+                    if(i == n)
+                        break;
+                }
+
+                char32_t cp;
+                i += utf_decode_one(p, n, i, cp);
+                out = utf_encode_one(cp, out);
+            }
+        }
+
+        // The result of a conversion uses the source's allocator, rebound
+        template <typename CharT, typename Alloc, typename Traits = std::char_traits<CharT>>
+        using rebound_password = basic_password<CharT, Traits, typename std::allocator_traits<Alloc>::template rebind_alloc<CharT>>;
+    }
+
+    // Converts p to another encoding form. Throws std::invalid_argument if p is ill-formed (lone surrogates,
+    // overlong UTF-8...): nothing is allocated in that case.
+    // The result is allocated with p's allocator (rebound to ToCharT).
+    template <typename ToCharT, typename ToTraits = std::char_traits<ToCharT>, typename FromCharT, typename FromTraits, typename FromAlloc>
+    detail::rebound_password<ToCharT, FromAlloc, ToTraits> transcode(const basic_password<FromCharT, FromTraits, FromAlloc> & p)
+    {
+        std::size_t length = detail::transcoded_length<ToCharT>(p.data(), p.size());
+        if(length == static_cast<std::size_t>(-1))
+            throw std::invalid_argument("merl::transcode(): Invalid argument -> Ill-formed UTF-" + std::to_string(detail::utf_bits<FromCharT>) + " input");
+
+        detail::rebound_password<ToCharT, FromAlloc, ToTraits> result(length, ToCharT{}, p.get_allocator());
+        detail::transcode(p.data(), p.size(), result.data());
+        return result;
+    }
+
+    template <typename CharT, typename Traits, typename Alloc>
+    detail::rebound_password<char, Alloc> to_password(const basic_password<CharT, Traits, Alloc> & p)
+    {
+        return transcode<char>(p);
+    }
+    template <typename CharT, typename Traits, typename Alloc>
+    detail::rebound_password<wchar_t, Alloc> to_wpassword(const basic_password<CharT, Traits, Alloc> & p)
+    {
+        return transcode<wchar_t>(p);
+    }
+    template <typename CharT, typename Traits, typename Alloc>
+    detail::rebound_password<char8_t, Alloc> to_u8password(const basic_password<CharT, Traits, Alloc> & p)
+    {
+        return transcode<char8_t>(p);
+    }
+    template <typename CharT, typename Traits, typename Alloc>
+    detail::rebound_password<char16_t, Alloc> to_u16password(const basic_password<CharT, Traits, Alloc> & p)
+    {
+        return transcode<char16_t>(p);
+    }
+    template <typename CharT, typename Traits, typename Alloc>
+    detail::rebound_password<char32_t, Alloc> to_u32password(const basic_password<CharT, Traits, Alloc> & p)
+    {
+        return transcode<char32_t>(p);
+    }
+}
+
+#endif // MERLIN_PASSWORD_TRANSCODE_HPP
@@ -0,0 +1,426 @@
+#ifndef MERLIN_PASSWORD_UNICODE_HPP
+#define MERLIN_PASSWORD_UNICODE_HPP
+
+#include <merlin_basic_password.hpp>
+#include <merlin_detail.hpp>
+#include <merlin_unicode_tables.hpp>
+
+// UTF-8 validation and PRECIS OpaqueString enforcement (RFC 8265 section 4.2) over basic_password<char>.
+// Passwords made only of printable ASCII are already in their enforced form and skip normalization entirely;
+// all other passwords go through intermediate basic_password buffers, which are wiped on destruction.
+
+namespace merl
+{
+    namespace detail
+    {
+        // --- ASCII prefix scan ---
+        // Returns the length of the leading run of ASCII bytes (printable == false) or of printable ASCII bytes,
+        // i.e. 0x20-0x7E (printable == true)
+        inline std::size_t ascii_prefix_scalar(const unsigned char * p, std::size_t n, bool printable) noexcept
+        {
+            std::size_t i = 0;
+            if(printable)
+                while(i < n && p[i] >= 0x20 && p[i] < 0x7f)
+                    ++i;
+            else
+                while(i < n && p[i] < 0x80)
+                    ++i;
+            return i;
+        }
+
+#if MERLIN_X86_SIMD
+        MERLIN_TARGET("sse4.1")
+        inline std::size_t ascii_prefix_sse41(const unsigned char * p, std::size_t n, bool printable) noexcept
+        {
+            const __m128i below = _mm_set1_epi8(0x1f);
+            const __m128i above = _mm_set1_epi8(0x7f);
+
+            std::size_t i = 0;
+            for(; i + 16 <= n; i += 16)
+            {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+                // Bytes >= 0x80 are negative as signed bytes, so they fail the first comparison
+                int bad = printable ? ~_mm_movemask_epi8(_mm_and_si128(_mm_cmpgt_epi8(v, below), _mm_cmpgt_epi8(above, v))) & 0xffff
+                                    : _mm_movemask_epi8(v);
+                if(bad)
+                    return i + __builtin_ctz(static_cast<unsigned int>(bad));
+            }
+            return i + ascii_prefix_scalar(p + i, n - i, printable);
+        }
+        MERLIN_TARGET("avx2")
+        inline std::size_t ascii_prefix_avx2(const unsigned char * p, std::size_t n, bool printable) noexcept
+        {
+            const __m256i below = _mm256_set1_epi8(0x1f);
+            const __m256i above = _mm256_set1_epi8(0x7f);
+
+            std::size_t i = 0;
+            for(; i + 32 <= n; i += 32)
+            {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i));
+                unsigned int bad = printable ? ~static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpgt_epi8(v, below), _mm256_cmpgt_epi8(above, v))))
+                                             : static_cast<unsigned int>(_mm256_movemask_epi8(v));
+                if(bad)
+                    return i + __builtin_ctz(bad);
+            }
+            return i + ascii_prefix_scalar(p + i, n - i, printable);
+        }
+#endif
+
+        inline std::size_t ascii_prefix(const unsigned char * p, std::size_t n, bool printable) noexcept
+        {
+#if MERLIN_X86_SIMD
+            if(cpu().avx2)
+                return ascii_prefix_avx2(p, n, printable);
+            if(cpu().sse41)
+                return ascii_prefix_sse41(p, n, printable);
+#endif
+            return ascii_prefix_scalar(p, n, printable);
+        }
+
+        // --- UTF-8 ---
+        // Decodes the sequence starting at p[i] (i < n) into cp and returns its length, or 0 if it is ill-formed
+        // (overlong forms, surrogates and code points above U+10FFFF are rejected)
+        inline std::size_t utf8_decode_one(const unsigned char * p, std::size_t n, std::size_t i, char32_t & cp) noexcept
+        {
+            unsigned char b0 = p[i];
+            if(b0 < 0x80)
+            {
+                cp = b0;
+                return 1;
+            }
+
+            std::size_t length;
+            unsigned char lo = 0x80, hi = 0xbf;
+            if(b0 >= 0xc2 && b0 <= 0xdf)
+                length = 2;
+            else if(b0 >= 0xe0 && b0 <= 0xef)
+            {
+                length = 3;
+                if(b0 == 0xe0)
+                    lo = 0xa0;
+                else if(b0 == 0xed)
+                    hi = 0x9f;
+            }
+            else if(b0 >= 0xf0 && b0 <= 0xf4)
+            {
+                length = 4;
+                if(b0 == 0xf0)
+                    lo = 0x90;
+                else if(b0 == 0xf4)
+                    hi = 0x8f;
+            }
+            else
+                return 0;
+
+            if(n - i < length || p[i+1] < lo || p[i+1] > hi)
+                return 0;
+
+            char32_t value = b0 & (0x7f >> length);
+            for(std::size_t k = 1; k < length; ++k)
+            {
+                if((p[i+k] & 0xc0) != 0x80)
+                    return 0;
+                value = (value << 6) | (p[i+k] & 0x3f);
+            }
+            cp = value;
+            return length;
+        }
+
+        // Returns the number of code points in p, or npos if p is not well-formed UTF-8
+        inline std::size_t utf8_count(const unsigned char * p, std::size_t n) noexcept
+        {
+            std::size_t count = 0;
+            std::size_t i = 0;
+            while(i < n)
+            {
+                std::size_t ascii = ascii_prefix(p + i, n - i, false);
+                i += ascii;
+                count += ascii;
+                if(i == n)
+                    break;
+
+                char32_t cp;
+                std::size_t length = utf8_decode_one(p, n, i, cp);
+                if(!length)
+                    return static_cast<std::size_t>(-1);
+                i += length;
+                ++count;
+            }
+            return count;
+        }
+
+        inline std::size_t utf8_length(char32_t cp) noexcept
+        {
+            return cp < 0x80 ? 1 : cp < 0x800 ? 2 : cp < 0x10000 ? 3 : 4;
+        }
+        inline char * utf8_encode_one(char32_t cp, char * out) noexcept
+        {
+            if(cp < 0x80)
+                *out++ = static_cast<char>(cp);
+            else if(cp < 0x800)
+            {
+                *out++ = static_cast<char>(0xc0 | (cp >> 6));
+                *out++ = static_cast<char>(0x80 | (cp & 0x3f));
+            }
+            else if(cp < 0x10000)
+            {
+                *out++ = static_cast<char>(0xe0 | (cp >> 12));
+                *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+                *out++ = static_cast<char>(0x80 | (cp & 0x3f));
+            }
+            else
+            {
+                *out++ = static_cast<char>(0xf0 | (cp >> 18));
+                *out++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3f));
+                *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+                *out++ = static_cast<char>(0x80 | (cp & 0x3f));
+            }
+            return out;
+        }
+
+        // --- Unicode properties ---
+        template <std::size_t N>
+        const unicode::range_value * find_range(const unicode::range_value (&table)[N], char32_t cp) noexcept
+        {
+            const unicode::range_value * it = std::upper_bound(table, table + N, cp,
+                                                               [](char32_t c, const unicode::range_value & r) { return c < r.first; });
+            if(it == table || (--it)->last < cp)
+                return nullptr;
+            return it;
+        }
+
+        inline std::uint8_t combining_class(char32_t cp) noexcept
+        {
+            if(cp < 0x300)
+                return 0;
+            const unicode::range_value * r = find_range(unicode::combining_classes, cp);
+            return r ? r->value : 0;
+        }
+
+        inline std::uint8_t precis_freeform_property(char32_t cp) noexcept
+        {
+            const unicode::range_value * r = find_range(unicode::precis_freeform, cp);
+            return r ? r->value : unicode::precis_disallowed;
+        }
+
+        // Non-ASCII members of General_Category Zs, mapped to U+0020 by the OpaqueString profile
+        inline bool is_non_ascii_space(char32_t cp) noexcept
+        {
+            return cp == 0xa0 || cp == 0x1680 || (cp >= 0x2000 && cp <= 0x200a) || cp == 0x202f || cp == 0x205f || cp == 0x3000;
+        }
+
+        // --- Normalization Form C (UAX #15) ---
+        namespace hangul
+        {
+            inline constexpr char32_t s_base = 0xac00, l_base = 0x1100, v_base = 0x1161, t_base = 0x11a7;
+            inline constexpr char32_t l_count = 19, v_count = 21, t_count = 28, n_count = v_count * t_count, s_count = l_count * n_count;
+        }
+
+        inline const unicode::decomposition * find_decomposition(char32_t cp) noexcept
+        {
+            if(cp < 0xc0)
+                return nullptr;
+            const unicode::decomposition * end = std::end(unicode::decompositions);
+            const unicode::decomposition * it = std::lower_bound(std::begin(unicode::decompositions), end, cp,
+                                                                 [](const unicode::decomposition & d, char32_t c) { return d.code_point < c; });
+            return (it != end && it->code_point == cp) ? it : nullptr;
+        }
+
+        // Writes the full canonical decomposition of cp to out (if not null) and returns its length
+        inline std::size_t decompose(char32_t cp, char32_t * out) noexcept
+        {
+            if(cp - hangul::s_base < hangul::s_count)
+            {
+                char32_t s_index = cp - hangul::s_base;
+                char32_t t = s_index % hangul::t_count;
+                if(out)
+                {
+                    out[0] = hangul::l_base + s_index / hangul::n_count;
+                    out[1] = hangul::v_base + (s_index % hangul::n_count) / hangul::t_count;
+                    if(t)
+                        out[2] = hangul::t_base + t;
+                }
+                return t ? 3 : 2;
+            }
+
+            const unicode::decomposition * d = find_decomposition(cp);
+            if(!d)
+            {
+                if(out)
+                    *out = cp;
+                return 1;
+            }
+
+            std::size_t length = decompose(d->first, out);
+            if(d->second)
+                length += decompose(d->second, out ? out + length : nullptr);
+            return length;
+        }
+
+        // Returns the primary composite of (first, second), or 0 if there is none
+        inline char32_t compose(char32_t first, char32_t second) noexcept
+        {
+            if(first - hangul::l_base < hangul::l_count && second - hangul::v_base < hangul::v_count)
+                return hangul::s_base + ((first - hangul::l_base) * hangul::v_count + (second - hangul::v_base)) * hangul::t_count;
+            if(first - hangul::s_base < hangul::s_count && (first - hangul::s_base) % hangul::t_count == 0
+               && second - hangul::t_base - 1 < hangul::t_count - 1)
+                return first + (second - hangul::t_base);
+
+            const unicode::composition * end = std::end(unicode::compositions);
+            const unicode::composition * it = std::lower_bound(std::begin(unicode::compositions), end, std::make_pair(first, second),
+                                                               [](const unicode::composition & c, const std::pair<char32_t, char32_t> & key)
+                                                               { return c.first < key.first || (c.first == key.first && c.second < key.second); });
+            return (it != end && it->first == first && it->second == second) ? it->composite : 0;
+        }
+
+        // Puts s into Normalization Form C, in place
+        inline void normalize_nfc(u32password & s)
+        {
+            std::size_t length = 0;
+            for(char32_t cp : s)
+                length += decompose(cp, nullptr);
+
+            u32password nfd(length, 0);
+            char32_t * out = nfd.data();
+            for(char32_t cp : s)
+                out += decompose(cp, out);
+
+            // Canonical ordering: stable sort of each run of non-starters by combining class
+            char32_t * d = nfd.data();
+            for(std::size_t i = 1; i < length; ++i)
+            {
+                std::uint8_t cc = combining_class(d[i]);
+                if(!cc)
+                    continue;
+                for(std::size_t j = i; j > 0; --j)
+                {
+                    std::uint8_t prev = combining_class(d[j-1]);
+                    if(!prev || prev <= cc)
+                        break;
+                    std::swap(d[j-1], d[j]);
+                }
+            }
+
+            // Canonical composition
+            if(length)
+            {
+                std::size_t starter = 0;
+                int last_class = combining_class(d[0]) ? 256 : 0;
+                std::size_t composed = 1;
+                for(std::size_t i = 1; i < length; ++i)
+                {
+                    char32_t cp = d[i];
+                    int cc = combining_class(cp);
+                    char32_t composite = compose(d[starter], cp);
+                    if(composite && (last_class < cc || last_class == 0))
+                    {
+                        d[starter] = composite;
+                        continue;
+                    }
+                    if(!cc)
+                        starter = composed;
+                    last_class = cc;
+                    d[composed++] = cp;
+                }
+                nfd.resize(composed);
+            }
+
+            s.swap(nfd);
+        }
+
+        // --- PRECIS contextual rules (RFC 5892 appendix A) ---
+        inline bool is_greek(char32_t cp) noexcept
+        {
+            return (cp >= 0x370 && cp <= 0x3ff && cp != 0x374 && cp != 0x37e && cp != 0x385 && cp != 0x387) || (cp >= 0x1f00 && cp <= 0x1fff);
+        }
+        inline bool is_hebrew(char32_t cp) noexcept
+        {
+            return (cp >= 0x591 && cp <= 0x5f4) || (cp >= 0xfb1d && cp <= 0xfb4f);
+        }
+        inline bool is_hiragana_katakana_han(char32_t cp) noexcept
+        {
+            return (cp >= 0x3041 && cp <= 0x309f) || (cp >= 0x30a0 && cp <= 0x30ff && cp != 0x30fb) || (cp >= 0x31f0 && cp <= 0x31ff)
+                || (cp >= 0xff66 && cp <= 0xff9d) || (cp >= 0x2e80 && cp <= 0x2fdf) || cp == 0x3005 || cp == 0x3007
+                || (cp >= 0x3021 && cp <= 0x3029) || (cp >= 0x3038 && cp <= 0x303b) || (cp >= 0x3400 && cp <= 0x4dbf)
+                || (cp >= 0x4e00 && cp <= 0x9fff) || (cp >= 0xf900 && cp <= 0xfaff) || (cp >= 0x20000 && cp <= 0x3134f);
+        }
+
+        // ZWNJ is only accepted after a virama: the joining-type alternative of its rule is not implemented
+        inline bool precis_context_allowed(const char32_t * s, std::size_t n, std::size_t i) noexcept
+        {
+            char32_t cp = s[i];
+            char32_t before = i ? s[i-1] : 0;
+            char32_t after = i + 1 < n ? s[i+1] : 0;
+
+            if(cp == 0x200c || cp == 0x200d)
+                return i && combining_class(before) == 9;
+            if(cp == 0xb7)
+                return before == 0x6c && after == 0x6c;
+            if(cp == 0x375)
+                return is_greek(after);
+            if(cp == 0x5f3 || cp == 0x5f4)
+                return is_hebrew(before);
+            if(cp == 0x30fb)
+                return std::any_of(s, s + n, is_hiragana_katakana_han);
+            if(cp >= 0x660 && cp <= 0x669)
+                return std::none_of(s, s + n, [](char32_t c) { return c >= 0x6f0 && c <= 0x6f9; });
+            if(cp >= 0x6f0 && cp <= 0x6f9)
+                return std::none_of(s, s + n, [](char32_t c) { return c >= 0x660 && c <= 0x669; });
+            return false;
+        }
+    }
+
+    template <typename Traits, typename Alloc>
+    bool is_valid_utf8(const basic_password<char, Traits, Alloc> & p) noexcept
+    {
+        return detail::utf8_count(reinterpret_cast<const unsigned char *>(p.data()), p.size()) != static_cast<std::size_t>(-1);
+    }
+
+    // Enforces the PRECIS OpaqueString profile on p, in place:
+    // non-ASCII spaces are mapped to U+0020, the result is put in NFC and checked against the FreeformClass.
+    // Throws std::invalid_argument if p is not valid UTF-8, is empty or contains a disallowed code point
+    // (p is left unchanged in that case).
+    template <typename Traits, typename Alloc>
+    void precis_opaque_string(basic_password<char, Traits, Alloc> & p)
+    {
+        const unsigned char * bytes = reinterpret_cast<const unsigned char *>(p.data());
+
+        if(p.empty())
+            throw std::invalid_argument("merl::precis_opaque_string(): Invalid argument -> Empty password");
+        if(detail::ascii_prefix(bytes, p.size(), true) == p.size())
+            return;
+
+        std::size_t count = detail::utf8_count(bytes, p.size());
+        if(count == static_cast<std::size_t>(-1))
+            throw std::invalid_argument("merl::precis_opaque_string(): Invalid argument -> Invalid UTF-8");
+
+        u32password code_points(count, 0);
+        for(std::size_t i = 0, k = 0; i < p.size(); ++k)
+        {
+            char32_t cp;
+            i += detail::utf8_decode_one(bytes, p.size(), i, cp);
+            code_points[k] = detail::is_non_ascii_space(cp) ? U' ' : cp;
+        }
+
+        detail::normalize_nfc(code_points);
+
+        const char32_t * s = code_points.data();
+        std::size_t length = 0;
+        for(std::size_t i = 0; i < code_points.size(); ++i)
+        {
+            std::uint8_t property = detail::precis_freeform_property(s[i]);
+            if(property == detail::unicode::precis_disallowed
+               || (property != detail::unicode::precis_valid && !detail::precis_context_allowed(s, code_points.size(), i)))
+                throw std::invalid_argument("merl::precis_opaque_string(): Invalid argument -> Disallowed code point");
+            length += detail::utf8_length(s[i]);
+        }
+
+        basic_password<char, Traits, Alloc> result(length, '\0', p.get_allocator());
+        char * out = result.data();
+        for(char32_t cp : code_points)
+            out = detail::utf8_encode_one(cp, out);
+        p.swap(result);
+    }
+}
+
+#endif // MERLIN_PASSWORD_UNICODE_HPP
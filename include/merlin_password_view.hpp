@@ -0,0 +1,471 @@
+#ifndef MERLIN_PASSWORD_VIEW_HPP
+#define MERLIN_PASSWORD_VIEW_HPP
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+// basic_password_view: a non-owning, read-only window onto (part of) a secret, for parsing and slicing without
+// copying plaintext to a new heap buffer. Obtained from basic_password::view(pos, count), never implicitly:
+// a view does not extend the lifetime of its owner, and it cannot be taken from a temporary basic_password.
+// The view itself never wipes anything; its characters belong to the owner, which does.
+
+namespace merl
+{
+    template <typename CharT, typename Traits = std::char_traits<CharT>, typename Alloc = std::allocator<CharT>>
+    class basic_password;
+
+    template <typename CharT, typename Traits = std::char_traits<CharT>>
+    class basic_password_view
+    {
+        public:
+            using traits_type = Traits;
+            using value_type = CharT;
+            using size_type = std::size_t;
+            using const_reference = const value_type &;
+            using const_pointer = const value_type *;
+            using const_iterator = const value_type *;
+            using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+            static const size_type npos = -1;
+
+        private:
+            const CharT * data_;
+            size_type size_;
+
+            constexpr size_type clamp(size_type pos, size_type count) const noexcept
+            {
+                return std::min(count, size_ - pos);
+            }
+
+        public:
+            // Constructors
+            constexpr basic_password_view() noexcept : data_{nullptr}, size_{0}
+            {}
+            constexpr basic_password_view(const CharT * p, size_type count) noexcept : data_{p}, size_{count}
+            {}
+            constexpr basic_password_view(const CharT * p) : data_{p}, size_{p ? Traits::length(p) : 0}
+            {}
+            basic_password_view(std::nullptr_t) = delete;
+            template <typename Alloc>
+            explicit basic_password_view(const basic_password<CharT, Traits, Alloc> & p) noexcept : data_{p.data()}, size_{p.size()}
+            {}
+            template <typename Alloc>
+            basic_password_view(const basic_password<CharT, Traits, Alloc> &&) = delete; // would dangle at the end of the full-expression
+
+            constexpr basic_password_view(const basic_password_view &) noexcept = default;
+            constexpr basic_password_view & operator=(const basic_password_view &) noexcept = default;
+
+            // Elements access
+            constexpr const_reference operator[](size_type pos) const
+            {
+                return data_[pos];
+            }
+            constexpr const_reference at(size_type pos) const
+            {
+                if(pos >= size_)
+                    throw std::out_of_range("merl::basic_password_view::at(): Out of range (pos = " + std::to_string(pos) + ", size = " + std::to_string(size_) + ')');
+
+                return data_[pos];
+            }
+            constexpr const_reference front() const
+            {
+                return data_[0];
+            }
+            constexpr const_reference back() const
+            {
+                return data_[size_-1];
+            }
+            // Not null-terminated in general
+            constexpr const_pointer data() const noexcept
+            {
+                return data_;
+            }
+
+            // Capacity
+            constexpr bool empty() const noexcept
+            {
+                return !size_;
+            }
+            constexpr size_type size() const noexcept
+            {
+                return size_;
+            }
+            constexpr size_type max_size() const noexcept
+            {
+                return std::numeric_limits<size_type>::max()-1;
+            }
+
+            // Iterators
+            constexpr const_iterator cbegin() const noexcept
+            {
+                return data_;
+            }
+            constexpr const_iterator begin() const noexcept
+            {
+                return data_;
+            }
+            constexpr const_iterator cend() const noexcept
+            {
+                return data_+size_;
+            }
+            constexpr const_iterator end() const noexcept
+            {
+                return data_+size_;
+            }
+            constexpr const_reverse_iterator crbegin() const noexcept
+            {
+                return const_reverse_iterator(end());
+            }
+            constexpr const_reverse_iterator rbegin() const noexcept
+            {
+                return const_reverse_iterator(end());
+            }
+            constexpr const_reverse_iterator crend() const noexcept
+            {
+                return const_reverse_iterator(begin());
+            }
+            constexpr const_reverse_iterator rend() const noexcept
+            {
+                return const_reverse_iterator(begin());
+            }
+
+            // Modifiers (of the window only)
+            constexpr void remove_prefix(size_type n)
+            {
+                data_ += n;
+                size_ -= n;
+            }
+            constexpr void remove_suffix(size_type n)
+            {
+                size_ -= n;
+            }
+            constexpr void swap(basic_password_view & other) noexcept
+            {
+                std::swap(data_, other.data_);
+                std::swap(size_, other.size_);
+            }
+
+            // Operations
+            constexpr size_type copy(CharT * dest, size_type count, size_type pos = 0) const
+            {
+                if(pos > size_)
+                    throw std::out_of_range("merl::basic_password_view::copy(): Out of range (position = " + std::to_string(pos) + ", size = " + std::to_string(size_) + ')');
+
+                count = clamp(pos, count);
+                Traits::copy(dest, data_ + pos, count);
+                return count;
+            }
+            constexpr basic_password_view view(size_type pos = 0, size_type count = npos) const
+            {
+                if(pos > size_)
+                    throw std::out_of_range("merl::basic_password_view::view(): Out of range (position = " + std::to_string(pos) + ", size = " + std::to_string(size_) + ')');
+
+                return basic_password_view(data_ + pos, clamp(pos, count));
+            }
+
+            constexpr int compare(basic_password_view v) const noexcept
+            {
+                int result = size_ && v.size_ ? Traits::compare(data_, v.data_, std::min(size_, v.size_)) : 0;
+
+                if(!result)
+                {
+                    if(size_ < v.size_)
+                        result = -1;
+                    else if(size_ > v.size_)
+                        result = 1;
+                }
+
+                return result;
+            }
+            constexpr int compare(size_type pos1, size_type count1, basic_password_view v) const
+            {
+                if(pos1 > size_)
+                    throw std::out_of_range("merl::basic_password_view::compare(): Out of range (position = " + std::to_string(pos1) + ", size = " + std::to_string(size_) + ')');
+
+                return view(pos1, count1).compare(v);
+            }
+            constexpr int compare(size_type pos1, size_type count1, basic_password_view v, size_type pos2, size_type count2 = npos) const
+            {
+                if(pos1 > size_)
+                    throw std::out_of_range("merl::basic_password_view::compare(): Out of range (position = " + std::to_string(pos1) + ", size = " + std::to_string(size_) + ')');
+                if(pos2 > v.size_)
+                    throw std::out_of_range("merl::basic_password_view::compare(): Out of range (position = " + std::to_string(pos2) + ", size = " + std::to_string(v.size_) + ')');
+
+                return view(pos1, count1).compare(v.view(pos2, count2));
+            }
+            constexpr int compare(const CharT * p) const
+            {
+                return compare(basic_password_view(p));
+            }
+            constexpr int compare(size_type pos1, size_type count1, const CharT * p) const
+            {
+                return compare(pos1, count1, basic_password_view(p));
+            }
+            constexpr int compare(size_type pos1, size_type count1, const CharT * p, size_type count2) const
+            {
+                return compare(pos1, count1, basic_password_view(p, count2));
+            }
+
+            constexpr bool starts_with(basic_password_view v) const noexcept
+            {
+                return size_ >= v.size_ && !basic_password_view(data_, v.size_).compare(v);
+            }
+            constexpr bool starts_with(CharT c) const noexcept
+            {
+                return size_ && Traits::eq(data_[0], c);
+            }
+            constexpr bool starts_with(const CharT * p) const
+            {
+                return starts_with(basic_password_view(p));
+            }
+            constexpr bool ends_with(basic_password_view v) const noexcept
+            {
+                return size_ >= v.size_ && !basic_password_view(data_ + size_ - v.size_, v.size_).compare(v);
+            }
+            constexpr bool ends_with(CharT c) const noexcept
+            {
+                return size_ && Traits::eq(data_[size_-1], c);
+            }
+            constexpr bool ends_with(const CharT * p) const
+            {
+                return ends_with(basic_password_view(p));
+            }
+
+            constexpr bool contains(basic_password_view v) const noexcept
+            {
+                return find(v) != npos;
+            }
+            constexpr bool contains(CharT c) const noexcept
+            {
+                return find(c) != npos;
+            }
+            constexpr bool contains(const CharT * p) const
+            {
+                return find(p) != npos;
+            }
+
+            // Search
+            constexpr size_type find(basic_password_view v, size_type pos = 0) const noexcept
+            {
+                return find(v.data_, pos, v.size_);
+            }
+            constexpr size_type find(const CharT * p, size_type pos, size_type count) const noexcept
+            {
+                if(pos > size_ || count > size_ - pos)
+                    return npos;
+                if(!count)
+                    return pos;
+
+                // Only positions where the first character matches are compared in full
+                const CharT * last = data_ + size_ - count + 1;
+                for(const CharT * it = data_ + pos; it < last; ++it)
+                {
+                    it = Traits::find(it, last - it, p[0]);
+                    if(!it)
+                        return npos;
+                    if(!Traits::compare(it + 1, p + 1, count - 1))
+                        return it - data_;
+                }
+
+                return npos;
+            }
+            constexpr size_type find(const CharT * p, size_type pos = 0) const
+            {
+                return find(p, pos, Traits::length(p));
+            }
+            constexpr size_type find(CharT c, size_type pos = 0) const noexcept
+            {
+                if(pos >= size_)
+                    return npos;
+
+                const CharT * it = Traits::find(data_ + pos, size_ - pos, c);
+                return it ? it - data_ : npos;
+            }
+
+            constexpr size_type rfind(basic_password_view v, size_type pos = npos) const noexcept
+            {
+                return rfind(v.data_, pos, v.size_);
+            }
+            constexpr size_type rfind(const CharT * p, size_type pos, size_type count) const noexcept
+            {
+                if(count > size_)
+                    return npos;
+
+                pos = std::min(pos, size_ - count);
+                for(size_type i = 0; i <= pos; ++i)
+                {
+                    if(!Traits::compare(data_ + pos - i, p, count))
+                        return pos - i;
+                }
+
+                return npos;
+            }
+            constexpr size_type rfind(const CharT * p, size_type pos = npos) const
+            {
+                return rfind(p, pos, Traits::length(p));
+            }
+            constexpr size_type rfind(CharT c, size_type pos = npos) const noexcept
+            {
+                if(!size_)
+                    return npos;
+                if(pos >= size_)
+                    pos = size_-1;
+
+                for(size_type i = 0; i <= pos; ++i)
+                {
+                    if(Traits::eq(data_[pos - i], c))
+                        return pos - i;
+                }
+                return npos;
+            }
+
+            constexpr size_type find_first_of(basic_password_view v, size_type pos = 0) const noexcept
+            {
+                return find_first_of(v.data_, pos, v.size_);
+            }
+            constexpr size_type find_first_of(const CharT * p, size_type pos, size_type count) const noexcept
+            {
+                for(size_type i = pos; i < size_; ++i)
+                {
+                    if(Traits::find(p, count, data_[i]))
+                        return i;
+                }
+                return npos;
+            }
+            constexpr size_type find_first_of(const CharT * p, size_type pos = 0) const
+            {
+                return find_first_of(p, pos, Traits::length(p));
+            }
+            constexpr size_type find_first_of(CharT c, size_type pos = 0) const noexcept
+            {
+                return find(c, pos);
+            }
+
+            constexpr size_type find_last_of(basic_password_view v, size_type pos = npos) const noexcept
+            {
+                return find_last_of(v.data_, pos, v.size_);
+            }
+            constexpr size_type find_last_of(const CharT * p, size_type pos, size_type count) const noexcept
+            {
+                if(!size_ || !count)
+                    return npos;
+                if(pos >= size_)
+                    pos = size_-1;
+
+                for(size_type i = 0; i <= pos; ++i)
+                {
+                    if(Traits::find(p, count, data_[pos - i]))
+                        return pos - i;
+                }
+                return npos;
+            }
+            constexpr size_type find_last_of(const CharT * p, size_type pos = npos) const
+            {
+                return find_last_of(p, pos, Traits::length(p));
+            }
+            constexpr size_type find_last_of(CharT c, size_type pos = npos) const noexcept
+            {
+                return rfind(c, pos);
+            }
+
+            constexpr size_type find_first_not_of(basic_password_view v, size_type pos = 0) const noexcept
+            {
+                return find_first_not_of(v.data_, pos, v.size_);
+            }
+            constexpr size_type find_first_not_of(const CharT * p, size_type pos, size_type count) const noexcept
+            {
+                for(size_type i = pos; i < size_; ++i)
+                {
+                    if(!Traits::find(p, count, data_[i]))
+                        return i;
+                }
+                return npos;
+            }
+            constexpr size_type find_first_not_of(const CharT * p, size_type pos = 0) const
+            {
+                return find_first_not_of(p, pos, Traits::length(p));
+            }
+            constexpr size_type find_first_not_of(CharT c, size_type pos = 0) const noexcept
+            {
+                return find_first_not_of(&c, pos, 1);
+            }
+
+            constexpr size_type find_last_not_of(basic_password_view v, size_type pos = npos) const noexcept
+            {
+                return find_last_not_of(v.data_, pos, v.size_);
+            }
+            constexpr size_type find_last_not_of(const CharT * p, size_type pos, size_type count) const noexcept
+            {
+                if(!size_)
+                    return npos;
+                if(pos >= size_)
+                    pos = size_-1;
+
+                for(size_type i = 0; i <= pos; ++i)
+                {
+                    if(!Traits::find(p, count, data_[pos - i]))
+                        return pos - i;
+                }
+                return npos;
+            }
+            constexpr size_type find_last_not_of(const CharT * p, size_type pos = npos) const
+            {
+                return find_last_not_of(p, pos, Traits::length(p));
+            }
+            constexpr size_type find_last_not_of(CharT c, size_type pos = npos) const noexcept
+            {
+                return find_last_not_of(&c, pos, 1);
+            }
+    };
+
+    // Non-member functions
+    template <typename CharT, typename Traits>
+    constexpr bool operator==(basic_password_view<CharT, Traits> lhs, basic_password_view<CharT, Traits> rhs) noexcept
+    {
+        return lhs.size() == rhs.size() && !lhs.compare(rhs);
+    }
+    template <typename CharT, typename Traits>
+    constexpr bool operator==(basic_password_view<CharT, Traits> lhs, const CharT * rhs)
+    {
+        return !lhs.compare(rhs);
+    }
+    template <typename CharT, typename Traits>
+    constexpr Traits::comparison_category operator<=>(basic_password_view<CharT, Traits> lhs, basic_password_view<CharT, Traits> rhs) noexcept
+    {
+        int result = lhs.compare(rhs);
+
+        if(result < 0)
+            return Traits::comparison_category::less;
+
+        if(result > 0)
+            return Traits::comparison_category::greater;
+
+        return Traits::comparison_category::equal;
+    }
+    template <typename CharT, typename Traits>
+    constexpr Traits::comparison_category operator<=>(basic_password_view<CharT, Traits> lhs, const CharT * rhs)
+    {
+        return lhs <=> basic_password_view<CharT, Traits>(rhs);
+    }
+
+    template <typename CharT, typename Traits>
+    constexpr void swap(basic_password_view<CharT, Traits> & lhs, basic_password_view<CharT, Traits> & rhs) noexcept
+    {
+        lhs.swap(rhs);
+    }
+
+    using password_view = basic_password_view<char>;
+    using wpassword_view = basic_password_view<wchar_t>;
+    using u8password_view = basic_password_view<char8_t>;
+    using u16password_view = basic_password_view<char16_t>;
+    using u32password_view = basic_password_view<char32_t>;
+}
+
+#endif // MERLIN_PASSWORD_VIEW_HPP
@@ -0,0 +1,716 @@
+#ifndef MERLIN_PBKDF2_HPP
+#define MERLIN_PBKDF2_HPP
+
+#include <merlin_basic_password.hpp>
+#include <merlin_detail.hpp>
+#include <merlin_sha2.hpp>
+
+#include <stdexcept>
+
+// PBKDF2-HMAC-SHA256 / PBKDF2-HMAC-SHA512 (RFC 8018) over basic_password.
+// A pbkdf2_*_key holds the HMAC inner and outer states of one password, so the key blocks are hashed once
+// no matter how many derivations use it. pbkdf2_batch() spreads the output blocks of many derivations
+// over independent SIMD lanes: 16 (AVX-512) or 8 (AVX2) for SHA-256, 8 (AVX-512) or 4 (AVX2) for SHA-512.
+// Without wide lanes, or with a single block left, the one-lane path uses the SHA-256 extensions when available.
+
+namespace merl
+{
+    namespace detail
+    {
+        // Hashes the last bytes of a message (data, then up to 16 extra bytes) whose first prefix bytes are already in state
+        template <typename Spec>
+        void sha2_finish(typename Spec::word_type * state, std::uint64_t prefix, const unsigned char * data, std::size_t n,
+                         const unsigned char * extra, std::size_t extra_n, unsigned char * digest) noexcept
+        {
+            using word_type = typename Spec::word_type;
+            constexpr std::size_t block_size = 16 * sizeof(word_type);
+
+            std::size_t whole = n / block_size * block_size;
+            if(whole)
+                Spec::blocks(state, data, n / block_size);
+
+            unsigned char block[3 * block_size] = {};
+            std::size_t rest = n - whole;
+            if(rest)
+                std::memcpy(block, data + whole, rest);
+            if(extra_n)
+                std::memcpy(block + rest, extra, extra_n);
+            rest += extra_n;
+            block[rest] = 0x80;
+
+            std::size_t length = (rest + 1 + 2 * sizeof(word_type) + block_size - 1) / block_size * block_size;
+            std::uint64_t total = prefix + n + extra_n;
+            store_be<std::uint64_t>(block + length - 8, total << 3);
+            if constexpr(sizeof(word_type) == 8)
+                store_be<std::uint64_t>(block + length - 16, total >> 61);
+            Spec::blocks(state, block, length / block_size);
+
+            for(std::size_t i = 0; i < Spec::digest_size / sizeof(word_type); ++i)
+                store_be<word_type>(digest + i * sizeof(word_type), state[i]);
+            secure_zero(block, sizeof(block));
+        }
+
+        // HMAC inner / outer states after absorbing (key ^ ipad) and (key ^ opad)
+        template <typename Spec>
+        struct hmac_state
+        {
+            using word_type = typename Spec::word_type;
+            static constexpr std::size_t block_size = 16 * sizeof(word_type);
+
+            word_type inner[8];
+            word_type outer[8];
+
+            hmac_state(const void * key, std::size_t n) noexcept
+            {
+                unsigned char block[block_size] = {};
+                if(n > block_size)
+                    basic_sha2<Spec>::hash(key, n, block);
+                else if(n)
+                    std::memcpy(block, key, n);
+
+                for(unsigned char & b : block)
+                    b ^= 0x36;
+                std::memcpy(inner, Spec::iv, sizeof(inner));
+                Spec::blocks(inner, block, 1);
+
+                for(unsigned char & b : block)
+                    b ^= 0x36 ^ 0x5c;
+                std::memcpy(outer, Spec::iv, sizeof(outer));
+                Spec::blocks(outer, block, 1);
+
+                secure_zero(block, sizeof(block));
+            }
+            hmac_state(const hmac_state &) noexcept = default;
+            hmac_state & operator=(const hmac_state &) noexcept = default;
+            ~hmac_state()
+            {
+                secure_zero(this, sizeof(*this));
+            }
+
+            // HMAC of (data, then up to 16 extra bytes)
+            void mac(const void * data, std::size_t n, const unsigned char * extra, std::size_t extra_n, unsigned char * out) const noexcept
+            {
+                word_type state[8];
+                unsigned char digest[Spec::digest_size];
+
+                std::memcpy(state, inner, sizeof(state));
+                sha2_finish<Spec>(state, block_size, static_cast<const unsigned char *>(data), n, extra, extra_n, digest);
+                std::memcpy(state, outer, sizeof(state));
+                sha2_finish<Spec>(state, block_size, digest, Spec::digest_size, nullptr, 0, out);
+
+                secure_zero(state, sizeof(state));
+                secure_zero(digest, sizeof(digest));
+            }
+        };
+
+        // --- PBKDF2 iteration kernels ---
+        // Each kernel runs count iterations U = HMAC(P, U), T ^= U on its lanes. All lane arrays are word-major
+        // (word i of lane l at [i * lanes + l]) and hold the digest words in host order.
+
+        // One lane through the regular block function, so the SHA-256 extensions are used when present
+        template <typename Spec>
+        void pbkdf2_iterate_x1(const typename Spec::word_type * inner, const typename Spec::word_type * outer,
+                               typename Spec::word_type * u, typename Spec::word_type * t, std::uint32_t count) noexcept
+        {
+            using word_type = typename Spec::word_type;
+            constexpr std::size_t block_size = 16 * sizeof(word_type);
+            constexpr std::size_t words = Spec::digest_size / sizeof(word_type);
+
+            unsigned char block[block_size] = {};
+            block[Spec::digest_size] = 0x80;
+            store_be<std::uint64_t>(block + block_size - 8, (block_size + Spec::digest_size) * 8);
+
+            word_type state[8];
+            for(std::size_t i = 0; i < words; ++i)
+                store_be<word_type>(block + i * sizeof(word_type), u[i]);
+            for(; count; --count)
+            {
+                std::memcpy(state, inner, sizeof(state));
+                Spec::blocks(state, block, 1);
+                for(std::size_t i = 0; i < words; ++i)
+                    store_be<word_type>(block + i * sizeof(word_type), state[i]);
+
+                std::memcpy(state, outer, sizeof(state));
+                Spec::blocks(state, block, 1);
+                for(std::size_t i = 0; i < words; ++i)
+                {
+                    store_be<word_type>(block + i * sizeof(word_type), state[i]);
+                    t[i] ^= state[i];
+                }
+            }
+            std::memcpy(u, state, words * sizeof(word_type));
+
+            secure_zero(block, sizeof(block));
+            secure_zero(state, sizeof(state));
+        }
+
+#if MERLIN_X86_SIMD
+        // --- SHA-256, 8 lanes (AVX2) ---
+        MERLIN_TARGET("avx2")
+        inline void sha256_compress_x8_avx2(__m256i * s, __m256i * w) noexcept
+        {
+            __m256i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+#if defined(__GNUC__)
+            #pragma GCC unroll 64
+#endif
+            for(int t = 0; t < 64; ++t)
+            {
+                if(t >= 16)
+                {
+                    __m256i w15 = w[(t - 15) % 16], w2 = w[(t - 2) % 16];
+                    __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(rotr32_avx2<7>(w15), rotr32_avx2<18>(w15)), _mm256_srli_epi32(w15, 3));
+                    __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(rotr32_avx2<17>(w2), rotr32_avx2<19>(w2)), _mm256_srli_epi32(w2, 10));
+                    w[t % 16] = _mm256_add_epi32(_mm256_add_epi32(w[t % 16], s0), _mm256_add_epi32(w[(t - 7) % 16], s1));
+                }
+                __m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+                __m256i maj = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));
+                __m256i t1 = _mm256_add_epi32(_mm256_add_epi32(h, _mm256_xor_si256(_mm256_xor_si256(rotr32_avx2<6>(e), rotr32_avx2<11>(e)), rotr32_avx2<25>(e))),
+                                              _mm256_add_epi32(_mm256_add_epi32(ch, w[t % 16]), _mm256_set1_epi32(static_cast<int>(sha256_k[t]))));
+                __m256i t2 = _mm256_add_epi32(_mm256_xor_si256(_mm256_xor_si256(rotr32_avx2<2>(a), rotr32_avx2<13>(a)), rotr32_avx2<22>(a)), maj);
+                h = g; g = f; f = e; e = _mm256_add_epi32(d, t1);
+                d = c; c = b; b = a; a = _mm256_add_epi32(t1, t2);
+            }
+            s[0] = _mm256_add_epi32(s[0], a); s[1] = _mm256_add_epi32(s[1], b);
+            s[2] = _mm256_add_epi32(s[2], c); s[3] = _mm256_add_epi32(s[3], d);
+            s[4] = _mm256_add_epi32(s[4], e); s[5] = _mm256_add_epi32(s[5], f);
+            s[6] = _mm256_add_epi32(s[6], g); s[7] = _mm256_add_epi32(s[7], h);
+        }
+        MERLIN_TARGET("avx2")
+        inline void pbkdf2_sha256_x8_avx2(const std::uint32_t * inner, const std::uint32_t * outer,
+                                          std::uint32_t * u, std::uint32_t * t, std::uint32_t count) noexcept
+        {
+            __m256i s[8], w[16], acc[8];
+            for(int i = 0; i < 8; ++i)
+            {
+                s[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(u + 8*i));
+                acc[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(t + 8*i));
+            }
+            for(; count; --count)
+            {
+                for(int pass = 0; pass < 2; ++pass)
+                {
+                    const std::uint32_t * key = pass ? outer : inner;
+                    for(int i = 0; i < 8; ++i)
+                    {
+                        w[i] = s[i];
+                        s[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(key + 8*i));
+                    }
+                    w[8] = _mm256_set1_epi32(static_cast<int>(0x80000000u));
+                    for(int i = 9; i < 15; ++i)
+                        w[i] = _mm256_setzero_si256();
+                    w[15] = _mm256_set1_epi32((64 + 32) * 8);
+                    sha256_compress_x8_avx2(s, w);
+                }
+                for(int i = 0; i < 8; ++i)
+                    acc[i] = _mm256_xor_si256(acc[i], s[i]);
+            }
+            for(int i = 0; i < 8; ++i)
+            {
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(u + 8*i), s[i]);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(t + 8*i), acc[i]);
+            }
+            for(__m256i & v : w)
+                v = _mm256_setzero_si256();
+        }
+
+        // --- SHA-512, 4 lanes (AVX2) ---
+        MERLIN_TARGET("avx2")
+        inline void sha512_compress_x4_avx2(__m256i * s, __m256i * w) noexcept
+        {
+            __m256i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+#if defined(__GNUC__)
+            #pragma GCC unroll 80
+#endif
+            for(int t = 0; t < 80; ++t)
+            {
+                if(t >= 16)
+                {
+                    __m256i w15 = w[(t - 15) % 16], w2 = w[(t - 2) % 16];
+                    __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(rotr64_avx2<1>(w15), rotr64_avx2<8>(w15)), _mm256_srli_epi64(w15, 7));
+                    __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(rotr64_avx2<19>(w2), rotr64_avx2<61>(w2)), _mm256_srli_epi64(w2, 6));
+                    w[t % 16] = _mm256_add_epi64(_mm256_add_epi64(w[t % 16], s0), _mm256_add_epi64(w[(t - 7) % 16], s1));
+                }
+                __m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+                __m256i maj = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));
+                __m256i t1 = _mm256_add_epi64(_mm256_add_epi64(h, _mm256_xor_si256(_mm256_xor_si256(rotr64_avx2<14>(e), rotr64_avx2<18>(e)), rotr64_avx2<41>(e))),
+                                              _mm256_add_epi64(_mm256_add_epi64(ch, w[t % 16]), _mm256_set1_epi64x(static_cast<long long>(sha512_k[t]))));
+                __m256i t2 = _mm256_add_epi64(_mm256_xor_si256(_mm256_xor_si256(rotr64_avx2<28>(a), rotr64_avx2<34>(a)), rotr64_avx2<39>(a)), maj);
+                h = g; g = f; f = e; e = _mm256_add_epi64(d, t1);
+                d = c; c = b; b = a; a = _mm256_add_epi64(t1, t2);
+            }
+            s[0] = _mm256_add_epi64(s[0], a); s[1] = _mm256_add_epi64(s[1], b);
+            s[2] = _mm256_add_epi64(s[2], c); s[3] = _mm256_add_epi64(s[3], d);
+            s[4] = _mm256_add_epi64(s[4], e); s[5] = _mm256_add_epi64(s[5], f);
+            s[6] = _mm256_add_epi64(s[6], g); s[7] = _mm256_add_epi64(s[7], h);
+        }
+        MERLIN_TARGET("avx2")
+        inline void pbkdf2_sha512_x4_avx2(const std::uint64_t * inner, const std::uint64_t * outer,
+                                          std::uint64_t * u, std::uint64_t * t, std::uint32_t count) noexcept
+        {
+            __m256i s[8], w[16], acc[8];
+            for(int i = 0; i < 8; ++i)
+            {
+                s[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(u + 4*i));
+                acc[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(t + 4*i));
+            }
+            for(; count; --count)
+            {
+                for(int pass = 0; pass < 2; ++pass)
+                {
+                    const std::uint64_t * key = pass ? outer : inner;
+                    for(int i = 0; i < 8; ++i)
+                    {
+                        w[i] = s[i];
+                        s[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(key + 4*i));
+                    }
+                    w[8] = _mm256_set1_epi64x(static_cast<long long>(0x8000000000000000ull));
+                    for(int i = 9; i < 15; ++i)
+                        w[i] = _mm256_setzero_si256();
+                    w[15] = _mm256_set1_epi64x((128 + 64) * 8);
+                    sha512_compress_x4_avx2(s, w);
+                }
+                for(int i = 0; i < 8; ++i)
+                    acc[i] = _mm256_xor_si256(acc[i], s[i]);
+            }
+            for(int i = 0; i < 8; ++i)
+            {
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(u + 4*i), s[i]);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(t + 4*i), acc[i]);
+            }
+            for(__m256i & v : w)
+                v = _mm256_setzero_si256();
+        }
+
+        // --- SHA-256, 16 lanes and SHA-512, 8 lanes (AVX-512: native rotates, three-input logic) ---
+        MERLIN_TARGET("avx512f")
+        inline void sha256_compress_x16_avx512(__m512i * s, __m512i * w) noexcept
+        {
+            __m512i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+#if defined(__GNUC__)
+            #pragma GCC unroll 64
+#endif
+            for(int t = 0; t < 64; ++t)
+            {
+                if(t >= 16)
+                {
+                    __m512i w15 = w[(t - 15) % 16], w2 = w[(t - 2) % 16];
+                    __m512i s0 = _mm512_ternarylogic_epi32(rotr32_avx512<7>(w15), rotr32_avx512<18>(w15), shr32_avx512<3>(w15), 0x96);
+                    __m512i s1 = _mm512_ternarylogic_epi32(rotr32_avx512<17>(w2), rotr32_avx512<19>(w2), shr32_avx512<10>(w2), 0x96);
+                    w[t % 16] = _mm512_add_epi32(_mm512_add_epi32(w[t % 16], s0), _mm512_add_epi32(w[(t - 7) % 16], s1));
+                }
+                __m512i ch = _mm512_ternarylogic_epi32(e, f, g, 0xca);
+                __m512i maj = _mm512_ternarylogic_epi32(a, b, c, 0xe8);
+                __m512i t1 = _mm512_add_epi32(_mm512_add_epi32(h, _mm512_ternarylogic_epi32(rotr32_avx512<6>(e), rotr32_avx512<11>(e), rotr32_avx512<25>(e), 0x96)),
+                                              _mm512_add_epi32(_mm512_add_epi32(ch, w[t % 16]), _mm512_set1_epi32(static_cast<int>(sha256_k[t]))));
+                __m512i t2 = _mm512_add_epi32(_mm512_ternarylogic_epi32(rotr32_avx512<2>(a), rotr32_avx512<13>(a), rotr32_avx512<22>(a), 0x96), maj);
+                h = g; g = f; f = e; e = _mm512_add_epi32(d, t1);
+                d = c; c = b; b = a; a = _mm512_add_epi32(t1, t2);
+            }
+            s[0] = _mm512_add_epi32(s[0], a); s[1] = _mm512_add_epi32(s[1], b);
+            s[2] = _mm512_add_epi32(s[2], c); s[3] = _mm512_add_epi32(s[3], d);
+            s[4] = _mm512_add_epi32(s[4], e); s[5] = _mm512_add_epi32(s[5], f);
+            s[6] = _mm512_add_epi32(s[6], g); s[7] = _mm512_add_epi32(s[7], h);
+        }
+        MERLIN_TARGET("avx512f")
+        inline void pbkdf2_sha256_x16_avx512(const std::uint32_t * inner, const std::uint32_t * outer,
+                                             std::uint32_t * u, std::uint32_t * t, std::uint32_t count) noexcept
+        {
+            __m512i s[8], w[16], acc[8];
+            for(int i = 0; i < 8; ++i)
+            {
+                s[i] = _mm512_loadu_si512(u + 16*i);
+                acc[i] = _mm512_loadu_si512(t + 16*i);
+            }
+            for(; count; --count)
+            {
+                for(int pass = 0; pass < 2; ++pass)
+                {
+                    const std::uint32_t * key = pass ? outer : inner;
+                    for(int i = 0; i < 8; ++i)
+                    {
+                        w[i] = s[i];
+                        s[i] = _mm512_loadu_si512(key + 16*i);
+                    }
+                    w[8] = _mm512_set1_epi32(static_cast<int>(0x80000000u));
+                    for(int i = 9; i < 15; ++i)
+                        w[i] = _mm512_setzero_si512();
+                    w[15] = _mm512_set1_epi32((64 + 32) * 8);
+                    sha256_compress_x16_avx512(s, w);
+                }
+                for(int i = 0; i < 8; ++i)
+                    acc[i] = _mm512_xor_si512(acc[i], s[i]);
+            }
+            for(int i = 0; i < 8; ++i)
+            {
+                _mm512_storeu_si512(u + 16*i, s[i]);
+                _mm512_storeu_si512(t + 16*i, acc[i]);
+            }
+            for(__m512i & v : w)
+                v = _mm512_setzero_si512();
+        }
+        MERLIN_TARGET("avx512f")
+        inline void sha512_compress_x8_avx512(__m512i * s, __m512i * w) noexcept
+        {
+            __m512i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+#if defined(__GNUC__)
+            #pragma GCC unroll 80
+#endif
+            for(int t = 0; t < 80; ++t)
+            {
+                if(t >= 16)
+                {
+                    __m512i w15 = w[(t - 15) % 16], w2 = w[(t - 2) % 16];
+                    __m512i s0 = _mm512_ternarylogic_epi64(rotr64_avx512<1>(w15), rotr64_avx512<8>(w15), shr64_avx512<7>(w15), 0x96);
+                    __m512i s1 = _mm512_ternarylogic_epi64(rotr64_avx512<19>(w2), rotr64_avx512<61>(w2), shr64_avx512<6>(w2), 0x96);
+                    w[t % 16] = _mm512_add_epi64(_mm512_add_epi64(w[t % 16], s0), _mm512_add_epi64(w[(t - 7) % 16], s1));
+                }
+                __m512i ch = _mm512_ternarylogic_epi64(e, f, g, 0xca);
+                __m512i maj = _mm512_ternarylogic_epi64(a, b, c, 0xe8);
+                __m512i t1 = _mm512_add_epi64(_mm512_add_epi64(h, _mm512_ternarylogic_epi64(rotr64_avx512<14>(e), rotr64_avx512<18>(e), rotr64_avx512<41>(e), 0x96)),
+                                              _mm512_add_epi64(_mm512_add_epi64(ch, w[t % 16]), _mm512_set1_epi64(static_cast<long long>(sha512_k[t]))));
+                __m512i t2 = _mm512_add_epi64(_mm512_ternarylogic_epi64(rotr64_avx512<28>(a), rotr64_avx512<34>(a), rotr64_avx512<39>(a), 0x96), maj);
+                h = g; g = f; f = e; e = _mm512_add_epi64(d, t1);
+                d = c; c = b; b = a; a = _mm512_add_epi64(t1, t2);
+            }
+            s[0] = _mm512_add_epi64(s[0], a); s[1] = _mm512_add_epi64(s[1], b);
+            s[2] = _mm512_add_epi64(s[2], c); s[3] = _mm512_add_epi64(s[3], d);
+            s[4] = _mm512_add_epi64(s[4], e); s[5] = _mm512_add_epi64(s[5], f);
+            s[6] = _mm512_add_epi64(s[6], g); s[7] = _mm512_add_epi64(s[7], h);
+        }
+        MERLIN_TARGET("avx512f")
+        inline void pbkdf2_sha512_x8_avx512(const std::uint64_t * inner, const std::uint64_t * outer,
+                                            std::uint64_t * u, std::uint64_t * t, std::uint32_t count) noexcept
+        {
+            __m512i s[8], w[16], acc[8];
+            for(int i = 0; i < 8; ++i)
+            {
+                s[i] = _mm512_loadu_si512(u + 8*i);
+                acc[i] = _mm512_loadu_si512(t + 8*i);
+            }
+            for(; count; --count)
+            {
+                for(int pass = 0; pass < 2; ++pass)
+                {
+                    const std::uint64_t * key = pass ? outer : inner;
+                    for(int i = 0; i < 8; ++i)
+                    {
+                        w[i] = s[i];
+                        s[i] = _mm512_loadu_si512(key + 8*i);
+                    }
+                    w[8] = _mm512_set1_epi64(static_cast<long long>(0x8000000000000000ull));
+                    for(int i = 9; i < 15; ++i)
+                        w[i] = _mm512_setzero_si512();
+                    w[15] = _mm512_set1_epi64((128 + 64) * 8);
+                    sha512_compress_x8_avx512(s, w);
+                }
+                for(int i = 0; i < 8; ++i)
+                    acc[i] = _mm512_xor_si512(acc[i], s[i]);
+            }
+            for(int i = 0; i < 8; ++i)
+            {
+                _mm512_storeu_si512(u + 8*i, s[i]);
+                _mm512_storeu_si512(t + 8*i, acc[i]);
+            }
+            for(__m512i & v : w)
+                v = _mm512_setzero_si512();
+        }
+#endif
+
+        template <typename Spec>
+        struct pbkdf2_lanes;
+
+        template <>
+        struct pbkdf2_lanes<sha256_spec>
+        {
+            static constexpr std::size_t max_width = 16;
+
+            static std::size_t width() noexcept
+            {
+#if MERLIN_X86_SIMD
+                if(cpu().avx512f)
+                    return 16;
+                if(cpu().avx2)
+                    return 8;
+#endif
+                return 1;
+            }
+            static void iterate([[maybe_unused]] std::size_t width, const std::uint32_t * inner, const std::uint32_t * outer,
+                                std::uint32_t * u, std::uint32_t * t, std::uint32_t count) noexcept
+            {
+#if MERLIN_X86_SIMD
+                if(width == 16)
+                    return pbkdf2_sha256_x16_avx512(inner, outer, u, t, count);
+                if(width == 8)
+                    return pbkdf2_sha256_x8_avx2(inner, outer, u, t, count);
+#endif
+                pbkdf2_iterate_x1<sha256_spec>(inner, outer, u, t, count);
+            }
+        };
+        template <>
+        struct pbkdf2_lanes<sha512_spec>
+        {
+            static constexpr std::size_t max_width = 8;
+
+            static std::size_t width() noexcept
+            {
+#if MERLIN_X86_SIMD
+                if(cpu().avx512f)
+                    return 8;
+                if(cpu().avx2)
+                    return 4;
+#endif
+                return 1;
+            }
+            static void iterate([[maybe_unused]] std::size_t width, const std::uint64_t * inner, const std::uint64_t * outer,
+                                std::uint64_t * u, std::uint64_t * t, std::uint32_t count) noexcept
+            {
+#if MERLIN_X86_SIMD
+                if(width == 8)
+                    return pbkdf2_sha512_x8_avx512(inner, outer, u, t, count);
+                if(width == 4)
+                    return pbkdf2_sha512_x4_avx2(inner, outer, u, t, count);
+#endif
+                pbkdf2_iterate_x1<sha512_spec>(inner, outer, u, t, count);
+            }
+        };
+    }
+
+    namespace detail
+    {
+        template <typename Spec>
+        struct pbkdf2_runner;
+    }
+
+    // The HMAC states of one password, reusable for any number of derivations
+    template <typename Spec>
+    class basic_pbkdf2_key
+    {
+        public:
+            template <typename CharT, typename Traits, typename Alloc>
+            explicit basic_pbkdf2_key(const basic_password<CharT, Traits, Alloc> & password) noexcept
+                : state_(password.data(), password.size() * sizeof(CharT))
+            {}
+            template <typename CharT, typename Traits>
+            explicit basic_pbkdf2_key(basic_password_view<CharT, Traits> password) noexcept
+                : state_(password.data(), password.size() * sizeof(CharT))
+            {}
+            basic_pbkdf2_key(const void * key, std::size_t n) noexcept
+                : state_(key, n)
+            {}
+
+            // Derives out_size bytes into out
+            void derive(const void * salt, std::size_t salt_size, std::uint32_t iterations, unsigned char * out, std::size_t out_size) const;
+
+        private:
+            template <typename S>
+            friend struct detail::pbkdf2_runner;
+
+            detail::hmac_state<Spec> state_;
+    };
+
+    using pbkdf2_sha256_key = basic_pbkdf2_key<detail::sha256_spec>;
+    using pbkdf2_sha512_key = basic_pbkdf2_key<detail::sha512_spec>;
+
+    // One derivation of a batch
+    template <typename Spec>
+    struct basic_pbkdf2_request
+    {
+        const basic_pbkdf2_key<Spec> * key;
+        const void * salt;
+        std::size_t salt_size;
+        std::uint32_t iterations;
+        unsigned char * out;
+        std::size_t out_size;
+    };
+
+    using pbkdf2_sha256_request = basic_pbkdf2_request<detail::sha256_spec>;
+    using pbkdf2_sha512_request = basic_pbkdf2_request<detail::sha512_spec>;
+
+    namespace detail
+    {
+        template <typename Spec>
+        struct pbkdf2_runner
+        {
+            using word_type = typename Spec::word_type;
+            using lanes = pbkdf2_lanes<Spec>;
+
+            static constexpr std::size_t words = Spec::digest_size / sizeof(word_type);
+            static constexpr std::size_t max_width = lanes::max_width;
+
+            static void check(const basic_pbkdf2_request<Spec> & r)
+            {
+                if(!r.key || (!r.salt && r.salt_size) || !r.out)
+                    throw std::invalid_argument("merl::pbkdf2(): Invalid argument -> Null pointer");
+                if(!r.iterations)
+                    throw std::invalid_argument("merl::pbkdf2(): Invalid argument -> Iteration count must be positive");
+                if(!r.out_size || (r.out_size - 1) / Spec::digest_size >= 0xffffffffu)
+                    throw std::length_error("merl::pbkdf2(): Length error -> Derived key length out of range");
+            }
+
+            // Block `index` (1-based) of a request: its U1 and T, then the remaining iterations on the lanes
+            static void first_iteration(const basic_pbkdf2_request<Spec> & r, std::uint32_t index, word_type * u, word_type * t, std::size_t stride) noexcept
+            {
+                unsigned char counter[4] = {static_cast<unsigned char>(index >> 24), static_cast<unsigned char>(index >> 16),
+                                            static_cast<unsigned char>(index >> 8), static_cast<unsigned char>(index)};
+                unsigned char digest[Spec::digest_size];
+                r.key->state_.mac(r.salt, r.salt_size, counter, 4, digest);
+                for(std::size_t i = 0; i < words; ++i)
+                    u[i * stride] = t[i * stride] = load_be<word_type>(digest + i * sizeof(word_type));
+                secure_zero(digest, sizeof(digest));
+            }
+            static void store_block(const basic_pbkdf2_request<Spec> & r, std::uint32_t index, const word_type * t, std::size_t stride) noexcept
+            {
+                unsigned char digest[Spec::digest_size];
+                for(std::size_t i = 0; i < words; ++i)
+                    store_be<word_type>(digest + i * sizeof(word_type), t[i * stride]);
+
+                std::size_t offset = static_cast<std::size_t>(index - 1) * Spec::digest_size;
+                std::size_t n = r.out_size - offset < Spec::digest_size ? r.out_size - offset : Spec::digest_size;
+                std::memcpy(r.out + offset, digest, n);
+                secure_zero(digest, sizeof(digest));
+            }
+
+            static void run(const basic_pbkdf2_request<Spec> * requests, std::size_t count)
+            {
+                for(std::size_t i = 0; i < count; ++i)
+                    check(requests[i]);
+
+                const std::size_t width = lanes::width();
+
+                // Lane state, word-major; lanes without work compute garbage that is never read
+                alignas(64) word_type inner[8 * max_width] = {};
+                alignas(64) word_type outer[8 * max_width] = {};
+                alignas(64) word_type u[8 * max_width] = {};
+                alignas(64) word_type t[8 * max_width] = {};
+                std::size_t request[max_width];
+                std::uint32_t index[max_width];
+                std::uint32_t remaining[max_width] = {};
+                bool active[max_width] = {};
+
+                // Output blocks are handed out in order: (request, block index)
+                std::size_t next_request = 0;
+                std::uint32_t next_index = 1;
+                auto take = [&](std::size_t & r, std::uint32_t & i)
+                {
+                    if(next_request == count)
+                        return false;
+                    r = next_request;
+                    i = next_index;
+                    if(static_cast<std::size_t>(next_index) * Spec::digest_size >= requests[next_request].out_size)
+                    {
+                        ++next_request;
+                        next_index = 1;
+                    }
+                    else
+                        ++next_index;
+                    return true;
+                };
+
+                for(;;)
+                {
+                    std::size_t busy = 0;
+                    for(std::size_t l = 0; l < width; ++l)
+                    {
+                        while(!active[l] && take(request[l], index[l]))
+                        {
+                            const basic_pbkdf2_request<Spec> & r = requests[request[l]];
+                            first_iteration(r, index[l], u + l, t + l, width);
+                            if(r.iterations == 1)
+                            {
+                                store_block(r, index[l], t + l, width);
+                                continue;
+                            }
+                            for(std::size_t i = 0; i < 8; ++i)
+                            {
+                                inner[i * width + l] = r.key->state_.inner[i];
+                                outer[i * width + l] = r.key->state_.outer[i];
+                            }
+                            remaining[l] = r.iterations - 1;
+                            active[l] = true;
+                        }
+                        busy += active[l];
+                    }
+                    if(!busy)
+                        break;
+
+                    if(busy == 1 && width > 1)
+                    {
+                        // A lone block runs faster on the one-lane path than with idle lanes
+                        std::size_t l = 0;
+                        while(!active[l])
+                            ++l;
+                        word_type in1[8], out1[8], u1[8], t1[8];
+                        for(std::size_t i = 0; i < 8; ++i)
+                        {
+                            in1[i] = inner[i * width + l];
+                            out1[i] = outer[i * width + l];
+                            u1[i] = u[i * width + l];
+                            t1[i] = t[i * width + l];
+                        }
+                        pbkdf2_iterate_x1<Spec>(in1, out1, u1, t1, remaining[l]);
+                        store_block(requests[request[l]], index[l], t1, 1);
+                        active[l] = false;
+                        secure_zero(in1, sizeof(in1));
+                        secure_zero(out1, sizeof(out1));
+                        secure_zero(u1, sizeof(u1));
+                        secure_zero(t1, sizeof(t1));
+                        continue;
+                    }
+
+                    std::uint32_t step = 0xffffffffu;
+                    for(std::size_t l = 0; l < width; ++l)
+                        if(active[l] && remaining[l] < step)
+                            step = remaining[l];
+
+                    lanes::iterate(width, inner, outer, u, t, step);
+
+                    for(std::size_t l = 0; l < width; ++l)
+                    {
+                        if(!active[l])
+                            continue;
+                        remaining[l] -= step;
+                        if(!remaining[l])
+                        {
+                            store_block(requests[request[l]], index[l], t + l, width);
+                            active[l] = false;
+                        }
+                    }
+                }
+
+                secure_zero(inner, sizeof(inner));
+                secure_zero(outer, sizeof(outer));
+                secure_zero(u, sizeof(u));
+                secure_zero(t, sizeof(t));
+            }
+        };
+    }
+
+    template <typename Spec>
+    void basic_pbkdf2_key<Spec>::derive(const void * salt, std::size_t salt_size, std::uint32_t iterations, unsigned char * out, std::size_t out_size) const
+    {
+        basic_pbkdf2_request<Spec> request{this, salt, salt_size, iterations, out, out_size};
+        detail::pbkdf2_runner<Spec>::run(&request, 1);
+    }
+
+    // Runs every request, filling the SIMD lanes with output blocks from as many requests as are available
+    template <typename Spec>
+    void pbkdf2_batch(const basic_pbkdf2_request<Spec> * requests, std::size_t count)
+    {
+        detail::pbkdf2_runner<Spec>::run(requests, count);
+    }
+
+    template <typename CharT, typename Traits, typename Alloc>
+    void pbkdf2_hmac_sha256(const basic_password<CharT, Traits, Alloc> & password, const void * salt, std::size_t salt_size,
+                            std::uint32_t iterations, unsigned char * out, std::size_t out_size)
+    {
+        pbkdf2_sha256_key(password).derive(salt, salt_size, iterations, out, out_size);
+    }
+    template <typename CharT, typename Traits, typename Alloc>
+    void pbkdf2_hmac_sha512(const basic_password<CharT, Traits, Alloc> & password, const void * salt, std::size_t salt_size,
+                            std::uint32_t iterations, unsigned char * out, std::size_t out_size)
+    {
+        pbkdf2_sha512_key(password).derive(salt, salt_size, iterations, out, out_size);
+    }
+}
+
+#endif // MERLIN_PBKDF2_HPP
@@ -0,0 +1,416 @@
+#ifndef MERLIN_SCRYPT_HPP
+#define MERLIN_SCRYPT_HPP
+
+#include <merlin_basic_password.hpp>
+#include <merlin_detail.hpp>
+#include <merlin_password_codecs.hpp>
+#include <merlin_pbkdf2.hpp>
+#include <merlin_secure_allocator.hpp>
+#include <merlin_siphash.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// scrypt (RFC 7914) over basic_password: the PBKDF2-HMAC-SHA256 steps read the password in place.
+// The p lanes of ROMix are spread over worker threads, BlockMix runs on SSE2 (AVX-512VL rotates when available), and the V arrays
+// of all workers live in one locked, non-dumpable mapping that is wiped before it is released.
+// PHC strings ($scrypt$ln=...,r=...,p=...$salt$hash) are handled like the Argon2id ones.
+
+namespace merl
+{
+    namespace detail
+    {
+        // b = b + Salsa20/8(b), words in natural order
+        inline void salsa20_8_scalar(std::uint32_t * b) noexcept
+        {
+            std::uint32_t x[16];
+            std::memcpy(x, b, sizeof(x));
+            for(int i = 0; i < 8; i += 2)
+            {
+                x[4] ^= rotl32(x[0] + x[12], 7);   x[8] ^= rotl32(x[4] + x[0], 9);
+                x[12] ^= rotl32(x[8] + x[4], 13);  x[0] ^= rotl32(x[12] + x[8], 18);
+                x[9] ^= rotl32(x[5] + x[1], 7);    x[13] ^= rotl32(x[9] + x[5], 9);
+                x[1] ^= rotl32(x[13] + x[9], 13);  x[5] ^= rotl32(x[1] + x[13], 18);
+                x[14] ^= rotl32(x[10] + x[6], 7);  x[2] ^= rotl32(x[14] + x[10], 9);
+                x[6] ^= rotl32(x[2] + x[14], 13);  x[10] ^= rotl32(x[6] + x[2], 18);
+                x[3] ^= rotl32(x[15] + x[11], 7);  x[7] ^= rotl32(x[3] + x[15], 9);
+                x[11] ^= rotl32(x[7] + x[3], 13);  x[15] ^= rotl32(x[11] + x[7], 18);
+
+                x[1] ^= rotl32(x[0] + x[3], 7);    x[2] ^= rotl32(x[1] + x[0], 9);
+                x[3] ^= rotl32(x[2] + x[1], 13);   x[0] ^= rotl32(x[3] + x[2], 18);
+                x[6] ^= rotl32(x[5] + x[4], 7);    x[7] ^= rotl32(x[6] + x[5], 9);
+                x[4] ^= rotl32(x[7] + x[6], 13);   x[5] ^= rotl32(x[4] + x[7], 18);
+                x[11] ^= rotl32(x[10] + x[9], 7);  x[8] ^= rotl32(x[11] + x[10], 9);
+                x[9] ^= rotl32(x[8] + x[11], 13);  x[10] ^= rotl32(x[9] + x[8], 18);
+                x[12] ^= rotl32(x[15] + x[14], 7); x[13] ^= rotl32(x[12] + x[15], 9);
+                x[14] ^= rotl32(x[13] + x[12], 13); x[15] ^= rotl32(x[14] + x[13], 18);
+            }
+            for(int i = 0; i < 16; ++i)
+                b[i] += x[i];
+            secure_zero(x, sizeof(x));
+        }
+
+        // out = BlockMix(in ^ v), or BlockMix(in) when v is null; 2r 64-byte blocks of 16 words
+        inline void scrypt_blockmix_scalar(const std::uint32_t * in, const std::uint32_t * v, std::uint32_t * out, std::uint32_t r) noexcept
+        {
+            std::uint32_t x[16];
+            const std::size_t last = (2 * std::size_t{r} - 1) * 16;
+            for(int k = 0; k < 16; ++k)
+                x[k] = v ? in[last + k] ^ v[last + k] : in[last + k];
+            for(std::size_t i = 0; i < 2 * std::size_t{r}; ++i)
+            {
+                for(int k = 0; k < 16; ++k)
+                    x[k] ^= v ? in[16*i + k] ^ v[16*i + k] : in[16*i + k];
+                salsa20_8_scalar(x);
+                std::memcpy(out + 16 * (i / 2 + (i & 1) * r), x, sizeof(x));
+            }
+            secure_zero(x, sizeof(x));
+        }
+
+        // ROMix of one 128r-byte lane b, with v holding n * 128r bytes and xy 256r bytes of scratch
+        inline void scrypt_romix_scalar(unsigned char * b, void * v_memory, void * xy, std::uint64_t n, std::uint32_t r) noexcept
+        {
+            const std::size_t words = 32 * std::size_t{r};
+            std::uint32_t * v = static_cast<std::uint32_t *>(v_memory);
+            std::uint32_t * x = static_cast<std::uint32_t *>(xy);
+            std::uint32_t * y = x + words;
+            for(std::size_t k = 0; k < words; ++k)
+                x[k] = load_le32(b + 4*k);
+
+            // BlockMix writes each V[i + 1] in place rather than into X followed by a copy
+            std::memcpy(v, x, 4 * words);
+            for(std::uint64_t i = 0; i + 1 < n; ++i)
+                scrypt_blockmix_scalar(v + i * words, nullptr, v + (i + 1) * words, r);
+            scrypt_blockmix_scalar(v + (n - 1) * words, nullptr, x, r);
+            for(std::uint64_t i = 0; i < n; ++i)
+            {
+                // Integerify: the first 64 bits of the last block
+                std::uint64_t j = (x[words - 16] | std::uint64_t{x[words - 15]} << 32) & (n - 1);
+                scrypt_blockmix_scalar(x, v + j * words, y, r);
+                std::swap(x, y);
+            }
+
+            for(std::size_t k = 0; k < words; ++k)
+                store_le32(b + 4*k, x[k]);
+        }
+
+#if MERLIN_X86_SIMD && (defined(__x86_64__) || defined(__SSE2__))
+        // SSE2 is part of the baseline here, so the SIMD kernel carries no target attribute and is forced inline into
+        // its entry points: compiled inside the AVX-512VL one, every shift/shift/or rotate becomes a single vprold.
+
+        // Salsa20/8 on the diagonals: position i of each 64-byte block holds word 5i mod 16, so that b0..b3 are
+        // (x0 x5 x10 x15) (x4 x9 x14 x3) (x8 x13 x2 x7) (x12 x1 x6 x11) and every quarter-round step is one vector operation
+        __attribute__((always_inline))
+        inline void salsa20_8_simd(__m128i & b0, __m128i & b1, __m128i & b2, __m128i & b3) noexcept
+        {
+            __m128i x0 = b0, x1 = b1, x2 = b2, x3 = b3;
+            for(int i = 0; i < 8; i += 2)
+            {
+                __m128i t;
+                t = _mm_add_epi32(x0, x3);
+                x1 = _mm_xor_si128(x1, _mm_or_si128(_mm_slli_epi32(t, 7), _mm_srli_epi32(t, 25)));
+                t = _mm_add_epi32(x1, x0);
+                x2 = _mm_xor_si128(x2, _mm_or_si128(_mm_slli_epi32(t, 9), _mm_srli_epi32(t, 23)));
+                t = _mm_add_epi32(x2, x1);
+                x3 = _mm_xor_si128(x3, _mm_or_si128(_mm_slli_epi32(t, 13), _mm_srli_epi32(t, 19)));
+                t = _mm_add_epi32(x3, x2);
+                x0 = _mm_xor_si128(x0, _mm_or_si128(_mm_slli_epi32(t, 18), _mm_srli_epi32(t, 14)));
+
+                x1 = _mm_shuffle_epi32(x1, 0x93);
+                x2 = _mm_shuffle_epi32(x2, 0x4e);
+                x3 = _mm_shuffle_epi32(x3, 0x39);
+
+                t = _mm_add_epi32(x0, x1);
+                x3 = _mm_xor_si128(x3, _mm_or_si128(_mm_slli_epi32(t, 7), _mm_srli_epi32(t, 25)));
+                t = _mm_add_epi32(x3, x0);
+                x2 = _mm_xor_si128(x2, _mm_or_si128(_mm_slli_epi32(t, 9), _mm_srli_epi32(t, 23)));
+                t = _mm_add_epi32(x2, x3);
+                x1 = _mm_xor_si128(x1, _mm_or_si128(_mm_slli_epi32(t, 13), _mm_srli_epi32(t, 19)));
+                t = _mm_add_epi32(x1, x2);
+                x0 = _mm_xor_si128(x0, _mm_or_si128(_mm_slli_epi32(t, 18), _mm_srli_epi32(t, 14)));
+
+                x1 = _mm_shuffle_epi32(x1, 0x39);
+                x2 = _mm_shuffle_epi32(x2, 0x4e);
+                x3 = _mm_shuffle_epi32(x3, 0x93);
+            }
+            b0 = _mm_add_epi32(b0, x0);
+            b1 = _mm_add_epi32(b1, x1);
+            b2 = _mm_add_epi32(b2, x2);
+            b3 = _mm_add_epi32(b3, x3);
+        }
+
+        template <bool Xor>
+        __attribute__((always_inline))
+        inline void scrypt_blockmix_simd(const __m128i * in, const __m128i * v, __m128i * out, std::uint32_t r) noexcept
+        {
+            const std::size_t last = (2 * std::size_t{r} - 1) * 4;
+            __m128i x0 = _mm_load_si128(in + last), x1 = _mm_load_si128(in + last + 1);
+            __m128i x2 = _mm_load_si128(in + last + 2), x3 = _mm_load_si128(in + last + 3);
+            if constexpr(Xor)
+            {
+                x0 = _mm_xor_si128(x0, _mm_load_si128(v + last));
+                x1 = _mm_xor_si128(x1, _mm_load_si128(v + last + 1));
+                x2 = _mm_xor_si128(x2, _mm_load_si128(v + last + 2));
+                x3 = _mm_xor_si128(x3, _mm_load_si128(v + last + 3));
+            }
+            for(std::size_t i = 0; i < 2 * std::size_t{r}; ++i)
+            {
+                x0 = _mm_xor_si128(x0, _mm_load_si128(in + 4*i));
+                x1 = _mm_xor_si128(x1, _mm_load_si128(in + 4*i + 1));
+                x2 = _mm_xor_si128(x2, _mm_load_si128(in + 4*i + 2));
+                x3 = _mm_xor_si128(x3, _mm_load_si128(in + 4*i + 3));
+                if constexpr(Xor)
+                {
+                    x0 = _mm_xor_si128(x0, _mm_load_si128(v + 4*i));
+                    x1 = _mm_xor_si128(x1, _mm_load_si128(v + 4*i + 1));
+                    x2 = _mm_xor_si128(x2, _mm_load_si128(v + 4*i + 2));
+                    x3 = _mm_xor_si128(x3, _mm_load_si128(v + 4*i + 3));
+                }
+                salsa20_8_simd(x0, x1, x2, x3);
+                __m128i * o = out + 4 * (i / 2 + (i & 1) * r);
+                _mm_store_si128(o, x0);
+                _mm_store_si128(o + 1, x1);
+                _mm_store_si128(o + 2, x2);
+                _mm_store_si128(o + 3, x3);
+            }
+        }
+
+        // Same contract as scrypt_romix_scalar; v and xy must be 16-byte aligned
+        __attribute__((always_inline))
+        inline void scrypt_romix_simd(unsigned char * b, void * v_memory, void * xy, std::uint64_t n, std::uint32_t r) noexcept
+        {
+            const std::size_t words = 32 * std::size_t{r};
+            const std::size_t vectors = words / 4;
+            __m128i * v = static_cast<__m128i *>(v_memory);
+            __m128i * x = static_cast<__m128i *>(xy);
+            __m128i * y = x + vectors;
+
+            std::uint32_t * xw = reinterpret_cast<std::uint32_t *>(x);
+            for(std::size_t k = 0; k < words; k += 16)
+                for(std::size_t i = 0; i < 16; ++i)
+                    xw[k + i] = load_le32(b + 4 * (k + i * 5 % 16));
+
+            std::memcpy(v, x, 4 * words);
+            for(std::uint64_t i = 0; i + 1 < n; ++i)
+                scrypt_blockmix_simd<false>(v + i * vectors, nullptr, v + (i + 1) * vectors, r);
+            scrypt_blockmix_simd<false>(v + (n - 1) * vectors, nullptr, x, r);
+            for(std::uint64_t i = 0; i < n; ++i)
+            {
+                // Words 0 and 1 of the last block sit at positions 0 and 13
+                const std::uint32_t * last = reinterpret_cast<const std::uint32_t *>(x + vectors - 4);
+                std::uint64_t j = (last[0] | std::uint64_t{last[13]} << 32) & (n - 1);
+                scrypt_blockmix_simd<true>(x, v + j * vectors, y, r);
+                std::swap(x, y);
+            }
+
+            xw = reinterpret_cast<std::uint32_t *>(x);
+            for(std::size_t k = 0; k < words; k += 16)
+                for(std::size_t i = 0; i < 16; ++i)
+                    store_le32(b + 4 * (k + i * 5 % 16), xw[k + i]);
+        }
+
+        inline void scrypt_romix_sse2(unsigned char * b, void * v, void * xy, std::uint64_t n, std::uint32_t r) noexcept
+        {
+            scrypt_romix_simd(b, v, xy, n, r);
+        }
+        MERLIN_TARGET("avx512f,avx512vl")
+        inline void scrypt_romix_avx512(unsigned char * b, void * v, void * xy, std::uint64_t n, std::uint32_t r) noexcept
+        {
+            scrypt_romix_simd(b, v, xy, n, r);
+        }
+#endif
+
+        using scrypt_romix_function = void (*)(unsigned char *, void *, void *, std::uint64_t, std::uint32_t) noexcept;
+
+        inline scrypt_romix_function scrypt_select_romix() noexcept
+        {
+#if MERLIN_X86_SIMD && (defined(__x86_64__) || defined(__SSE2__))
+            if(cpu().avx512vl)
+                return scrypt_romix_avx512;
+            return scrypt_romix_sse2;
+#else
+            return scrypt_romix_scalar;
+#endif
+        }
+
+        inline void check_scrypt_params(std::uint64_t n, std::uint32_t r, std::uint32_t p, const void * salt, std::size_t salt_size,
+                                        const unsigned char * out, std::size_t out_size)
+        {
+            if(n < 2 || (n & (n - 1)))
+                throw std::invalid_argument("merl::scrypt(): Invalid argument -> N must be a power of 2 greater than 1");
+            if(!r || !p || std::uint64_t{r} * p >= (std::uint64_t{1} << 30))
+                throw std::invalid_argument("merl::scrypt(): Invalid argument -> r and p must be non-zero with r * p < 2^30");
+            if(r < 4 && n >> (16 * r))
+                throw std::invalid_argument("merl::scrypt(): Invalid argument -> N must be less than 2^(16 * r)");
+            if((!salt && salt_size) || !out || !out_size)
+                throw std::invalid_argument("merl::scrypt(): Invalid argument -> Null salt or empty output");
+            if(n > std::numeric_limits<std::size_t>::max() / (128 * std::size_t{r}) - 2)
+                throw std::length_error("merl::scrypt(): Length error -> N * r exceeds the address space");
+        }
+
+        inline void scrypt_hash(const pbkdf2_sha256_key & key, const void * salt, std::size_t salt_size, std::uint64_t n,
+                                std::uint32_t r, std::uint32_t p, unsigned char * out, std::size_t out_size, std::uint32_t threads)
+        {
+            check_scrypt_params(n, r, p, salt, salt_size, out, out_size);
+
+            std::uint32_t workers = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+            workers = std::min(workers, p);
+
+            // [B: p lanes][per worker: V (n blocks of 128r), X and Y (128r each)]
+            const std::size_t lane_size = 128 * std::size_t{r};
+            const std::size_t worker_size = lane_size * (static_cast<std::size_t>(n) + 2);
+            if(worker_size > (std::numeric_limits<std::size_t>::max() - std::size_t{p} * lane_size) / workers)
+                throw std::length_error("merl::scrypt(): Length error -> N * r exceeds the address space");
+            struct memory_guard
+            {
+                locked_region region;
+                ~memory_guard()
+                {
+                    unmap_locked_region(region);
+                }
+            } memory{map_locked_region(std::size_t{p} * lane_size + workers * worker_size, true, true)};
+            unsigned char * b = static_cast<unsigned char *>(memory.region.p);
+            unsigned char * scratch = b + std::size_t{p} * lane_size;
+
+            key.derive(salt, salt_size, 1, b, std::size_t{p} * lane_size);
+
+            scrypt_romix_function romix = scrypt_select_romix();
+            auto work = [=](std::uint32_t first)
+            {
+                unsigned char * v = scratch + first * worker_size;
+                for(std::uint32_t lane = first; lane < p; lane += workers)
+                    romix(b + lane * lane_size, v, v + static_cast<std::size_t>(n) * lane_size, n, r);
+            };
+            if(workers == 1)
+                work(0);
+            else
+            {
+                std::vector<std::jthread> pool;
+                pool.reserve(workers - 1);
+                for(std::uint32_t w = 1; w < workers; ++w)
+                    pool.emplace_back(work, w);
+                work(0);
+            }
+
+            key.derive(b, std::size_t{p} * lane_size, 1, out, out_size);
+        }
+    }
+
+    // Raw scrypt: writes out_size bytes to out. threads = 0 runs one thread per lane (capped at the hardware concurrency).
+    template <typename CharT, typename Traits, typename Alloc>
+    void scrypt(const basic_password<CharT, Traits, Alloc> & password, const void * salt, std::size_t salt_size, std::uint64_t n, std::uint32_t r,
+                std::uint32_t p, unsigned char * out, std::size_t out_size, std::uint32_t threads = 0)
+    {
+        detail::scrypt_hash(pbkdf2_sha256_key(password), salt, salt_size, n, r, p, out, out_size, threads);
+    }
+
+    // --- PHC string format ---
+    struct scrypt_phc
+    {
+        static constexpr std::size_t max_salt_size = 64;
+        static constexpr std::size_t max_hash_size = 64;
+        // "$scrypt$ln=63,r=4294967295,p=4294967295$" plus two unpadded base64 fields of 64 bytes and a separator
+        static constexpr std::size_t max_encoded_size = 40 + 86 + 1 + 86;
+
+        std::uint32_t log2_n = 15;
+        std::uint32_t r = 8;
+        std::uint32_t p = 1;
+        unsigned char salt[max_salt_size];
+        std::size_t salt_size = 0;
+        unsigned char hash[max_hash_size];
+        std::size_t hash_size = 0;
+
+        ~scrypt_phc()
+        {
+            detail::secure_zero(hash, sizeof(hash));
+        }
+    };
+
+    // Upper bound on the memory scrypt_verify() lets a PHC string, which may come from an untrusted store, ask for:
+    // 128 r N p bytes (the V arrays of all lanes, which also bounds the work), checked before scrypt() runs
+    struct scrypt_verify_limits
+    {
+        std::uint32_t max_memory_kib = 1048576; // 1 GiB
+    };
+
+    // Writes the PHC string of phc to out (no terminator) and returns its length; throws if it does not fit
+    inline std::size_t scrypt_encode(const scrypt_phc & phc, char * out, std::size_t size)
+    {
+        if(phc.salt_size > scrypt_phc::max_salt_size || phc.hash_size > scrypt_phc::max_hash_size || phc.log2_n > 63)
+            throw std::invalid_argument("merl::scrypt_encode(): Invalid argument -> Salt or hash longer than 64 bytes, or ln above 63");
+
+        char buffer[scrypt_phc::max_encoded_size];
+        char * p = detail::phc_put(buffer, "$scrypt$ln=");
+        p = detail::phc_put_number(p, phc.log2_n);
+        p = detail::phc_put(p, ",r=");
+        p = detail::phc_put_number(p, phc.r);
+        p = detail::phc_put(p, ",p=");
+        p = detail::phc_put_number(p, phc.p);
+        p = detail::phc_put(p, "$");
+        p = detail::phc_put_base64(p, phc.salt, phc.salt_size);
+        p = detail::phc_put(p, "$");
+        p = detail::phc_put_base64(p, phc.hash, phc.hash_size);
+
+        std::size_t length = static_cast<std::size_t>(p - buffer);
+        if(length > size)
+            throw std::length_error("merl::scrypt_encode(): Length error -> Output buffer too small");
+        std::memcpy(out, buffer, length);
+        return length;
+    }
+
+    // Parses a $scrypt$ PHC string into phc; the output length is the length of the hash field
+    inline void scrypt_decode(std::string_view s, scrypt_phc & phc)
+    {
+        if(!detail::phc_take(s, "$scrypt$ln=") || !detail::phc_take_number(s, phc.log2_n) || phc.log2_n > 63
+           || !detail::phc_take(s, ",r=") || !detail::phc_take_number(s, phc.r)
+           || !detail::phc_take(s, ",p=") || !detail::phc_take_number(s, phc.p)
+           || !detail::phc_take(s, "$") || !detail::phc_take_base64(s, phc.salt, scrypt_phc::max_salt_size, phc.salt_size)
+           || !detail::phc_take(s, "$") || !detail::phc_take_base64(s, phc.hash, scrypt_phc::max_hash_size, phc.hash_size)
+           || !s.empty())
+            throw std::invalid_argument("merl::scrypt_decode(): Invalid argument -> Malformed PHC string");
+    }
+
+    // Hashes password under salt with N = 2^log2_n and writes the PHC string (32-byte hash) to out; returns its length
+    template <typename CharT, typename Traits, typename Alloc>
+    std::size_t scrypt_hash_encoded(const basic_password<CharT, Traits, Alloc> & password, const void * salt, std::size_t salt_size,
+                                    std::uint32_t log2_n, std::uint32_t r, std::uint32_t p, char * out, std::size_t size)
+    {
+        if(salt_size > scrypt_phc::max_salt_size || log2_n > 63)
+            throw std::invalid_argument("merl::scrypt_hash_encoded(): Invalid argument -> Salt longer than 64 bytes or ln above 63");
+
+        scrypt_phc phc;
+        phc.log2_n = log2_n;
+        phc.r = r;
+        phc.p = p;
+        std::memcpy(phc.salt, salt, salt_size);
+        phc.salt_size = salt_size;
+        phc.hash_size = 32;
+        scrypt(password, salt, salt_size, std::uint64_t{1} << log2_n, r, p, phc.hash, phc.hash_size);
+        return scrypt_encode(phc, out, size);
+    }
+
+    // Recomputes the hash described by a PHC string and compares it in constant time; throws if it needs more memory than limits allow
+    template <typename CharT, typename Traits, typename Alloc>
+    bool scrypt_verify(const basic_password<CharT, Traits, Alloc> & password, std::string_view encoded, std::uint32_t threads = 0,
+                       const scrypt_verify_limits & limits = {})
+    {
+        scrypt_phc phc;
+        scrypt_decode(encoded, phc);
+
+        // r p N <= max_memory_kib * 1024 / 128, without forming 128 r N p (which overflows 64 bits)
+        std::uint64_t max_rpn = std::uint64_t{limits.max_memory_kib} * 8;
+        if(std::uint64_t{phc.r} * phc.p > (max_rpn >> phc.log2_n))
+            throw std::invalid_argument("merl::scrypt_verify(): Invalid argument -> Parameters exceed the verification limits");
+
+        unsigned char computed[scrypt_phc::max_hash_size];
+        scrypt(password, phc.salt, phc.salt_size, std::uint64_t{1} << phc.log2_n, phc.r, phc.p, computed, phc.hash_size, threads);
+        bool equal = detail::ct_equal(computed, phc.hash, phc.hash_size);
+        detail::secure_zero(computed, sizeof(computed));
+        return equal;
+    }
+}
+
+#endif // MERLIN_SCRYPT_HPP
@@ -0,0 +1,128 @@
+#ifndef MERLIN_SECURE_ALLOCATOR_HPP
+#define MERLIN_SECURE_ALLOCATOR_HPP
+
+#include <merlin_detail.hpp>
+
+#include <limits>
+#include <new>
+#include <type_traits>
+
+#if __has_include(<sys/mman.h>) && __has_include(<unistd.h>)
+    #define MERLIN_HAS_MMAN 1
+    #include <sys/mman.h>
+    #include <unistd.h>
+#else
+    #define MERLIN_HAS_MMAN 0
+#endif
+
+// Standard allocator that wipes every block before releasing it. Blocks are aligned to at least a cache line,
+// so secret data never shares a line with unrelated objects and SIMD kernels can use aligned accesses.
+// Large work areas (KDF memory) are mapped directly instead, so they can be locked in RAM and kept out of core dumps.
+
+namespace merl
+{
+    namespace detail
+    {
+        struct locked_region
+        {
+            void * p;
+            std::size_t size;   // mapped size, size rounded up to the page size
+            bool huge_pages;    // backed by hugetlb pages, or transparent huge pages were requested for it
+            bool locked;        // mlock succeeded
+        };
+
+        // Maps size bytes of zeroed, faulted-in memory; throws std::bad_alloc. Locking is best effort, see locked_region::locked.
+        inline locked_region map_locked_region(std::size_t size, bool huge_pages, bool lock)
+        {
+#if MERLIN_HAS_MMAN
+            constexpr std::size_t huge_page_size = std::size_t{2} << 20;
+            locked_region r{MAP_FAILED, 0, huge_pages, false};
+    #if defined(MAP_HUGETLB)
+            // Explicit huge pages only exist if the administrator reserved some (vm.nr_hugepages)
+            if(huge_pages && size >= huge_page_size)
+            {
+                r.size = (size + huge_page_size - 1) / huge_page_size * huge_page_size;
+                r.p = ::mmap(nullptr, r.size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0);
+            }
+    #endif
+            if(r.p == MAP_FAILED)
+            {
+                std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+                r.size = (size + page - 1) / page * page;
+                r.p = ::mmap(nullptr, r.size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if(r.p == MAP_FAILED)
+                    throw std::bad_alloc();
+    #if defined(MADV_HUGEPAGE)
+                // Must come before the first touch for the faults to be served with huge pages
+                if(!huge_pages || size < huge_page_size || ::madvise(r.p, r.size, MADV_HUGEPAGE) != 0)
+                    r.huge_pages = false;
+    #else
+                r.huge_pages = false;
+    #endif
+            }
+    #if defined(MADV_DONTDUMP)
+            ::madvise(r.p, r.size, MADV_DONTDUMP);
+    #endif
+            // mlock faults every page in; without it the pages are touched here rather than by the first user
+            r.locked = lock && ::mlock(r.p, r.size) == 0;
+            if(!r.locked)
+                std::memset(r.p, 0, r.size);
+            return r;
+#else
+            (void)lock;
+            (void)huge_pages;
+            void * p = ::operator new(size, std::align_val_t{64});
+            std::memset(p, 0, size);
+            return locked_region{p, size, false, false};
+#endif
+        }
+
+        // Wipes and unmaps a region from map_locked_region()
+        inline void unmap_locked_region(const locked_region & r) noexcept
+        {
+            secure_zero(r.p, r.size);
+#if MERLIN_HAS_MMAN
+            if(r.locked)
+                ::munlock(r.p, r.size);
+            ::munmap(r.p, r.size);
+#else
+            ::operator delete(r.p, r.size, std::align_val_t{64});
+#endif
+        }
+    }
+
+    template <typename T>
+    class secure_allocator
+    {
+        public:
+            using value_type = T;
+            using is_always_equal = std::true_type;
+
+            static constexpr std::size_t alignment = alignof(T) > 64 ? alignof(T) : 64;
+
+            secure_allocator() noexcept = default;
+            template <typename U>
+            secure_allocator(const secure_allocator<U> &) noexcept
+            {}
+
+            T * allocate(std::size_t n)
+            {
+                if(n > std::numeric_limits<std::size_t>::max() / sizeof(T))
+                    throw std::bad_array_new_length();
+                return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t{alignment}));
+            }
+            void deallocate(T * p, std::size_t n) noexcept
+            {
+                detail::secure_zero(p, n * sizeof(T));
+                ::operator delete(p, n * sizeof(T), std::align_val_t{alignment});
+            }
+
+            template <typename U>
+            bool operator==(const secure_allocator<U> &) const noexcept
+            {
+                return true;
+            }
+    };
+}
+
+#endif // MERLIN_SECURE_ALLOCATOR_HPP
@@ -0,0 +1,128 @@
+#ifndef MERLIN_SECURE_ARENA_HPP
+#define MERLIN_SECURE_ARENA_HPP
+
+#include <merlin_detail.hpp>
+#include <merlin_secure_allocator.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+// secure_arena: a std::pmr::memory_resource for short-lived secrets, e.g. everything one authentication request
+// derives. Allocations bump a cursor through a locked region (see map_locked_region), so a dozen temporaries cost
+// no trips to the heap; a block is wiped as soon as it is deallocated, and the most recent one is reclaimed.
+// When a region runs out, a region twice as large is mapped. Destroying the arena wipes and unmaps every
+// region at once, so declare it before the objects that use it:
+//
+//     merl::secure_arena arena;
+//     merl::pmr::password pwd(input, &arena);
+//
+// Mapping and locking a region costs a few system calls, so a server should keep one arena per worker and
+// release() it between requests rather than build a new one each time.
+// Like std::pmr::monotonic_buffer_resource, an arena is meant for one thread at a time.
+
+namespace merl
+{
+    class secure_arena : public std::pmr::memory_resource
+    {
+        public:
+            explicit secure_arena(std::size_t initial_size = 4096, bool lock_memory = true) : lock_memory_{lock_memory}
+            {
+                if(!initial_size)
+                    throw std::invalid_argument("merl::secure_arena::secure_arena(): Invalid argument -> Empty arena");
+
+                add_region(initial_size);
+            }
+            secure_arena(const secure_arena &) = delete;
+            secure_arena & operator=(const secure_arena &) = delete;
+            ~secure_arena()
+            {
+                for(const detail::locked_region & region : regions_)
+                    detail::unmap_locked_region(region);
+            }
+
+            // Wipes everything handed out so far and starts over in the largest region; the others are unmapped
+            void release() noexcept
+            {
+                detail::locked_region last = regions_.back();
+                regions_.pop_back();
+                for(const detail::locked_region & region : regions_)
+                    detail::unmap_locked_region(region);
+                regions_.assign(1, last);
+
+                std::byte * begin = static_cast<std::byte *>(last.p);
+                detail::secure_zero(begin, cursor_ - begin);
+                cursor_ = begin;
+            }
+
+            // Bytes mapped over all regions
+            std::size_t capacity() const noexcept
+            {
+                std::size_t total = 0;
+                for(const detail::locked_region & region : regions_)
+                    total += region.size;
+                return total;
+            }
+            // Bytes left in the current region
+            std::size_t available() const noexcept
+            {
+                return end_ - cursor_;
+            }
+            // Whether every region could be locked in RAM (mlock fails past RLIMIT_MEMLOCK without CAP_IPC_LOCK)
+            bool locked() const noexcept
+            {
+                return std::all_of(regions_.begin(), regions_.end(), [](const detail::locked_region & region) { return region.locked; });
+            }
+
+        private:
+            std::vector<detail::locked_region> regions_;   // the last one is being carved up
+            std::byte * cursor_ = nullptr;
+            std::byte * end_ = nullptr;
+            bool lock_memory_;
+
+            void add_region(std::size_t size)
+            {
+                regions_.reserve(regions_.size() + 1);
+                regions_.push_back(detail::map_locked_region(size, false, lock_memory_));
+                cursor_ = static_cast<std::byte *>(regions_.back().p);
+                end_ = cursor_ + regions_.back().size;
+            }
+
+            void * do_allocate(std::size_t bytes, std::size_t alignment) override
+            {
+                void * p = cursor_;
+                std::size_t space = end_ - cursor_;
+                if(!std::align(alignment, bytes, p, space))
+                {
+                    if(bytes > std::numeric_limits<std::size_t>::max() / 2 - alignment)
+                        throw std::bad_alloc();
+
+                    // Regions are page aligned, so alignment extra bytes always suffice
+                    add_region(std::max(regions_.back().size * 2, bytes + alignment));
+                    p = cursor_;
+                    space = end_ - cursor_;
+                    std::align(alignment, bytes, p, space);
+                }
+                cursor_ = static_cast<std::byte *>(p) + bytes;
+                return p;
+            }
+            void do_deallocate(void * p, std::size_t bytes, std::size_t) override
+            {
+                detail::secure_zero(p, bytes);
+                // Give back the most recent block, which covers temporaries freed in reverse order
+                if(static_cast<std::byte *>(p) + bytes == cursor_)
+                    cursor_ = static_cast<std::byte *>(p);
+            }
+            bool do_is_equal(const std::pmr::memory_resource & other) const noexcept override
+            {
+                return this == &other;
+            }
+    };
+}
+
+#endif // MERLIN_SECURE_ARENA_HPP
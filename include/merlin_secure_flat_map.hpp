@@ -0,0 +1,462 @@
+#ifndef MERLIN_SECURE_FLAT_MAP_HPP
+#define MERLIN_SECURE_FLAT_MAP_HPP
+
+#include <merlin_basic_password.hpp>
+#include <merlin_detail.hpp>
+#include <merlin_password_view.hpp>
+#include <merlin_secure_allocator.hpp>
+#include <merlin_secure_arena.hpp>
+#include <merlin_secure_vector.hpp>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+// secure_flat_map<Key, T>: an immutable sorted map for read-mostly credential tables, rebuilt as a whole.
+// Keys and values sit in two parallel arrays in Eytzinger (BFS) order: node k has children 2k and 2k + 1,
+// so a lookup is a branch-free descent whose next nodes share cache lines and can be prefetched ahead.
+// Each table keeps its arrays in a secure_arena of its own: locked in RAM as far as RLIMIT_MEMLOCK allows (see
+// locked()), left out of core dumps and wiped when the table goes. Allocator-aware values (merl::pmr::password) put
+// their characters there too; others (merl::password, std::string) keep theirs on the heap, wiped but not locked.
+// For byte-sized character keys (basic_password, std::basic_string) under std::less, a third array holds 8 characters
+// of each key, past the prefix all keys share (say "service/"), as a big-endian integer; most steps compare that
+// integer and never touch the key's own buffer.
+// Lookups are transparent, so find(view) or find("tenant") builds no key.
+// atomic_secure_flat_map publishes rebuilt tables to concurrent readers; a replaced table is wiped when its last reader lets go.
+
+namespace merl
+{
+    namespace detail
+    {
+        template <typename Key, typename Compare>
+        struct flat_map_prefix : std::false_type
+        {};
+        template <typename CharT, typename Alloc, typename Compare>
+            requires (sizeof(CharT) == 1 && (std::is_same_v<Compare, std::less<>> || std::is_same_v<Compare, std::less<basic_password<CharT, std::char_traits<CharT>, Alloc>>>))
+        struct flat_map_prefix<basic_password<CharT, std::char_traits<CharT>, Alloc>, Compare> : std::true_type
+        {};
+        template <typename CharT, typename Alloc, typename Compare>
+            requires (sizeof(CharT) == 1 && (std::is_same_v<Compare, std::less<>> || std::is_same_v<Compare, std::less<std::basic_string<CharT, std::char_traits<CharT>, Alloc>>>))
+        struct flat_map_prefix<std::basic_string<CharT, std::char_traits<CharT>, Alloc>, Compare> : std::true_type
+        {};
+
+        // The characters of a key as bytes
+        template <typename K>
+        std::basic_string_view<unsigned char> key_bytes(const K & key) noexcept
+        {
+            if constexpr(requires { key.data(); key.size(); })
+                return std::basic_string_view<unsigned char>(reinterpret_cast<const unsigned char *>(key.data()), key.size());
+            else
+            {
+                std::basic_string_view<std::remove_cvref_t<decltype(*key)>> sv(key);
+                return std::basic_string_view<unsigned char>(reinterpret_cast<const unsigned char *>(sv.data()), sv.size());
+            }
+        }
+        // 8 characters from pos on, big-endian and zero padded: a < b as integers implies a < b as strings
+        inline std::uint64_t key_prefix(std::basic_string_view<unsigned char> bytes, std::size_t pos) noexcept
+        {
+            std::uint64_t prefix = 0;
+            for(std::size_t i = pos; i < pos + 8; ++i)
+                prefix = (prefix << 8) | (i < bytes.size() ? bytes[i] : 0);
+            return prefix;
+        }
+
+        inline void prefetch(const void * p) noexcept
+        {
+#if defined(__GNUC__)
+            __builtin_prefetch(p);
+#else
+            (void)p;
+#endif
+        }
+    }
+
+    template <typename Key, typename T, typename Compare = std::less<>>
+    class secure_flat_map
+    {
+        public:
+            using key_type = Key;
+            using mapped_type = T;
+            using value_type = std::pair<const Key &, const T &>;
+            using size_type = std::size_t;
+            using difference_type = std::ptrdiff_t;
+            using key_compare = Compare;
+
+        private:
+            static constexpr bool use_prefix = detail::flat_map_prefix<Key, Compare>::value;
+
+            template <typename U>
+            using table_vector = secure_vector<U, std::pmr::polymorphic_allocator<U>>;
+
+            // Node k (1-based) is stored at index k - 1. The arena is declared first, so it outlives the arrays.
+            struct table
+            {
+                secure_arena arena;
+                table_vector<Key> keys;
+                table_vector<T> values;
+                table_vector<std::uint64_t> prefixes;
+                size_type common = 0; // length of the prefix all keys share, skipped by prefixes
+
+                // Sized for n entries, so the arrays take one region (allocator-aware values may add more)
+                explicit table(size_type n)
+                    : arena(std::max<std::size_t>(n * (sizeof(Key) + sizeof(T) + (use_prefix ? sizeof(std::uint64_t) : 0)) + 3 * alignof(std::max_align_t), 4096)),
+                      keys(std::pmr::polymorphic_allocator<Key>(&arena)), values(std::pmr::polymorphic_allocator<T>(&arena)),
+                      prefixes(std::pmr::polymorphic_allocator<std::uint64_t>(&arena))
+                {}
+            };
+
+            std::unique_ptr<table> table_; // null while empty
+            [[no_unique_address]] Compare comp_;
+
+            // Sorted position of each node, by an in-order walk of the implicit tree
+            static void layout(size_type * order, size_type n)
+            {
+                if(!n)
+                    return;
+
+                size_type next = 0;
+                size_type k = 1;
+                while(2 * k <= n)
+                    k *= 2;
+                for(; k; k = successor(k, n))
+                    order[k - 1] = next++;
+            }
+            static size_type successor(size_type k, size_type n) noexcept
+            {
+                if(2 * k + 1 <= n)
+                {
+                    k = 2 * k + 1;
+                    while(2 * k <= n)
+                        k *= 2;
+                    return k;
+                }
+                // Climb past the nodes whose right subtree is done; 0 once the root's is
+                k >>= std::countr_one(k);
+                return k >> 1;
+            }
+
+            template <typename K>
+            size_type lower_bound_node(const K & key) const
+            {
+                if(!table_)
+                    return 0;
+
+                const Key * keys = table_->keys.data();
+                size_type n = table_->keys.size();
+                size_type k = 1;
+                if constexpr(use_prefix)
+                {
+                    // Keys below or above the shared prefix order before or after every entry
+                    size_type common = table_->common;
+                    std::basic_string_view<unsigned char> bytes = detail::key_bytes(key);
+                    int c = bytes.substr(0, common).compare(detail::key_bytes(keys[0]).substr(0, common));
+                    if(c > 0)
+                        return 0;
+                    if(c < 0)
+                    {
+                        while(2 * k <= n)
+                            k *= 2;
+                        return k;
+                    }
+
+                    std::uint64_t prefix = detail::key_prefix(bytes, common);
+                    const std::uint64_t * prefixes = table_->prefixes.data();
+                    while(k <= n)
+                    {
+                        detail::prefetch(prefixes + 8 * k - 1); // the 8 great-grandchildren share one cache line
+                        std::uint64_t p = prefixes[k - 1];
+                        // Only the rare tie needs the keys themselves; the common case stays branch free
+                        bool less = p < prefix;
+                        if(p == prefix) [[unlikely]]
+                            less = comp_(keys[k - 1], key);
+                        k = 2 * k + less;
+                    }
+                }
+                else
+                {
+                    while(k <= n)
+                        k = 2 * k + static_cast<bool>(comp_(keys[k - 1], key));
+                }
+                // Undo the right turns taken after the last left turn: that left turn was at the lower bound
+                k >>= std::countr_one(k) + 1;
+                return k;
+            }
+            template <typename K>
+            size_type find_node(const K & key) const
+            {
+                size_type k = lower_bound_node(key);
+                return k && !comp_(key, table_->keys[k - 1]) ? k : 0;
+            }
+
+        public:
+            class const_iterator
+            {
+                friend class secure_flat_map;
+
+                private:
+                    const secure_flat_map * map_ = nullptr;
+                    size_type node_ = 0;
+
+                    const_iterator(const secure_flat_map * map, size_type node) noexcept : map_{map}, node_{node}
+                    {}
+
+                public:
+                    using iterator_category = std::forward_iterator_tag;
+                    using value_type = std::pair<const Key &, const T &>;
+                    using difference_type = std::ptrdiff_t;
+                    using reference = value_type;
+                    using pointer = void;
+
+                    const_iterator() noexcept = default;
+
+                    value_type operator*() const noexcept
+                    {
+                        return value_type(map_->table_->keys[node_ - 1], map_->table_->values[node_ - 1]);
+                    }
+                    const Key & key() const noexcept
+                    {
+                        return map_->table_->keys[node_ - 1];
+                    }
+                    const T & value() const noexcept
+                    {
+                        return map_->table_->values[node_ - 1];
+                    }
+                    const_iterator & operator++() noexcept
+                    {
+                        node_ = successor(node_, map_->size());
+                        return *this;
+                    }
+                    const_iterator operator++(int) noexcept
+                    {
+                        const_iterator tmp(*this);
+                        ++*this;
+                        return tmp;
+                    }
+
+                    friend bool operator==(const const_iterator & lhs, const const_iterator & rhs) noexcept
+                    {
+                        return lhs.node_ == rhs.node_;
+                    }
+            };
+            using iterator = const_iterator;
+
+            // Constructors
+            secure_flat_map() = default;
+            explicit secure_flat_map(const Compare & comp) : comp_{comp}
+            {}
+            // Builds from (key, value) pairs in any order; for equal keys the first one wins, as with std::map::insert
+            template <typename InputIt>
+            secure_flat_map(InputIt first, InputIt last, const Compare & comp = Compare()) : comp_{comp}
+            {
+                secure_vector<std::pair<Key, T>, secure_allocator<std::pair<Key, T>>> items(first, last);
+                build(items);
+            }
+            secure_flat_map(std::initializer_list<std::pair<Key, T>> il, const Compare & comp = Compare()) : secure_flat_map(il.begin(), il.end(), comp)
+            {}
+            // Takes the pairs over, moving keys and values into place
+            template <typename Alloc>
+            explicit secure_flat_map(secure_vector<std::pair<Key, T>, Alloc> && items, const Compare & comp = Compare()) : comp_{comp}
+            {
+                build(items);
+                items.clear();
+            }
+            // Copies into a table (and arena) of its own
+            secure_flat_map(const secure_flat_map & other) : comp_{other.comp_}
+            {
+                if(!other.table_)
+                    return;
+
+                const table & from = *other.table_;
+                table_ = std::make_unique<table>(from.keys.size());
+                table_->keys.assign(from.keys.begin(), from.keys.end());
+                table_->values.assign(from.values.begin(), from.values.end());
+                table_->prefixes.assign(from.prefixes.begin(), from.prefixes.end());
+                table_->common = from.common;
+            }
+            secure_flat_map(secure_flat_map &&) noexcept = default;
+
+            // Assignment
+            secure_flat_map & operator=(const secure_flat_map & other)
+            {
+                if(&other != this)
+                {
+                    secure_flat_map tmp(other);
+                    swap(tmp);
+                }
+                return *this;
+            }
+            secure_flat_map & operator=(secure_flat_map &&) noexcept = default;
+
+        private:
+            template <typename Items>
+            void build(Items & items)
+            {
+                std::stable_sort(items.begin(), items.end(), [&](const auto & lhs, const auto & rhs) { return comp_(lhs.first, rhs.first); });
+                auto last = std::unique(items.begin(), items.end(), [&](const auto & lhs, const auto & rhs) { return !comp_(lhs.first, rhs.first); });
+                size_type n = last - items.begin();
+                if(!n)
+                    return;
+
+                table_ = std::make_unique<table>(n);
+                table & t = *table_;
+                if constexpr(use_prefix)
+                {
+                    // The smallest and largest keys share the least
+                    std::basic_string_view<unsigned char> lo = detail::key_bytes(items[0].first);
+                    std::basic_string_view<unsigned char> hi = detail::key_bytes(items[n - 1].first);
+                    t.common = std::mismatch(lo.begin(), lo.end(), hi.begin(), hi.end()).first - lo.begin();
+                }
+
+                secure_vector<size_type, secure_allocator<size_type>> order;
+                order.resize_for_overwrite(n);
+                layout(order.data(), n);
+                t.keys.reserve(n);
+                t.values.reserve(n);
+                for(size_type i = 0; i < n; ++i)
+                {
+                    t.keys.push_back(std::move(items[order[i]].first));
+                    t.values.push_back(std::move(items[order[i]].second));
+                }
+                if constexpr(use_prefix)
+                {
+                    t.prefixes.reserve(n);
+                    for(const Key & key : t.keys)
+                        t.prefixes.push_back(detail::key_prefix(detail::key_bytes(key), t.common));
+                }
+            }
+
+        public:
+            // Lookup
+            template <typename K>
+            const_iterator find(const K & key) const
+            {
+                return const_iterator(this, find_node(key));
+            }
+            template <typename K>
+            bool contains(const K & key) const
+            {
+                return find_node(key);
+            }
+            template <typename K>
+            size_type count(const K & key) const
+            {
+                return find_node(key) ? 1 : 0;
+            }
+            template <typename K>
+            const T & at(const K & key) const
+            {
+                size_type k = find_node(key);
+                if(!k)
+                    throw std::out_of_range("merl::secure_flat_map::at(): Out of range -> Key not found");
+
+                return table_->values[k - 1];
+            }
+            // First entry whose key is not less than key
+            template <typename K>
+            const_iterator lower_bound(const K & key) const
+            {
+                return const_iterator(this, lower_bound_node(key));
+            }
+
+            // Iterators (in key order)
+            const_iterator begin() const noexcept
+            {
+                size_type k = empty() ? 0 : 1;
+                while(k && 2 * k <= size())
+                    k *= 2;
+                return const_iterator(this, k);
+            }
+            const_iterator cbegin() const noexcept
+            {
+                return begin();
+            }
+            const_iterator end() const noexcept
+            {
+                return const_iterator(this, 0);
+            }
+            const_iterator cend() const noexcept
+            {
+                return end();
+            }
+
+            // Capacity
+            bool empty() const noexcept
+            {
+                return !table_;
+            }
+            size_type size() const noexcept
+            {
+                return table_ ? table_->keys.size() : 0;
+            }
+            // Whether the table's memory could be locked in RAM (mlock fails past RLIMIT_MEMLOCK without CAP_IPC_LOCK)
+            bool locked() const noexcept
+            {
+                return !table_ || table_->arena.locked();
+            }
+
+            // Observers
+            key_compare key_comp() const
+            {
+                return comp_;
+            }
+
+            void swap(secure_flat_map & other) noexcept
+            {
+                using std::swap;
+                table_.swap(other.table_);
+                swap(comp_, other.comp_);
+            }
+    };
+
+    template <typename Key, typename T, typename Compare>
+    void swap(secure_flat_map<Key, T, Compare> & lhs, secure_flat_map<Key, T, Compare> & rhs) noexcept
+    {
+        lhs.swap(rhs);
+    }
+
+    // A secure_flat_map shared between reader threads and a rebuilding writer. Readers take a snapshot with load()
+    // and keep using it however long they like; rebuild() and store() publish a new table atomically.
+    template <typename Key, typename T, typename Compare = std::less<>>
+    class atomic_secure_flat_map
+    {
+        public:
+            using map_type = secure_flat_map<Key, T, Compare>;
+
+        private:
+            std::atomic<std::shared_ptr<const map_type>> map_ {std::make_shared<const map_type>()};
+
+        public:
+            atomic_secure_flat_map() = default;
+            explicit atomic_secure_flat_map(map_type map) : map_{std::make_shared<const map_type>(std::move(map))}
+            {}
+            atomic_secure_flat_map(const atomic_secure_flat_map &) = delete;
+            atomic_secure_flat_map & operator=(const atomic_secure_flat_map &) = delete;
+
+            std::shared_ptr<const map_type> load() const noexcept
+            {
+                return map_.load(std::memory_order_acquire);
+            }
+            void store(map_type map)
+            {
+                map_.store(std::make_shared<const map_type>(std::move(map)), std::memory_order_release);
+            }
+            // Builds the new table off to the side, then swaps it in
+            template <typename InputIt>
+            void rebuild(InputIt first, InputIt last)
+            {
+                store(map_type(first, last));
+            }
+    };
+}
+
+#endif // MERLIN_SECURE_FLAT_MAP_HPP
@@ -0,0 +1,207 @@
+#ifndef MERLIN_SECURE_RING_BUFFER_HPP
+#define MERLIN_SECURE_RING_BUFFER_HPP
+
+#include <merlin_basic_password.hpp>
+#include <merlin_detail.hpp>
+#include <merlin_password_view.hpp>
+#include <merlin_secure_allocator.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+// secure_ring_buffer: a lock-free single-producer/single-consumer queue of secret values in a locked region
+// (see map_locked_region: kept out of swap where possible and out of core dumps). The capacity is a power of two
+// and both cursors only ever grow, so an index is cursor & (capacity - 1). write_span()/commit() and
+// read_span()/consume() give direct access to the free and filled parts of the ring; consume() wipes the
+// slots it hands back before the producer can see them. Exactly one thread may produce and one may consume.
+
+namespace merl
+{
+    template <typename T>
+    class secure_ring_buffer
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "merl::secure_ring_buffer holds raw secret values");
+        static_assert(alignof(T) <= 64);
+
+        public:
+            using value_type = T;
+            using size_type = std::size_t;
+
+        private:
+            static constexpr size_type line = 64;
+
+            detail::locked_region region_;
+            T * data_;
+            size_type mask_;
+
+            // Each side writes its own cursor and keeps a stale copy of the other's, refreshed only when the ring looks full or empty
+            alignas(line) std::atomic<size_type> head_ {0};  // next slot to write, owned by the producer
+            size_type tail_cache_ = 0;
+            alignas(line) std::atomic<size_type> tail_ {0};  // next slot to read, owned by the consumer
+            size_type head_cache_ = 0;
+
+            static size_type round_capacity(size_type min_capacity)
+            {
+                if(!min_capacity)
+                    throw std::invalid_argument("merl::secure_ring_buffer::secure_ring_buffer(): Invalid argument -> capacity must be positive");
+                if(min_capacity > (size_type{1} << (sizeof(size_type) * 8 - 2)) / sizeof(T))
+                    throw std::length_error("merl::secure_ring_buffer::secure_ring_buffer(): Length error -> capacity = " + std::to_string(min_capacity));
+
+                size_type capacity = 1;
+                while(capacity < min_capacity)
+                    capacity <<= 1;
+                return capacity;
+            }
+
+            // commit() and consume() without the clamp, for counts already taken from a span
+            void publish(size_type n) noexcept
+            {
+                head_.store(head_.load(std::memory_order_relaxed) + n, std::memory_order_release);
+            }
+            void release(size_type n) noexcept
+            {
+                size_type tail = tail_.load(std::memory_order_relaxed);
+                detail::secure_zero(data_ + (tail & mask_), n * sizeof(T));
+                tail_.store(tail + n, std::memory_order_release);
+            }
+
+        public:
+            // Rounds min_capacity up to a power of two; lock_memory as for map_locked_region
+            explicit secure_ring_buffer(size_type min_capacity, bool lock_memory = true) :
+                region_{detail::map_locked_region(round_capacity(min_capacity) * sizeof(T), false, lock_memory)},
+                data_{static_cast<T *>(region_.p)},
+                mask_{round_capacity(min_capacity) - 1}
+            {}
+            secure_ring_buffer(const secure_ring_buffer &) = delete;
+            secure_ring_buffer & operator=(const secure_ring_buffer &) = delete;
+
+            ~secure_ring_buffer()
+            {
+                detail::unmap_locked_region(region_);
+            }
+
+            // Capacity
+            size_type capacity() const noexcept
+            {
+                return mask_ + 1;
+            }
+            // Exact from either owner thread when the other side is idle, a snapshot otherwise
+            size_type size() const noexcept
+            {
+                return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+            }
+            bool empty() const noexcept
+            {
+                return !size();
+            }
+            bool full() const noexcept
+            {
+                return size() == capacity();
+            }
+            bool is_locked() const noexcept
+            {
+                return region_.locked;
+            }
+
+            // Producer side
+            // Contiguous free slots from the write cursor up to the end of the ring; fill them, then commit()
+            std::span<T> write_span() noexcept
+            {
+                size_type head = head_.load(std::memory_order_relaxed);
+                if(head - tail_cache_ == capacity())
+                    tail_cache_ = tail_.load(std::memory_order_acquire);
+                size_type index = head & mask_;
+                return std::span<T>(data_ + index, std::min(capacity() - (head - tail_cache_), capacity() - index));
+            }
+            // Publishes n slots written through write_span(), clamped to the free slots it spans; returns how many
+            size_type commit(size_type n) noexcept
+            {
+                n = std::min(n, write_span().size());
+                publish(n);
+                return n;
+            }
+            // Copies up to n values in; returns how many fit
+            size_type write(const T * p, size_type n) noexcept
+            {
+                size_type done = 0;
+                for(int part = 0; part < 2 && done < n; ++part)
+                {
+                    std::span<T> free = write_span();
+                    size_type count = std::min(free.size(), n - done);
+                    if(!count)
+                        break;
+                    std::memcpy(free.data(), p + done, count * sizeof(T));
+                    publish(count);
+                    done += count;
+                }
+                return done;
+            }
+            bool push(const T & value) noexcept
+            {
+                return write(&value, 1) == 1;
+            }
+
+            // Consumer side
+            // Contiguous filled slots from the read cursor up to the end of the ring; read them, then consume()
+            std::span<const T> read_span() noexcept
+            {
+                size_type tail = tail_.load(std::memory_order_relaxed);
+                if(head_cache_ == tail)
+                    head_cache_ = head_.load(std::memory_order_acquire);
+                size_type index = tail & mask_;
+                return std::span<const T>(data_ + index, std::min(head_cache_ - tail, capacity() - index));
+            }
+            // Wipes n slots returned by read_span() and hands them back to the producer; n is clamped to the filled
+            // slots it spans, so a bad count can neither wipe past the ring nor hand back unread slots. Returns how many.
+            size_type consume(size_type n) noexcept
+            {
+                n = std::min(n, read_span().size());
+                release(n);
+                return n;
+            }
+            // Moves up to n values out; returns how many were available
+            size_type read(T * out, size_type n) noexcept
+            {
+                size_type done = 0;
+                for(int part = 0; part < 2 && done < n; ++part)
+                {
+                    std::span<const T> filled = read_span();
+                    size_type count = std::min(filled.size(), n - done);
+                    if(!count)
+                        break;
+                    std::memcpy(out + done, filled.data(), count * sizeof(T));
+                    release(count);
+                    done += count;
+                }
+                return done;
+            }
+            bool pop(T & value) noexcept
+            {
+                return read(&value, 1) == 1;
+            }
+            // Appends up to max available characters to p and consumes them; returns how many were moved
+            template <typename Traits, typename Alloc>
+            size_type drain(basic_password<T, Traits, Alloc> & p, size_type max = -1)
+            {
+                size_type done = 0;
+                for(int part = 0; part < 2 && done < max; ++part)
+                {
+                    std::span<const T> filled = read_span();
+                    size_type count = std::min(filled.size(), max - done);
+                    if(!count)
+                        break;
+                    p.append(basic_password_view<T, Traits>(filled.data(), count));
+                    release(count);
+                    done += count;
+                }
+                return done;
+            }
+    };
+}
+
+#endif // MERLIN_SECURE_RING_BUFFER_HPP
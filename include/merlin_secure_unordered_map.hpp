@@ -0,0 +1,884 @@
+#ifndef MERLIN_SECURE_UNORDERED_MAP_HPP
+#define MERLIN_SECURE_UNORDERED_MAP_HPP
+
+#include <merlin_basic_password.hpp>
+#include <merlin_detail.hpp>
+#include <merlin_password_hash.hpp>
+#include <merlin_secure_allocator.hpp>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+// secure_unordered_map<Key, T>: an open-addressing hash map (Swiss table layout) for credential lookup tables.
+// All entries live in one flat block from a secure allocator instead of one heap node each. A parallel array of
+// control bytes holds 7 bits of each entry's hash, and 16 of them are compared at once (SSE2) per probe step.
+// Storage is wiped before it is released: a slot on erase, the old block on rehash, everything on destruction.
+// For character-sequence keys (basic_password, std::basic_string) the defaults are the per-process SipHash
+// (password_hasher) and the constant-time password_equal, both transparent: find("tenant") or find(string_view)
+// looks up without building a key.
+
+namespace merl
+{
+    namespace detail
+    {
+        // Control bytes: full slots hold the low 7 hash bits (0..127), the rest are negative
+        inline constexpr std::int8_t ctrl_empty = -128;
+        inline constexpr std::int8_t ctrl_deleted = -2;
+        inline constexpr std::int8_t ctrl_sentinel = -1;
+
+        inline constexpr std::size_t probe_width = 16;
+
+        // Shared by every empty map, so lookups and begin() need no allocation
+        alignas(16) inline constexpr std::int8_t empty_ctrl_group[probe_width] = {
+            ctrl_sentinel, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty,
+            ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty};
+
+        // The 16 control bytes starting at some position, as bit masks (bit i <=> byte i)
+        struct probe_group
+        {
+#if MERLIN_X86_SIMD && defined(__SSE2__)
+            __m128i ctrl;
+
+            explicit probe_group(const std::int8_t * p) noexcept : ctrl{_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))}
+            {}
+            std::uint32_t match(std::int8_t h2) const noexcept
+            {
+                return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl)));
+            }
+            std::uint32_t match_empty() const noexcept
+            {
+                return match(ctrl_empty);
+            }
+            std::uint32_t match_empty_or_deleted() const noexcept
+            {
+                return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(ctrl_sentinel), ctrl)));
+            }
+#else
+            const std::int8_t * ctrl;
+
+            explicit probe_group(const std::int8_t * p) noexcept : ctrl{p}
+            {}
+            std::uint32_t match(std::int8_t h2) const noexcept
+            {
+                std::uint32_t m = 0;
+                for(std::size_t i = 0; i < probe_width; ++i)
+                    m |= std::uint32_t{ctrl[i] == h2} << i;
+                return m;
+            }
+            std::uint32_t match_empty() const noexcept
+            {
+                return match(ctrl_empty);
+            }
+            std::uint32_t match_empty_or_deleted() const noexcept
+            {
+                std::uint32_t m = 0;
+                for(std::size_t i = 0; i < probe_width; ++i)
+                    m |= std::uint32_t{ctrl[i] < ctrl_sentinel} << i;
+                return m;
+            }
+#endif
+        };
+
+        template <typename Key>
+        struct is_char_sequence : std::false_type
+        {};
+        template <typename CharT, typename Traits, typename Alloc>
+        struct is_char_sequence<basic_password<CharT, Traits, Alloc>> : std::true_type
+        {};
+        template <typename CharT, typename Traits, typename Alloc>
+        struct is_char_sequence<std::basic_string<CharT, Traits, Alloc>> : std::true_type
+        {};
+
+        template <typename Key>
+        using secure_map_hash = std::conditional_t<is_char_sequence<Key>::value, password_hasher, std::hash<Key>>;
+        template <typename Key>
+        using secure_map_equal = std::conditional_t<is_char_sequence<Key>::value, password_equal, std::equal_to<Key>>;
+    }
+
+    template <typename Key, typename T, typename Hash = detail::secure_map_hash<Key>, typename KeyEqual = detail::secure_map_equal<Key>,
+              typename Alloc = secure_allocator<std::pair<const Key, T>>>
+    class secure_unordered_map
+    {
+        public:
+            using key_type = Key;
+            using mapped_type = T;
+            using value_type = std::pair<const Key, T>;
+            using size_type = std::size_t;
+            using difference_type = std::ptrdiff_t;
+            using hasher = Hash;
+            using key_equal = KeyEqual;
+            using allocator_type = Alloc;
+            using reference = value_type &;
+            using const_reference = const value_type &;
+
+        private:
+            template <typename V>
+            class iterator_impl
+            {
+                friend class secure_unordered_map;
+
+                private:
+                    const std::int8_t * ctrl_ = nullptr;
+                    V * slot_ = nullptr;
+
+                    iterator_impl(const std::int8_t * ctrl, V * slot) noexcept : ctrl_{ctrl}, slot_{slot}
+                    {
+                        skip();
+                    }
+                    // Stops on the next full slot, or on the sentinel that follows the last one
+                    void skip() noexcept
+                    {
+                        while(*ctrl_ < detail::ctrl_sentinel)
+                        {
+                            ++ctrl_;
+                            ++slot_;
+                        }
+                    }
+
+                public:
+                    using iterator_category = std::forward_iterator_tag;
+                    using value_type = secure_unordered_map::value_type;
+                    using difference_type = std::ptrdiff_t;
+                    using pointer = V *;
+                    using reference = V &;
+
+                    iterator_impl() noexcept = default;
+                    template <typename W, typename = std::enable_if_t<std::is_const_v<V> && !std::is_const_v<W>>>
+                    iterator_impl(const iterator_impl<W> & other) noexcept : ctrl_{other.ctrl_}, slot_{other.slot_}
+                    {}
+
+                    reference operator*() const noexcept
+                    {
+                        return *slot_;
+                    }
+                    pointer operator->() const noexcept
+                    {
+                        return slot_;
+                    }
+                    iterator_impl & operator++() noexcept
+                    {
+                        ++ctrl_;
+                        ++slot_;
+                        skip();
+                        return *this;
+                    }
+                    iterator_impl operator++(int) noexcept
+                    {
+                        iterator_impl tmp(*this);
+                        ++(*this);
+                        return tmp;
+                    }
+
+                    friend bool operator==(const iterator_impl & lhs, const iterator_impl & rhs) noexcept
+                    {
+                        return lhs.ctrl_ == rhs.ctrl_;
+                    }
+
+                    template <typename W>
+                    friend class iterator_impl;
+            };
+
+        public:
+            using iterator = iterator_impl<value_type>;
+            using const_iterator = iterator_impl<const value_type>;
+
+        private:
+            using slot_type = value_type;
+            struct alignas(std::max(alignof(slot_type), detail::probe_width)) chunk
+            {
+                unsigned char bytes[std::max(alignof(slot_type), detail::probe_width)];
+            };
+            using chunk_allocator = typename std::allocator_traits<Alloc>::template rebind_alloc<chunk>;
+            using chunk_traits = std::allocator_traits<chunk_allocator>;
+            using slot_allocator = typename std::allocator_traits<Alloc>::template rebind_alloc<slot_type>;
+            using slot_traits = std::allocator_traits<slot_allocator>;
+
+            static constexpr size_type cloned_bytes = detail::probe_width - 1;
+
+            template <typename K>
+            static constexpr bool transparent_lookup = requires { typename Hash::is_transparent; typename KeyEqual::is_transparent; };
+
+            [[no_unique_address]] Hash hash_;
+            [[no_unique_address]] KeyEqual eq_;
+            [[no_unique_address]] chunk_allocator alloc_;
+            std::int8_t * ctrl_ = const_cast<std::int8_t *>(detail::empty_ctrl_group);
+            slot_type * slots_ = nullptr;
+            size_type capacity_ = 0;    // 0, or 2^k - 1 slots
+            size_type size_ = 0;
+            size_type growth_left_ = 0; // insertions into empty slots before the next rehash
+
+            // 7/8 maximum load factor
+            static size_type growth(size_type capacity) noexcept
+            {
+                return capacity - capacity / 8;
+            }
+            static size_type capacity_for(size_type n) noexcept
+            {
+                size_type capacity = detail::probe_width - 1;
+                while(growth(capacity) < n)
+                    capacity = capacity * 2 + 1;
+                return capacity;
+            }
+            static size_type ctrl_chunks(size_type capacity) noexcept
+            {
+                return (capacity + 1 + cloned_bytes + sizeof(chunk) - 1) / sizeof(chunk);
+            }
+            static size_type block_chunks(size_type capacity) noexcept
+            {
+                return ctrl_chunks(capacity) + (capacity * sizeof(slot_type) + sizeof(chunk) - 1) / sizeof(chunk);
+            }
+
+            template <typename K>
+            std::size_t hash_of(const K & key) const
+            {
+                // Spreads hashers with weak low bits (std::hash of integers is the identity) over both halves
+                std::uint64_t h = static_cast<std::uint64_t>(hash_(key)) * 0x9e3779b97f4a7c15ull;
+                return static_cast<std::size_t>(h ^ (h >> 32));
+            }
+            static std::int8_t h2(std::size_t hash) noexcept
+            {
+                return static_cast<std::int8_t>(hash & 0x7f);
+            }
+
+            static void set_ctrl(std::int8_t * ctrl, size_type capacity, size_type i, std::int8_t h) noexcept
+            {
+                ctrl[i] = h;
+                ctrl[((i - cloned_bytes) & capacity) + (cloned_bytes & capacity)] = h;
+            }
+            void set_ctrl(size_type i, std::int8_t h) noexcept
+            {
+                set_ctrl(ctrl_, capacity_, i, h);
+            }
+            static void reset_ctrl(std::int8_t * ctrl, size_type capacity) noexcept
+            {
+                std::memset(ctrl, detail::ctrl_empty, capacity + 1 + cloned_bytes);
+                ctrl[capacity] = detail::ctrl_sentinel;
+            }
+            void reset_ctrl() noexcept
+            {
+                reset_ctrl(ctrl_, capacity_);
+                growth_left_ = growth(capacity_) - size_;
+            }
+
+            template <typename K>
+            size_type find_index(const K & key, std::size_t hash) const
+            {
+                if(!capacity_)
+                    return capacity_;
+
+                size_type pos = (hash >> 7) & capacity_;
+                for(size_type step = detail::probe_width;; step += detail::probe_width)
+                {
+                    detail::probe_group g(ctrl_ + pos);
+                    for(std::uint32_t m = g.match(h2(hash)); m; m &= m - 1)
+                    {
+                        size_type i = (pos + std::countr_zero(m)) & capacity_;
+                        if(eq_(slots_[i].first, key))
+                            return i;
+                    }
+                    if(g.match_empty())
+                        return capacity_;
+                    pos = (pos + step) & capacity_;
+                }
+            }
+            static size_type find_free(const std::int8_t * ctrl, size_type capacity, std::size_t hash) noexcept
+            {
+                size_type pos = (hash >> 7) & capacity;
+                for(size_type step = detail::probe_width;; step += detail::probe_width)
+                {
+                    if(std::uint32_t m = detail::probe_group(ctrl + pos).match_empty_or_deleted())
+                        return (pos + std::countr_zero(m)) & capacity;
+                    pos = (pos + step) & capacity;
+                }
+            }
+            size_type find_free(std::size_t hash) const noexcept
+            {
+                return find_free(ctrl_, capacity_, hash);
+            }
+
+            void release() noexcept
+            {
+                if(!capacity_)
+                    return;
+
+                for(size_type i = 0; i < capacity_; ++i)
+                {
+                    if(ctrl_[i] >= 0)
+                        destroy_slot(i);
+                }
+                secure_del(reinterpret_cast<chunk *>(ctrl_), capacity_);
+                ctrl_ = const_cast<std::int8_t *>(detail::empty_ctrl_group);
+                slots_ = nullptr;
+                capacity_ = size_ = growth_left_ = 0;
+            }
+            void destroy_slot(size_type i) noexcept
+            {
+                slot_allocator a(alloc_);
+                slot_traits::destroy(a, slots_ + i);
+                detail::secure_zero(slots_ + i, sizeof(slot_type));
+            }
+            // Same rule as basic_password::secure_del(): wipe the block, then give it back
+            void secure_del(chunk * block, size_type capacity) noexcept
+            {
+                detail::secure_zero(block, block_chunks(capacity) * sizeof(chunk));
+                chunk_traits::deallocate(alloc_, block, block_chunks(capacity));
+            }
+
+            // Rehashing moves the entries only if neither their moves nor the hash can throw, and copies them otherwise
+            // (as secure_vector does): a rehash that throws then leaves the map as it was
+            static constexpr bool move_on_rehash = (std::is_nothrow_move_constructible_v<Key> && std::is_nothrow_move_constructible_v<T> &&
+                std::is_nothrow_invocable_v<const Hash &, const Key &>) || !(std::is_copy_constructible_v<Key> && std::is_copy_constructible_v<T>);
+
+            // Builds a table of new_capacity slots holding every entry, then switches over; the old block is wiped and released
+            void resize(size_type new_capacity)
+            {
+                chunk * block = chunk_traits::allocate(alloc_, block_chunks(new_capacity));
+                std::int8_t * ctrl = reinterpret_cast<std::int8_t *>(block);
+                slot_type * slots = reinterpret_cast<slot_type *>(block + ctrl_chunks(new_capacity));
+                reset_ctrl(ctrl, new_capacity);
+
+                slot_allocator a(alloc_);
+                try
+                {
+                    for(size_type i = 0; i < capacity_; ++i)
+                    {
+                        if(ctrl_[i] < 0)
+                            continue;
+
+                        std::size_t hash = hash_of(slots_[i].first);
+                        size_type target = find_free(ctrl, new_capacity, hash);
+                        // The key is const only to users; a moved-from entry is destroyed right after
+                        if constexpr(move_on_rehash)
+                            slot_traits::construct(a, slots + target, std::move(const_cast<Key &>(slots_[i].first)), std::move(slots_[i].second));
+                        else
+                            slot_traits::construct(a, slots + target, std::as_const(slots_[i]));
+                        set_ctrl(ctrl, new_capacity, target, h2(hash));
+                    }
+                }
+                catch(...)
+                {
+                    for(size_type i = 0; i < new_capacity; ++i)
+                    {
+                        if(ctrl[i] >= 0)
+                            slot_traits::destroy(a, slots + i);
+                    }
+                    secure_del(block, new_capacity);
+                    throw;
+                }
+
+                size_type size = size_;
+                release();
+                ctrl_ = ctrl;
+                slots_ = slots;
+                capacity_ = new_capacity;
+                size_ = size;
+                growth_left_ = growth(capacity_) - size_;
+            }
+            // Takes over other's block, hasher and equality; the block must be deallocatable through alloc_
+            void adopt(secure_unordered_map & other) noexcept
+            {
+                hash_ = std::move(other.hash_);
+                eq_ = std::move(other.eq_);
+                ctrl_ = std::exchange(other.ctrl_, const_cast<std::int8_t *>(detail::empty_ctrl_group));
+                slots_ = std::exchange(other.slots_, nullptr);
+                capacity_ = std::exchange(other.capacity_, 0);
+                size_ = std::exchange(other.size_, 0);
+                growth_left_ = std::exchange(other.growth_left_, 0);
+            }
+            void grow()
+            {
+                // Tombstone-heavy tables (at most ~25/32 live) are rebuilt at the same size rather than doubled
+                resize(size_ * 32 <= capacity_ * 25 ? capacity_ : capacity_ * 2 + 1);
+            }
+
+            // Finds key, or claims a slot for it and lets construct(slot) build the entry there
+            template <typename K, typename Construct>
+            std::pair<iterator, bool> find_or_prepare(const K & key, Construct construct)
+            {
+                std::size_t hash = hash_of(key);
+                size_type i = find_index(key, hash);
+                if(i != capacity_)
+                    return {iterator_at(i), false};
+
+                if(!capacity_)
+                    resize(capacity_for(1));
+
+                i = find_free(hash);
+                if(!growth_left_ && ctrl_[i] == detail::ctrl_empty)
+                {
+                    grow();
+                    i = find_free(hash);
+                }
+
+                construct(slots_ + i);
+                growth_left_ -= ctrl_[i] == detail::ctrl_empty;
+                set_ctrl(i, h2(hash));
+                ++size_;
+                return {iterator_at(i), true};
+            }
+
+            void erase_at(size_type i) noexcept
+            {
+                destroy_slot(i);
+                --size_;
+
+                // A slot can go back to empty (ending probes early again) only if no probe window
+                // around it was ever completely full, i.e. no lookup could have probed past it
+                size_type before = (i - detail::probe_width) & capacity_;
+                std::uint32_t empty_after = detail::probe_group(ctrl_ + i).match_empty();
+                std::uint32_t empty_before = detail::probe_group(ctrl_ + before).match_empty();
+                bool was_never_full = empty_before && empty_after &&
+                    static_cast<size_type>(std::countr_zero(empty_after) + std::countl_zero(static_cast<std::uint16_t>(empty_before))) < detail::probe_width;
+
+                set_ctrl(i, was_never_full ? detail::ctrl_empty : detail::ctrl_deleted);
+                growth_left_ += was_never_full;
+            }
+
+            iterator iterator_at(size_type i) noexcept
+            {
+                return iterator(ctrl_ + i, slots_ + i);
+            }
+            const_iterator iterator_at(size_type i) const noexcept
+            {
+                return const_iterator(ctrl_ + i, slots_ + i);
+            }
+
+        public:
+            // Constructors
+            secure_unordered_map() = default;
+            explicit secure_unordered_map(size_type bucket_count, const Hash & hash = Hash(), const KeyEqual & equal = KeyEqual(), const Alloc & alloc = Alloc())
+                : hash_{hash}, eq_{equal}, alloc_{alloc}
+            {
+                reserve(bucket_count);
+            }
+            explicit secure_unordered_map(const Alloc & alloc) : alloc_{alloc}
+            {}
+            template <typename InputIt>
+            secure_unordered_map(InputIt first, InputIt last, size_type bucket_count = 0, const Hash & hash = Hash(), const KeyEqual & equal = KeyEqual(), const Alloc & alloc = Alloc())
+                : secure_unordered_map(bucket_count, hash, equal, alloc)
+            {
+                insert(first, last);
+            }
+            secure_unordered_map(std::initializer_list<value_type> il, size_type bucket_count = 0, const Hash & hash = Hash(), const KeyEqual & equal = KeyEqual(), const Alloc & alloc = Alloc())
+                : secure_unordered_map(il.begin(), il.end(), std::max(bucket_count, il.size()), hash, equal, alloc)
+            {}
+
+            secure_unordered_map(const secure_unordered_map & other)
+                : secure_unordered_map(other, allocator_type(chunk_traits::select_on_container_copy_construction(other.alloc_)))
+            {}
+            secure_unordered_map(const secure_unordered_map & other, const Alloc & alloc) : hash_{other.hash_}, eq_{other.eq_}, alloc_{alloc}
+            {
+                reserve(other.size_);
+                for(const value_type & v : other)
+                    insert(v);
+            }
+            secure_unordered_map(secure_unordered_map && other) noexcept
+                : hash_{std::move(other.hash_)}, eq_{std::move(other.eq_)}, alloc_{std::move(other.alloc_)},
+                  ctrl_{std::exchange(other.ctrl_, const_cast<std::int8_t *>(detail::empty_ctrl_group))},
+                  slots_{std::exchange(other.slots_, nullptr)}, capacity_{std::exchange(other.capacity_, 0)},
+                  size_{std::exchange(other.size_, 0)}, growth_left_{std::exchange(other.growth_left_, 0)}
+            {}
+
+            // Destructor
+            ~secure_unordered_map()
+            {
+                release();
+            }
+
+            // Assignment
+            secure_unordered_map & operator=(const secure_unordered_map & other)
+            {
+                if(&other != this)
+                {
+                    // Built first with the allocator this map ends up with, so a throwing copy leaves *this untouched
+                    if constexpr(chunk_traits::propagate_on_container_copy_assignment::value)
+                    {
+                        secure_unordered_map tmp(other, allocator_type(other.alloc_));
+                        release();
+                        alloc_ = other.alloc_;
+                        adopt(tmp);
+                    }
+                    else
+                    {
+                        secure_unordered_map tmp(other, allocator_type(alloc_));
+                        release();
+                        adopt(tmp);
+                    }
+                }
+                return *this;
+            }
+            secure_unordered_map & operator=(secure_unordered_map && other) noexcept(chunk_traits::propagate_on_container_move_assignment::value || chunk_traits::is_always_equal::value)
+            {
+                if(&other != this)
+                {
+                    if constexpr(chunk_traits::propagate_on_container_move_assignment::value || chunk_traits::is_always_equal::value)
+                    {
+                        release();
+                        if constexpr(chunk_traits::propagate_on_container_move_assignment::value)
+                            alloc_ = std::move(other.alloc_);
+                        adopt(other);
+                    }
+                    else if(alloc_ == other.alloc_)
+                    {
+                        release();
+                        adopt(other);
+                    }
+                    else
+                    {
+                        // The block belongs to other's allocator: the entries move one by one into storage from ours
+                        clear();
+                        hash_ = other.hash_;
+                        eq_ = other.eq_;
+                        reserve(other.size_);
+                        for(value_type & v : other)
+                            try_emplace(std::move(const_cast<Key &>(v.first)), std::move(v.second));
+                        other.release();
+                    }
+                }
+                return *this;
+            }
+            secure_unordered_map & operator=(std::initializer_list<value_type> il)
+            {
+                clear();
+                insert(il);
+                return *this;
+            }
+
+            allocator_type get_allocator() const noexcept
+            {
+                return allocator_type(alloc_);
+            }
+            hasher hash_function() const
+            {
+                return hash_;
+            }
+            key_equal key_eq() const
+            {
+                return eq_;
+            }
+
+            // Iterators
+            iterator begin() noexcept
+            {
+                return capacity_ ? iterator_at(0) : end();
+            }
+            const_iterator begin() const noexcept
+            {
+                return capacity_ ? iterator_at(0) : end();
+            }
+            const_iterator cbegin() const noexcept
+            {
+                return begin();
+            }
+            iterator end() noexcept
+            {
+                iterator it;
+                it.ctrl_ = ctrl_ + capacity_;
+                return it;
+            }
+            const_iterator end() const noexcept
+            {
+                const_iterator it;
+                it.ctrl_ = ctrl_ + capacity_;
+                return it;
+            }
+            const_iterator cend() const noexcept
+            {
+                return end();
+            }
+
+            // Capacity
+            bool empty() const noexcept
+            {
+                return !size_;
+            }
+            size_type size() const noexcept
+            {
+                return size_;
+            }
+            size_type max_size() const noexcept
+            {
+                return std::numeric_limits<difference_type>::max() / sizeof(slot_type);
+            }
+            size_type capacity() const noexcept
+            {
+                return capacity_;
+            }
+            float load_factor() const noexcept
+            {
+                return capacity_ ? static_cast<float>(size_) / capacity_ : 0.0f;
+            }
+            float max_load_factor() const noexcept
+            {
+                return 0.875f;
+            }
+
+            // Room for count entries without rehashing
+            void reserve(size_type count)
+            {
+                if(count > max_size())
+                    throw std::length_error("merl::secure_unordered_map::reserve(): Length error -> Maximum size exceeded");
+
+                if(count && (!capacity_ || growth(capacity_) < count))
+                    resize(capacity_for(count));
+            }
+            // Rebuilds the table with at least count slots (and room for every entry), dropping tombstones
+            void rehash(size_type count)
+            {
+                if(!count && !size_)
+                {
+                    release();
+                    return;
+                }
+                resize(std::max(capacity_for(size_), count ? std::bit_ceil(count + 1) - 1 : 0));
+            }
+
+            // Modifiers
+            // Keeps the capacity; every slot is wiped
+            void clear() noexcept
+            {
+                if(!capacity_)
+                    return;
+
+                for(size_type i = 0; i < capacity_; ++i)
+                {
+                    if(ctrl_[i] >= 0)
+                        destroy_slot(i);
+                }
+                size_ = 0;
+                reset_ctrl();
+            }
+
+            template <typename... Args>
+            std::pair<iterator, bool> try_emplace(const Key & key, Args &&... args)
+            {
+                return find_or_prepare(key, [&](slot_type * slot)
+                {
+                    slot_allocator a(alloc_);
+                    slot_traits::construct(a, slot, std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+                });
+            }
+            template <typename... Args>
+            std::pair<iterator, bool> try_emplace(Key && key, Args &&... args)
+            {
+                return find_or_prepare(key, [&](slot_type * slot)
+                {
+                    slot_allocator a(alloc_);
+                    slot_traits::construct(a, slot, std::piecewise_construct, std::forward_as_tuple(std::move(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+                });
+            }
+            template <typename... Args>
+            std::pair<iterator, bool> emplace(Args &&... args)
+            {
+                std::pair<Key, T> entry(std::forward<Args>(args)...);
+                return try_emplace(std::move(entry.first), std::move(entry.second));
+            }
+            std::pair<iterator, bool> insert(const value_type & value)
+            {
+                return try_emplace(value.first, value.second);
+            }
+            std::pair<iterator, bool> insert(value_type && value)
+            {
+                return try_emplace(value.first, std::move(value.second));
+            }
+            template <typename P, typename = std::enable_if_t<std::is_constructible_v<value_type, P &&>>>
+            std::pair<iterator, bool> insert(P && value)
+            {
+                return emplace(std::forward<P>(value));
+            }
+            template <typename InputIt>
+            void insert(InputIt first, InputIt last)
+            {
+                for(; first != last; ++first)
+                    insert(*first);
+            }
+            void insert(std::initializer_list<value_type> il)
+            {
+                insert(il.begin(), il.end());
+            }
+            template <typename M>
+            std::pair<iterator, bool> insert_or_assign(const Key & key, M && obj)
+            {
+                auto r = try_emplace(key, std::forward<M>(obj));
+                if(!r.second)
+                    r.first->second = std::forward<M>(obj);
+                return r;
+            }
+            template <typename M>
+            std::pair<iterator, bool> insert_or_assign(Key && key, M && obj)
+            {
+                auto r = try_emplace(std::move(key), std::forward<M>(obj));
+                if(!r.second)
+                    r.first->second = std::forward<M>(obj);
+                return r;
+            }
+
+            iterator erase(const_iterator pos) noexcept
+            {
+                size_type i = pos.ctrl_ - ctrl_;
+                erase_at(i);
+                iterator next = iterator_at(i);
+                return next;
+            }
+            iterator erase(iterator pos) noexcept
+            {
+                return erase(const_iterator(pos));
+            }
+            size_type erase(const Key & key)
+            {
+                size_type i = find_index(key, hash_of(key));
+                if(i == capacity_)
+                    return 0;
+                erase_at(i);
+                return 1;
+            }
+            template <typename K, typename = std::enable_if_t<transparent_lookup<K> && !std::is_convertible_v<K, const_iterator>>>
+            size_type erase(const K & key)
+            {
+                size_type i = find_index(key, hash_of(key));
+                if(i == capacity_)
+                    return 0;
+                erase_at(i);
+                return 1;
+            }
+
+            void swap(secure_unordered_map & other) noexcept
+            {
+                using std::swap;
+                swap(hash_, other.hash_);
+                swap(eq_, other.eq_);
+                if constexpr(chunk_traits::propagate_on_container_swap::value)
+                    swap(alloc_, other.alloc_);
+                swap(ctrl_, other.ctrl_);
+                swap(slots_, other.slots_);
+                swap(capacity_, other.capacity_);
+                swap(size_, other.size_);
+                swap(growth_left_, other.growth_left_);
+            }
+
+            // Lookup
+            iterator find(const Key & key)
+            {
+                size_type i = find_index(key, hash_of(key));
+                return i == capacity_ ? end() : iterator_at(i);
+            }
+            const_iterator find(const Key & key) const
+            {
+                size_type i = find_index(key, hash_of(key));
+                return i == capacity_ ? end() : iterator_at(i);
+            }
+            template <typename K, typename = std::enable_if_t<transparent_lookup<K>>>
+            iterator find(const K & key)
+            {
+                size_type i = find_index(key, hash_of(key));
+                return i == capacity_ ? end() : iterator_at(i);
+            }
+            template <typename K, typename = std::enable_if_t<transparent_lookup<K>>>
+            const_iterator find(const K & key) const
+            {
+                size_type i = find_index(key, hash_of(key));
+                return i == capacity_ ? end() : iterator_at(i);
+            }
+            bool contains(const Key & key) const
+            {
+                return find(key) != end();
+            }
+            template <typename K, typename = std::enable_if_t<transparent_lookup<K>>>
+            bool contains(const K & key) const
+            {
+                return find(key) != end();
+            }
+            size_type count(const Key & key) const
+            {
+                return contains(key);
+            }
+            template <typename K, typename = std::enable_if_t<transparent_lookup<K>>>
+            size_type count(const K & key) const
+            {
+                return contains(key);
+            }
+
+            T & at(const Key & key)
+            {
+                return const_cast<T &>(std::as_const(*this).at(key));
+            }
+            const T & at(const Key & key) const
+            {
+                const_iterator it = find(key);
+                if(it == end())
+                    throw std::out_of_range("merl::secure_unordered_map::at(): Out of range -> Key not found");
+                return it->second;
+            }
+            template <typename K, typename = std::enable_if_t<transparent_lookup<K>>>
+            T & at(const K & key)
+            {
+                return const_cast<T &>(std::as_const(*this).at(key));
+            }
+            template <typename K, typename = std::enable_if_t<transparent_lookup<K>>>
+            const T & at(const K & key) const
+            {
+                const_iterator it = find(key);
+                if(it == end())
+                    throw std::out_of_range("merl::secure_unordered_map::at(): Out of range -> Key not found");
+                return it->second;
+            }
+            T & operator[](const Key & key)
+            {
+                return try_emplace(key).first->second;
+            }
+            T & operator[](Key && key)
+            {
+                return try_emplace(std::move(key)).first->second;
+            }
+    };
+
+    // Non-member functions
+    template <typename Key, typename T, typename Hash, typename KeyEqual, typename Alloc>
+    bool operator==(const secure_unordered_map<Key, T, Hash, KeyEqual, Alloc> & lhs, const secure_unordered_map<Key, T, Hash, KeyEqual, Alloc> & rhs)
+    {
+        if(lhs.size() != rhs.size())
+            return false;
+
+        for(const auto & entry : lhs)
+        {
+            auto it = rhs.find(entry.first);
+            if(it == rhs.end() || !(it->second == entry.second))
+                return false;
+        }
+        return true;
+    }
+
+    template <typename Key, typename T, typename Hash, typename KeyEqual, typename Alloc>
+    void swap(secure_unordered_map<Key, T, Hash, KeyEqual, Alloc> & lhs, secure_unordered_map<Key, T, Hash, KeyEqual, Alloc> & rhs) noexcept
+    {
+        lhs.swap(rhs);
+    }
+
+    template <typename Key, typename T, typename Hash, typename KeyEqual, typename Alloc, typename Pred>
+    typename secure_unordered_map<Key, T, Hash, KeyEqual, Alloc>::size_type erase_if(secure_unordered_map<Key, T, Hash, KeyEqual, Alloc> & m, Pred pred)
+    {
+        typename secure_unordered_map<Key, T, Hash, KeyEqual, Alloc>::size_type n = 0;
+        for(auto it = m.begin(); it != m.end();)
+        {
+            if(pred(*it))
+            {
+                it = m.erase(it);
+                ++n;
+            }
+            else
+                ++it;
+        }
+        return n;
+    }
+}
+
+#endif // MERLIN_SECURE_UNORDERED_MAP_HPP
@@ -0,0 +1,606 @@
+#ifndef MERLIN_SECURE_VECTOR_HPP
+#define MERLIN_SECURE_VECTOR_HPP
+
+#include <merlin_detail.hpp>
+#include <algorithm>
+#include <compare>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+// secure_vector<T, Alloc>: a contiguous dynamic array for binary keys, nonces and derived material.
+// It follows basic_password's secure_del() rule: storage is wiped before it goes back to the allocator,
+// whether it is released on destruction or left behind by a reallocation. Slots that leave the live range
+// (clear, erase, pop_back, shrinking resize) are wiped in place as well. Capacity grows geometrically (x2),
+// and resize_for_overwrite() grows without initializing trivial elements, for buffers a KDF or RNG is about to fill.
+// Any standard allocator works; the wiping does not depend on it (secure_allocator adds cache-line alignment).
+
+namespace merl
+{
+    template <typename T, typename Alloc = std::allocator<T>>
+    class secure_vector
+    {
+        public:
+            using value_type = T;
+            using allocator_type = Alloc;
+            using size_type = std::size_t;
+            using difference_type = std::ptrdiff_t;
+            using reference = value_type &;
+            using const_reference = const value_type &;
+            using pointer = value_type *;
+            using const_pointer = const value_type *;
+            using iterator = value_type *;
+            using const_iterator = const value_type *;
+            using reverse_iterator = std::reverse_iterator<iterator>;
+            using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        private:
+            using alloc_traits = std::allocator_traits<Alloc>;
+
+            [[no_unique_address]] Alloc alloc_;
+            T * data_ = nullptr;
+            size_type size_ = 0;
+            size_type capacity_ = 0;
+
+            // Destroys [first, last) and wipes the bytes they occupied
+            void destroy(T * first, T * last) noexcept
+            {
+                for(T * p = first; p != last; ++p)
+                    alloc_traits::destroy(alloc_, p);
+                detail::secure_zero(first, (last - first) * sizeof(T));
+            }
+            // Wipes the whole block, then gives it back to the allocator
+            void secure_del(T * p, size_type capacity) noexcept
+            {
+                if(!p)
+                    return;
+                detail::secure_zero(p, capacity * sizeof(T));
+                alloc_traits::deallocate(alloc_, p, capacity);
+            }
+            void release() noexcept
+            {
+                destroy(data_, data_ + size_);
+                secure_del(data_, capacity_);
+                data_ = nullptr;
+                size_ = capacity_ = 0;
+            }
+
+            size_type grown_capacity(size_type needed, const char * func) const
+            {
+                if(needed > max_size())
+                    throw std::length_error(std::string("merl::secure_vector::") + func + "(): Length error -> Maximum size exceeded");
+
+                return std::max(needed, capacity_ > max_size() / 2 ? max_size() : capacity_ * 2);
+            }
+            // Moves the elements to a new block of new_capacity after make(new_block) constructed whatever goes
+            // at [size_, ...): the old elements stay readable (and may be the source) until then.
+            template <typename Make>
+            void reallocate(size_type new_capacity, Make make)
+            {
+                T * target = alloc_traits::allocate(alloc_, new_capacity);
+                size_type made = 0;
+                try
+                {
+                    made = make(target);
+                    if constexpr(std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
+                    {
+                        for(size_type i = 0; i < size_; ++i)
+                            alloc_traits::construct(alloc_, target + i, std::move(data_[i]));
+                    }
+                    else
+                    {
+                        size_type i = 0;
+                        try
+                        {
+                            for(; i < size_; ++i)
+                                alloc_traits::construct(alloc_, target + i, std::as_const(data_[i]));
+                        }
+                        catch(...)
+                        {
+                            std::destroy(target, target + i);
+                            throw;
+                        }
+                    }
+                }
+                catch(...)
+                {
+                    std::destroy(target + size_, target + size_ + made);
+                    secure_del(target, new_capacity);
+                    throw;
+                }
+
+                destroy(data_, data_ + size_);
+                secure_del(data_, capacity_);
+                data_ = target;
+                capacity_ = new_capacity;
+            }
+
+            // Appends count elements built by construct(slot, i); on a reallocation they are built before the old elements move
+            template <typename Construct>
+            void append_n(size_type count, Construct construct, const char * func)
+            {
+                if(count > capacity_ - size_)
+                {
+                    reallocate(grown_capacity(size_ + count, func), [&](T * target)
+                    {
+                        size_type i = 0;
+                        try
+                        {
+                            for(; i < count; ++i)
+                                construct(target + size_ + i, i);
+                        }
+                        catch(...)
+                        {
+                            std::destroy(target + size_, target + size_ + i);
+                            throw;
+                        }
+                        return count;
+                    });
+                }
+                else
+                {
+                    size_type i = 0;
+                    try
+                    {
+                        for(; i < count; ++i)
+                            construct(data_ + size_ + i, i);
+                    }
+                    catch(...)
+                    {
+                        destroy(data_ + size_, data_ + size_ + i);
+                        throw;
+                    }
+                }
+                size_ += count;
+            }
+            template <typename InputIt>
+            void append_range(InputIt first, InputIt last, const char * func)
+            {
+                if constexpr(std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>)
+                {
+                    append_n(static_cast<size_type>(std::distance(first, last)), [&](T * slot, size_type)
+                    {
+                        alloc_traits::construct(alloc_, slot, *first);
+                        ++first;
+                    }, func);
+                }
+                else
+                {
+                    for(; first != last; ++first)
+                        emplace_back(*first);
+                }
+            }
+            iterator check_iterator(const_iterator pos, const char * func) const
+            {
+                if(pos < data_ || pos > data_ + size_)
+                    throw std::invalid_argument(std::string("merl::secure_vector::") + func + "(): Invalid argument -> Invalid iterator");
+
+                return const_cast<iterator>(pos);
+            }
+
+        public:
+            // Constructors
+            secure_vector() noexcept(noexcept(Alloc()))
+            {}
+            explicit secure_vector(const Alloc & alloc) noexcept : alloc_{alloc}
+            {}
+            explicit secure_vector(size_type count, const Alloc & alloc = Alloc()) : alloc_{alloc}
+            {
+                resize(count);
+            }
+            secure_vector(size_type count, const T & value, const Alloc & alloc = Alloc()) : alloc_{alloc}
+            {
+                resize(count, value);
+            }
+            template <typename InputIt, typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+            secure_vector(InputIt first, InputIt last, const Alloc & alloc = Alloc()) : alloc_{alloc}
+            {
+                append_range(first, last, "secure_vector");
+            }
+            secure_vector(std::initializer_list<T> il, const Alloc & alloc = Alloc()) : secure_vector(il.begin(), il.end(), alloc)
+            {}
+
+            secure_vector(const secure_vector & other) : secure_vector(other, alloc_traits::select_on_container_copy_construction(other.alloc_))
+            {}
+            secure_vector(const secure_vector & other, const Alloc & alloc) : alloc_{alloc}
+            {
+                reserve(other.size_);
+                append_range(other.begin(), other.end(), "secure_vector");
+            }
+            secure_vector(secure_vector && other) noexcept
+                : alloc_{std::move(other.alloc_)}, data_{std::exchange(other.data_, nullptr)},
+                  size_{std::exchange(other.size_, 0)}, capacity_{std::exchange(other.capacity_, 0)}
+            {}
+
+            // Destructor
+            ~secure_vector()
+            {
+                release();
+            }
+
+            // Assignment
+            secure_vector & operator=(const secure_vector & other)
+            {
+                if(&other != this)
+                {
+                    if constexpr(alloc_traits::propagate_on_container_copy_assignment::value)
+                    {
+                        if(alloc_ != other.alloc_)
+                            release();
+                        alloc_ = other.alloc_;
+                    }
+                    assign(other.begin(), other.end());
+                }
+                return *this;
+            }
+            secure_vector & operator=(secure_vector && other) noexcept(alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value)
+            {
+                if(&other != this)
+                {
+                    if constexpr(alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value)
+                    {
+                        release();
+                        if constexpr(alloc_traits::propagate_on_container_move_assignment::value)
+                            alloc_ = std::move(other.alloc_);
+                        data_ = std::exchange(other.data_, nullptr);
+                        size_ = std::exchange(other.size_, 0);
+                        capacity_ = std::exchange(other.capacity_, 0);
+                    }
+                    else if(alloc_ == other.alloc_)
+                    {
+                        release();
+                        data_ = std::exchange(other.data_, nullptr);
+                        size_ = std::exchange(other.size_, 0);
+                        capacity_ = std::exchange(other.capacity_, 0);
+                    }
+                    else
+                    {
+                        assign(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+                        other.release();
+                    }
+                }
+                return *this;
+            }
+            secure_vector & operator=(std::initializer_list<T> il)
+            {
+                assign(il.begin(), il.end());
+                return *this;
+            }
+
+            void assign(size_type count, const T & value)
+            {
+                if(count > capacity_)
+                {
+                    secure_vector tmp(count, value, alloc_);
+                    swap(tmp);
+                }
+                else
+                {
+                    clear();
+                    resize(count, value);
+                }
+            }
+            template <typename InputIt, typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+            void assign(InputIt first, InputIt last)
+            {
+                clear();
+                append_range(first, last, "assign");
+            }
+            void assign(std::initializer_list<T> il)
+            {
+                assign(il.begin(), il.end());
+            }
+
+            allocator_type get_allocator() const noexcept
+            {
+                return alloc_;
+            }
+
+            // Elements access
+            const_reference operator[](size_type pos) const
+            {
+                return data_[pos];
+            }
+            reference operator[](size_type pos)
+            {
+                return data_[pos];
+            }
+            const_reference at(size_type pos) const
+            {
+                if(pos >= size_)
+                    throw std::out_of_range("merl::secure_vector::at(): Out of range (pos = " + std::to_string(pos) + ", size = " + std::to_string(size_) + ')');
+
+                return data_[pos];
+            }
+            reference at(size_type pos)
+            {
+                return const_cast<T &>(std::as_const(*this).at(pos));
+            }
+            const_reference front() const
+            {
+                return data_[0];
+            }
+            reference front()
+            {
+                return data_[0];
+            }
+            const_reference back() const
+            {
+                return data_[size_-1];
+            }
+            reference back()
+            {
+                return data_[size_-1];
+            }
+            const_pointer data() const noexcept
+            {
+                return data_;
+            }
+            pointer data() noexcept
+            {
+                return data_;
+            }
+
+            // Iterators
+            const_iterator cbegin() const noexcept
+            {
+                return data_;
+            }
+            const_iterator begin() const noexcept
+            {
+                return data_;
+            }
+            iterator begin() noexcept
+            {
+                return data_;
+            }
+            const_iterator cend() const noexcept
+            {
+                return data_+size_;
+            }
+            const_iterator end() const noexcept
+            {
+                return data_+size_;
+            }
+            iterator end() noexcept
+            {
+                return data_+size_;
+            }
+            const_reverse_iterator crbegin() const noexcept
+            {
+                return const_reverse_iterator(end());
+            }
+            const_reverse_iterator rbegin() const noexcept
+            {
+                return const_reverse_iterator(end());
+            }
+            reverse_iterator rbegin() noexcept
+            {
+                return reverse_iterator(end());
+            }
+            const_reverse_iterator crend() const noexcept
+            {
+                return const_reverse_iterator(begin());
+            }
+            const_reverse_iterator rend() const noexcept
+            {
+                return const_reverse_iterator(begin());
+            }
+            reverse_iterator rend() noexcept
+            {
+                return reverse_iterator(begin());
+            }
+
+            // Capacity
+            bool empty() const noexcept
+            {
+                return !size_;
+            }
+            size_type size() const noexcept
+            {
+                return size_;
+            }
+            size_type max_size() const noexcept
+            {
+                return std::min<size_type>(alloc_traits::max_size(alloc_), std::numeric_limits<difference_type>::max() / sizeof(T));
+            }
+            size_type capacity() const noexcept
+            {
+                return capacity_;
+            }
+            void reserve(size_type new_capacity)
+            {
+                if(new_capacity > max_size())
+                    throw std::length_error("merl::secure_vector::reserve(): Length error -> Maximum size exceeded");
+
+                if(new_capacity > capacity_)
+                    reallocate(new_capacity, [](T *) { return size_type{0}; });
+            }
+            void shrink_to_fit()
+            {
+                if(capacity_ == size_)
+                    return;
+
+                if(!size_)
+                    release();
+                else
+                    reallocate(size_, [](T *) { return size_type{0}; });
+            }
+
+            // Modifiers
+            // Keeps the capacity; the released slots are wiped
+            void clear() noexcept
+            {
+                destroy(data_, data_ + size_);
+                size_ = 0;
+            }
+
+            template <typename... Args>
+            reference emplace_back(Args &&... args)
+            {
+                append_n(1, [&](T * slot, size_type) { alloc_traits::construct(alloc_, slot, std::forward<Args>(args)...); }, "emplace_back");
+                return back();
+            }
+            void push_back(const T & value)
+            {
+                emplace_back(value);
+            }
+            void push_back(T && value)
+            {
+                emplace_back(std::move(value));
+            }
+            void pop_back()
+            {
+                destroy(data_ + size_ - 1, data_ + size_);
+                --size_;
+            }
+
+            // Insertions build the new elements at the end, then rotate them into place
+            template <typename... Args>
+            iterator emplace(const_iterator pos, Args &&... args)
+            {
+                size_type index = check_iterator(pos, "emplace") - data_;
+                emplace_back(std::forward<Args>(args)...);
+                std::rotate(data_ + index, data_ + size_ - 1, data_ + size_);
+                return data_ + index;
+            }
+            iterator insert(const_iterator pos, const T & value)
+            {
+                return emplace(pos, value);
+            }
+            iterator insert(const_iterator pos, T && value)
+            {
+                return emplace(pos, std::move(value));
+            }
+            iterator insert(const_iterator pos, size_type count, const T & value)
+            {
+                size_type index = check_iterator(pos, "insert") - data_;
+                size_type old_size = size_;
+                append_n(count, [&](T * slot, size_type) { alloc_traits::construct(alloc_, slot, value); }, "insert");
+                std::rotate(data_ + index, data_ + old_size, data_ + size_);
+                return data_ + index;
+            }
+            template <typename InputIt, typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+            iterator insert(const_iterator pos, InputIt first, InputIt last)
+            {
+                size_type index = check_iterator(pos, "insert") - data_;
+                size_type old_size = size_;
+                append_range(first, last, "insert");
+                std::rotate(data_ + index, data_ + old_size, data_ + size_);
+                return data_ + index;
+            }
+            iterator insert(const_iterator pos, std::initializer_list<T> il)
+            {
+                return insert(pos, il.begin(), il.end());
+            }
+
+            iterator erase(const_iterator pos)
+            {
+                if(check_iterator(pos, "erase") == end())
+                    throw std::invalid_argument("merl::secure_vector::erase(): Invalid argument -> Invalid iterator");
+
+                return erase(pos, pos + 1);
+            }
+            iterator erase(const_iterator first, const_iterator last)
+            {
+                iterator f = check_iterator(first, "erase");
+                iterator l = check_iterator(last, "erase");
+                if(f > l)
+                    throw std::invalid_argument("merl::secure_vector::erase(): Invalid argument -> Invalid iterator");
+
+                if(f != l)
+                {
+                    iterator new_end = std::move(l, end(), f);
+                    destroy(new_end, end());
+                    size_ = new_end - data_;
+                }
+                return f;
+            }
+
+            void resize(size_type count)
+            {
+                if(count < size_)
+                {
+                    destroy(data_ + count, data_ + size_);
+                    size_ = count;
+                }
+                else
+                    append_n(count - size_, [&](T * slot, size_type) { alloc_traits::construct(alloc_, slot); }, "resize");
+            }
+            void resize(size_type count, const T & value)
+            {
+                if(count < size_)
+                {
+                    destroy(data_ + count, data_ + size_);
+                    size_ = count;
+                }
+                else
+                    append_n(count - size_, [&](T * slot, size_type) { alloc_traits::construct(alloc_, slot, value); }, "resize");
+            }
+            // Like resize(), but new elements are default-initialized: trivial ones keep whatever bytes the block held,
+            // so the caller must overwrite all of them
+            void resize_for_overwrite(size_type count)
+            {
+                if(count < size_)
+                {
+                    destroy(data_ + count, data_ + size_);
+                    size_ = count;
+                }
+                else
+                    append_n(count - size_, [](T * slot, size_type) { ::new(static_cast<void *>(slot)) T; }, "resize_for_overwrite");
+            }
+
+            void swap(secure_vector & other) noexcept
+            {
+                using std::swap;
+                if constexpr(alloc_traits::propagate_on_container_swap::value)
+                    swap(alloc_, other.alloc_);
+                swap(data_, other.data_);
+                swap(size_, other.size_);
+                swap(capacity_, other.capacity_);
+            }
+    };
+
+    // Non-member functions
+    template <typename T, typename Alloc>
+    bool operator==(const secure_vector<T, Alloc> & lhs, const secure_vector<T, Alloc> & rhs)
+    {
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+    template <typename T, typename Alloc>
+    auto operator<=>(const secure_vector<T, Alloc> & lhs, const secure_vector<T, Alloc> & rhs)
+    {
+        return std::lexicographical_compare_three_way(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+
+    template <typename T, typename Alloc>
+    void swap(secure_vector<T, Alloc> & lhs, secure_vector<T, Alloc> & rhs) noexcept
+    {
+        lhs.swap(rhs);
+    }
+
+    template <typename T, typename Alloc, typename U>
+    secure_vector<T, Alloc>::size_type erase(secure_vector<T, Alloc> & v, const U & value)
+    {
+        auto it = std::remove(v.begin(), v.end(), value);
+        auto r = v.end() - it;
+        v.erase(it, v.end());
+        return r;
+    }
+    template <typename T, typename Alloc, typename Pred>
+    secure_vector<T, Alloc>::size_type erase_if(secure_vector<T, Alloc> & v, Pred pred)
+    {
+        auto it = std::remove_if(v.begin(), v.end(), pred);
+        auto r = v.end() - it;
+        v.erase(it, v.end());
+        return r;
+    }
+}
+
+#endif // MERLIN_SECURE_VECTOR_HPP
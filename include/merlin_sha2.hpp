@@ -0,0 +1,499 @@
+#ifndef MERLIN_SHA2_HPP
+#define MERLIN_SHA2_HPP
+
+#include <merlin_basic_password.hpp>
+#include <merlin_detail.hpp>
+
+#include <string_view>
+
+// SHA-256 and SHA-512 (FIPS 180-4) with incremental contexts that hash basic_password storage in place.
+// Whole blocks are compressed straight from the caller's buffer; only a partial trailing block is buffered.
+// The context, and every message schedule derived from the input, is wiped once it is no longer needed.
+// SHA-256 uses the SHA extensions when available, otherwise AVX2; SHA-512 uses AVX2 for the message schedule.
+
+namespace merl
+{
+    namespace detail
+    {
+        inline constexpr std::uint32_t sha256_k[64] = {
+            0x428a2f98u, 0x71374491u, 0xb5c0fbcfu, 0xe9b5dba5u, 0x3956c25bu, 0x59f111f1u, 0x923f82a4u, 0xab1c5ed5u,
+            0xd807aa98u, 0x12835b01u, 0x243185beu, 0x550c7dc3u, 0x72be5d74u, 0x80deb1feu, 0x9bdc06a7u, 0xc19bf174u,
+            0xe49b69c1u, 0xefbe4786u, 0x0fc19dc6u, 0x240ca1ccu, 0x2de92c6fu, 0x4a7484aau, 0x5cb0a9dcu, 0x76f988dau,
+            0x983e5152u, 0xa831c66du, 0xb00327c8u, 0xbf597fc7u, 0xc6e00bf3u, 0xd5a79147u, 0x06ca6351u, 0x14292967u,
+            0x27b70a85u, 0x2e1b2138u, 0x4d2c6dfcu, 0x53380d13u, 0x650a7354u, 0x766a0abbu, 0x81c2c92eu, 0x92722c85u,
+            0xa2bfe8a1u, 0xa81a664bu, 0xc24b8b70u, 0xc76c51a3u, 0xd192e819u, 0xd6990624u, 0xf40e3585u, 0x106aa070u,
+            0x19a4c116u, 0x1e376c08u, 0x2748774cu, 0x34b0bcb5u, 0x391c0cb3u, 0x4ed8aa4au, 0x5b9cca4fu, 0x682e6ff3u,
+            0x748f82eeu, 0x78a5636fu, 0x84c87814u, 0x8cc70208u, 0x90befffau, 0xa4506cebu, 0xbef9a3f7u, 0xc67178f2u
+        };
+        inline constexpr std::uint64_t sha512_k[80] = {
+            0x428a2f98d728ae22ull, 0x7137449123ef65cdull, 0xb5c0fbcfec4d3b2full, 0xe9b5dba58189dbbcull,
+            0x3956c25bf348b538ull, 0x59f111f1b605d019ull, 0x923f82a4af194f9bull, 0xab1c5ed5da6d8118ull,
+            0xd807aa98a3030242ull, 0x12835b0145706fbeull, 0x243185be4ee4b28cull, 0x550c7dc3d5ffb4e2ull,
+            0x72be5d74f27b896full, 0x80deb1fe3b1696b1ull, 0x9bdc06a725c71235ull, 0xc19bf174cf692694ull,
+            0xe49b69c19ef14ad2ull, 0xefbe4786384f25e3ull, 0x0fc19dc68b8cd5b5ull, 0x240ca1cc77ac9c65ull,
+            0x2de92c6f592b0275ull, 0x4a7484aa6ea6e483ull, 0x5cb0a9dcbd41fbd4ull, 0x76f988da831153b5ull,
+            0x983e5152ee66dfabull, 0xa831c66d2db43210ull, 0xb00327c898fb213full, 0xbf597fc7beef0ee4ull,
+            0xc6e00bf33da88fc2ull, 0xd5a79147930aa725ull, 0x06ca6351e003826full, 0x142929670a0e6e70ull,
+            0x27b70a8546d22ffcull, 0x2e1b21385c26c926ull, 0x4d2c6dfc5ac42aedull, 0x53380d139d95b3dfull,
+            0x650a73548baf63deull, 0x766a0abb3c77b2a8ull, 0x81c2c92e47edaee6ull, 0x92722c851482353bull,
+            0xa2bfe8a14cf10364ull, 0xa81a664bbc423001ull, 0xc24b8b70d0f89791ull, 0xc76c51a30654be30ull,
+            0xd192e819d6ef5218ull, 0xd69906245565a910ull, 0xf40e35855771202aull, 0x106aa07032bbd1b8ull,
+            0x19a4c116b8d2d0c8ull, 0x1e376c085141ab53ull, 0x2748774cdf8eeb99ull, 0x34b0bcb5e19b48a8ull,
+            0x391c0cb3c5c95a63ull, 0x4ed8aa4ae3418acbull, 0x5b9cca4f7763e373ull, 0x682e6ff3d6b2b8a3ull,
+            0x748f82ee5defb2fcull, 0x78a5636f43172f60ull, 0x84c87814a1f0ab72ull, 0x8cc702081a6439ecull,
+            0x90befffa23631e28ull, 0xa4506cebde82bde9ull, 0xbef9a3f7b2c67915ull, 0xc67178f2e372532bull,
+            0xca273eceea26619cull, 0xd186b8c721c0c207ull, 0xeada7dd6cde0eb1eull, 0xf57d4f7fee6ed178ull,
+            0x06f067aa72176fbaull, 0x0a637dc5a2c898a6ull, 0x113f9804bef90daeull, 0x1b710b35131c471bull,
+            0x28db77f523047d84ull, 0x32caab7b40c72493ull, 0x3c9ebe0a15c9bebcull, 0x431d67c49c100d4cull,
+            0x4cc5d4becb3e42b6ull, 0x597f299cfc657e2aull, 0x5fcb6fab3ad6faecull, 0x6c44198c4a475817ull
+        };
+
+        template <typename Word>
+        Word load_be(const unsigned char * p) noexcept
+        {
+            Word v = 0;
+            for(std::size_t i = 0; i < sizeof(Word); ++i)
+                v = (v << 8) | p[i];
+            return v;
+        }
+        template <typename Word>
+        void store_be(unsigned char * p, Word v) noexcept
+        {
+            for(std::size_t i = sizeof(Word); i--; v >>= 8)
+                p[i] = static_cast<unsigned char>(v);
+        }
+
+        // --- Rounds over a precomputed W[t] + K[t] schedule, shared by the scalar and AVX2 kernels ---
+        inline void sha256_round(std::uint32_t a, std::uint32_t b, std::uint32_t c, std::uint32_t & d, std::uint32_t e, std::uint32_t f, std::uint32_t g, std::uint32_t & h, std::uint32_t wk) noexcept
+        {
+            std::uint32_t t1 = h + (rotr32(e, 6) ^ rotr32(e, 11) ^ rotr32(e, 25)) + ((e & f) ^ (~e & g)) + wk;
+            d += t1;
+            h = t1 + (rotr32(a, 2) ^ rotr32(a, 13) ^ rotr32(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        }
+        inline void sha256_rounds(std::uint32_t * state, const std::uint32_t * wk) noexcept
+        {
+            std::uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+            std::uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+            // Eight rounds per iteration, rotating the roles of the variables instead of moving them
+            for(int t = 0; t < 64; t += 8)
+            {
+                sha256_round(a, b, c, d, e, f, g, h, wk[t]);
+                sha256_round(h, a, b, c, d, e, f, g, wk[t + 1]);
+                sha256_round(g, h, a, b, c, d, e, f, wk[t + 2]);
+                sha256_round(f, g, h, a, b, c, d, e, wk[t + 3]);
+                sha256_round(e, f, g, h, a, b, c, d, wk[t + 4]);
+                sha256_round(d, e, f, g, h, a, b, c, wk[t + 5]);
+                sha256_round(c, d, e, f, g, h, a, b, wk[t + 6]);
+                sha256_round(b, c, d, e, f, g, h, a, wk[t + 7]);
+            }
+            state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+            state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+        }
+        inline void sha512_round(std::uint64_t a, std::uint64_t b, std::uint64_t c, std::uint64_t & d, std::uint64_t e, std::uint64_t f, std::uint64_t g, std::uint64_t & h, std::uint64_t wk) noexcept
+        {
+            std::uint64_t t1 = h + (rotr64(e, 14) ^ rotr64(e, 18) ^ rotr64(e, 41)) + ((e & f) ^ (~e & g)) + wk;
+            d += t1;
+            h = t1 + (rotr64(a, 28) ^ rotr64(a, 34) ^ rotr64(a, 39)) + ((a & b) ^ (a & c) ^ (b & c));
+        }
+        inline void sha512_rounds(std::uint64_t * state, const std::uint64_t * wk) noexcept
+        {
+            std::uint64_t a = state[0], b = state[1], c = state[2], d = state[3];
+            std::uint64_t e = state[4], f = state[5], g = state[6], h = state[7];
+            // Eight rounds per iteration, rotating the roles of the variables instead of moving them
+            for(int t = 0; t < 80; t += 8)
+            {
+                sha512_round(a, b, c, d, e, f, g, h, wk[t]);
+                sha512_round(h, a, b, c, d, e, f, g, wk[t + 1]);
+                sha512_round(g, h, a, b, c, d, e, f, wk[t + 2]);
+                sha512_round(f, g, h, a, b, c, d, e, wk[t + 3]);
+                sha512_round(e, f, g, h, a, b, c, d, wk[t + 4]);
+                sha512_round(d, e, f, g, h, a, b, c, wk[t + 5]);
+                sha512_round(c, d, e, f, g, h, a, b, wk[t + 6]);
+                sha512_round(b, c, d, e, f, g, h, a, wk[t + 7]);
+            }
+            state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+            state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+        }
+
+        // --- Portable kernels ---
+        inline void sha256_blocks_scalar(std::uint32_t * state, const unsigned char * p, std::size_t blocks) noexcept
+        {
+            std::uint32_t w[64];
+            for(; blocks; --blocks, p += 64)
+            {
+                for(int t = 0; t < 16; ++t)
+                    w[t] = load_be<std::uint32_t>(p + 4*t);
+                for(int t = 16; t < 64; ++t)
+                    w[t] = (rotr32(w[t-2], 17) ^ rotr32(w[t-2], 19) ^ (w[t-2] >> 10)) + w[t-7]
+                         + (rotr32(w[t-15], 7) ^ rotr32(w[t-15], 18) ^ (w[t-15] >> 3)) + w[t-16];
+                for(int t = 0; t < 64; ++t)
+                    w[t] += sha256_k[t];
+                sha256_rounds(state, w);
+            }
+            secure_zero(w, sizeof(w));
+        }
+        inline void sha512_blocks_scalar(std::uint64_t * state, const unsigned char * p, std::size_t blocks) noexcept
+        {
+            std::uint64_t w[80];
+            for(; blocks; --blocks, p += 128)
+            {
+                for(int t = 0; t < 16; ++t)
+                    w[t] = load_be<std::uint64_t>(p + 8*t);
+                for(int t = 16; t < 80; ++t)
+                    w[t] = (rotr64(w[t-2], 19) ^ rotr64(w[t-2], 61) ^ (w[t-2] >> 6)) + w[t-7]
+                         + (rotr64(w[t-15], 1) ^ rotr64(w[t-15], 8) ^ (w[t-15] >> 7)) + w[t-16];
+                for(int t = 0; t < 80; ++t)
+                    w[t] += sha512_k[t];
+                sha512_rounds(state, w);
+            }
+            secure_zero(w, sizeof(w));
+        }
+
+#if MERLIN_X86_SIMD
+        // --- SHA extensions (SHA-256 only) ---
+        MERLIN_TARGET("sha,sse4.1")
+        inline void sha256_blocks_shani(std::uint32_t * state, const unsigned char * p, std::size_t blocks) noexcept
+        {
+            const __m128i bswap = _mm_set_epi64x(0x0c0d0e0f08090a0bll, 0x0405060700010203ll);
+
+            // The instructions keep the state as ABEF / CDGH
+            __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(state)), 0xb1);
+            __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(state + 4)), 0x1b);
+            __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+            state1 = _mm_blend_epi16(state1, tmp, 0xf0);
+
+            for(; blocks; --blocks, p += 64)
+            {
+                const __m128i abef = state0;
+                const __m128i cdgh = state1;
+                __m128i msg[4];
+
+#if defined(__GNUC__)
+                #pragma GCC unroll 16
+#endif
+                for(int g = 0; g < 16; ++g)
+                {
+                    if(g < 4)
+                        msg[g] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16*g)), bswap);
+                    __m128i wk = _mm_add_epi32(msg[g % 4], _mm_loadu_si128(reinterpret_cast<const __m128i *>(sha256_k + 4*g)));
+                    state1 = _mm_sha256rnds2_epu32(state1, state0, wk);
+                    if(g >= 3 && g < 15)
+                    {
+                        __m128i w7 = _mm_alignr_epi8(msg[g % 4], msg[(g + 3) % 4], 4);
+                        msg[(g + 1) % 4] = _mm_sha256msg2_epu32(_mm_add_epi32(msg[(g + 1) % 4], w7), msg[g % 4]);
+                    }
+                    state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(wk, 0x0e));
+                    if(g >= 1 && g < 13)
+                        msg[(g + 3) % 4] = _mm_sha256msg1_epu32(msg[(g + 3) % 4], msg[g % 4]);
+                }
+
+                state0 = _mm_add_epi32(state0, abef);
+                state1 = _mm_add_epi32(state1, cdgh);
+                for(__m128i & m : msg)
+                    m = _mm_setzero_si128();
+            }
+
+            tmp = _mm_shuffle_epi32(state0, 0x1b);
+            state1 = _mm_shuffle_epi32(state1, 0xb1);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(state), _mm_blend_epi16(tmp, state1, 0xf0));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(state + 4), _mm_alignr_epi8(state1, tmp, 8));
+        }
+
+        // --- AVX2 message schedules ---
+        // Two blocks are scheduled at once, one per 128-bit lane (an odd last block is paired with itself);
+        // the rounds then run over the W[t] + K[t] buffer of each block in turn.
+        MERLIN_TARGET("avx2")
+        inline __m256i sha256_load2_avx2(const unsigned char * a, const unsigned char * b) noexcept
+        {
+            const __m256i bswap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                                   3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+            __m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a))),
+                                                _mm_loadu_si128(reinterpret_cast<const __m128i *>(b)), 1);
+            return _mm256_shuffle_epi8(v, bswap);
+        }
+        MERLIN_TARGET("avx2")
+        inline void store_wk2_avx2(void * a, void * b, __m256i v) noexcept
+        {
+            _mm_store_si128(static_cast<__m128i *>(a), _mm256_castsi256_si128(v));
+            _mm_store_si128(static_cast<__m128i *>(b), _mm256_extracti128_si256(v, 1));
+        }
+        MERLIN_TARGET("avx2")
+        inline __m256i sha256_sigma1_avx2(__m256i v) noexcept
+        {
+            return _mm256_xor_si256(_mm256_xor_si256(_mm256_or_si256(_mm256_srli_epi32(v, 17), _mm256_slli_epi32(v, 15)),
+                                                     _mm256_or_si256(_mm256_srli_epi32(v, 19), _mm256_slli_epi32(v, 13))),
+                                    _mm256_srli_epi32(v, 10));
+        }
+        MERLIN_TARGET("avx2")
+        inline void sha256_blocks_avx2(std::uint32_t * state, const unsigned char * p, std::size_t blocks) noexcept
+        {
+            alignas(32) std::uint32_t wk[2][64];
+            while(blocks)
+            {
+                const bool pair = blocks >= 2;
+                const unsigned char * q = pair ? p + 64 : p;
+
+                // x[j] holds W[4j..4j+3] (mod 16) of both blocks
+                __m256i x[4];
+                for(int j = 0; j < 4; ++j)
+                {
+                    x[j] = sha256_load2_avx2(p + 16*j, q + 16*j);
+                    __m256i k = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(sha256_k + 4*j)));
+                    store_wk2_avx2(wk[0] + 4*j, wk[1] + 4*j, _mm256_add_epi32(x[j], k));
+                }
+
+#if defined(__GNUC__)
+                #pragma GCC unroll 12
+#endif
+                for(int t = 16; t < 64; t += 4)
+                {
+                    const int j = (t / 4) % 4;
+                    __m256i w15 = _mm256_alignr_epi8(x[(j + 1) % 4], x[j], 4);
+                    __m256i w7 = _mm256_alignr_epi8(x[(j + 3) % 4], x[(j + 2) % 4], 4);
+                    __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(_mm256_or_si256(_mm256_srli_epi32(w15, 7), _mm256_slli_epi32(w15, 25)),
+                                                                   _mm256_or_si256(_mm256_srli_epi32(w15, 18), _mm256_slli_epi32(w15, 14))),
+                                                  _mm256_srli_epi32(w15, 3));
+                    __m256i sum = _mm256_add_epi32(_mm256_add_epi32(x[j], s0), w7);
+
+                    // sigma1 depends on W[t-2], so the four new words are completed two at a time
+                    __m256i lo = _mm256_add_epi32(sum, sha256_sigma1_avx2(_mm256_shuffle_epi32(x[(j + 3) % 4], 0xfe)));
+                    __m256i hi = _mm256_add_epi32(sum, sha256_sigma1_avx2(_mm256_shuffle_epi32(lo, 0x40)));
+                    x[j] = _mm256_blend_epi32(lo, hi, 0xcc);
+
+                    __m256i k = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(sha256_k + t)));
+                    store_wk2_avx2(wk[0] + t, wk[1] + t, _mm256_add_epi32(x[j], k));
+                }
+
+                sha256_rounds(state, wk[0]);
+                if(pair)
+                    sha256_rounds(state, wk[1]);
+                p += pair ? 128 : 64;
+                blocks -= pair ? 2 : 1;
+            }
+            secure_zero(wk, sizeof(wk));
+        }
+        MERLIN_TARGET("avx2")
+        inline void sha512_blocks_avx2(std::uint64_t * state, const unsigned char * p, std::size_t blocks) noexcept
+        {
+            const __m256i bswap = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+                                                   7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+            alignas(32) std::uint64_t wk[2][80];
+            while(blocks)
+            {
+                const bool pair = blocks >= 2;
+                const unsigned char * q = pair ? p + 128 : p;
+
+                // x[j] holds W[2j], W[2j+1] (mod 16) of both blocks
+                __m256i x[8];
+                for(int j = 0; j < 8; ++j)
+                {
+                    __m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16*j))),
+                                                        _mm_loadu_si128(reinterpret_cast<const __m128i *>(q + 16*j)), 1);
+                    x[j] = _mm256_shuffle_epi8(v, bswap);
+                    __m256i k = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(sha512_k + 2*j)));
+                    store_wk2_avx2(wk[0] + 2*j, wk[1] + 2*j, _mm256_add_epi64(x[j], k));
+                }
+
+#if defined(__GNUC__)
+                #pragma GCC unroll 32
+#endif
+                for(int t = 16; t < 80; t += 2)
+                {
+                    const int j = (t / 2) % 8;
+                    __m256i w15 = _mm256_alignr_epi8(x[(j + 1) % 8], x[j], 8);
+                    __m256i w7 = _mm256_alignr_epi8(x[(j + 5) % 8], x[(j + 4) % 8], 8);
+                    __m256i w2 = x[(j + 7) % 8];
+                    __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(_mm256_or_si256(_mm256_srli_epi64(w15, 1), _mm256_slli_epi64(w15, 63)),
+                                                                   _mm256_or_si256(_mm256_srli_epi64(w15, 8), _mm256_slli_epi64(w15, 56))),
+                                                  _mm256_srli_epi64(w15, 7));
+                    __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(_mm256_or_si256(_mm256_srli_epi64(w2, 19), _mm256_slli_epi64(w2, 45)),
+                                                                   _mm256_or_si256(_mm256_srli_epi64(w2, 61), _mm256_slli_epi64(w2, 3))),
+                                                  _mm256_srli_epi64(w2, 6));
+                    x[j] = _mm256_add_epi64(_mm256_add_epi64(x[j], s0), _mm256_add_epi64(w7, s1));
+
+                    __m256i k = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(sha512_k + t)));
+                    store_wk2_avx2(wk[0] + t, wk[1] + t, _mm256_add_epi64(x[j], k));
+                }
+
+                sha512_rounds(state, wk[0]);
+                if(pair)
+                    sha512_rounds(state, wk[1]);
+                p += pair ? 256 : 128;
+                blocks -= pair ? 2 : 1;
+            }
+            secure_zero(wk, sizeof(wk));
+        }
+#endif
+
+        inline void sha256_blocks(std::uint32_t * state, const unsigned char * p, std::size_t blocks) noexcept
+        {
+#if MERLIN_X86_SIMD
+            if(cpu().sha && cpu().sse41)
+                return sha256_blocks_shani(state, p, blocks);
+            if(cpu().avx2)
+                return sha256_blocks_avx2(state, p, blocks);
+#endif
+            sha256_blocks_scalar(state, p, blocks);
+        }
+        inline void sha512_blocks(std::uint64_t * state, const unsigned char * p, std::size_t blocks) noexcept
+        {
+#if MERLIN_X86_SIMD
+            if(cpu().avx2)
+                return sha512_blocks_avx2(state, p, blocks);
+#endif
+            sha512_blocks_scalar(state, p, blocks);
+        }
+
+        struct sha256_spec
+        {
+            using word_type = std::uint32_t;
+            static constexpr std::size_t digest_size = 32;
+            static constexpr word_type iv[8] = {
+                0x6a09e667u, 0xbb67ae85u, 0x3c6ef372u, 0xa54ff53au, 0x510e527fu, 0x9b05688cu, 0x1f83d9abu, 0x5be0cd19u
+            };
+
+            static void blocks(word_type * state, const unsigned char * p, std::size_t n) noexcept
+            {
+                sha256_blocks(state, p, n);
+            }
+        };
+        struct sha512_spec
+        {
+            using word_type = std::uint64_t;
+            static constexpr std::size_t digest_size = 64;
+            static constexpr word_type iv[8] = {
+                0x6a09e667f3bcc908ull, 0xbb67ae8584caa73bull, 0x3c6ef372fe94f82bull, 0xa54ff53a5f1d36f1ull,
+                0x510e527fade682d1ull, 0x9b05688c2b3e6c1full, 0x1f83d9abfb41bd6bull, 0x5be0cd19137e2179ull
+            };
+
+            static void blocks(word_type * state, const unsigned char * p, std::size_t n) noexcept
+            {
+                sha512_blocks(state, p, n);
+            }
+        };
+    }
+
+    template <typename Spec>
+    class basic_sha2
+    {
+        public:
+            using word_type = typename Spec::word_type;
+
+            static constexpr std::size_t block_size = 16 * sizeof(word_type);
+            static constexpr std::size_t digest_size = Spec::digest_size;
+
+            basic_sha2() noexcept
+            {
+                reset();
+            }
+            basic_sha2(const basic_sha2 &) noexcept = default;
+            basic_sha2 & operator=(const basic_sha2 &) noexcept = default;
+            ~basic_sha2()
+            {
+                detail::secure_zero(this, sizeof(*this));
+            }
+
+            void reset() noexcept
+            {
+                for(int i = 0; i < 8; ++i)
+                    state_[i] = Spec::iv[i];
+                length_ = 0;
+                buffered_ = 0;
+                detail::secure_zero(buffer_, block_size);
+            }
+
+            basic_sha2 & update(const void * data, std::size_t n) noexcept
+            {
+                if(!n)
+                    return *this; // data may be null
+                const unsigned char * p = static_cast<const unsigned char *>(data);
+                length_ += n;
+
+                if(buffered_)
+                {
+                    std::size_t take = n < block_size - buffered_ ? n : block_size - buffered_;
+                    std::memcpy(buffer_ + buffered_, p, take);
+                    buffered_ += take;
+                    p += take;
+                    n -= take;
+                    if(buffered_ < block_size)
+                        return *this;
+                    Spec::blocks(state_, buffer_, 1);
+                    buffered_ = 0;
+                }
+
+                if(n >= block_size)
+                {
+                    Spec::blocks(state_, p, n / block_size);
+                    p += n / block_size * block_size;
+                    n %= block_size;
+                }
+
+                std::memcpy(buffer_, p, n);
+                buffered_ = n;
+                return *this;
+            }
+            template <typename CharT, typename Traits, typename Alloc>
+            basic_sha2 & update(const basic_password<CharT, Traits, Alloc> & p) noexcept
+            {
+                return update(p.data(), p.size() * sizeof(CharT));
+            }
+            template <typename CharT, typename Traits>
+            basic_sha2 & update(basic_password_view<CharT, Traits> v) noexcept
+            {
+                return update(v.data(), v.size() * sizeof(CharT));
+            }
+            template <typename CharT, typename Traits>
+            basic_sha2 & update(std::basic_string_view<CharT, Traits> sv) noexcept
+            {
+                return update(sv.data(), sv.size() * sizeof(CharT));
+            }
+
+            // Writes digest_size bytes to digest, then resets the context
+            void final(unsigned char * digest) noexcept
+            {
+                constexpr std::size_t length_offset = block_size - 2 * sizeof(word_type);
+
+                buffer_[buffered_++] = 0x80;
+                if(buffered_ > length_offset)
+                {
+                    std::memset(buffer_ + buffered_, 0, block_size - buffered_);
+                    Spec::blocks(state_, buffer_, 1);
+                    buffered_ = 0;
+                }
+                std::memset(buffer_ + buffered_, 0, block_size - 8 - buffered_);
+                detail::store_be<std::uint64_t>(buffer_ + block_size - 8, length_ << 3);
+                if constexpr(sizeof(word_type) == 8)
+                    detail::store_be<std::uint64_t>(buffer_ + length_offset, length_ >> 61);
+                Spec::blocks(state_, buffer_, 1);
+
+                for(std::size_t i = 0; i < digest_size / sizeof(word_type); ++i)
+                    detail::store_be<word_type>(digest + i * sizeof(word_type), state_[i]);
+                reset();
+            }
+
+            // One-shot hash of n bytes
+            static void hash(const void * data, std::size_t n, unsigned char * digest) noexcept
+            {
+                basic_sha2 ctx;
+                ctx.update(data, n);
+                ctx.final(digest);
+            }
+            template <typename CharT, typename Traits, typename Alloc>
+            static void hash(const basic_password<CharT, Traits, Alloc> & p, unsigned char * digest) noexcept
+            {
+                hash(p.data(), p.size() * sizeof(CharT), digest);
+            }
+
+        private:
+            word_type state_[8];
+            std::uint64_t length_;
+            std::size_t buffered_;
+            unsigned char buffer_[block_size];
+    };
+
+    using sha256 = basic_sha2<detail::sha256_spec>;
+    using sha512 = basic_sha2<detail::sha512_spec>;
+}
+
+#endif // MERLIN_SHA2_HPP
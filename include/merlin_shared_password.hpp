@@ -0,0 +1,330 @@
+#ifndef MERLIN_SHARED_PASSWORD_HPP
+#define MERLIN_SHARED_PASSWORD_HPP
+
+#include <merlin_basic_password.hpp>
+#include <merlin_detail.hpp>
+#include <merlin_password_hash.hpp>
+#include <merlin_password_view.hpp>
+#include <merlin_secure_allocator.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+// basic_shared_password: an immutable password shared by reference. One secure block holds the reference count,
+// the size and the characters; copies only bump the count (thread safe, like std::shared_ptr), and the last
+// handle to go wipes and frees the block. Handing one service secret to many workers costs a single allocation.
+// Edits go through to_mutable(), which copies the characters into a new basic_password.
+
+namespace merl
+{
+    template <typename CharT, typename Traits = std::char_traits<CharT>>
+    class basic_shared_password
+    {
+        public:
+            using traits_type = Traits;
+            using value_type = CharT;
+            using size_type = std::size_t;
+            using difference_type = std::ptrdiff_t;
+            using const_reference = const CharT &;
+            using const_pointer = const CharT *;
+            using const_iterator = const CharT *;
+            using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+            static constexpr size_type npos = -1;
+
+        private:
+            struct block
+            {
+                std::atomic<size_type> refs;
+                size_type size;
+            };
+            static_assert(sizeof(block) % alignof(CharT) == 0);
+
+            static constexpr CharT empty_[1] {};
+
+            block * block_ = nullptr;
+
+            static size_type block_bytes(size_type size) noexcept
+            {
+                return sizeof(block) + (size + 1) * sizeof(CharT);
+            }
+            static CharT * chars(block * b) noexcept
+            {
+                return reinterpret_cast<CharT *>(reinterpret_cast<std::byte *>(b) + sizeof(block));
+            }
+
+            // Empty passwords share no block at all
+            void assign_view(basic_password_view<CharT, Traits> v)
+            {
+                if(v.empty())
+                    return;
+                if(v.size() > (std::numeric_limits<size_type>::max() - sizeof(block)) / sizeof(CharT) - 1)
+                    throw std::length_error("merl::basic_shared_password::basic_shared_password(): Length error -> size exceeds max_size()");
+
+                block * b = reinterpret_cast<block *>(secure_allocator<std::byte>().allocate(block_bytes(v.size())));
+                ::new(b) block{{1}, v.size()};
+                Traits::copy(chars(b), v.data(), v.size());
+                chars(b)[v.size()] = CharT();
+                block_ = b;
+            }
+            void release() noexcept
+            {
+                // acq_rel: the wipe must not be reordered before other owners' last reads
+                if(block_ && block_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    size_type bytes = block_bytes(block_->size);
+                    block_->~block();
+                    secure_allocator<std::byte>().deallocate(reinterpret_cast<std::byte *>(block_), bytes); // wipes the whole block
+                }
+                block_ = nullptr;
+            }
+
+        public:
+            // Constructors
+            basic_shared_password() noexcept = default;
+            explicit basic_shared_password(basic_password_view<CharT, Traits> v)
+            {
+                assign_view(v);
+            }
+            template <typename Alloc>
+            explicit basic_shared_password(const basic_password<CharT, Traits, Alloc> & p)
+            {
+                assign_view(p.view());
+            }
+            // Takes the secret over: the source is wiped and left empty
+            template <typename Alloc>
+            explicit basic_shared_password(basic_password<CharT, Traits, Alloc> && p)
+            {
+                basic_password<CharT, Traits, Alloc> tmp(std::move(p));
+                assign_view(tmp.view());
+            }
+            explicit basic_shared_password(const CharT * p)
+            {
+                assign_view(basic_password_view<CharT, Traits>(p));
+            }
+            basic_shared_password(std::nullptr_t) = delete;
+            basic_shared_password(const basic_shared_password & other) noexcept : block_{other.block_}
+            {
+                if(block_)
+                    block_->refs.fetch_add(1, std::memory_order_relaxed);
+            }
+            basic_shared_password(basic_shared_password && other) noexcept : block_{std::exchange(other.block_, nullptr)}
+            {}
+
+            // Destructor
+            ~basic_shared_password()
+            {
+                release();
+            }
+
+            // Assignment
+            basic_shared_password & operator=(const basic_shared_password & other) noexcept
+            {
+                basic_shared_password(other).swap(*this);
+                return *this;
+            }
+            basic_shared_password & operator=(basic_shared_password && other) noexcept
+            {
+                basic_shared_password(std::move(other)).swap(*this);
+                return *this;
+            }
+
+            // Elements access
+            const CharT & at(size_type pos) const
+            {
+                if(pos >= size())
+                    throw std::out_of_range("merl::basic_shared_password::at(): Out of range (pos = " + std::to_string(pos) + ", size = " + std::to_string(size()) + ')');
+
+                return data()[pos];
+            }
+            const CharT & operator[](size_type pos) const noexcept
+            {
+                return data()[pos];
+            }
+            const CharT & front() const noexcept
+            {
+                return data()[0];
+            }
+            const CharT & back() const noexcept
+            {
+                return data()[size() - 1];
+            }
+            // Null terminated, like basic_password::data()
+            const CharT * data() const noexcept
+            {
+                return block_ ? chars(block_) : empty_;
+            }
+
+            // Iterators
+            const_iterator begin() const noexcept
+            {
+                return data();
+            }
+            const_iterator cbegin() const noexcept
+            {
+                return begin();
+            }
+            const_iterator end() const noexcept
+            {
+                return data() + size();
+            }
+            const_iterator cend() const noexcept
+            {
+                return end();
+            }
+            const_reverse_iterator rbegin() const noexcept
+            {
+                return const_reverse_iterator(end());
+            }
+            const_reverse_iterator crbegin() const noexcept
+            {
+                return rbegin();
+            }
+            const_reverse_iterator rend() const noexcept
+            {
+                return const_reverse_iterator(begin());
+            }
+            const_reverse_iterator crend() const noexcept
+            {
+                return rend();
+            }
+
+            // Capacity
+            bool empty() const noexcept
+            {
+                return !block_;
+            }
+            size_type size() const noexcept
+            {
+                return block_ ? block_->size : 0;
+            }
+            size_type length() const noexcept
+            {
+                return size();
+            }
+            // Number of handles sharing the secret (0 when empty); only a hint while other threads copy or drop handles
+            size_type use_count() const noexcept
+            {
+                return block_ ? block_->refs.load(std::memory_order_relaxed) : 0;
+            }
+
+            // Modifiers
+            // Drops this handle; the secret is wiped if it was the last one
+            void reset() noexcept
+            {
+                release();
+            }
+            void swap(basic_shared_password & other) noexcept
+            {
+                std::swap(block_, other.block_);
+            }
+
+            // Operations
+            // A private, editable copy of the secret
+            template <typename Alloc = std::allocator<CharT>>
+            basic_password<CharT, Traits, Alloc> to_mutable(const Alloc & alloc = Alloc()) const
+            {
+                return basic_password<CharT, Traits, Alloc>(view(), alloc);
+            }
+            basic_password_view<CharT, Traits> view(size_type pos = 0, size_type count = npos) const &
+            {
+                if(pos > size())
+                    throw std::out_of_range("merl::basic_shared_password::view(): Out of range (position = " + std::to_string(pos) + ", size = " + std::to_string(size()) + ')');
+
+                return basic_password_view<CharT, Traits>(data() + pos, std::min(count, size() - pos));
+            }
+            basic_password_view<CharT, Traits> view(size_type pos = 0, size_type count = npos) const && = delete;
+            explicit operator basic_password_view<CharT, Traits>() const & noexcept
+            {
+                return basic_password_view<CharT, Traits>(data(), size());
+            }
+            explicit operator basic_password_view<CharT, Traits>() const && = delete;
+
+            int compare(basic_password_view<CharT, Traits> v) const noexcept
+            {
+                return view().compare(v);
+            }
+            bool starts_with(basic_password_view<CharT, Traits> v) const noexcept
+            {
+                return view().starts_with(v);
+            }
+            bool ends_with(basic_password_view<CharT, Traits> v) const noexcept
+            {
+                return view().ends_with(v);
+            }
+            bool contains(basic_password_view<CharT, Traits> v) const noexcept
+            {
+                return view().contains(v);
+            }
+            size_type find(basic_password_view<CharT, Traits> v, size_type pos = 0) const noexcept
+            {
+                return view().find(v, pos);
+            }
+            size_type rfind(basic_password_view<CharT, Traits> v, size_type pos = npos) const noexcept
+            {
+                return view().rfind(v, pos);
+            }
+    };
+
+    // Non-member functions
+    template <typename CharT, typename Traits>
+    bool operator==(const basic_shared_password<CharT, Traits> & lhs, const basic_shared_password<CharT, Traits> & rhs) noexcept
+    {
+        return lhs.data() == rhs.data() || lhs.view() == rhs.view();
+    }
+    template <typename CharT, typename Traits>
+    Traits::comparison_category operator<=>(const basic_shared_password<CharT, Traits> & lhs, const basic_shared_password<CharT, Traits> & rhs) noexcept
+    {
+        return lhs.view() <=> rhs.view();
+    }
+    template <typename CharT, typename Traits>
+    bool operator==(const basic_shared_password<CharT, Traits> & lhs, basic_password_view<CharT, Traits> rhs) noexcept
+    {
+        return lhs.view() == rhs;
+    }
+    template <typename CharT, typename Traits>
+    Traits::comparison_category operator<=>(const basic_shared_password<CharT, Traits> & lhs, basic_password_view<CharT, Traits> rhs) noexcept
+    {
+        return lhs.view() <=> rhs;
+    }
+    template <typename CharT, typename Traits, typename Alloc>
+    bool operator==(const basic_shared_password<CharT, Traits> & lhs, const basic_password<CharT, Traits, Alloc> & rhs) noexcept
+    {
+        return lhs.view() == rhs.view();
+    }
+    template <typename CharT, typename Traits, typename Alloc>
+    Traits::comparison_category operator<=>(const basic_shared_password<CharT, Traits> & lhs, const basic_password<CharT, Traits, Alloc> & rhs) noexcept
+    {
+        return lhs.view() <=> rhs.view();
+    }
+
+    template <typename CharT, typename Traits>
+    void swap(basic_shared_password<CharT, Traits> & lhs, basic_shared_password<CharT, Traits> & rhs) noexcept
+    {
+        lhs.swap(rhs);
+    }
+
+    using shared_password = basic_shared_password<char>;
+    using wshared_password = basic_shared_password<wchar_t>;
+    using u8shared_password = basic_shared_password<char8_t>;
+    using u16shared_password = basic_shared_password<char16_t>;
+    using u32shared_password = basic_shared_password<char32_t>;
+}
+
+template <typename CharT, typename Traits>
+struct std::hash<merl::basic_shared_password<CharT, Traits>>
+{
+    std::size_t operator()(const merl::basic_shared_password<CharT, Traits> & p) const noexcept
+    {
+        return merl::detail::hash_bytes(p.data(), p.size() * sizeof(CharT));
+    }
+};
+
+#endif // MERLIN_SHARED_PASSWORD_HPP
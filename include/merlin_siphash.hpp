@@ -0,0 +1,172 @@
+#ifndef MERLIN_SIPHASH_HPP
+#define MERLIN_SIPHASH_HPP
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <random>
+
+// SipHash (J.-P. Aumasson, D. J. Bernstein): the keyed hash used for password fingerprints and hash tables.
+
+namespace merl
+{
+    struct siphash_key
+    {
+        std::uint64_t k0;
+        std::uint64_t k1;
+
+        static siphash_key random()
+        {
+            std::random_device rd;
+            siphash_key key;
+            key.k0 = (std::uint64_t{rd()} << 32) ^ rd();
+            key.k1 = (std::uint64_t{rd()} << 32) ^ rd();
+            return key;
+        }
+    };
+
+    namespace detail
+    {
+        inline std::uint64_t rotl64(std::uint64_t x, int b) noexcept
+        {
+            return (x << b) | (x >> (64 - b));
+        }
+        inline std::uint64_t load_le64(const unsigned char * p) noexcept
+        {
+            if constexpr(std::endian::native == std::endian::little)
+            {
+                std::uint64_t v;
+                std::memcpy(&v, p, 8);
+                return v;
+            }
+            else
+            {
+                std::uint64_t v = 0;
+                for(int i = 7; i >= 0; --i)
+                    v = (v << 8) | p[i];
+                return v;
+            }
+        }
+
+        inline std::uint32_t load_le32(const unsigned char * p) noexcept
+        {
+            return static_cast<std::uint32_t>(p[0]) | static_cast<std::uint32_t>(p[1]) << 8
+                 | static_cast<std::uint32_t>(p[2]) << 16 | static_cast<std::uint32_t>(p[3]) << 24;
+        }
+        inline void store_le32(unsigned char * p, std::uint32_t v) noexcept
+        {
+            for(int i = 0; i < 4; ++i)
+                p[i] = static_cast<unsigned char>(v >> (8*i));
+        }
+
+        struct sip_state
+        {
+            std::uint64_t v0, v1, v2, v3;
+
+            void round() noexcept
+            {
+                v0 += v1; v1 = rotl64(v1, 13); v1 ^= v0; v0 = rotl64(v0, 32);
+                v2 += v3; v3 = rotl64(v3, 16); v3 ^= v2;
+                v0 += v3; v3 = rotl64(v3, 21); v3 ^= v0;
+                v2 += v1; v1 = rotl64(v1, 17); v1 ^= v2; v2 = rotl64(v2, 32);
+            }
+        };
+
+        inline std::uint32_t rotl32(std::uint32_t x, int b) noexcept
+        {
+            return (x << b) | (x >> (32 - b));
+        }
+
+        struct half_sip_state
+        {
+            std::uint32_t v0, v1, v2, v3;
+
+            void round() noexcept
+            {
+                v0 += v1; v1 = rotl32(v1, 5); v1 ^= v0; v0 = rotl32(v0, 16);
+                v2 += v3; v3 = rotl32(v3, 8); v3 ^= v2;
+                v0 += v3; v3 = rotl32(v3, 7); v3 ^= v0;
+                v2 += v1; v1 = rotl32(v1, 13); v1 ^= v2; v2 = rotl32(v2, 16);
+            }
+        };
+
+        // HalfSipHash-c-d with a 32-bit output, keyed with the low 64 bits of key.k0 (for 32-bit targets)
+        template <int CRounds, int DRounds>
+        std::uint32_t halfsiphash(const siphash_key & key, const void * data, std::size_t n) noexcept
+        {
+            const unsigned char * p = static_cast<const unsigned char *>(data);
+            std::uint32_t k0 = static_cast<std::uint32_t>(key.k0), k1 = static_cast<std::uint32_t>(key.k0 >> 32);
+            half_sip_state s{k0, k1, k0 ^ 0x6c796765u, k1 ^ 0x74656462u};
+
+            std::size_t blocks = n / 4;
+            for(std::size_t i = 0; i < blocks; ++i)
+            {
+                const unsigned char * b = p + 4*i;
+                std::uint32_t m = std::uint32_t{b[0]} | (std::uint32_t{b[1]} << 8) | (std::uint32_t{b[2]} << 16) | (std::uint32_t{b[3]} << 24);
+                s.v3 ^= m;
+                for(int r = 0; r < CRounds; ++r)
+                    s.round();
+                s.v0 ^= m;
+            }
+
+            std::uint32_t last = std::uint32_t(n & 0xff) << 24;
+            for(std::size_t i = 0; i < n % 4; ++i)
+                last |= std::uint32_t{p[4*blocks + i]} << (8*i);
+
+            s.v3 ^= last;
+            for(int r = 0; r < CRounds; ++r)
+                s.round();
+            s.v0 ^= last;
+
+            s.v2 ^= 0xff;
+            for(int r = 0; r < DRounds; ++r)
+                s.round();
+            return s.v1 ^ s.v3;
+        }
+
+        // SipHash-c-d with a 64-bit output
+        template <int CRounds, int DRounds>
+        std::uint64_t siphash(const siphash_key & key, const void * data, std::size_t n) noexcept
+        {
+            const unsigned char * p = static_cast<const unsigned char *>(data);
+            sip_state s{key.k0 ^ 0x736f6d6570736575ull, key.k1 ^ 0x646f72616e646f6dull,
+                        key.k0 ^ 0x6c7967656e657261ull, key.k1 ^ 0x7465646279746573ull};
+
+            std::size_t blocks = n / 8;
+            for(std::size_t i = 0; i < blocks; ++i)
+            {
+                std::uint64_t m = load_le64(p + 8*i);
+                s.v3 ^= m;
+                for(int r = 0; r < CRounds; ++r)
+                    s.round();
+                s.v0 ^= m;
+            }
+
+            std::uint64_t last = std::uint64_t(n & 0xff) << 56;
+            for(std::size_t i = 0; i < n % 8; ++i)
+                last |= std::uint64_t{p[8*blocks + i]} << (8*i);
+
+            s.v3 ^= last;
+            for(int r = 0; r < CRounds; ++r)
+                s.round();
+            s.v0 ^= last;
+
+            s.v2 ^= 0xff;
+            for(int r = 0; r < DRounds; ++r)
+                s.round();
+            return s.v0 ^ s.v1 ^ s.v2 ^ s.v3;
+        }
+    }
+
+    inline std::uint64_t siphash13(const siphash_key & key, const void * data, std::size_t n) noexcept
+    {
+        return detail::siphash<1, 3>(key, data, n);
+    }
+    inline std::uint64_t siphash24(const siphash_key & key, const void * data, std::size_t n) noexcept
+    {
+        return detail::siphash<2, 4>(key, data, n);
+    }
+}
+
+#endif // MERLIN_SIPHASH_HPP
@@ -0,0 +1,492 @@
+#ifndef MERLIN_VERIFY_EXECUTOR_HPP
+#define MERLIN_VERIFY_EXECUTOR_HPP
+
+#include <merlin_argon2.hpp>
+#include <merlin_argon2_pool.hpp>
+#include <merlin_basic_password.hpp>
+#include <merlin_crypt.hpp>
+#include <merlin_scrypt.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+// Runs password verifications (Argon2id and scrypt PHC strings, crypt(3) hashes) on a fixed set of worker threads,
+// so request handlers can co_await them instead of blocking for the duration of a KDF:
+//
+//     verify_result r = co_await merl::verify_async(std::move(pw), stored_hash);
+//
+// The password is moved into the job (the awaiter, which lives in the coroutine frame) and wiped as soon as the
+// KDF is done. Jobs wait in a bounded queue, one list per priority class: workers always take interactive jobs first,
+// and at most batch_threads of them run batch jobs at once, so a login never waits behind a full rehash backlog.
+// A queued job completes early when its deadline passes or its stop token is triggered; a running KDF is not interrupted.
+// The awaiting coroutine is resumed on the thread that completes the job (a worker, the deadline thread, or the thread
+// requesting the stop).
+
+namespace merl
+{
+    enum class verify_priority
+    {
+        interactive,
+        batch
+    };
+
+    enum class verify_status
+    {
+        match,
+        mismatch,
+        cancelled,          // stop requested while queued, or executor destroyed
+        deadline_exceeded,  // deadline passed before a worker took the job
+        queue_full,
+        error               // malformed or unsupported hash, see verify_result::error
+    };
+
+    struct verify_result
+    {
+        verify_status status = verify_status::error;
+        std::exception_ptr error;
+
+        explicit operator bool() const noexcept
+        {
+            return status == verify_status::match;
+        }
+    };
+
+    struct verify_options
+    {
+        verify_priority priority = verify_priority::interactive;
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+        std::stop_token stop;
+    };
+
+    struct verify_executor_options
+    {
+        std::uint32_t threads = 0;              // workers, 0 for the hardware concurrency
+        std::uint32_t batch_threads = 0;        // workers that may run batch jobs at the same time, 0 for all but one
+        std::size_t queue_capacity = 1024;      // queued (not yet running) jobs, past which submissions get queue_full
+        bool pin_threads = true;                // bind each worker to one CPU (Linux, best effort)
+        argon2_memory_pool * pool = nullptr;    // Argon2id work areas, nullptr to allocate them per hash
+    };
+
+    class verify_executor;
+
+    namespace detail
+    {
+        // Verifies password against any hash format the library reads; throws std::invalid_argument for others
+        template <typename CharT, typename Traits, typename Alloc>
+        bool verify_encoded(const basic_password<CharT, Traits, Alloc> & password, std::string_view encoded, argon2_memory_pool * pool)
+        {
+            // The executor provides the parallelism: one thread per hash
+            if(encoded.starts_with("$argon2id$"))
+                return pool ? argon2id_verify(password, encoded, *pool, 1) : argon2id_verify(password, encoded, 1);
+            if(encoded.starts_with("$scrypt$"))
+                return scrypt_verify(password, encoded, 1);
+            if constexpr(sizeof(CharT) == 1)
+                return crypt_verify(password, encoded);
+            else
+                throw std::invalid_argument("merl::verify_async(): Invalid argument -> Unsupported hash format");
+        }
+
+        struct verify_job
+        {
+            enum class state
+            {
+                created,
+                queued,
+                running,
+                done
+            };
+
+            verify_priority priority = verify_priority::interactive;
+            std::chrono::steady_clock::time_point deadline;
+            verify_result result;
+            std::coroutine_handle<> continuation;
+            state current = state::created;
+            bool cancel_requested = false;
+            verify_job * prev = nullptr;
+            verify_job * next = nullptr;
+
+            // Verifies, stores the outcome in result and wipes the password
+            virtual void run(argon2_memory_pool * pool) noexcept = 0;
+
+            protected:
+                ~verify_job() = default;
+        };
+
+        // Intrusive FIFO, so queuing and cancelling neither allocate nor search
+        struct verify_job_list
+        {
+            verify_job * head = nullptr;
+            verify_job * tail = nullptr;
+
+            bool empty() const noexcept
+            {
+                return !head;
+            }
+            void push_back(verify_job * job) noexcept
+            {
+                job->prev = tail;
+                job->next = nullptr;
+                (tail ? tail->next : head) = job;
+                tail = job;
+            }
+            void erase(verify_job * job) noexcept
+            {
+                (job->prev ? job->prev->next : head) = job->next;
+                (job->next ? job->next->prev : tail) = job->prev;
+                job->prev = job->next = nullptr;
+            }
+        };
+
+        inline void pin_current_thread(std::size_t index) noexcept
+        {
+#if defined(__linux__)
+            cpu_set_t allowed;
+            if(::sched_getaffinity(0, sizeof(allowed), &allowed) != 0 || !CPU_COUNT(&allowed))
+                return;
+            std::size_t n = index % static_cast<std::size_t>(CPU_COUNT(&allowed));
+            for(int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            {
+                if(CPU_ISSET(cpu, &allowed) && !n--)
+                {
+                    cpu_set_t one;
+                    CPU_ZERO(&one);
+                    CPU_SET(cpu, &one);
+                    ::pthread_setaffinity_np(::pthread_self(), sizeof(one), &one);
+                    return;
+                }
+            }
+#else
+            (void)index;
+#endif
+        }
+    }
+
+    template <typename CharT, typename Traits>
+    class verify_awaitable;
+
+    class verify_executor
+    {
+        public:
+            explicit verify_executor(const verify_executor_options & options = {})
+                : capacity_(options.queue_capacity), pool_(options.pool)
+            {
+                std::uint32_t threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+                batch_limit_ = options.batch_threads ? std::min(options.batch_threads, threads) : std::max(1u, threads - 1);
+                if(!capacity_)
+                    throw std::invalid_argument("merl::verify_executor::verify_executor(): Invalid argument -> Empty queue");
+
+                workers_.reserve(threads);
+                for(std::uint32_t i = 0; i < threads; ++i)
+                    workers_.emplace_back([this, i, pin = options.pin_threads](std::stop_token stop) { work(stop, i, pin); });
+                timer_ = std::jthread([this](std::stop_token stop) { expire(stop); });
+            }
+            verify_executor(const verify_executor &) = delete;
+            verify_executor & operator=(const verify_executor &) = delete;
+            // Waits for the running jobs; queued ones complete with verify_status::cancelled
+            ~verify_executor()
+            {
+                for(std::jthread & w : workers_)
+                    w.request_stop();
+                timer_.request_stop();
+                workers_.clear();
+                timer_ = std::jthread();
+
+                std::vector<detail::verify_job *> left;
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    for(detail::verify_job_list & list : queues_)
+                        while(!list.empty())
+                            left.push_back(unlink(list.head, verify_status::cancelled));
+                }
+                for(detail::verify_job * job : left)
+                    job->continuation.resume();
+            }
+
+            std::size_t threads() const noexcept
+            {
+                return workers_.size();
+            }
+            std::size_t queued() const
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return queued_;
+            }
+
+        private:
+            template <typename CharT, typename Traits>
+            friend class verify_awaitable;
+
+            std::size_t capacity_;
+            argon2_memory_pool * pool_;
+            std::uint32_t batch_limit_ = 1;
+            std::uint32_t running_batch_ = 0;
+            std::size_t queued_ = 0;
+            std::uint64_t deadline_changes_ = 0;
+            detail::verify_job_list queues_[2];
+            mutable std::mutex mutex_;
+            std::condition_variable_any work_available_;
+            std::condition_variable_any deadlines_changed_;
+            std::vector<std::jthread> workers_;
+            std::jthread timer_;
+
+            // Called with the mutex held: takes a queued job out and marks it done with status
+            detail::verify_job * unlink(detail::verify_job * job, verify_status status) noexcept
+            {
+                queues_[static_cast<int>(job->priority)].erase(job);
+                --queued_;
+                job->current = detail::verify_job::state::done;
+                job->result.status = status;
+                return job;
+            }
+
+            // Returns false (job done, its coroutine not to be suspended) if it is cancelled, past its deadline or the queue is full
+            bool enqueue(detail::verify_job * job) noexcept
+            {
+                bool wake_timer;
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    std::optional<verify_status> refused;
+                    if(job->cancel_requested)
+                        refused = verify_status::cancelled;
+                    else if(job->deadline <= std::chrono::steady_clock::now())
+                        refused = verify_status::deadline_exceeded;
+                    else if(queued_ >= capacity_)
+                        refused = verify_status::queue_full;
+                    if(refused)
+                    {
+                        job->result.status = *refused;
+                        job->current = detail::verify_job::state::done;
+                        return false;
+                    }
+                    queues_[static_cast<int>(job->priority)].push_back(job);
+                    ++queued_;
+                    job->current = detail::verify_job::state::queued;
+                    wake_timer = job->deadline != std::chrono::steady_clock::time_point::max();
+                    deadline_changes_ += wake_timer;
+                }
+                work_available_.notify_one();
+                if(wake_timer)
+                    deadlines_changed_.notify_one();
+                return true;
+            }
+
+            // Stop callback of a job: completes it if it is still queued
+            void cancel(detail::verify_job * job) noexcept
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if(job->current == detail::verify_job::state::created)
+                        job->cancel_requested = true;
+                    if(job->current != detail::verify_job::state::queued)
+                        return;
+                    unlink(job, verify_status::cancelled);
+                }
+                job->continuation.resume();
+            }
+
+            // Called with the mutex held
+            bool runnable() const noexcept
+            {
+                return !queues_[0].empty() || (!queues_[1].empty() && running_batch_ < batch_limit_);
+            }
+
+            void work(std::stop_token stop, std::size_t index, bool pin)
+            {
+                if(pin)
+                    detail::pin_current_thread(index);
+                for(;;)
+                {
+                    detail::verify_job * job;
+                    {
+                        std::unique_lock<std::mutex> lock(mutex_);
+                        // Once stopping, the jobs still queued are left to the destructor to cancel
+                        if(!work_available_.wait(lock, stop, [this] { return runnable(); }) || stop.stop_requested())
+                            return;
+                        detail::verify_job_list & list = queues_[0].empty() ? queues_[1] : queues_[0];
+                        job = list.head;
+                        if(job->deadline <= std::chrono::steady_clock::now())
+                            unlink(job, verify_status::deadline_exceeded);
+                        else
+                        {
+                            list.erase(job);
+                            --queued_;
+                            job->current = detail::verify_job::state::running;
+                            running_batch_ += job->priority == verify_priority::batch;
+                        }
+                    }
+
+                    if(job->current == detail::verify_job::state::running)
+                    {
+                        job->run(pool_);
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        if(job->priority == verify_priority::batch)
+                        {
+                            --running_batch_;
+                            work_available_.notify_one();
+                        }
+                        job->current = detail::verify_job::state::done;
+                    }
+                    job->continuation.resume();
+                }
+            }
+
+            // Completes queued jobs whose deadline passed while every worker was busy
+            void expire(std::stop_token stop)
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                while(!stop.stop_requested())
+                {
+                    auto earliest = std::chrono::steady_clock::time_point::max();
+                    for(const detail::verify_job_list & list : queues_)
+                        for(const detail::verify_job * job = list.head; job; job = job->next)
+                            earliest = std::min(earliest, job->deadline);
+
+                    std::uint64_t changes = deadline_changes_;
+                    auto changed = [&] { return deadline_changes_ != changes; };
+                    if(earliest == std::chrono::steady_clock::time_point::max())
+                        deadlines_changed_.wait(lock, stop, changed);
+                    else if(deadlines_changed_.wait_until(lock, stop, earliest, changed))
+                        continue;
+
+                    std::vector<detail::verify_job *> expired;
+                    auto now = std::chrono::steady_clock::now();
+                    for(detail::verify_job_list & list : queues_)
+                    {
+                        for(detail::verify_job * job = list.head; job;)
+                        {
+                            detail::verify_job * next = job->next;
+                            if(job->deadline <= now)
+                                expired.push_back(unlink(job, verify_status::deadline_exceeded));
+                            job = next;
+                        }
+                    }
+                    if(expired.empty())
+                        continue;
+                    lock.unlock();
+                    for(detail::verify_job * job : expired)
+                        job->continuation.resume();
+                    lock.lock();
+                }
+            }
+    };
+
+    // Awaiter of one verification; owns the password until the KDF is done. Not movable: it is meant to be co_awaited
+    // right away, as returned by verify_async().
+    template <typename CharT, typename Traits>
+    class verify_awaitable : private detail::verify_job
+    {
+        public:
+            verify_awaitable(verify_executor & executor, basic_password<CharT, Traits> && password, std::string_view stored_hash,
+                             const verify_options & options)
+                : executor_(executor), password_(std::move(password)), stored_hash_(stored_hash), stop_(options.stop)
+            {
+                priority = options.priority;
+                deadline = options.deadline;
+            }
+            verify_awaitable(const verify_awaitable &) = delete;
+            verify_awaitable & operator=(const verify_awaitable &) = delete;
+
+            bool await_ready() const noexcept
+            {
+                return false;
+            }
+            bool await_suspend(std::coroutine_handle<> continuation_handle) noexcept
+            {
+                continuation = continuation_handle;
+                if(stop_.stop_possible())
+                    cancel_.emplace(stop_, canceller{this});
+                // Once queued, the job may complete and the coroutine resume (destroying *this) on another thread
+                return executor_.enqueue(this);
+            }
+            verify_result await_resume() noexcept
+            {
+                cancel_.reset();
+                password_.clear();
+                return std::move(result);
+            }
+
+        private:
+            struct canceller
+            {
+                verify_awaitable * self;
+                void operator()() const noexcept
+                {
+                    self->executor_.cancel(self);
+                }
+            };
+
+            verify_executor & executor_;
+            basic_password<CharT, Traits> password_;
+            std::string stored_hash_;
+            std::stop_token stop_;
+            std::optional<std::stop_callback<canceller>> cancel_;   // last, so it is unregistered first
+
+            void run(argon2_memory_pool * pool) noexcept override
+            {
+                try
+                {
+                    result.status = detail::verify_encoded(password_, stored_hash_, pool) ? verify_status::match : verify_status::mismatch;
+                }
+                catch(...)
+                {
+                    result.status = verify_status::error;
+                    result.error = std::current_exception();
+                }
+                password_.clear();
+            }
+    };
+
+    // Process-wide executor with the default options, created on first use
+    inline verify_executor & default_verify_executor()
+    {
+        static verify_executor executor;
+        return executor;
+    }
+
+    template <typename CharT, typename Traits>
+    verify_awaitable<CharT, Traits> verify_async(verify_executor & executor, basic_password<CharT, Traits> && password,
+                                                 std::string_view stored_hash, const verify_options & options = {})
+    {
+        return verify_awaitable<CharT, Traits>(executor, std::move(password), stored_hash, options);
+    }
+    template <typename CharT, typename Traits>
+    verify_awaitable<CharT, Traits> verify_async(basic_password<CharT, Traits> && password, std::string_view stored_hash,
+                                                 const verify_options & options = {})
+    {
+        return verify_awaitable<CharT, Traits>(default_verify_executor(), std::move(password), stored_hash, options);
+    }
+    // Other allocators: the job runs on a worker thread, so the secret is moved out of resources meant for one thread
+    // (such as secure_arena) into a default-allocated password, and the source is wiped
+    template <typename CharT, typename Traits, typename Alloc>
+    verify_awaitable<CharT, Traits> verify_async(verify_executor & executor, basic_password<CharT, Traits, Alloc> && password,
+                                                 std::string_view stored_hash, const verify_options & options = {})
+    {
+        basic_password<CharT, Traits> owned(password.view());
+        password.clear();
+        return verify_awaitable<CharT, Traits>(executor, std::move(owned), stored_hash, options);
+    }
+    template <typename CharT, typename Traits, typename Alloc>
+    verify_awaitable<CharT, Traits> verify_async(basic_password<CharT, Traits, Alloc> && password, std::string_view stored_hash,
+                                                 const verify_options & options = {})
+    {
+        return verify_async(default_verify_executor(), std::move(password), stored_hash, options);
+    }
+}
+
+#endif // MERLIN_VERIFY_EXECUTOR_HPP
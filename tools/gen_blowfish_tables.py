@@ -0,0 +1,54 @@
+#!/usr/bin/env python3
+# Generates include/merlin_blowfish_tables.hpp: the initial Blowfish P-array and S-boxes, which are
+# the hexadecimal digits of the fractional part of pi.
+# Usage: python3 tools/gen_blowfish_tables.py > include/merlin_blowfish_tables.hpp
+
+WORDS = 18 + 4 * 256
+
+def pi_fraction_hex(digits):
+    """First `digits` hexadecimal digits of pi - 3 (Machin's formula on fixed-point integers)."""
+    bits = 4 * digits + 64
+    one = 1 << bits
+
+    def arctan_inv(x):
+        total, term, n, sign = 0, one // x, 1, 1
+        while term:
+            total += sign * (term // n)
+            term //= x * x
+            n += 2
+            sign = -sign
+        return total
+
+    pi = 16 * arctan_inv(5) - 4 * arctan_inv(239)
+    return (pi - 3 * one) >> 64
+
+fraction = pi_fraction_hex(8 * WORDS)
+words = [(fraction >> (32 * (WORDS - 1 - i))) & 0xffffffff for i in range(WORDS)]
+assert words[0] == 0x243f6a88 and words[18] == 0xd1310ba6
+
+def table(values, indent):
+    rows = [', '.join('0x%08x' % v for v in values[i:i + 8]) for i in range(0, len(values), 8)]
+    return (',\n' + indent).join(rows)
+
+print('#ifndef MERLIN_BLOWFISH_TABLES_HPP')
+print('#define MERLIN_BLOWFISH_TABLES_HPP')
+print()
+print('// Generated by tools/gen_blowfish_tables.py (hexadecimal digits of pi) - do not edit.')
+print()
+print('#include <cstdint>')
+print()
+print('namespace merl::detail')
+print('{')
+print('    inline constexpr std::uint32_t blowfish_p[18] = {')
+print('        ' + table(words[:18], '        '))
+print('    };')
+print('    inline constexpr std::uint32_t blowfish_s[4][256] = {')
+for box in range(4):
+    start = 18 + 256 * box
+    print('        {')
+    print('            ' + table(words[start:start + 256], '            '))
+    print('        }' + (',' if box < 3 else ''))
+print('    };')
+print('}')
+print()
+print('#endif // MERLIN_BLOWFISH_TABLES_HPP')
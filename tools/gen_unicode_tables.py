@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+# Generates include/merlin_unicode_tables.hpp from the Unicode database bundled with Python (unicodedata).
+# Usage: python3 tools/gen_unicode_tables.py > include/merlin_unicode_tables.hpp
+
+import unicodedata as ud
+
+def ranges(values):
+    """Collapses {cp: value} into [first, last, value] runs of consecutive code points."""
+    out = []
+    for cp in sorted(values):
+        v = values[cp]
+        if out and out[-1][1] == cp - 1 and out[-1][2] == v:
+            out[-1][1] = cp
+        else:
+            out.append([cp, cp, v])
+    return out
+
+def in_ranges(cp, rs):
+    return any(a <= cp <= b for a, b in rs)
+
+# --- Canonical combining classes ---
+ccc = {cp: ud.combining(chr(cp)) for cp in range(0x110000) if ud.combining(chr(cp))}
+
+# --- Canonical decompositions (single level) and primary composites ---
+decompositions = []
+compositions = []
+for cp in range(0x110000):
+    d = ud.decomposition(chr(cp))
+    if not d or d.startswith('<'):
+        continue
+    parts = [int(x, 16) for x in d.split()]
+    first, second = parts[0], parts[1] if len(parts) == 2 else 0
+    decompositions.append((cp, first, second))
+    if second and ud.normalize('NFC', chr(first) + chr(second)) == chr(cp):
+        compositions.append((first, second, cp))
+compositions.sort()
+
+# --- PRECIS FreeformClass derived property (RFC 8264 section 8, RFC 5892 section 2.6 exceptions) ---
+VALID, CONTEXTJ, CONTEXTO = 1, 2, 3
+
+exceptions = {0x00DF: VALID, 0x03C2: VALID, 0x06FD: VALID, 0x06FE: VALID, 0x0F0B: VALID, 0x3007: VALID,
+              0x00B7: CONTEXTO, 0x0375: CONTEXTO, 0x05F3: CONTEXTO, 0x05F4: CONTEXTO, 0x30FB: CONTEXTO,
+              0x0640: 0, 0x07FA: 0, 0x302E: 0, 0x302F: 0, 0x3031: 0, 0x3032: 0, 0x3033: 0, 0x3034: 0, 0x3035: 0, 0x303B: 0}
+exceptions.update({cp: CONTEXTO for cp in list(range(0x0660, 0x066A)) + list(range(0x06F0, 0x06FA))})
+
+old_hangul_jamo = [(0x1100, 0x11FF), (0xA960, 0xA97C), (0xD7B0, 0xD7C6), (0xD7CB, 0xD7FB)]
+# Default_Ignorable_Code_Point = Other_Default_Ignorable_Code_Point + Cf + Variation_Selector
+#                                - White_Space - FFF9..FFFB - 13430..13438 - Prepended_Concatenation_Mark
+other_default_ignorable = [(0x034F, 0x034F), (0x115F, 0x1160), (0x17B4, 0x17B5), (0x2065, 0x2065), (0x3164, 0x3164),
+                           (0xFFA0, 0xFFA0), (0xFFF0, 0xFFF8), (0xE0000, 0xE0000), (0xE0002, 0xE001F),
+                           (0xE0080, 0xE00FF), (0xE01F0, 0xE0FFF)]
+variation_selectors = [(0x180B, 0x180D), (0x180F, 0x180F), (0xFE00, 0xFE0F), (0xE0100, 0xE01EF)]
+not_ignorable = [(0xFFF9, 0xFFFB), (0x13430, 0x13438), (0x0600, 0x0605), (0x06DD, 0x06DD), (0x070F, 0x070F),
+                 (0x0890, 0x0891), (0x08E2, 0x08E2), (0x110BD, 0x110BD), (0x110CD, 0x110CD)]
+
+def default_ignorable(cp):
+    if in_ranges(cp, not_ignorable):
+        return False
+    return ud.category(chr(cp)) == 'Cf' or in_ranges(cp, other_default_ignorable) or in_ranges(cp, variation_selectors)
+
+def noncharacter(cp):
+    return 0xFDD0 <= cp <= 0xFDEF or (cp & 0xFFFE) == 0xFFFE
+
+def freeform(cp):
+    if cp in exceptions:
+        return exceptions[cp]
+    c = chr(cp)
+    cat = ud.category(c)
+    if cat == 'Cn':
+        return 0
+    if 0x21 <= cp <= 0x7E:
+        return VALID
+    if cp in (0x200C, 0x200D):
+        return CONTEXTJ
+    if in_ranges(cp, old_hangul_jamo) or default_ignorable(cp) or noncharacter(cp) or cat == 'Cc':
+        return 0
+    if ud.normalize('NFKC', c) != c: # HasCompat
+        return VALID
+    if cat in ('Ll', 'Lu', 'Lo', 'Nd', 'Lm', 'Mn', 'Mc', 'Lt', 'Nl', 'No', 'Me', 'Zs',
+               'Sm', 'Sc', 'Sk', 'So', 'Pc', 'Pd', 'Ps', 'Pe', 'Pi', 'Pf', 'Po'):
+        return VALID
+    return 0
+
+precis = {cp: v for cp in range(0x110000) if not (0xD800 <= cp <= 0xDFFF) for v in [freeform(cp)] if v}
+
+# --- Output ---
+def rows(items, fmt, per_line):
+    lines = []
+    for i in range(0, len(items), per_line):
+        lines.append('        ' + ' '.join(fmt(x) for x in items[i:i+per_line]))
+    return '\n'.join(lines)
+
+print('''#ifndef MERLIN_UNICODE_TABLES_HPP
+#define MERLIN_UNICODE_TABLES_HPP
+
+// Generated by tools/gen_unicode_tables.py from the Unicode Character Database %s - do not edit.
+
+#include <cstdint>
+
+namespace merl::detail::unicode
+{
+    struct range_value
+    {
+        char32_t first;
+        char32_t last;
+        std::uint8_t value;
+    };
+    struct decomposition
+    {
+        char32_t code_point;
+        char32_t first;
+        char32_t second;
+    };
+    struct composition
+    {
+        char32_t first;
+        char32_t second;
+        char32_t composite;
+    };
+
+    inline constexpr std::uint8_t precis_disallowed = 0;
+    inline constexpr std::uint8_t precis_valid = 1;
+    inline constexpr std::uint8_t precis_contextj = 2;
+    inline constexpr std::uint8_t precis_contexto = 3;
+
+    inline constexpr char unicode_version[] = "%s";
+''' % (ud.unidata_version, ud.unidata_version))
+
+print('    // Canonical_Combining_Class, non-zero runs only')
+print('    inline constexpr range_value combining_classes[] =\n    {')
+print(rows(ranges(ccc), lambda r: '{0x%X, 0x%X, %d},' % tuple(r), 6))
+print('    };\n')
+
+print('    // Canonical decomposition mappings: {code point, first, second (0 for singletons)}, sorted by code point')
+print('    inline constexpr decomposition decompositions[] =\n    {')
+print(rows(decompositions, lambda d: '{0x%X, 0x%X, 0x%X},' % d, 5))
+print('    };\n')
+
+print('    // Primary composites: {first, second, composite}, sorted by (first, second)')
+print('    inline constexpr composition compositions[] =\n    {')
+print(rows(compositions, lambda d: '{0x%X, 0x%X, 0x%X},' % d, 5))
+print('    };\n')
+
+print('    // PRECIS FreeformClass derived property, runs that are not DISALLOWED/UNASSIGNED only')
+print('    inline constexpr range_value precis_freeform[] =\n    {')
+print(rows(ranges(precis), lambda r: '{0x%X, 0x%X, %d},' % tuple(r), 6))
+print('    };')
+print('}\n\n#endif // MERLIN_UNICODE_TABLES_HPP')